@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/apdu-batch.h
+ * \brief Batched exchange of fixed APDU sequences with preallocated response buffers.
+ */
+#ifndef INFINEON_APDU_BATCH_H
+#define INFINEON_APDU_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief IFX status code module identifier.
+ */
+#define LIBAPDUBATCH 0x39U
+
+/**
+ * \brief IFX status encoding function identifier for apdu_batch_transceive().
+ */
+#define IFX_APDU_BATCH_TRANSCEIVE (0x01U)
+
+/**
+ * \brief Error reason if a response does not fit into its response buffer.
+ */
+#define APDU_BATCH_RESPONSE_TOO_LARGE (0x01U)
+
+/**
+ * \brief Error reason if a response does not end with status word \c 9000.
+ */
+#define APDU_BATCH_STATUS_WORD_MISMATCH (0x02U)
+
+/**
+ * \brief Error reason of entries not exchanged because the batch stopped at an earlier error.
+ */
+#define APDU_BATCH_NOT_EXECUTED (0x03U)
+
+/**
+ * \brief Flag: continue with the next entry after an error instead of stopping.
+ */
+#define APDU_BATCH_CONTINUE_ON_ERROR (0x01U)
+
+/**
+ * \brief Flag: treat responses not ending with status word \c 9000 as error.
+ */
+#define APDU_BATCH_CHECK_STATUS_WORD (0x02U)
+
+/**
+ * \brief Flag: no other protocol stack accesses the I2C device during the batch.
+ *
+ * \details The I2C slave address is then only set before the first frame of
+ * the batch instead of before every frame (see i2c_rpi_pin_slave_address()).
+ */
+#define APDU_BATCH_EXCLUSIVE_BUS (0x04U)
+
+/** \struct apdu_batch_entry_t
+ * \brief Single command APDU of a batch and the slot its response is stored in.
+ */
+typedef struct
+{
+    /**
+     * \brief Command APDU.
+     */
+    const uint8_t *apdu;
+
+    /**
+     * \brief Number of bytes in \ref apdu_batch_entry_t.apdu.
+     */
+    size_t apdu_len;
+
+    /**
+     * \brief Preallocated buffer for response including status word (\c NULL to discard response data).
+     */
+    uint8_t *response;
+
+    /**
+     * \brief Size of \ref apdu_batch_entry_t.response in [bytes].
+     */
+    size_t response_capacity;
+
+    /**
+     * \brief Number of response bytes received (set by apdu_batch_transceive(), may exceed capacity on error).
+     */
+    size_t response_len;
+
+    /**
+     * \brief Result of this entry (set by apdu_batch_transceive()).
+     */
+    ifx_status_t status;
+} apdu_batch_entry_t;
+
+/**
+ * \brief Exchanges a sequence of APDUs back-to-back.
+ *
+ * \details The protocol stack and all entries are validated once up front,
+ * then each APDU is exchanged in order via ifx_protocol_transceive() (same
+ * framing, guard times and per-response allocation). With
+ * \ref APDU_BATCH_EXCLUSIVE_BUS the I2C slave address is set once for the
+ * whole batch, saving one syscall per I2C frame. Responses are copied into the
+ * preallocated slots of the entries, so the caller does not manage any
+ * response memory. Each entry's \ref apdu_batch_entry_t.status reports its
+ * own result; entries skipped after an error are marked with
+ * \ref APDU_BATCH_NOT_EXECUTED.
+ *
+ * \param[in] self Protocol stack to be used.
+ * \param[in,out] entries APDUs to be exchanged and their response slots.
+ * \param[in] entry_count Number of entries in \p entries.
+ * \param[in] flags Combination of \ref APDU_BATCH_CONTINUE_ON_ERROR, \ref APDU_BATCH_CHECK_STATUS_WORD and \ref APDU_BATCH_EXCLUSIVE_BUS.
+ * \param[out] completed Optional buffer to store number of successfully exchanged entries in.
+ * \return ifx_status_t \c IFX_SUCCESS if all entries succeeded, status of first failed entry otherwise.
+ */
+ifx_status_t apdu_batch_transceive(ifx_protocol_t *self, apdu_batch_entry_t *entries, size_t entry_count, uint32_t flags, size_t *completed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_APDU_BATCH_H
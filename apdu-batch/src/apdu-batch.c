@@ -0,0 +1,155 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file apdu-batch.c
+ * \brief Batched exchange of fixed APDU sequences with preallocated response buffers.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/apdu-batch.h"
+#include "infineon/i2c-rpi.h"
+#include "infineon/trace-rpi.h"
+#include "apdu-batch.h"
+
+/**
+ * \brief Checks that all entries of a batch can be exchanged.
+ *
+ * \param[in] entries Entries to be checked.
+ * \param[in] entry_count Number of entries in \p entries.
+ * \return bool \c true if all entries are valid.
+ */
+bool apdu_batch_validate_entries(const apdu_batch_entry_t *entries, size_t entry_count)
+{
+    for (size_t i = 0U; i < entry_count; i++)
+    {
+        if ((entries[i].apdu == NULL) || (entries[i].apdu_len == 0U) || ((entries[i].response == NULL) && (entries[i].response_capacity != 0U)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Copies response into slot of entry and determines its result.
+ *
+ * \param[in,out] entry Entry the response belongs to.
+ * \param[in] response Response received from protocol stack.
+ * \param[in] response_len Number of bytes in \p response.
+ * \param[in] flags Flags given to apdu_batch_transceive().
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t apdu_batch_store_response(apdu_batch_entry_t *entry, const uint8_t *response, size_t response_len, uint32_t flags)
+{
+    entry->response_len = response_len;
+    if (entry->response != NULL)
+    {
+        if (response_len > entry->response_capacity)
+        {
+            return IFX_ERROR(LIBAPDUBATCH, IFX_APDU_BATCH_TRANSCEIVE, APDU_BATCH_RESPONSE_TOO_LARGE);
+        }
+        if (response_len > 0U)
+        {
+            memcpy(entry->response, response, response_len);
+        }
+    }
+    if (((flags & APDU_BATCH_CHECK_STATUS_WORD) != 0U) &&
+        ((response_len < 2U) || (response[response_len - 2U] != 0x90U) || (response[response_len - 1U] != 0x00U)))
+    {
+        return IFX_ERROR(LIBAPDUBATCH, IFX_APDU_BATCH_TRANSCEIVE, APDU_BATCH_STATUS_WORD_MISMATCH);
+    }
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Exchanges a sequence of APDUs back-to-back.
+ *
+ * \param[in] self Protocol stack to be used.
+ * \param[in,out] entries APDUs to be exchanged and their response slots.
+ * \param[in] entry_count Number of entries in \p entries.
+ * \param[in] flags Combination of \ref APDU_BATCH_CONTINUE_ON_ERROR, \ref APDU_BATCH_CHECK_STATUS_WORD and \ref APDU_BATCH_EXCLUSIVE_BUS.
+ * \param[out] completed Optional buffer to store number of successfully exchanged entries in.
+ * \return ifx_status_t \c IFX_SUCCESS if all entries succeeded, status of first failed entry otherwise.
+ */
+ifx_status_t apdu_batch_transceive(ifx_protocol_t *self, apdu_batch_entry_t *entries, size_t entry_count, uint32_t flags, size_t *completed)
+{
+    // Validate parameters and protocol stack once for the whole batch
+    if ((self == NULL) || ((entries == NULL) && (entry_count > 0U)) ||
+        ((flags & ~(uint32_t) (APDU_BATCH_CONTINUE_ON_ERROR | APDU_BATCH_CHECK_STATUS_WORD | APDU_BATCH_EXCLUSIVE_BUS)) != 0U) ||
+        !apdu_batch_validate_entries(entries, entry_count))
+    {
+        return IFX_ERROR(LIBAPDUBATCH, IFX_APDU_BATCH_TRANSCEIVE, IFX_ILLEGAL_ARGUMENT);
+    }
+    if ((self->_transceive == NULL) && ((self->_transmit == NULL) || (self->_receive == NULL)))
+    {
+        return IFX_ERROR(LIBAPDUBATCH, IFX_APDU_BATCH_TRANSCEIVE, IFX_PROTOCOL_STACK_INVALID);
+    }
+    if (completed != NULL)
+    {
+        *completed = 0U;
+    }
+    for (size_t i = 0U; i < entry_count; i++)
+    {
+        entries[i].response_len = 0U;
+        entries[i].status = IFX_ERROR(LIBAPDUBATCH, IFX_APDU_BATCH_TRANSCEIVE, APDU_BATCH_NOT_EXECUTED);
+    }
+
+    // Set I2C slave address only once for the whole batch (stacks without Raspberry PI I2C layer are left alone)
+    bool pinned = false;
+    bool previously_pinned = false;
+    if ((flags & APDU_BATCH_EXCLUSIVE_BUS) != 0U)
+    {
+        pinned = !ifx_error_check(i2c_rpi_pin_slave_address(self, true, &previously_pinned));
+    }
+
+    trace_rpi_begin("apdu_batch", "apdu", entry_count);
+    ifx_status_t result = IFX_SUCCESS;
+    size_t successful = 0U;
+    for (size_t i = 0U; i < entry_count; i++)
+    {
+        apdu_batch_entry_t *entry = &entries[i];
+        uint8_t *response = NULL;
+        size_t response_len = 0U;
+        entry->status = ifx_protocol_transceive(self, entry->apdu, entry->apdu_len, &response, &response_len);
+        if (!ifx_error_check(entry->status))
+        {
+            entry->status = apdu_batch_store_response(entry, response, response_len, flags);
+        }
+        if (response != NULL)
+        {
+            free(response);
+        }
+
+        if (!ifx_error_check(entry->status))
+        {
+            successful++;
+            continue;
+        }
+        if (!ifx_error_check(result))
+        {
+            result = entry->status;
+        }
+        if ((flags & APDU_BATCH_CONTINUE_ON_ERROR) == 0U)
+        {
+            break;
+        }
+    }
+    trace_rpi_end("apdu_batch", "apdu", successful, result);
+    if (pinned)
+    {
+        i2c_rpi_pin_slave_address(self, previously_pinned, NULL);
+    }
+
+    if (completed != NULL)
+    {
+        *completed = successful;
+    }
+    return result;
+}
@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file apdu-batch.h
+ * \brief Internal definitions for batched exchange of fixed APDU sequences.
+ */
+#ifndef APDU_BATCH_H
+#define APDU_BATCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "infineon/apdu-batch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Checks that all entries of a batch can be exchanged.
+ *
+ * \param[in] entries Entries to be checked.
+ * \param[in] entry_count Number of entries in \p entries.
+ * \return bool \c true if all entries are valid.
+ */
+bool apdu_batch_validate_entries(const apdu_batch_entry_t *entries, size_t entry_count);
+
+/**
+ * \brief Copies response into slot of entry and determines its result.
+ *
+ * \param[in,out] entry Entry the response belongs to.
+ * \param[in] response Response received from protocol stack.
+ * \param[in] response_len Number of bytes in \p response.
+ * \param[in] flags Flags given to apdu_batch_transceive().
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t apdu_batch_store_response(apdu_batch_entry_t *entry, const uint8_t *response, size_t response_len, uint32_t flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APDU_BATCH_H
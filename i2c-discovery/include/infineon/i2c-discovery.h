@@ -0,0 +1,219 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/i2c-discovery.h
+ * \brief Concurrent scan of I2C adapters for NBTs.
+ */
+#ifndef INFINEON_I2C_DISCOVERY_H
+#define INFINEON_I2C_DISCOVERY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief IFX status code module identifier.
+ */
+#define LIBI2CDISCOVERY 0x3FU
+
+/**
+ * \brief IFX status encoding function identifier for i2c_discovery_scan().
+ */
+#define IFX_I2C_DISCOVERY_SCAN (0x01U)
+
+/**
+ * \brief Error reason if no I2C adapter could be found or opened.
+ */
+#define I2C_DISCOVERY_NO_ADAPTER (0x01U)
+
+/**
+ * \brief First 7 bit address probed if not configured otherwise.
+ */
+#define I2C_DISCOVERY_DEFAULT_FIRST_ADDRESS 0x08U
+
+/**
+ * \brief Last 7 bit address probed if not configured otherwise.
+ */
+#define I2C_DISCOVERY_DEFAULT_LAST_ADDRESS 0x77U
+
+/**
+ * \brief Longest probe in [ms] before scan of an adapter is aborted if not configured otherwise.
+ */
+#define I2C_DISCOVERY_DEFAULT_TIMEOUT_MS 10U
+
+/**
+ * \brief Maximum length of I2C character device paths including terminator.
+ */
+#define I2C_DISCOVERY_MAX_DEVICE_LEN 64U
+
+/**
+ * \brief Maximum number of CIP bytes kept per tag.
+ */
+#define I2C_DISCOVERY_MAX_CIP_LEN 64U
+
+/** \struct i2c_discovery_options_t
+ * \brief Settings of a scan.
+ */
+typedef struct
+{
+    /**
+     * \brief First 7 bit address to be probed (\c 0 for \ref I2C_DISCOVERY_DEFAULT_FIRST_ADDRESS).
+     */
+    uint8_t first_address;
+
+    /**
+     * \brief Last 7 bit address to be probed (\c 0 for \ref I2C_DISCOVERY_DEFAULT_LAST_ADDRESS).
+     */
+    uint8_t last_address;
+
+    /**
+     * \brief Longest probe in [ms] before scan of the adapter is aborted (\c 0 for \ref I2C_DISCOVERY_DEFAULT_TIMEOUT_MS).
+     */
+    uint32_t timeout_ms;
+
+    /**
+     * \brief Whether each acknowledging address is activated via GP T=1' to tell NBTs from other devices.
+     */
+    bool activate;
+
+    /**
+     * \brief Whether addresses of common EEPROM ranges (0x30 to 0x37, 0x50 to 0x5f) are activated as well.
+     *
+     * \details Activation writes a multi-byte GP T=1' frame, which an EEPROM
+     * may take as data to be stored, so these addresses are only probed by default.
+     */
+    bool activate_eeprom_ranges;
+} i2c_discovery_options_t;
+
+/** \struct i2c_discovery_device_t
+ * \brief Device acknowledging its address during a scan.
+ */
+typedef struct
+{
+    /**
+     * \brief I2C character device of the adapter.
+     */
+    char device[I2C_DISCOVERY_MAX_DEVICE_LEN];
+
+    /**
+     * \brief 7 bit I2C slave address.
+     */
+    uint8_t address;
+
+    /**
+     * \brief Duration of the probe in [ns].
+     */
+    uint64_t probe_ns;
+
+    /**
+     * \brief Whether GP T=1' activation was attempted.
+     */
+    bool activated;
+
+    /**
+     * \brief Result of GP T=1' activation (only valid if \ref activated is set).
+     */
+    ifx_status_t activation_status;
+
+    /**
+     * \brief Duration of GP T=1' activation in [ns].
+     */
+    uint64_t activation_ns;
+
+    /**
+     * \brief Communication interface parameters returned by the tag (truncated to \ref I2C_DISCOVERY_MAX_CIP_LEN).
+     */
+    uint8_t cip[I2C_DISCOVERY_MAX_CIP_LEN];
+
+    /**
+     * \brief Number of bytes in \ref cip.
+     */
+    size_t cip_len;
+} i2c_discovery_device_t;
+
+/** \struct i2c_discovery_report_t
+ * \brief Result of a scan.
+ */
+typedef struct
+{
+    /**
+     * \brief Acknowledging devices ordered by adapter and address.
+     */
+    i2c_discovery_device_t *devices;
+
+    /**
+     * \brief Number of entries in \ref devices.
+     */
+    size_t device_count;
+
+    /**
+     * \brief Number of adapters scanned.
+     */
+    size_t adapter_count;
+
+    /**
+     * \brief Number of adapters that could not be opened or do not support zero-length probes.
+     */
+    size_t failed_adapters;
+
+    /**
+     * \brief Number of addresses probed on all adapters.
+     */
+    size_t probes;
+
+    /**
+     * \brief Number of addresses skipped because a kernel driver claimed them.
+     */
+    size_t busy_addresses;
+
+    /**
+     * \brief Number of adapters whose scan was aborted because a probe took longer than the timeout.
+     */
+    size_t slow_adapters;
+
+    /**
+     * \brief Duration of the whole scan in [ns].
+     */
+    uint64_t elapsed_ns;
+} i2c_discovery_report_t;
+
+/**
+ * \brief Scans I2C adapters for devices and NBTs.
+ *
+ * \details Every adapter is scanned by its own thread. Each address is
+ * probed with a zero-length write via \c I2C_RDWR (SMBus quick write on
+ * adapters without plain I2C support), which NBTs acknowledge even while
+ * idle. The adapter's own timeout and retries are left untouched as they are
+ * shared with all other users of the bus; instead, the scan of an adapter is
+ * aborted once a probe takes longer than the configured timeout. Addresses
+ * claimed by kernel drivers are skipped. If enabled, a GP T=1' stack is
+ * activated on every acknowledging address outside of the EEPROM ranges (see
+ * \ref i2c_discovery_options_t.activate_eeprom_ranges) and the CIP is kept.
+ *
+ * \param[in] devices I2C character devices to be scanned (\c NULL for all \c /dev/i2c-N).
+ * \param[in] device_count Number of entries in \p devices.
+ * \param[in] options Scan settings (\c NULL for defaults with activation).
+ * \param[out] report Buffer to store result in (to be freed with i2c_discovery_free()).
+ * \return ifx_status_t \c IFX_SUCCESS if at least one adapter was scanned, any other value in case of error.
+ */
+ifx_status_t i2c_discovery_scan(const char *const *devices, size_t device_count, const i2c_discovery_options_t *options, i2c_discovery_report_t *report);
+
+/**
+ * \brief Frees memory of a scan result.
+ *
+ * \param[in] report Result of i2c_discovery_scan().
+ */
+void i2c_discovery_free(i2c_discovery_report_t *report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_I2C_DISCOVERY_H
@@ -0,0 +1,415 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file i2c-discovery.c
+ * \brief Concurrent scan of I2C adapters for NBTs.
+ */
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/ifx-t1prime.h"
+#include "infineon/i2c-discovery.h"
+#include "infineon/i2c-rpi.h"
+#include "i2c-discovery.h"
+
+static uint64_t i2c_discovery_get_monotonic_ns(void);
+static int i2c_discovery_compare_adapters(const void *a, const void *b);
+static bool i2c_discovery_is_eeprom_address(unsigned address);
+static void i2c_discovery_activate(int fd, i2c_discovery_device_t *device);
+
+/**
+ * \brief Scans I2C adapters for devices and NBTs.
+ *
+ * \param[in] devices I2C character devices to be scanned (\c NULL for all \c /dev/i2c-N).
+ * \param[in] device_count Number of entries in \p devices.
+ * \param[in] options Scan settings (\c NULL for defaults with activation).
+ * \param[out] report Buffer to store result in (to be freed with i2c_discovery_free()).
+ * \return ifx_status_t \c IFX_SUCCESS if at least one adapter was scanned, any other value in case of error.
+ */
+ifx_status_t i2c_discovery_scan(const char *const *devices, size_t device_count, const i2c_discovery_options_t *options, i2c_discovery_report_t *report)
+{
+    // Validate parameters
+    if ((report == NULL) || ((devices == NULL) && (device_count > 0U)) ||
+        ((options != NULL) && ((options->first_address > 0x7fU) || (options->last_address > 0x7fU))))
+    {
+        return IFX_ERROR(LIBI2CDISCOVERY, IFX_I2C_DISCOVERY_SCAN, IFX_ILLEGAL_ARGUMENT);
+    }
+    memset(report, 0, sizeof(i2c_discovery_report_t));
+
+    i2c_discovery_options_t settings = {0U, 0U, 0U, true, false};
+    if (options != NULL)
+    {
+        settings = *options;
+    }
+    settings.first_address = (settings.first_address == 0U) ? I2C_DISCOVERY_DEFAULT_FIRST_ADDRESS : settings.first_address;
+    settings.last_address = (settings.last_address == 0U) ? I2C_DISCOVERY_DEFAULT_LAST_ADDRESS : settings.last_address;
+    settings.timeout_ms = (settings.timeout_ms == 0U) ? I2C_DISCOVERY_DEFAULT_TIMEOUT_MS : settings.timeout_ms;
+    if (settings.first_address > settings.last_address)
+    {
+        return IFX_ERROR(LIBI2CDISCOVERY, IFX_I2C_DISCOVERY_SCAN, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    uint64_t start_ns = i2c_discovery_get_monotonic_ns();
+    I2CDiscoveryAdapter *adapters = NULL;
+    size_t adapter_count = 0U;
+    if (devices == NULL)
+    {
+        ifx_status_t status = i2c_discovery_list_adapters(&adapters, &adapter_count);
+        if (ifx_error_check(status))
+        {
+            return status;
+        }
+    }
+    else if (device_count > 0U)
+    {
+        adapters = calloc(device_count, sizeof(I2CDiscoveryAdapter));
+        if (adapters == NULL)
+        {
+            return IFX_ERROR(LIBI2CDISCOVERY, IFX_I2C_DISCOVERY_SCAN, IFX_OUT_OF_MEMORY);
+        }
+        for (size_t i = 0U; i < device_count; i++)
+        {
+            if ((devices[i] == NULL) || (strlen(devices[i]) >= I2C_DISCOVERY_MAX_DEVICE_LEN))
+            {
+                free(adapters);
+                return IFX_ERROR(LIBI2CDISCOVERY, IFX_I2C_DISCOVERY_SCAN, IFX_ILLEGAL_ARGUMENT);
+            }
+            strcpy(adapters[i].device, devices[i]);
+        }
+        adapter_count = device_count;
+    }
+    if (adapter_count == 0U)
+    {
+        free(adapters);
+        return IFX_ERROR(LIBI2CDISCOVERY, IFX_I2C_DISCOVERY_SCAN, I2C_DISCOVERY_NO_ADAPTER);
+    }
+
+    // One thread per adapter, adapters without thread are scanned here afterwards
+    for (size_t i = 0U; i < adapter_count; i++)
+    {
+        adapters[i].options = &settings;
+        adapters[i].started = (pthread_create(&adapters[i].thread, NULL, i2c_discovery_scan_adapter, &adapters[i]) == 0);
+    }
+    size_t total = 0U;
+    for (size_t i = 0U; i < adapter_count; i++)
+    {
+        if (adapters[i].started)
+        {
+            pthread_join(adapters[i].thread, NULL);
+        }
+        else
+        {
+            i2c_discovery_scan_adapter(&adapters[i]);
+        }
+        total += adapters[i].device_count;
+    }
+
+    // Merge results in adapter order
+    ifx_status_t status = IFX_SUCCESS;
+    if (total > 0U)
+    {
+        report->devices = malloc(total * sizeof(i2c_discovery_device_t));
+        if (report->devices == NULL)
+        {
+            status = IFX_ERROR(LIBI2CDISCOVERY, IFX_I2C_DISCOVERY_SCAN, IFX_OUT_OF_MEMORY);
+        }
+    }
+    for (size_t i = 0U; i < adapter_count; i++)
+    {
+        if (report->devices != NULL)
+        {
+            memcpy(&report->devices[report->device_count], adapters[i].devices, adapters[i].device_count * sizeof(i2c_discovery_device_t));
+            report->device_count += adapters[i].device_count;
+        }
+        free(adapters[i].devices);
+        report->failed_adapters += adapters[i].failed ? 1U : 0U;
+        report->probes += adapters[i].probes;
+        report->busy_addresses += adapters[i].busy_addresses;
+        report->slow_adapters += adapters[i].slow ? 1U : 0U;
+    }
+    report->adapter_count = adapter_count;
+    report->elapsed_ns = i2c_discovery_get_monotonic_ns() - start_ns;
+    free(adapters);
+
+    if (!ifx_error_check(status) && (report->failed_adapters == report->adapter_count))
+    {
+        status = IFX_ERROR(LIBI2CDISCOVERY, IFX_I2C_DISCOVERY_SCAN, I2C_DISCOVERY_NO_ADAPTER);
+    }
+    return status;
+}
+
+/**
+ * \brief Frees memory of a scan result.
+ *
+ * \param[in] report Result of i2c_discovery_scan().
+ */
+void i2c_discovery_free(i2c_discovery_report_t *report)
+{
+    if (report == NULL)
+    {
+        return;
+    }
+    free(report->devices);
+    report->devices = NULL;
+    report->device_count = 0U;
+}
+
+/**
+ * \brief Lists all i2c-dev character devices ordered by adapter number.
+ *
+ * \param[out] adapters Buffer to store newly allocated adapters in.
+ * \param[out] adapter_count Buffer to store number of adapters in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_discovery_list_adapters(I2CDiscoveryAdapter **adapters, size_t *adapter_count)
+{
+    *adapters = NULL;
+    *adapter_count = 0U;
+    DIR *directory = opendir(I2C_DISCOVERY_DEVICE_DIRECTORY);
+    if (directory == NULL)
+    {
+        return IFX_ERROR(LIBI2CDISCOVERY, IFX_I2C_DISCOVERY_SCAN, I2C_DISCOVERY_NO_ADAPTER);
+    }
+
+    ifx_status_t status = IFX_SUCCESS;
+    struct dirent *entry;
+    while ((entry = readdir(directory)) != NULL)
+    {
+        unsigned number = 0U;
+        int consumed = 0;
+        if ((sscanf(entry->d_name, "i2c-%u%n", &number, &consumed) != 1) || (entry->d_name[consumed] != '\0'))
+        {
+            continue;
+        }
+        I2CDiscoveryAdapter *grown = realloc(*adapters, (*adapter_count + 1U) * sizeof(I2CDiscoveryAdapter));
+        if (grown == NULL)
+        {
+            status = IFX_ERROR(LIBI2CDISCOVERY, IFX_I2C_DISCOVERY_SCAN, IFX_OUT_OF_MEMORY);
+            break;
+        }
+        *adapters = grown;
+        memset(&grown[*adapter_count], 0, sizeof(I2CDiscoveryAdapter));
+        snprintf(grown[*adapter_count].device, I2C_DISCOVERY_MAX_DEVICE_LEN, I2C_DISCOVERY_DEVICE_DIRECTORY "/i2c-%u", number);
+        (*adapter_count)++;
+    }
+    closedir(directory);
+
+    if (ifx_error_check(status))
+    {
+        free(*adapters);
+        *adapters = NULL;
+        *adapter_count = 0U;
+        return status;
+    }
+    if (*adapter_count > 1U)
+    {
+        qsort(*adapters, *adapter_count, sizeof(I2CDiscoveryAdapter), i2c_discovery_compare_adapters);
+    }
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Scans all addresses of a single adapter.
+ *
+ * \param[in,out] arg \ref I2CDiscoveryAdapter to be scanned.
+ * \return void* Always \c NULL.
+ */
+void *i2c_discovery_scan_adapter(void *arg)
+{
+    I2CDiscoveryAdapter *adapter = (I2CDiscoveryAdapter *) arg;
+    const i2c_discovery_options_t *options = adapter->options;
+    int fd = open(adapter->device, O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+    {
+        adapter->failed = true;
+        return NULL;
+    }
+
+    // Zero-length write is acknowledged by NBTs even while idle (reads are not)
+    unsigned long functionality = 0U;
+    if (ioctl(fd, I2C_FUNCS, &functionality) < 0)
+    {
+        functionality = 0U;
+    }
+    bool smbus = ((functionality & I2C_FUNC_I2C) == 0U);
+    if (smbus && ((functionality & I2C_FUNC_SMBUS_QUICK) == 0U))
+    {
+        adapter->failed = true;
+        close(fd);
+        return NULL;
+    }
+
+    for (unsigned address = options->first_address; address <= options->last_address; address++)
+    {
+        // Addresses claimed by kernel drivers are left alone
+        if (ioctl(fd, I2C_SLAVE, (unsigned long) address) < 0)
+        {
+            adapter->busy_addresses += (errno == EBUSY) ? 1U : 0U;
+            continue;
+        }
+
+        uint64_t start_ns = i2c_discovery_get_monotonic_ns();
+        int result = i2c_discovery_probe(fd, (uint8_t) address, smbus);
+        if ((result < 0) && (errno == EOPNOTSUPP) && !smbus && ((functionality & I2C_FUNC_SMBUS_QUICK) != 0U))
+        {
+            // Adapter quirk rejecting zero-length messages
+            smbus = true;
+            start_ns = i2c_discovery_get_monotonic_ns();
+            result = i2c_discovery_probe(fd, (uint8_t) address, smbus);
+        }
+        uint64_t probe_ns = i2c_discovery_get_monotonic_ns() - start_ns;
+        adapter->probes++;
+
+        // Adapter timeout is shared with other users of the bus (and cannot be read back), so slow adapters are given up instead
+        if (probe_ns > ((uint64_t) options->timeout_ms * 1000000U))
+        {
+            adapter->slow = true;
+            break;
+        }
+        if ((result < 0) && (errno == EOPNOTSUPP))
+        {
+            adapter->failed = true;
+            break;
+        }
+        if (result < 0)
+        {
+            continue;
+        }
+
+        i2c_discovery_device_t *grown = realloc(adapter->devices, (adapter->device_count + 1U) * sizeof(i2c_discovery_device_t));
+        if (grown == NULL)
+        {
+            break;
+        }
+        adapter->devices = grown;
+        i2c_discovery_device_t *device = &grown[adapter->device_count++];
+        memset(device, 0, sizeof(i2c_discovery_device_t));
+        memcpy(device->device, adapter->device, sizeof(device->device));
+        device->address = (uint8_t) address;
+        device->probe_ns = probe_ns;
+        if (options->activate && (options->activate_eeprom_ranges || !i2c_discovery_is_eeprom_address(address)))
+        {
+            i2c_discovery_activate(fd, device);
+        }
+    }
+    close(fd);
+    return NULL;
+}
+
+/**
+ * \brief Probes single address with a zero-length write.
+ *
+ * \param[in] fd File descriptor of the adapter (slave address already set for SMBus).
+ * \param[in] address 7 bit I2C slave address.
+ * \param[in] smbus Whether SMBus quick write is used instead of \c I2C_RDWR.
+ * \return int \c 0 if the address was acknowledged, \c -1 with \c errno set otherwise.
+ */
+int i2c_discovery_probe(int fd, uint8_t address, bool smbus)
+{
+    if (smbus)
+    {
+        struct i2c_smbus_ioctl_data quick_write = {I2C_SMBUS_WRITE, 0U, I2C_SMBUS_QUICK, NULL};
+        return (ioctl(fd, I2C_SMBUS, &quick_write) < 0) ? -1 : 0;
+    }
+    struct i2c_msg message = {address, 0U, 0U, NULL};
+    struct i2c_rdwr_ioctl_data transfer = {&message, 1U};
+    return (ioctl(fd, I2C_RDWR, &transfer) < 0) ? -1 : 0;
+}
+
+/**
+ * \brief Returns current \c CLOCK_MONOTONIC time in [ns].
+ *
+ * \return uint64_t Current monotonic time in [ns].
+ */
+static uint64_t i2c_discovery_get_monotonic_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * \brief Orders adapters by adapter number (\c qsort() callback).
+ *
+ * \param[in] a First \ref I2CDiscoveryAdapter.
+ * \param[in] b Second \ref I2CDiscoveryAdapter.
+ * \return int Negative, zero or positive like \c strcmp().
+ */
+static int i2c_discovery_compare_adapters(const void *a, const void *b)
+{
+    const char *first = ((const I2CDiscoveryAdapter *) a)->device;
+    const char *second = ((const I2CDiscoveryAdapter *) b)->device;
+    size_t first_len = strlen(first);
+    size_t second_len = strlen(second);
+    if (first_len != second_len)
+    {
+        return (first_len < second_len) ? -1 : 1;
+    }
+    return strcmp(first, second);
+}
+
+/**
+ * \brief Checks whether address is commonly used by EEPROMs (e.g. 24Cxx, SPD and HAT ID EEPROMs).
+ *
+ * \param[in] address 7 bit I2C slave address.
+ * \return bool \c true if address is in 0x30 to 0x37 or 0x50 to 0x5f.
+ */
+static bool i2c_discovery_is_eeprom_address(unsigned address)
+{
+    return ((address >= 0x30U) && (address <= 0x37U)) || ((address >= 0x50U) && (address <= 0x5fU));
+}
+
+/**
+ * \brief Activates GP T=1' on an acknowledging address and keeps the CIP.
+ *
+ * \param[in] fd File descriptor of the adapter.
+ * \param[in,out] device Acknowledging device.
+ */
+static void i2c_discovery_activate(int fd, i2c_discovery_device_t *device)
+{
+    uint64_t start_ns = i2c_discovery_get_monotonic_ns();
+    ifx_protocol_t driver_adapter;
+    ifx_protocol_t protocol;
+    bool stack_initialized = false;
+    ifx_status_t status = i2c_rpi_initialize(&driver_adapter, fd, device->address);
+    if (!ifx_error_check(status))
+    {
+        status = ifx_t1prime_initialize(&protocol, &driver_adapter);
+        stack_initialized = !ifx_error_check(status);
+        if (!stack_initialized)
+        {
+            ifx_protocol_destroy(&driver_adapter);
+        }
+    }
+    if (stack_initialized)
+    {
+        uint8_t *cip = NULL;
+        size_t cip_len = 0U;
+        status = ifx_protocol_activate(&protocol, &cip, &cip_len);
+        if (!ifx_error_check(status) && (cip != NULL))
+        {
+            device->cip_len = (cip_len > I2C_DISCOVERY_MAX_CIP_LEN) ? I2C_DISCOVERY_MAX_CIP_LEN : cip_len;
+            memcpy(device->cip, cip, device->cip_len);
+        }
+        free(cip);
+        ifx_protocol_destroy(&protocol);
+    }
+    device->activated = true;
+    device->activation_status = status;
+    device->activation_ns = i2c_discovery_get_monotonic_ns() - start_ns;
+}
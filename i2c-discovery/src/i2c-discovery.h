@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file i2c-discovery.h
+ * \brief Internal definitions for concurrent scan of I2C adapters.
+ */
+#ifndef I2C_DISCOVERY_H
+#define I2C_DISCOVERY_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "infineon/i2c-discovery.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Directory containing i2c-dev character devices.
+ */
+#define I2C_DISCOVERY_DEVICE_DIRECTORY "/dev"
+
+/** \struct I2CDiscoveryAdapter
+ * \brief Scan state of a single adapter, owned by its thread until joined.
+ */
+typedef struct
+{
+    /**
+     * \brief I2C character device.
+     */
+    char device[I2C_DISCOVERY_MAX_DEVICE_LEN];
+
+    /**
+     * \brief Scan settings with defaults applied.
+     */
+    const i2c_discovery_options_t *options;
+
+    /**
+     * \brief Thread scanning this adapter.
+     */
+    pthread_t thread;
+
+    /**
+     * \brief Whether \ref I2CDiscoveryAdapter.thread was started.
+     */
+    bool started;
+
+    /**
+     * \brief Whether the adapter could not be opened or does not support zero-length probes.
+     */
+    bool failed;
+
+    /**
+     * \brief Acknowledging devices in address order.
+     */
+    i2c_discovery_device_t *devices;
+
+    /**
+     * \brief Number of entries in \ref I2CDiscoveryAdapter.devices.
+     */
+    size_t device_count;
+
+    /**
+     * \brief Number of addresses probed.
+     */
+    size_t probes;
+
+    /**
+     * \brief Number of addresses skipped because a kernel driver claimed them.
+     */
+    size_t busy_addresses;
+
+    /**
+     * \brief Whether the scan was aborted because a probe took longer than the timeout.
+     */
+    bool slow;
+} I2CDiscoveryAdapter;
+
+/**
+ * \brief Lists all i2c-dev character devices ordered by adapter number.
+ *
+ * \param[out] adapters Buffer to store newly allocated adapters in.
+ * \param[out] adapter_count Buffer to store number of adapters in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_discovery_list_adapters(I2CDiscoveryAdapter **adapters, size_t *adapter_count);
+
+/**
+ * \brief Scans all addresses of a single adapter.
+ *
+ * \param[in,out] arg \ref I2CDiscoveryAdapter to be scanned.
+ * \return void* Always \c NULL.
+ */
+void *i2c_discovery_scan_adapter(void *arg);
+
+/**
+ * \brief Probes single address with a zero-length write.
+ *
+ * \param[in] fd File descriptor of the adapter (slave address already set for SMBus).
+ * \param[in] address 7 bit I2C slave address.
+ * \param[in] smbus Whether SMBus quick write is used instead of \c I2C_RDWR.
+ * \return int \c 0 if the address was acknowledged, \c -1 with \c errno set otherwise.
+ */
+int i2c_discovery_probe(int fd, uint8_t address, bool smbus);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // I2C_DISCOVERY_H
@@ -0,0 +1,150 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/i2c-rpi-autotune.h
+ * \brief Adaptive guard time tuning for Raspberry PI I2C layer.
+ *
+ * \details Learned guard times are kept in a text cache file with one line
+ * per device:
+ *
+ *     # device     address  guard time [us]
+ *     /dev/i2c-1   0x18     85
+ */
+#ifndef INFINEON_I2C_RPI_AUTOTUNE_H
+#define INFINEON_I2C_RPI_AUTOTUNE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/i2c-rpi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief IFX status encoding function identifier for i2c_rpi_autotune_start().
+ */
+#define IFX_I2C_RPI_AUTOTUNE_START (0x8AU)
+
+/**
+ * \brief IFX status encoding function identifier for i2c_rpi_autotune_stop().
+ */
+#define IFX_I2C_RPI_AUTOTUNE_STOP (0x8BU)
+
+/**
+ * \brief IFX status encoding function identifier for i2c_rpi_autotune_get_state().
+ */
+#define IFX_I2C_RPI_AUTOTUNE_GET_STATE (0x8CU)
+
+/**
+ * \brief Conservative guard time tuning starts with if nothing is cached in [us].
+ */
+#define I2C_RPI_AUTOTUNE_START_GUARD_TIME_US 1000U
+
+/**
+ * \brief Upper limit of tuned guard times in [us].
+ */
+#define I2C_RPI_AUTOTUNE_MAX_GUARD_TIME_US 10000U
+
+/**
+ * \brief Number of consecutive clean frames required before a guard time is considered to work.
+ */
+#define I2C_RPI_AUTOTUNE_CLEAN_FRAMES 64U
+
+/**
+ * \brief Interval between working and failing guard time at which tuning stops in [us].
+ */
+#define I2C_RPI_AUTOTUNE_RESOLUTION_US 5U
+
+/** \struct i2c_rpi_autotune_state_t
+ * \brief Progress of guard time tuning.
+ */
+typedef struct
+{
+    /**
+     * \brief Guard time currently used in [us].
+     */
+    uint32_t guard_time_us;
+
+    /**
+     * \brief Smallest guard time observed to work in [us].
+     */
+    uint32_t working_guard_time_us;
+
+    /**
+     * \brief Largest guard time observed to fail in [us] (only valid if \ref failing is set).
+     */
+    uint32_t failing_guard_time_us;
+
+    /**
+     * \brief Whether any guard time failed so far.
+     */
+    bool failing;
+
+    /**
+     * \brief Whether the guard time has converged (and was stored in the cache file).
+     */
+    bool converged;
+
+    /**
+     * \brief Whether the start value was taken from the cache file.
+     */
+    bool cached;
+
+    /**
+     * \brief Number of guard time changes.
+     */
+    uint64_t adjustments;
+
+    /**
+     * \brief Number of NACKed writes and corrupted frames seen while tuning.
+     */
+    uint64_t errors;
+} i2c_rpi_autotune_state_t;
+
+/**
+ * \brief Starts adaptive guard time tuning of Raspberry PI I2C protocol stack.
+ *
+ * \details Starts with the guard time cached for this device (I2C character
+ * device and slave address) or with \ref I2C_RPI_AUTOTUNE_START_GUARD_TIME_US.
+ * After \ref I2C_RPI_AUTOTUNE_CLEAN_FRAMES frames without error the guard
+ * time is lowered, halving the interval between working and failing values.
+ * A NACKed write or a GP T=1' R-block reporting a corrupted frame
+ * immediately restores the last working guard time (doubling it if that one
+ * failed). Once converged, the guard time is stored in \p cache_path.
+ *
+ * Explicitly setting the guard time via ifx_i2c_set_guard_time() stops
+ * tuning.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[in] cache_path Cache file of learned guard times (\c NULL to not persist them).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_autotune_start(ifx_protocol_t *self, const char *cache_path);
+
+/**
+ * \brief Stops adaptive guard time tuning, keeping the current guard time.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_autotune_stop(ifx_protocol_t *self);
+
+/**
+ * \brief Returns progress of adaptive guard time tuning.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[out] state_buffer Buffer to store progress in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error (e.g. tuning not started).
+ */
+ifx_status_t i2c_rpi_autotune_get_state(ifx_protocol_t *self, i2c_rpi_autotune_state_t *state_buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_I2C_RPI_AUTOTUNE_H
@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/i2c-rpi-capture.h
+ * \brief Binary capture of I2C traffic and deterministic replay transport for Raspberry PI I2C layer.
+ *
+ * \details Capture files start with the 8 byte magic \ref I2C_RPI_CAPTURE_MAGIC
+ * followed by records of a \ref I2C_RPI_CAPTURE_RECORD_HEADER_LEN byte header
+ * and the transferred data. All integers are little endian:
+ *
+ * | Offset | Size | Content                                                   |
+ * |--------|------|-----------------------------------------------------------|
+ * | 0      | 8    | \c CLOCK_MONOTONIC time in [ns] at end of transfer        |
+ * | 8      | 1    | Direction (\ref i2c_rpi_capture_direction_t)              |
+ * | 9      | 1    | I2C slave address                                         |
+ * | 10     | 4    | Requested number of bytes                                 |
+ * | 14     | 4    | Return code (number of bytes or negative \c errno)        |
+ * | 18     | 4    | Number of data bytes following the header                 |
+ */
+#ifndef INFINEON_I2C_RPI_CAPTURE_H
+#define INFINEON_I2C_RPI_CAPTURE_H
+
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/i2c-rpi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief IFX status encoding function identifier for i2c_rpi_capture_start().
+ */
+#define IFX_I2C_RPI_CAPTURE_START (0x87U)
+
+/**
+ * \brief IFX status encoding function identifier for i2c_rpi_capture_stop().
+ */
+#define IFX_I2C_RPI_CAPTURE_STOP (0x88U)
+
+/**
+ * \brief IFX status encoding function identifier for i2c_rpi_replay_initialize().
+ */
+#define IFX_I2C_RPI_REPLAY_INITIALIZE (0x89U)
+
+/**
+ * \brief Magic bytes at start of capture files (format version 1).
+ */
+#define I2C_RPI_CAPTURE_MAGIC "NBTI2C\x00\x01"
+
+/**
+ * \brief Length of \ref I2C_RPI_CAPTURE_MAGIC in [bytes].
+ */
+#define I2C_RPI_CAPTURE_MAGIC_LEN 8U
+
+/**
+ * \brief Length of record header in capture files in [bytes].
+ */
+#define I2C_RPI_CAPTURE_RECORD_HEADER_LEN 22U
+
+/**
+ * \brief Direction of captured I2C transfer.
+ */
+typedef enum
+{
+    /**
+     * \brief Frame written to the I2C slave.
+     */
+    I2C_RPI_CAPTURE_WRITE = 0,
+
+    /**
+     * \brief Frame read from the I2C slave.
+     */
+    I2C_RPI_CAPTURE_READ = 1,
+
+    /**
+     * \brief Start of capture session without data, written by i2c_rpi_capture_start().
+     */
+    I2C_RPI_CAPTURE_SESSION = 2
+} i2c_rpi_capture_direction_t;
+
+/**
+ * \brief Timing of replay transport.
+ */
+typedef enum
+{
+    /**
+     * \brief Transfers complete immediately.
+     */
+    I2C_RPI_REPLAY_AS_FAST_AS_POSSIBLE = 0,
+
+    /**
+     * \brief Transfers do not complete earlier (relative to the first transfer) than in the capture.
+     *
+     * \details Appended capture sessions are replayed back to back: the gap
+     * before a session marker, a timestamp going backwards (e.g. after a
+     * reboot) or a gap longer than a minute is not waited for.
+     */
+    I2C_RPI_REPLAY_ORIGINAL_TIMING = 1
+} i2c_rpi_replay_timing_t;
+
+/**
+ * \brief Starts appending every I2C frame of a Raspberry PI I2C protocol stack to a capture file.
+ *
+ * \details The current backend keeps being used, every \c write() and
+ * \c read() is additionally recorded with direction, slave address, data,
+ * return code and timestamp. Capturing ends with i2c_rpi_capture_stop(),
+ * i2c_rpi_set_backend() or destruction of the protocol stack.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[in] path Path of capture file (appended to if it is a capture file already, created otherwise).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_capture_start(ifx_protocol_t *self, const char *path);
+
+/**
+ * \brief Stops capture and restores previous backend.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_capture_stop(ifx_protocol_t *self);
+
+/**
+ * \brief Populates I2C driver layer backend replaying a capture file.
+ *
+ * \details The whole capture is loaded into memory. Every \c write() and
+ * \c read() consumes the next record of the same direction and returns its
+ * recorded result (including missing acknowledges), reads return the
+ * recorded data. Written data is not compared, so upper layers may change
+ * as long as they produce the same sequence of transfers. Transfers beyond
+ * the end of the capture fail with \c ENODATA.
+ *
+ * \param[out] backend Backend to be populated (install via i2c_rpi_set_backend()).
+ * \param[in] path Path of capture file.
+ * \param[in] timing Timing of replayed transfers.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_replay_initialize(i2c_rpi_backend_t *backend, const char *path, i2c_rpi_replay_timing_t timing);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_I2C_RPI_CAPTURE_H
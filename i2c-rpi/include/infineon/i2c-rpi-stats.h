@@ -0,0 +1,351 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/i2c-rpi-stats.h
+ * \brief Runtime statistics of the I2C driver wrapper for Raspberry PI Linux OS.
+ */
+#ifndef INFINEON_I2C_RPI_STATS_H
+#define INFINEON_I2C_RPI_STATS_H
+
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Number of bits of precision per power of two of latency histograms.
+ *
+ * \details 3 bits result in a relative error of at most 12.5%.
+ */
+#define I2C_RPI_HISTOGRAM_SUB_BUCKET_BITS 3U
+
+/**
+ * \brief Number of linear sub buckets per power of two of latency histograms.
+ */
+#define I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT (1U << I2C_RPI_HISTOGRAM_SUB_BUCKET_BITS)
+
+/**
+ * \brief Highest power of two tracked by latency histograms (values above 2^40 [ns] are clamped).
+ */
+#define I2C_RPI_HISTOGRAM_MAX_EXPONENT 40U
+
+/**
+ * \brief Number of buckets of latency histograms.
+ */
+#define I2C_RPI_HISTOGRAM_BUCKET_COUNT \
+    (((I2C_RPI_HISTOGRAM_MAX_EXPONENT - I2C_RPI_HISTOGRAM_SUB_BUCKET_BITS) + 2U) * I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT)
+
+/**
+ * \brief IFX status encoding function identifier for i2c_rpi_get_latency_histogram().
+ */
+#define IFX_I2C_RPI_GET_LATENCY_HISTOGRAM (0x81U)
+
+/**
+ * \brief IFX status encoding function identifier for i2c_rpi_reset_latency_histograms().
+ */
+#define IFX_I2C_RPI_RESET_LATENCY_HISTOGRAMS (0x82U)
+
+/**
+ * \brief IFX status encoding function identifier for i2c_rpi_get_counters().
+ */
+#define IFX_I2C_RPI_GET_COUNTERS (0x83U)
+
+/**
+ * \brief IFX status encoding function identifier for i2c_rpi_reset_counters().
+ */
+#define IFX_I2C_RPI_RESET_COUNTERS (0x84U)
+
+/**
+ * \brief IFX status encoding function identifier for i2c_rpi_get_guard_time_report().
+ */
+#define IFX_I2C_RPI_GET_GUARD_TIME_REPORT (0x86U)
+
+/**
+ * \brief Operations of the I2C driver layer whose latency is recorded.
+ */
+typedef enum
+{
+    /**
+     * \brief \c write() of a frame to the I2C character device.
+     */
+    I2C_RPI_LATENCY_WRITE = 0,
+
+    /**
+     * \brief \c read() of a frame from the I2C character device.
+     */
+    I2C_RPI_LATENCY_READ = 1,
+
+    /**
+     * \brief Blocking on a pending guard time before an I2C access.
+     */
+    I2C_RPI_LATENCY_GUARD_TIME = 2,
+
+    /**
+     * \brief \c ioctl() setting the I2C slave address.
+     */
+    I2C_RPI_LATENCY_SET_ADDRESS = 3,
+
+    /**
+     * \brief Time by which the guard time had already elapsed before an I2C access (no blocking).
+     */
+    I2C_RPI_LATENCY_GUARD_TIME_SLACK = 4,
+
+    /**
+     * \brief Number of recorded operations.
+     */
+    I2C_RPI_LATENCY_COUNT = 5
+} i2c_rpi_latency_t;
+
+/** \struct i2c_rpi_histogram_t
+ * \brief Log-linear latency histogram in [ns].
+ *
+ * \details Values below 2 * \ref I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT get their
+ * own bucket, every higher power of two is split into
+ * \ref I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT linear buckets. All members are
+ * updated with relaxed atomic operations so recording is lock-free and
+ * snapshots may be taken while recording is ongoing.
+ */
+typedef struct
+{
+    /**
+     * \brief Number of recorded values.
+     */
+    uint64_t count;
+
+    /**
+     * \brief Sum of all recorded values in [ns].
+     */
+    uint64_t sum_ns;
+
+    /**
+     * \brief Smallest recorded value in [ns] (\c UINT64_MAX if empty).
+     */
+    uint64_t min_ns;
+
+    /**
+     * \brief Largest recorded value in [ns].
+     */
+    uint64_t max_ns;
+
+    /**
+     * \brief Number of recorded values per bucket.
+     */
+    uint64_t buckets[I2C_RPI_HISTOGRAM_BUCKET_COUNT];
+} i2c_rpi_histogram_t;
+
+/** \struct i2c_rpi_counters_t
+ * \brief Throughput and error counters of the I2C driver layer.
+ *
+ * \details All counters are monotonically increasing (until reset via
+ * i2c_rpi_reset_counters()) and updated with relaxed atomic operations so
+ * they may be read while I/O is running.
+ */
+typedef struct
+{
+    /**
+     * \brief Number of frames completely written to the I2C device.
+     */
+    uint64_t frames_sent;
+
+    /**
+     * \brief Number of bytes written to the I2C device.
+     */
+    uint64_t bytes_sent;
+
+    /**
+     * \brief Number of frames read from the I2C device.
+     */
+    uint64_t frames_received;
+
+    /**
+     * \brief Number of bytes read from the I2C device.
+     */
+    uint64_t bytes_received;
+
+    /**
+     * \brief Number of transfers not acknowledged by the slave (\c ENXIO or \c EREMOTEIO).
+     */
+    uint64_t nacks;
+
+    /**
+     * \brief Number of reads returning less bytes than requested.
+     */
+    uint64_t short_reads;
+
+    /**
+     * \brief Number of writes accepting less bytes than requested.
+     */
+    uint64_t short_writes;
+
+    /**
+     * \brief Number of other failed \c read() or \c write() calls.
+     */
+    uint64_t io_errors;
+
+    /**
+     * \brief Number of failed \c ioctl() calls setting the I2C slave address.
+     */
+    uint64_t ioctl_failures;
+
+    /**
+     * \brief Number of accesses that had to block on a pending guard time.
+     */
+    uint64_t guard_time_waits;
+
+    /**
+     * \brief Number of accesses whose guard time had already elapsed.
+     */
+    uint64_t guard_time_elapsed;
+} i2c_rpi_counters_t;
+
+/** \struct i2c_rpi_guard_time_report_t
+ * \brief Effective guard time of the I2C driver layer.
+ *
+ * \details The gap of an access is the time between the end of the
+ * previous transfer and the start of the access. Failed writes are taken as
+ * sign of a too short gap, failed reads are not as the tag does not
+ * acknowledge reads while processing.
+ */
+typedef struct
+{
+    /**
+     * \brief Currently configured guard time in [us].
+     */
+    uint32_t guard_time_us;
+
+    /**
+     * \brief Smallest guard time in [us] observed to work.
+     *
+     * \details Smallest successful gap in whole [us], but above the largest
+     * gap of a failed write. Equals \ref i2c_rpi_guard_time_report_t.guard_time_us
+     * if no transfer has been observed yet.
+     */
+    uint32_t recommended_guard_time_us;
+
+    /**
+     * \brief Number of accesses that had to block on a pending guard time.
+     */
+    uint64_t waits;
+
+    /**
+     * \brief Number of accesses whose guard time had already elapsed.
+     */
+    uint64_t elapsed;
+
+    /**
+     * \brief Total time in [ns] spent blocking on guard times.
+     */
+    uint64_t wait_ns;
+
+    /**
+     * \brief Smallest gap in [ns] before a successful transfer (\c UINT64_MAX if none).
+     */
+    uint64_t min_successful_gap_ns;
+
+    /**
+     * \brief Largest gap in [ns] before a failed write (\c 0 if none).
+     */
+    uint64_t max_failed_gap_ns;
+} i2c_rpi_guard_time_report_t;
+
+/**
+ * \brief Resets latency histogram to empty state.
+ *
+ * \param[in] histogram Histogram to be reset.
+ */
+void i2c_rpi_histogram_reset(i2c_rpi_histogram_t *histogram);
+
+/**
+ * \brief Records single latency value in histogram.
+ *
+ * \param[in] histogram Histogram to record value in.
+ * \param[in] value_ns Latency in [ns].
+ */
+void i2c_rpi_histogram_record(i2c_rpi_histogram_t *histogram, uint64_t value_ns);
+
+/**
+ * \brief Copies histogram that may concurrently be recorded to.
+ *
+ * \param[in] histogram Histogram to be copied.
+ * \param[out] snapshot_buffer Buffer to store copy in.
+ */
+void i2c_rpi_histogram_snapshot(const i2c_rpi_histogram_t *histogram, i2c_rpi_histogram_t *snapshot_buffer);
+
+/**
+ * \brief Returns value below which the given percentage of recorded values lie.
+ *
+ * \param[in] histogram Histogram (snapshot) to be evaluated.
+ * \param[in] percentile Percentile in range [0, 100].
+ * \return uint64_t Upper bound in [ns] of the bucket containing the percentile (\c 0 if empty).
+ */
+uint64_t i2c_rpi_histogram_get_percentile(const i2c_rpi_histogram_t *histogram, double percentile);
+
+/**
+ * \brief Returns lowest value in [ns] falling into histogram bucket.
+ *
+ * \param[in] bucket Index of the bucket.
+ * \return uint64_t Lowest value in [ns] of the bucket.
+ */
+uint64_t i2c_rpi_histogram_get_bucket_lower_bound(uint32_t bucket);
+
+/**
+ * \brief Returns snapshot of a latency histogram of Raspberry PI I2C protocol stack.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[in] operation Operation to get latency histogram for.
+ * \param[out] snapshot_buffer Buffer to store histogram snapshot in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_get_latency_histogram(ifx_protocol_t *self, i2c_rpi_latency_t operation, i2c_rpi_histogram_t *snapshot_buffer);
+
+/**
+ * \brief Resets all latency histograms of Raspberry PI I2C protocol stack.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_reset_latency_histograms(ifx_protocol_t *self);
+
+/**
+ * \brief Returns snapshot of throughput and error counters of Raspberry PI I2C protocol stack.
+ *
+ * \details Each counter is read atomically, the snapshot as a whole is not.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[out] counters_buffer Buffer to store counters in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_get_counters(ifx_protocol_t *self, i2c_rpi_counters_t *counters_buffer);
+
+/**
+ * \brief Resets all throughput and error counters of Raspberry PI I2C protocol stack.
+ *
+ * \details Also resets the gaps of the guard time report.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_reset_counters(ifx_protocol_t *self);
+
+/**
+ * \brief Returns effective guard time report of Raspberry PI I2C protocol stack.
+ *
+ * \details Wait times are taken from the \ref I2C_RPI_LATENCY_GUARD_TIME
+ * histogram, gaps are reset together with the counters.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[out] report_buffer Buffer to store report in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_get_guard_time_report(ifx_protocol_t *self, i2c_rpi_guard_time_report_t *report_buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_I2C_RPI_STATS_H
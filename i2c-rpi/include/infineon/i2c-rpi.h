@@ -8,6 +8,11 @@
 #ifndef INFINEON_I2C_RPI_H
 #define INFINEON_I2C_RPI_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
 #include "infineon/ifx-protocol.h"
 #include "infineon/ifx-i2c.h"
 
@@ -25,6 +30,90 @@ extern "C" {
  */
 #define I2C_RPI_LOG_TAG IFX_I2C_LOG_TAG
 
+/**
+ * \brief IFX status encoding function identifier for i2c_rpi_set_backend().
+ */
+#define IFX_I2C_RPI_SET_BACKEND (0x85U)
+
+/**
+ * \brief IFX status encoding function identifier for i2c_rpi_pin_slave_address().
+ */
+#define IFX_I2C_RPI_PIN_SLAVE_ADDRESS (0x8DU)
+
+/**
+ * \brief Sets I2C slave address for subsequent transfers of a backend.
+ *
+ * \param[in] context Backend specific context (\ref i2c_rpi_backend_t.context).
+ * \param[in] native_instance File descriptor passed to i2c_rpi_initialize().
+ * \param[in] slave_address I2C slave address to be used.
+ * \return int \c 0 if successful, \c -1 with \c errno set in case of error (like \c ioctl()).
+ */
+typedef int (*i2c_rpi_backend_set_slave_address_t)(void *context, int native_instance, uint8_t slave_address);
+
+/**
+ * \brief Writes single I2C frame via a backend.
+ *
+ * \param[in] context Backend specific context (\ref i2c_rpi_backend_t.context).
+ * \param[in] native_instance File descriptor passed to i2c_rpi_initialize().
+ * \param[in] data Data to be written.
+ * \param[in] data_len Number of bytes in \p data.
+ * \return ssize_t Number of bytes written, \c -1 with \c errno set in case of error (like \c write()).
+ */
+typedef ssize_t (*i2c_rpi_backend_write_t)(void *context, int native_instance, const uint8_t *data, size_t data_len);
+
+/**
+ * \brief Reads single I2C frame via a backend.
+ *
+ * \param[in] context Backend specific context (\ref i2c_rpi_backend_t.context).
+ * \param[in] native_instance File descriptor passed to i2c_rpi_initialize().
+ * \param[out] buffer Buffer to store read data in.
+ * \param[in] buffer_len Number of bytes to be read.
+ * \return ssize_t Number of bytes read, \c -1 with \c errno set in case of error (like \c read()).
+ */
+typedef ssize_t (*i2c_rpi_backend_read_t)(void *context, int native_instance, uint8_t *buffer, size_t buffer_len);
+
+/**
+ * \brief Frees backend specific context once the I2C layer is destroyed.
+ *
+ * \param[in] context Backend specific context (\ref i2c_rpi_backend_t.context).
+ */
+typedef void (*i2c_rpi_backend_destroy_t)(void *context);
+
+/** \struct i2c_rpi_backend_t
+ * \brief Transport used by the I2C driver layer to access the bus.
+ *
+ * \details By default the layer uses \c ioctl(), \c write() and \c read() on
+ * the i2c-dev file descriptor. Alternative backends (e.g. a simulated tag)
+ * can be installed via i2c_rpi_set_backend().
+ */
+typedef struct
+{
+    /**
+     * \brief Backend specific context passed to all callbacks.
+     */
+    void *context;
+
+    /**
+     * \brief Sets I2C slave address.
+     */
+    i2c_rpi_backend_set_slave_address_t set_slave_address;
+
+    /**
+     * \brief Writes I2C frame.
+     */
+    i2c_rpi_backend_write_t write;
+
+    /**
+     * \brief Reads I2C frame.
+     */
+    i2c_rpi_backend_read_t read;
+
+    /**
+     * \brief Frees \ref i2c_rpi_backend_t.context (may be \c NULL).
+     */
+    i2c_rpi_backend_destroy_t destroy;
+} i2c_rpi_backend_t;
+
 /**
  * \brief Initializes protocol object for Raspberry PI Linux OS.
  *
@@ -35,6 +124,35 @@ extern "C" {
  */
 ifx_status_t i2c_rpi_initialize(ifx_protocol_t *self, int native_instance, uint8_t slave_address);
 
+/**
+ * \brief Replaces transport of Raspberry PI I2C protocol stack.
+ *
+ * \details The backend is copied, its context is owned by the protocol stack
+ * afterwards and freed via \ref i2c_rpi_backend_t.destroy on destruction or
+ * when being replaced.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[in] backend Backend to be used (\c NULL to restore the i2c-dev backend).
+ * \return ifx_status_t `IFX_SUCCESS` if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_set_backend(ifx_protocol_t *self, const i2c_rpi_backend_t *backend);
+
+/**
+ * \brief Keeps I2C slave address set on the I2C device between frames.
+ *
+ * \details The slave address is set (\c ioctl(I2C_SLAVE)) before every frame
+ * by default, as other protocol stacks may use the same file descriptor with
+ * another address. While pinned it is only set before the first frame, saving
+ * one syscall per frame. Only pin the address while no other protocol stack
+ * accesses the file descriptor.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[in] pinned Whether slave address shall be kept set between frames.
+ * \param[out] previous Optional buffer to store previous setting in.
+ * \return ifx_status_t `IFX_SUCCESS` if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_pin_slave_address(ifx_protocol_t *self, bool pinned, bool *previous);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,396 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file i2c-rpi-autotune.c
+ * \brief Adaptive guard time tuning for Raspberry PI I2C layer.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/i2c-rpi.h"
+#include "infineon/i2c-rpi-autotune.h"
+#include "i2c-rpi.h"
+
+static bool i2c_rpi_autotune_load(const I2CRPIAutotuneState *autotune, uint8_t slave_address, uint32_t *guard_time_us);
+static void i2c_rpi_autotune_store(const I2CRPIAutotuneState *autotune, uint8_t slave_address, uint32_t guard_time_us);
+static void i2c_rpi_autotune_apply(I2CRPIProtocolProperties *properties, uint32_t guard_time_us);
+static void i2c_rpi_autotune_clean_frame(I2CRPIProtocolProperties *properties);
+static void i2c_rpi_autotune_error(I2CRPIProtocolProperties *properties);
+
+/**
+ * \brief Starts adaptive guard time tuning of Raspberry PI I2C protocol stack.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[in] cache_path Cache file of learned guard times (\c NULL to not persist them).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_autotune_start(ifx_protocol_t *self, const char *cache_path)
+{
+    // Validate parameters
+    if (self == NULL)
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_AUTOTUNE_START, IFX_ILLEGAL_ARGUMENT);
+    }
+    I2CRPIProtocolProperties *properties = NULL;
+    ifx_status_t status = i2c_rpi_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+
+    I2CRPIAutotuneState *autotune = calloc(1U, sizeof(I2CRPIAutotuneState));
+    if (autotune == NULL)
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_AUTOTUNE_START, IFX_OUT_OF_MEMORY);
+    }
+    if (cache_path != NULL)
+    {
+        autotune->cache_path = strdup(cache_path);
+        if (autotune->cache_path == NULL)
+        {
+            free(autotune);
+            return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_AUTOTUNE_START, IFX_OUT_OF_MEMORY);
+        }
+    }
+
+    // Cache entries are keyed by the I2C character device behind the file descriptor
+    char link[32];
+    snprintf(link, sizeof(link), "/proc/self/fd/%d", properties->native_instance);
+    ssize_t device_len = readlink(link, autotune->device, sizeof(autotune->device) - 1U);
+    autotune->device[(device_len > 0) ? (size_t) device_len : 0U] = '\0';
+
+    uint32_t guard_time_us = I2C_RPI_AUTOTUNE_START_GUARD_TIME_US;
+    autotune->progress.cached = i2c_rpi_autotune_load(autotune, properties->slave_address, &guard_time_us);
+    autotune->progress.converged = autotune->progress.cached;
+    autotune->progress.working_guard_time_us = guard_time_us;
+    autotune->progress.guard_time_us = guard_time_us;
+
+    i2c_rpi_autotune_free(properties->autotune);
+    properties->autotune = autotune;
+    properties->guard_time_us = guard_time_us;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Stops adaptive guard time tuning, keeping the current guard time.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_autotune_stop(ifx_protocol_t *self)
+{
+    // Validate parameters
+    if (self == NULL)
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_AUTOTUNE_STOP, IFX_ILLEGAL_ARGUMENT);
+    }
+    I2CRPIProtocolProperties *properties = NULL;
+    ifx_status_t status = i2c_rpi_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    i2c_rpi_autotune_free(properties->autotune);
+    properties->autotune = NULL;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Returns progress of adaptive guard time tuning.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[out] state_buffer Buffer to store progress in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error (e.g. tuning not started).
+ */
+ifx_status_t i2c_rpi_autotune_get_state(ifx_protocol_t *self, i2c_rpi_autotune_state_t *state_buffer)
+{
+    // Validate parameters
+    if ((self == NULL) || (state_buffer == NULL))
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_AUTOTUNE_GET_STATE, IFX_ILLEGAL_ARGUMENT);
+    }
+    I2CRPIProtocolProperties *properties = NULL;
+    ifx_status_t status = i2c_rpi_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    if (properties->autotune == NULL)
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_AUTOTUNE_GET_STATE, IFX_ILLEGAL_ARGUMENT);
+    }
+    *state_buffer = properties->autotune->progress;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Feeds result of a frame write into adaptive guard time tuning.
+ *
+ * \param[in] properties Protocol properties with active tuning.
+ * \param[in] data Written frame.
+ * \param[in] data_len Number of bytes in \p data.
+ * \param[in] nack Whether the write was not acknowledged.
+ */
+void i2c_rpi_autotune_record_write(I2CRPIProtocolProperties *properties, const uint8_t *data, size_t data_len, bool nack)
+{
+    // R-block with EDC error: host received a corrupted frame
+    bool corrupted = (data_len >= I2C_RPI_AUTOTUNE_PROLOGUE_LEN) && ((data[1] & 0xc0U) == 0x80U) && ((data[1] & 0x0fU) == 0x01U);
+    bool retry = properties->autotune->nacked;
+    properties->autotune->nacked = nack;
+    if (nack && retry)
+    {
+        properties->autotune->progress.errors++;
+    }
+    else if (nack || corrupted)
+    {
+        i2c_rpi_autotune_error(properties);
+    }
+    else
+    {
+        i2c_rpi_autotune_clean_frame(properties);
+    }
+}
+
+/**
+ * \brief Feeds successful read into adaptive guard time tuning.
+ *
+ * \param[in] properties Protocol properties with active tuning.
+ * \param[in] data Read data.
+ * \param[in] data_len Number of bytes in \p data.
+ */
+void i2c_rpi_autotune_record_read(I2CRPIProtocolProperties *properties, const uint8_t *data, size_t data_len)
+{
+    I2CRPIAutotuneState *autotune = properties->autotune;
+    autotune->nacked = false;
+
+    // Frames are read as prologue and remainder, only prologues carry a PCB
+    if ((autotune->expected_body_len > 0U) && (data_len == autotune->expected_body_len))
+    {
+        autotune->expected_body_len = 0U;
+        return;
+    }
+    autotune->expected_body_len = 0U;
+    if (data_len < I2C_RPI_AUTOTUNE_PROLOGUE_LEN)
+    {
+        return;
+    }
+    if (data_len == I2C_RPI_AUTOTUNE_PROLOGUE_LEN)
+    {
+        autotune->expected_body_len = (((size_t) data[2] << 8) | data[3]) + 2U;
+    }
+
+    // R-block with error: tag received a corrupted frame
+    if (((data[1] & 0xc0U) == 0x80U) && ((data[1] & 0x0fU) != 0x00U))
+    {
+        i2c_rpi_autotune_error(properties);
+    }
+    else
+    {
+        i2c_rpi_autotune_clean_frame(properties);
+    }
+}
+
+/**
+ * \brief Frees state of adaptive guard time tuning.
+ *
+ * \param[in] autotune State to be freed (may be \c NULL).
+ */
+void i2c_rpi_autotune_free(I2CRPIAutotuneState *autotune)
+{
+    if (autotune != NULL)
+    {
+        free(autotune->cache_path);
+        free(autotune);
+    }
+}
+
+/**
+ * \brief Switches to new guard time and restarts counting clean frames.
+ *
+ * \param[in] properties Protocol properties with active tuning.
+ * \param[in] guard_time_us New guard time in [us].
+ */
+static void i2c_rpi_autotune_apply(I2CRPIProtocolProperties *properties, uint32_t guard_time_us)
+{
+    I2CRPIAutotuneState *autotune = properties->autotune;
+    if (properties->guard_time_us != guard_time_us)
+    {
+        properties->guard_time_us = guard_time_us;
+        autotune->progress.adjustments++;
+    }
+    autotune->progress.guard_time_us = guard_time_us;
+    autotune->clean_frames = 0U;
+}
+
+/**
+ * \brief Lowers guard time after enough clean frames until working and failing values meet.
+ *
+ * \param[in] properties Protocol properties with active tuning.
+ */
+static void i2c_rpi_autotune_clean_frame(I2CRPIProtocolProperties *properties)
+{
+    I2CRPIAutotuneState *autotune = properties->autotune;
+    i2c_rpi_autotune_state_t *progress = &autotune->progress;
+    autotune->clean_frames++;
+    if (progress->converged || (autotune->clean_frames < I2C_RPI_AUTOTUNE_CLEAN_FRAMES))
+    {
+        return;
+    }
+
+    progress->working_guard_time_us = properties->guard_time_us;
+    uint32_t floor_us = progress->failing ? progress->failing_guard_time_us : 0U;
+    uint32_t interval_us = progress->working_guard_time_us - floor_us;
+    if ((progress->working_guard_time_us == 0U) || (progress->failing && (interval_us <= I2C_RPI_AUTOTUNE_RESOLUTION_US)))
+    {
+        progress->converged = true;
+        autotune->clean_frames = 0U;
+        i2c_rpi_autotune_store(autotune, properties->slave_address, progress->working_guard_time_us);
+        return;
+    }
+
+    // Bisect between failing and working value, without failures head for zero
+    uint32_t next_us = floor_us + (interval_us / 2U);
+    if (!progress->failing && (interval_us <= I2C_RPI_AUTOTUNE_RESOLUTION_US))
+    {
+        next_us = 0U;
+    }
+    i2c_rpi_autotune_apply(properties, next_us);
+}
+
+/**
+ * \brief Backs off after a NACKed write or corrupted frame.
+ *
+ * \param[in] properties Protocol properties with active tuning.
+ */
+static void i2c_rpi_autotune_error(I2CRPIProtocolProperties *properties)
+{
+    I2CRPIAutotuneState *autotune = properties->autotune;
+    i2c_rpi_autotune_state_t *progress = &autotune->progress;
+    progress->errors++;
+    progress->failing = true;
+    progress->failing_guard_time_us = properties->guard_time_us;
+
+    // Candidate failed: return to last working value, which may already be close enough
+    if (properties->guard_time_us < progress->working_guard_time_us)
+    {
+        i2c_rpi_autotune_apply(properties, progress->working_guard_time_us);
+        if ((progress->working_guard_time_us - progress->failing_guard_time_us) <= I2C_RPI_AUTOTUNE_RESOLUTION_US)
+        {
+            progress->converged = true;
+            i2c_rpi_autotune_store(autotune, properties->slave_address, progress->working_guard_time_us);
+        }
+        return;
+    }
+
+    // Working value failed (e.g. changed conditions): double it and tune again
+    uint32_t raised_us = properties->guard_time_us * 2U;
+    raised_us = (raised_us < I2C_RPI_AUTOTUNE_RESOLUTION_US) ? I2C_RPI_AUTOTUNE_RESOLUTION_US : raised_us;
+    raised_us = (raised_us > I2C_RPI_AUTOTUNE_MAX_GUARD_TIME_US) ? I2C_RPI_AUTOTUNE_MAX_GUARD_TIME_US : raised_us;
+    progress->working_guard_time_us = raised_us;
+    progress->converged = false;
+    i2c_rpi_autotune_apply(properties, raised_us);
+}
+
+/**
+ * \brief Looks up cached guard time of a device.
+ *
+ * \param[in] autotune Tuning state with cache file and device.
+ * \param[in] slave_address I2C slave address.
+ * \param[out] guard_time_us Buffer to store cached guard time in.
+ * \return bool \c true if an entry was found.
+ */
+static bool i2c_rpi_autotune_load(const I2CRPIAutotuneState *autotune, uint8_t slave_address, uint32_t *guard_time_us)
+{
+    if ((autotune->cache_path == NULL) || (autotune->device[0] == '\0'))
+    {
+        return false;
+    }
+    FILE *cache = fopen(autotune->cache_path, "r");
+    if (cache == NULL)
+    {
+        return false;
+    }
+
+    bool found = false;
+    char line[I2C_RPI_AUTOTUNE_MAX_DEVICE_LEN + 32U];
+    while (!found && (fgets(line, sizeof(line), cache) != NULL))
+    {
+        char device[I2C_RPI_AUTOTUNE_MAX_DEVICE_LEN];
+        int address = 0;
+        unsigned long value = 0U;
+        if ((line[0] != '#') && (sscanf(line, "%255s %i %lu", device, &address, &value) == 3) && (strcmp(device, autotune->device) == 0) &&
+            (address == (int) slave_address) && (value <= I2C_RPI_AUTOTUNE_MAX_GUARD_TIME_US))
+        {
+            *guard_time_us = (uint32_t) value;
+            found = true;
+        }
+    }
+    fclose(cache);
+    return found;
+}
+
+/**
+ * \brief Stores guard time of a device in the cache file, replacing an older entry.
+ *
+ * \details The cache file is rewritten via a temporary file and \c rename()
+ * so concurrent readers never see partial content. Failures are ignored, the
+ * value is learned again next time.
+ *
+ * \param[in] autotune Tuning state with cache file and device.
+ * \param[in] slave_address I2C slave address.
+ * \param[in] guard_time_us Learned guard time in [us].
+ */
+static void i2c_rpi_autotune_store(const I2CRPIAutotuneState *autotune, uint8_t slave_address, uint32_t guard_time_us)
+{
+    if ((autotune->cache_path == NULL) || (autotune->device[0] == '\0'))
+    {
+        return;
+    }
+    size_t temporary_len = strlen(autotune->cache_path) + 32U;
+    char *temporary_path = malloc(temporary_len);
+    if (temporary_path == NULL)
+    {
+        return;
+    }
+    snprintf(temporary_path, temporary_len, "%s.%ld.tmp", autotune->cache_path, (long) getpid());
+    FILE *output = fopen(temporary_path, "w");
+    if (output == NULL)
+    {
+        free(temporary_path);
+        return;
+    }
+
+    // Keep entries of other devices
+    FILE *cache = fopen(autotune->cache_path, "r");
+    if (cache != NULL)
+    {
+        char line[I2C_RPI_AUTOTUNE_MAX_DEVICE_LEN + 32U];
+        while (fgets(line, sizeof(line), cache) != NULL)
+        {
+            char device[I2C_RPI_AUTOTUNE_MAX_DEVICE_LEN];
+            int address = 0;
+            if ((line[0] != '#') && (sscanf(line, "%255s %i", device, &address) == 2) && (strcmp(device, autotune->device) == 0) &&
+                (address == (int) slave_address))
+            {
+                continue;
+            }
+            fputs(line, output);
+        }
+        fclose(cache);
+    }
+    fprintf(output, "%s 0x%02x %lu\n", autotune->device, (unsigned) slave_address, (unsigned long) guard_time_us);
+
+    bool written = (fclose(output) == 0);
+    if (!written || (rename(temporary_path, autotune->cache_path) != 0))
+    {
+        unlink(temporary_path);
+    }
+    free(temporary_path);
+}
@@ -0,0 +1,484 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file i2c-rpi-capture.c
+ * \brief Binary capture of I2C traffic and deterministic replay transport for Raspberry PI I2C layer.
+ */
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/i2c-rpi.h"
+#include "infineon/i2c-rpi-capture.h"
+#include "i2c-rpi.h"
+
+/**
+ * \brief Encodes 32 bit value little endian.
+ *
+ * \param[out] buffer Buffer to store encoded value in.
+ * \param[in] value Value to be encoded.
+ */
+static void i2c_rpi_capture_put_u32(uint8_t *buffer, uint32_t value)
+{
+    for (size_t i = 0U; i < 4U; i++)
+    {
+        buffer[i] = (uint8_t) (value >> (8U * i));
+    }
+}
+
+/**
+ * \brief Decodes little endian 32 bit value.
+ *
+ * \param[in] buffer Encoded value.
+ * \return uint32_t Decoded value.
+ */
+static uint32_t i2c_rpi_capture_get_u32(const uint8_t *buffer)
+{
+    uint32_t value = 0U;
+    for (size_t i = 0U; i < 4U; i++)
+    {
+        value |= (uint32_t) buffer[i] << (8U * i);
+    }
+    return value;
+}
+
+/**
+ * \brief Appends single record to capture file.
+ *
+ * \details Write errors are sticky in the \c FILE object and reported by
+ * i2c_rpi_capture_stop(), the transfer itself is not affected.
+ *
+ * \param[in] state Capture state.
+ * \param[in] direction Direction of transfer.
+ * \param[in] requested_len Requested number of bytes.
+ * \param[in] result Return value of the wrapped backend.
+ * \param[in] error \c errno of the wrapped backend if \p result is negative.
+ * \param[in] data Transferred data.
+ */
+static void i2c_rpi_capture_append(I2CRPICaptureState *state, i2c_rpi_capture_direction_t direction, size_t requested_len, ssize_t result, int error, const uint8_t *data)
+{
+    // Writes carry the requested data, reads what has actually been read
+    uint32_t data_len = (uint32_t) requested_len;
+    if (direction == I2C_RPI_CAPTURE_READ)
+    {
+        data_len = (result > 0) ? (uint32_t) result : 0U;
+    }
+
+    uint8_t header[I2C_RPI_CAPTURE_RECORD_HEADER_LEN];
+    uint64_t timestamp_ns = i2c_rpi_get_monotonic_ns();
+    i2c_rpi_capture_put_u32(&header[0], (uint32_t) timestamp_ns);
+    i2c_rpi_capture_put_u32(&header[4], (uint32_t) (timestamp_ns >> 32));
+    header[8] = (uint8_t) direction;
+    header[9] = state->slave_address;
+    i2c_rpi_capture_put_u32(&header[10], (uint32_t) requested_len);
+    i2c_rpi_capture_put_u32(&header[14], (uint32_t) ((result < 0) ? -error : (int32_t) result));
+    i2c_rpi_capture_put_u32(&header[18], data_len);
+    fwrite(header, sizeof(header), 1U, state->file);
+    if (data_len > 0U)
+    {
+        fwrite(data, data_len, 1U, state->file);
+    }
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_set_slave_address_t of capturing backend.
+ */
+static int i2c_rpi_capture_set_slave_address(void *context, int native_instance, uint8_t slave_address)
+{
+    I2CRPICaptureState *state = (I2CRPICaptureState *) context;
+    state->slave_address = slave_address;
+    return state->wrapped.set_slave_address(state->wrapped.context, native_instance, slave_address);
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_write_t of capturing backend.
+ */
+static ssize_t i2c_rpi_capture_write(void *context, int native_instance, const uint8_t *data, size_t data_len)
+{
+    I2CRPICaptureState *state = (I2CRPICaptureState *) context;
+    ssize_t result = state->wrapped.write(state->wrapped.context, native_instance, data, data_len);
+    int error = errno;
+    i2c_rpi_capture_append(state, I2C_RPI_CAPTURE_WRITE, data_len, result, error, data);
+    errno = error;
+    return result;
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_read_t of capturing backend.
+ */
+static ssize_t i2c_rpi_capture_read(void *context, int native_instance, uint8_t *buffer, size_t buffer_len)
+{
+    I2CRPICaptureState *state = (I2CRPICaptureState *) context;
+    ssize_t result = state->wrapped.read(state->wrapped.context, native_instance, buffer, buffer_len);
+    int error = errno;
+    i2c_rpi_capture_append(state, I2C_RPI_CAPTURE_READ, buffer_len, result, error, buffer);
+    errno = error;
+    return result;
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_destroy_t of capturing backend (also destroys wrapped backend).
+ */
+static void i2c_rpi_capture_destroy(void *context)
+{
+    I2CRPICaptureState *state = (I2CRPICaptureState *) context;
+    fclose(state->file);
+    if (state->wrapped.destroy != NULL)
+    {
+        state->wrapped.destroy(state->wrapped.context);
+    }
+    free(state);
+}
+
+/**
+ * \brief Starts appending every I2C frame of a Raspberry PI I2C protocol stack to a capture file.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[in] path Path of capture file (appended to if it is a capture file already, created otherwise).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_capture_start(ifx_protocol_t *self, const char *path)
+{
+    // Validate parameters
+    if ((self == NULL) || (path == NULL))
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_CAPTURE_START, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    I2CRPIProtocolProperties *properties = NULL;
+    ifx_status_t status = i2c_rpi_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    if (properties->backend.write == i2c_rpi_capture_write)
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_CAPTURE_START, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    I2CRPICaptureState *state = malloc(sizeof(I2CRPICaptureState));
+    if (state == NULL)
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_CAPTURE_START, IFX_OUT_OF_MEMORY);
+    }
+    state->file = fopen(path, "a+b");
+    if (state->file == NULL)
+    {
+        free(state);
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_CAPTURE_START, IFX_UNSPECIFIED_ERROR);
+    }
+
+    // Only ever append to actual capture files
+    uint8_t magic[I2C_RPI_CAPTURE_MAGIC_LEN];
+    size_t magic_len = fread(magic, 1U, sizeof(magic), state->file);
+    if ((magic_len > 0U) && ((magic_len != sizeof(magic)) || (memcmp(magic, I2C_RPI_CAPTURE_MAGIC, sizeof(magic)) != 0)))
+    {
+        fclose(state->file);
+        free(state);
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_CAPTURE_START, IFX_ILLEGAL_ARGUMENT);
+    }
+    fseek(state->file, 0, SEEK_END);
+    if ((magic_len == 0U) && (fwrite(I2C_RPI_CAPTURE_MAGIC, I2C_RPI_CAPTURE_MAGIC_LEN, 1U, state->file) != 1U))
+    {
+        fclose(state->file);
+        free(state);
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_CAPTURE_START, IFX_UNSPECIFIED_ERROR);
+    }
+
+    // Wrap current backend without destroying it
+    state->wrapped = properties->backend;
+    state->slave_address = properties->slave_address;
+
+    // Mark session boundary so that replay does not wait for the gap to any previous session
+    i2c_rpi_capture_append(state, I2C_RPI_CAPTURE_SESSION, 0U, 0, 0, NULL);
+    properties->backend.context = state;
+    properties->backend.set_slave_address = i2c_rpi_capture_set_slave_address;
+    properties->backend.write = i2c_rpi_capture_write;
+    properties->backend.read = i2c_rpi_capture_read;
+    properties->backend.destroy = i2c_rpi_capture_destroy;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Stops capture and restores previous backend.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_capture_stop(ifx_protocol_t *self)
+{
+    // Validate parameters
+    if (self == NULL)
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_CAPTURE_STOP, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    I2CRPIProtocolProperties *properties = NULL;
+    ifx_status_t status = i2c_rpi_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    if (properties->backend.write != i2c_rpi_capture_write)
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_CAPTURE_STOP, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    I2CRPICaptureState *state = (I2CRPICaptureState *) properties->backend.context;
+    properties->backend = state->wrapped;
+    bool failed = ferror(state->file) != 0;
+    if (fclose(state->file) != 0)
+    {
+        failed = true;
+    }
+    free(state);
+    return failed ? IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_CAPTURE_STOP, IFX_UNSPECIFIED_ERROR) : IFX_SUCCESS;
+}
+
+/**
+ * \brief Decodes record of capture file.
+ *
+ * \param[in] state Replay state containing capture.
+ * \param[in] offset Offset of record in capture.
+ * \param[out] record Buffer to store decoded record in.
+ * \return size_t Offset of following record or \c 0 if there is no complete record at \p offset.
+ */
+static size_t i2c_rpi_replay_decode(const I2CRPIReplayState *state, size_t offset, I2CRPIReplayRecord *record)
+{
+    if ((state->capture_len - offset) < I2C_RPI_CAPTURE_RECORD_HEADER_LEN)
+    {
+        return 0U;
+    }
+    const uint8_t *header = &state->capture[offset];
+    record->timestamp_ns = (uint64_t) i2c_rpi_capture_get_u32(&header[0]) | ((uint64_t) i2c_rpi_capture_get_u32(&header[4]) << 32);
+    record->direction = (i2c_rpi_capture_direction_t) header[8];
+    record->result = (int32_t) i2c_rpi_capture_get_u32(&header[14]);
+    record->data_len = i2c_rpi_capture_get_u32(&header[18]);
+    record->data = &header[I2C_RPI_CAPTURE_RECORD_HEADER_LEN];
+    if ((state->capture_len - offset - I2C_RPI_CAPTURE_RECORD_HEADER_LEN) < record->data_len)
+    {
+        return 0U;
+    }
+    return offset + I2C_RPI_CAPTURE_RECORD_HEADER_LEN + record->data_len;
+}
+
+/**
+ * \brief Rebases timestamps of all records in capture onto one continuous timeline.
+ *
+ * \details Appended capture sessions may use unrelated \c CLOCK_MONOTONIC
+ * bases (e.g. after a reboot). A session marker, a timestamp going backwards
+ * or a gap longer than \ref I2C_RPI_REPLAY_MAX_GAP_NS therefore continues the
+ * timeline right at the previous record.
+ *
+ * \param[in,out] state Replay state containing capture.
+ */
+static void i2c_rpi_replay_rebase(I2CRPIReplayState *state)
+{
+    uint64_t previous_ns = 0U;
+    uint64_t rebased_ns = 0U;
+    bool first = true;
+    I2CRPIReplayRecord record;
+    size_t offset = I2C_RPI_CAPTURE_MAGIC_LEN;
+    for (size_t next; (next = i2c_rpi_replay_decode(state, offset, &record)) != 0U; offset = next)
+    {
+        if (!first && (record.direction != I2C_RPI_CAPTURE_SESSION) && (record.timestamp_ns >= previous_ns) && ((record.timestamp_ns - previous_ns) <= I2C_RPI_REPLAY_MAX_GAP_NS))
+        {
+            rebased_ns += record.timestamp_ns - previous_ns;
+        }
+        first = false;
+        previous_ns = record.timestamp_ns;
+        i2c_rpi_capture_put_u32(&state->capture[offset], (uint32_t) rebased_ns);
+        i2c_rpi_capture_put_u32(&state->capture[offset + 4U], (uint32_t) (rebased_ns >> 32));
+    }
+}
+
+/**
+ * \brief Consumes next record of given direction.
+ *
+ * \details Waits for the recorded point in time with
+ * \ref I2C_RPI_REPLAY_ORIGINAL_TIMING.
+ *
+ * \param[in] state Replay state.
+ * \param[in] direction Direction of record to be consumed.
+ * \param[out] record Buffer to store record in.
+ * \return bool \c true if a record has been found.
+ */
+static bool i2c_rpi_replay_next(I2CRPIReplayState *state, i2c_rpi_capture_direction_t direction, I2CRPIReplayRecord *record)
+{
+    size_t *offset = (direction == I2C_RPI_CAPTURE_WRITE) ? &state->write_offset : &state->read_offset;
+    for (;;)
+    {
+        size_t next = i2c_rpi_replay_decode(state, *offset, record);
+        if (next == 0U)
+        {
+            return false;
+        }
+        *offset = next;
+        if (record->direction == direction)
+        {
+            break;
+        }
+    }
+
+    if (state->timing == I2C_RPI_REPLAY_ORIGINAL_TIMING)
+    {
+        // Never wait for records older than the first one
+        int64_t offset_ns = (int64_t) record->timestamp_ns - (int64_t) state->first_timestamp_ns;
+        if (offset_ns < 0)
+        {
+            offset_ns = 0;
+        }
+        int64_t now_ns = (int64_t) i2c_rpi_get_monotonic_ns();
+        if (state->start_ns == 0U)
+        {
+            state->start_ns = (uint64_t) (now_ns - offset_ns);
+        }
+        int64_t target_ns = (int64_t) state->start_ns + offset_ns;
+        if (target_ns > now_ns)
+        {
+            struct timespec target = {(time_t) (target_ns / 1000000000), (long) (target_ns % 1000000000)};
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, NULL) == EINTR)
+            {
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_set_slave_address_t of replay backend.
+ */
+static int i2c_rpi_replay_set_slave_address(void *context, int native_instance, uint8_t slave_address)
+{
+    (void) context;
+    (void) native_instance;
+    (void) slave_address;
+    return 0;
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_write_t of replay backend.
+ */
+static ssize_t i2c_rpi_replay_write(void *context, int native_instance, const uint8_t *data, size_t data_len)
+{
+    (void) native_instance;
+    (void) data;
+    I2CRPIReplayState *state = (I2CRPIReplayState *) context;
+    I2CRPIReplayRecord record;
+    if (!i2c_rpi_replay_next(state, I2C_RPI_CAPTURE_WRITE, &record))
+    {
+        errno = ENODATA;
+        return -1;
+    }
+    if (record.result < 0)
+    {
+        errno = -record.result;
+        return -1;
+    }
+    return ((size_t) record.result > data_len) ? (ssize_t) data_len : (ssize_t) record.result;
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_read_t of replay backend.
+ */
+static ssize_t i2c_rpi_replay_read(void *context, int native_instance, uint8_t *buffer, size_t buffer_len)
+{
+    (void) native_instance;
+    I2CRPIReplayState *state = (I2CRPIReplayState *) context;
+    I2CRPIReplayRecord record;
+    if (!i2c_rpi_replay_next(state, I2C_RPI_CAPTURE_READ, &record))
+    {
+        errno = ENODATA;
+        return -1;
+    }
+    if (record.result < 0)
+    {
+        errno = -record.result;
+        return -1;
+    }
+    size_t data_len = (record.data_len > buffer_len) ? buffer_len : record.data_len;
+    memcpy(buffer, record.data, data_len);
+    return (ssize_t) data_len;
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_destroy_t of replay backend.
+ */
+static void i2c_rpi_replay_destroy(void *context)
+{
+    I2CRPIReplayState *state = (I2CRPIReplayState *) context;
+    free(state->capture);
+    free(state);
+}
+
+/**
+ * \brief Populates I2C driver layer backend replaying a capture file.
+ *
+ * \param[out] backend Backend to be populated (install via i2c_rpi_set_backend()).
+ * \param[in] path Path of capture file.
+ * \param[in] timing Timing of replayed transfers.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_replay_initialize(i2c_rpi_backend_t *backend, const char *path, i2c_rpi_replay_timing_t timing)
+{
+    // Validate parameters
+    if ((backend == NULL) || (path == NULL) || ((timing != I2C_RPI_REPLAY_AS_FAST_AS_POSSIBLE) && (timing != I2C_RPI_REPLAY_ORIGINAL_TIMING)))
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_REPLAY_INITIALIZE, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_REPLAY_INITIALIZE, IFX_UNSPECIFIED_ERROR);
+    }
+    I2CRPIReplayState *state = malloc(sizeof(I2CRPIReplayState));
+    if (state == NULL)
+    {
+        fclose(file);
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_REPLAY_INITIALIZE, IFX_OUT_OF_MEMORY);
+    }
+
+    // Load whole capture so that replay does not perform any file I/O
+    long file_len = -1;
+    if (fseek(file, 0, SEEK_END) == 0)
+    {
+        file_len = ftell(file);
+    }
+    state->capture = NULL;
+    if ((file_len >= (long) I2C_RPI_CAPTURE_MAGIC_LEN) && (fseek(file, 0, SEEK_SET) == 0))
+    {
+        state->capture = malloc((size_t) file_len);
+    }
+    if ((state->capture == NULL) || (fread(state->capture, (size_t) file_len, 1U, file) != 1U) || (memcmp(state->capture, I2C_RPI_CAPTURE_MAGIC, I2C_RPI_CAPTURE_MAGIC_LEN) != 0))
+    {
+        fclose(file);
+        free(state->capture);
+        free(state);
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_REPLAY_INITIALIZE, IFX_ILLEGAL_ARGUMENT);
+    }
+    fclose(file);
+
+    state->capture_len = (size_t) file_len;
+    state->write_offset = I2C_RPI_CAPTURE_MAGIC_LEN;
+    state->read_offset = I2C_RPI_CAPTURE_MAGIC_LEN;
+    state->timing = timing;
+    state->start_ns = 0U;
+    i2c_rpi_replay_rebase(state);
+    I2CRPIReplayRecord first;
+    state->first_timestamp_ns = (i2c_rpi_replay_decode(state, I2C_RPI_CAPTURE_MAGIC_LEN, &first) != 0U) ? first.timestamp_ns : 0U;
+
+    backend->context = state;
+    backend->set_slave_address = i2c_rpi_replay_set_slave_address;
+    backend->write = i2c_rpi_replay_write;
+    backend->read = i2c_rpi_replay_read;
+    backend->destroy = i2c_rpi_replay_destroy;
+    return IFX_SUCCESS;
+}
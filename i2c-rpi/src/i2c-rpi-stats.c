@@ -0,0 +1,405 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file i2c-rpi-stats.c
+ * \brief Runtime statistics of the I2C driver wrapper for Raspberry PI Linux OS.
+ */
+#include <stdint.h>
+#include <time.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/i2c-rpi.h"
+#include "infineon/i2c-rpi-stats.h"
+#include "i2c-rpi.h"
+
+/**
+ * \brief Returns index of histogram bucket a value falls into.
+ *
+ * \param[in] value_ns Value in [ns].
+ * \return uint32_t Index of the bucket.
+ */
+static uint32_t i2c_rpi_histogram_get_bucket(uint64_t value_ns)
+{
+    if (value_ns < (2U * I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT))
+    {
+        return (uint32_t) value_ns;
+    }
+
+    // Clamp so that the highest power of two stays within the bucket array
+    const uint64_t limit = ((uint64_t) 1U << (I2C_RPI_HISTOGRAM_MAX_EXPONENT + 1U)) - 1U;
+    if (value_ns > limit)
+    {
+        value_ns = limit;
+    }
+    uint32_t exponent = 63U - (uint32_t) __builtin_clzll(value_ns);
+    uint32_t sub_bucket = (uint32_t) (value_ns >> (exponent - I2C_RPI_HISTOGRAM_SUB_BUCKET_BITS)) & (I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT - 1U);
+    return ((exponent - I2C_RPI_HISTOGRAM_SUB_BUCKET_BITS) * I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT) + I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT + sub_bucket;
+}
+
+/**
+ * \brief Returns width of histogram bucket in [ns].
+ *
+ * \param[in] bucket Index of the bucket.
+ * \return uint64_t Number of distinct values falling into the bucket.
+ */
+static uint64_t i2c_rpi_histogram_get_bucket_width(uint32_t bucket)
+{
+    if (bucket < (2U * I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT))
+    {
+        return 1U;
+    }
+    uint32_t exponent = ((bucket - I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT) / I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT) + I2C_RPI_HISTOGRAM_SUB_BUCKET_BITS;
+    return (uint64_t) 1U << (exponent - I2C_RPI_HISTOGRAM_SUB_BUCKET_BITS);
+}
+
+/**
+ * \brief Atomically lowers value to given minimum.
+ *
+ * \param[in] value Value to be updated.
+ * \param[in] candidate Candidate for new minimum.
+ */
+void i2c_rpi_atomic_min(uint64_t *value, uint64_t candidate)
+{
+    // Only needs a compare-and-swap when the value actually changes
+    uint64_t current = __atomic_load_n(value, __ATOMIC_RELAXED);
+    while ((candidate < current) && !__atomic_compare_exchange_n(value, &current, candidate, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+/**
+ * \brief Atomically raises value to given maximum.
+ *
+ * \param[in] value Value to be updated.
+ * \param[in] candidate Candidate for new maximum.
+ */
+void i2c_rpi_atomic_max(uint64_t *value, uint64_t candidate)
+{
+    uint64_t current = __atomic_load_n(value, __ATOMIC_RELAXED);
+    while ((candidate > current) && !__atomic_compare_exchange_n(value, &current, candidate, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+/**
+ * \brief Returns current \c CLOCK_MONOTONIC time in [ns].
+ *
+ * \return uint64_t Current monotonic time in [ns].
+ */
+uint64_t i2c_rpi_get_monotonic_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * \brief Returns lowest value in [ns] falling into histogram bucket.
+ *
+ * \param[in] bucket Index of the bucket.
+ * \return uint64_t Lowest value in [ns] of the bucket.
+ */
+uint64_t i2c_rpi_histogram_get_bucket_lower_bound(uint32_t bucket)
+{
+    if (bucket < (2U * I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT))
+    {
+        return bucket;
+    }
+    uint32_t exponent = ((bucket - I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT) / I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT) + I2C_RPI_HISTOGRAM_SUB_BUCKET_BITS;
+    uint64_t sub_bucket = (bucket - I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT) % I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT;
+    return (I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT + sub_bucket) << (exponent - I2C_RPI_HISTOGRAM_SUB_BUCKET_BITS);
+}
+
+/**
+ * \brief Resets latency histogram to empty state.
+ *
+ * \param[in] histogram Histogram to be reset.
+ */
+void i2c_rpi_histogram_reset(i2c_rpi_histogram_t *histogram)
+{
+    if (histogram == NULL)
+    {
+        return;
+    }
+    __atomic_store_n(&histogram->count, 0U, __ATOMIC_RELAXED);
+    __atomic_store_n(&histogram->sum_ns, 0U, __ATOMIC_RELAXED);
+    __atomic_store_n(&histogram->min_ns, UINT64_MAX, __ATOMIC_RELAXED);
+    __atomic_store_n(&histogram->max_ns, 0U, __ATOMIC_RELAXED);
+    for (uint32_t i = 0U; i < I2C_RPI_HISTOGRAM_BUCKET_COUNT; i++)
+    {
+        __atomic_store_n(&histogram->buckets[i], 0U, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * \brief Records single latency value in histogram.
+ *
+ * \param[in] histogram Histogram to record value in.
+ * \param[in] value_ns Latency in [ns].
+ */
+void i2c_rpi_histogram_record(i2c_rpi_histogram_t *histogram, uint64_t value_ns)
+{
+    __atomic_fetch_add(&histogram->buckets[i2c_rpi_histogram_get_bucket(value_ns)], 1U, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->count, 1U, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->sum_ns, value_ns, __ATOMIC_RELAXED);
+
+    i2c_rpi_atomic_min(&histogram->min_ns, value_ns);
+    i2c_rpi_atomic_max(&histogram->max_ns, value_ns);
+}
+
+/**
+ * \brief Copies histogram that may concurrently be recorded to.
+ *
+ * \param[in] histogram Histogram to be copied.
+ * \param[out] snapshot_buffer Buffer to store copy in.
+ */
+void i2c_rpi_histogram_snapshot(const i2c_rpi_histogram_t *histogram, i2c_rpi_histogram_t *snapshot_buffer)
+{
+    if ((histogram == NULL) || (snapshot_buffer == NULL))
+    {
+        return;
+    }
+
+    // Count is derived from buckets so that percentiles stay consistent
+    uint64_t count = 0U;
+    for (uint32_t i = 0U; i < I2C_RPI_HISTOGRAM_BUCKET_COUNT; i++)
+    {
+        snapshot_buffer->buckets[i] = __atomic_load_n(&histogram->buckets[i], __ATOMIC_RELAXED);
+        count += snapshot_buffer->buckets[i];
+    }
+    snapshot_buffer->count = count;
+    snapshot_buffer->sum_ns = __atomic_load_n(&histogram->sum_ns, __ATOMIC_RELAXED);
+    snapshot_buffer->min_ns = __atomic_load_n(&histogram->min_ns, __ATOMIC_RELAXED);
+    snapshot_buffer->max_ns = __atomic_load_n(&histogram->max_ns, __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Returns value below which the given percentage of recorded values lie.
+ *
+ * \param[in] histogram Histogram (snapshot) to be evaluated.
+ * \param[in] percentile Percentile in range [0, 100].
+ * \return uint64_t Upper bound in [ns] of the bucket containing the percentile (\c 0 if empty).
+ */
+uint64_t i2c_rpi_histogram_get_percentile(const i2c_rpi_histogram_t *histogram, double percentile)
+{
+    if ((histogram == NULL) || (histogram->count == 0U))
+    {
+        return 0U;
+    }
+    if (percentile < 0.0)
+    {
+        percentile = 0.0;
+    }
+    if (percentile > 100.0)
+    {
+        percentile = 100.0;
+    }
+
+    // Rank of the requested value, at least the first one
+    uint64_t rank = (uint64_t) (((percentile / 100.0) * (double) histogram->count) + 0.5);
+    if (rank == 0U)
+    {
+        rank = 1U;
+    }
+    uint64_t seen = 0U;
+    for (uint32_t i = 0U; i < I2C_RPI_HISTOGRAM_BUCKET_COUNT; i++)
+    {
+        seen += histogram->buckets[i];
+        if (seen >= rank)
+        {
+            uint64_t upper = i2c_rpi_histogram_get_bucket_lower_bound(i) + i2c_rpi_histogram_get_bucket_width(i) - 1U;
+            return (upper > histogram->max_ns) ? histogram->max_ns : upper;
+        }
+    }
+    return histogram->max_ns;
+}
+
+/**
+ * \brief Returns snapshot of a latency histogram of Raspberry PI I2C protocol stack.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[in] operation Operation to get latency histogram for.
+ * \param[out] snapshot_buffer Buffer to store histogram snapshot in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_get_latency_histogram(ifx_protocol_t *self, i2c_rpi_latency_t operation, i2c_rpi_histogram_t *snapshot_buffer)
+{
+    // Validate parameters
+    if ((self == NULL) || (snapshot_buffer == NULL) || (operation < I2C_RPI_LATENCY_WRITE) || (operation >= I2C_RPI_LATENCY_COUNT))
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_GET_LATENCY_HISTOGRAM, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    I2CRPIProtocolProperties *properties = NULL;
+    ifx_status_t status = i2c_rpi_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    i2c_rpi_histogram_snapshot(&properties->latency[operation], snapshot_buffer);
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Resets all latency histograms of Raspberry PI I2C protocol stack.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_reset_latency_histograms(ifx_protocol_t *self)
+{
+    // Validate parameters
+    if (self == NULL)
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_RESET_LATENCY_HISTOGRAMS, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    I2CRPIProtocolProperties *properties = NULL;
+    ifx_status_t status = i2c_rpi_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    for (int i = 0; i < I2C_RPI_LATENCY_COUNT; i++)
+    {
+        i2c_rpi_histogram_reset(&properties->latency[i]);
+    }
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Atomically adds value to counter of I2C driver layer.
+ *
+ * \param[in] counter Counter to be incremented.
+ * \param[in] value Value to be added.
+ */
+void i2c_rpi_counter_add(uint64_t *counter, uint64_t value)
+{
+    __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Returns snapshot of throughput and error counters of Raspberry PI I2C protocol stack.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[out] counters_buffer Buffer to store counters in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_get_counters(ifx_protocol_t *self, i2c_rpi_counters_t *counters_buffer)
+{
+    // Validate parameters
+    if ((self == NULL) || (counters_buffer == NULL))
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_GET_COUNTERS, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    I2CRPIProtocolProperties *properties = NULL;
+    ifx_status_t status = i2c_rpi_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    const i2c_rpi_counters_t *counters = &properties->counters;
+    counters_buffer->frames_sent = __atomic_load_n(&counters->frames_sent, __ATOMIC_RELAXED);
+    counters_buffer->bytes_sent = __atomic_load_n(&counters->bytes_sent, __ATOMIC_RELAXED);
+    counters_buffer->frames_received = __atomic_load_n(&counters->frames_received, __ATOMIC_RELAXED);
+    counters_buffer->bytes_received = __atomic_load_n(&counters->bytes_received, __ATOMIC_RELAXED);
+    counters_buffer->nacks = __atomic_load_n(&counters->nacks, __ATOMIC_RELAXED);
+    counters_buffer->short_reads = __atomic_load_n(&counters->short_reads, __ATOMIC_RELAXED);
+    counters_buffer->short_writes = __atomic_load_n(&counters->short_writes, __ATOMIC_RELAXED);
+    counters_buffer->io_errors = __atomic_load_n(&counters->io_errors, __ATOMIC_RELAXED);
+    counters_buffer->ioctl_failures = __atomic_load_n(&counters->ioctl_failures, __ATOMIC_RELAXED);
+    counters_buffer->guard_time_waits = __atomic_load_n(&counters->guard_time_waits, __ATOMIC_RELAXED);
+    counters_buffer->guard_time_elapsed = __atomic_load_n(&counters->guard_time_elapsed, __ATOMIC_RELAXED);
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Resets all throughput and error counters of Raspberry PI I2C protocol stack.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_reset_counters(ifx_protocol_t *self)
+{
+    // Validate parameters
+    if (self == NULL)
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_RESET_COUNTERS, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    I2CRPIProtocolProperties *properties = NULL;
+    ifx_status_t status = i2c_rpi_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    i2c_rpi_counters_reset(&properties->counters);
+    __atomic_store_n(&properties->min_successful_gap_ns, UINT64_MAX, __ATOMIC_RELAXED);
+    __atomic_store_n(&properties->max_failed_gap_ns, 0U, __ATOMIC_RELAXED);
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Returns effective guard time report of Raspberry PI I2C protocol stack.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[out] report_buffer Buffer to store report in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_get_guard_time_report(ifx_protocol_t *self, i2c_rpi_guard_time_report_t *report_buffer)
+{
+    // Validate parameters
+    if ((self == NULL) || (report_buffer == NULL))
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_GET_GUARD_TIME_REPORT, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    I2CRPIProtocolProperties *properties = NULL;
+    ifx_status_t status = i2c_rpi_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    report_buffer->guard_time_us = properties->guard_time_us;
+    report_buffer->waits = __atomic_load_n(&properties->counters.guard_time_waits, __ATOMIC_RELAXED);
+    report_buffer->elapsed = __atomic_load_n(&properties->counters.guard_time_elapsed, __ATOMIC_RELAXED);
+    report_buffer->wait_ns = __atomic_load_n(&properties->latency[I2C_RPI_LATENCY_GUARD_TIME].sum_ns, __ATOMIC_RELAXED);
+    report_buffer->min_successful_gap_ns = __atomic_load_n(&properties->min_successful_gap_ns, __ATOMIC_RELAXED);
+    report_buffer->max_failed_gap_ns = __atomic_load_n(&properties->max_failed_gap_ns, __ATOMIC_RELAXED);
+
+    // Smallest working gap, but never at or below a gap that failed
+    uint64_t recommended_us = properties->guard_time_us;
+    if (report_buffer->min_successful_gap_ns != UINT64_MAX)
+    {
+        recommended_us = report_buffer->min_successful_gap_ns / 1000U;
+        if ((report_buffer->max_failed_gap_ns > 0U) && (recommended_us <= (report_buffer->max_failed_gap_ns / 1000U)))
+        {
+            recommended_us = (report_buffer->max_failed_gap_ns / 1000U) + 1U;
+        }
+    }
+    report_buffer->recommended_guard_time_us = (recommended_us > UINT32_MAX) ? UINT32_MAX : (uint32_t) recommended_us;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Sets all counters to \c 0.
+ *
+ * \param[in] counters Counters to be reset.
+ */
+void i2c_rpi_counters_reset(i2c_rpi_counters_t *counters)
+{
+    __atomic_store_n(&counters->frames_sent, 0U, __ATOMIC_RELAXED);
+    __atomic_store_n(&counters->bytes_sent, 0U, __ATOMIC_RELAXED);
+    __atomic_store_n(&counters->frames_received, 0U, __ATOMIC_RELAXED);
+    __atomic_store_n(&counters->bytes_received, 0U, __ATOMIC_RELAXED);
+    __atomic_store_n(&counters->nacks, 0U, __ATOMIC_RELAXED);
+    __atomic_store_n(&counters->short_reads, 0U, __ATOMIC_RELAXED);
+    __atomic_store_n(&counters->short_writes, 0U, __ATOMIC_RELAXED);
+    __atomic_store_n(&counters->io_errors, 0U, __ATOMIC_RELAXED);
+    __atomic_store_n(&counters->ioctl_failures, 0U, __ATOMIC_RELAXED);
+    __atomic_store_n(&counters->guard_time_waits, 0U, __ATOMIC_RELAXED);
+    __atomic_store_n(&counters->guard_time_elapsed, 0U, __ATOMIC_RELAXED);
+}
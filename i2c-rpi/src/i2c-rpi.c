@@ -5,6 +5,8 @@
  * \file i2c-rpi.c
  * \brief I2C driver wrapper for NBT framework based on Raspberry PI i2c-dev.
  */
+#include <errno.h>
+#include <stdbool.h>
 #include <stdlib.h>
 
 /* Raspberry PI I2C specific headers */
@@ -20,6 +22,8 @@
 #include "infineon/ifx-protocol.h"
 #include "infineon/ifx-timer.h"
 #include "infineon/i2c-rpi.h"
+#include "infineon/i2c-rpi-stats.h"
+#include "infineon/trace-rpi.h"
 #include "i2c-rpi.h"
 
 /**
@@ -27,6 +31,20 @@
  */
 #define LOG_TAG I2C_RPI_LOG_TAG
 
+// Semaphores of USDT probes, incremented by tracers while attached
+I2C_RPI_PROBE_SEMAPHORE(transmit__entry);
+I2C_RPI_PROBE_SEMAPHORE(transmit__return);
+I2C_RPI_PROBE_SEMAPHORE(receive__entry);
+I2C_RPI_PROBE_SEMAPHORE(receive__return);
+I2C_RPI_PROBE_SEMAPHORE(await_guard_time__entry);
+I2C_RPI_PROBE_SEMAPHORE(await_guard_time__return);
+
+static ifx_status_t i2c_rpi_transmit_frame(ifx_protocol_t *self, const uint8_t *data, size_t data_len);
+static ifx_status_t i2c_rpi_receive_frame(ifx_protocol_t *self, size_t expected_len, uint8_t **response, size_t *response_len);
+static ifx_status_t i2c_rpi_join_guard_time(I2CRPIProtocolProperties *properties);
+static uint8_t i2c_rpi_get_probe_address(ifx_protocol_t *self);
+static void i2c_rpi_record_gap(I2CRPIProtocolProperties *properties, uint64_t start_ns, uint64_t end_ns, bool success);
+
 /**
  * \brief Initializes protocol object for Raspberry PI.
  *
@@ -64,7 +82,21 @@ ifx_status_t i2c_rpi_initialize(ifx_protocol_t *self, int native_instance, uint8
     properties->native_instance = native_instance;
     properties->clock_frequency_hz = I2C_RPI_DEFAULT_CLOCK_FREQUENCY_HZ;
     properties->slave_address = slave_address;
+    properties->slave_address_pinned = false;
+    properties->_slave_address_set = false;
+    properties->guard_time_us = I2C_RPI_DEFAULT_GUARD_TIME_US;
     properties->_guard_time_timer._start = NULL;
+    properties->_guard_time_expiry_ns = 0U;
+    properties->_last_transfer_end_ns = 0U;
+    properties->min_successful_gap_ns = UINT64_MAX;
+    properties->max_failed_gap_ns = 0U;
+    properties->autotune = NULL;
+    for (int i = 0; i < I2C_RPI_LATENCY_COUNT; i++)
+    {
+        i2c_rpi_histogram_reset(&properties->latency[i]);
+    }
+    i2c_rpi_counters_reset(&properties->counters);
+    i2c_rpi_get_native_backend(&properties->backend);
     self->_properties = properties;
 
     return IFX_SUCCESS;
@@ -95,6 +127,22 @@ ifx_status_t i2c_rpi_activate(ifx_protocol_t *self, uint8_t **response_buffer, s
  * \see ifx_protocol_transmit_callback_t
  */
 ifx_status_t i2c_rpi_transmit(ifx_protocol_t *self, const uint8_t *data, size_t data_len)
+{
+    uint64_t start_ns = I2C_RPI_PROBE_TIMESTAMP(transmit__return);
+    I2C_RPI_PROBE2(transmit__entry, i2c_rpi_get_probe_address(self), data_len);
+    trace_rpi_begin("i2c_transmit", "i2c", data_len);
+    ifx_status_t status = i2c_rpi_transmit_frame(self, data, data_len);
+    trace_rpi_end("i2c_transmit", "i2c", ifx_error_check(status) ? 0U : data_len, status);
+    I2C_RPI_PROBE4(transmit__return, i2c_rpi_get_probe_address(self), data_len, status, I2C_RPI_PROBE_ELAPSED(start_ns));
+    return status;
+}
+
+/**
+ * \brief Sends frame to I2C slave (actual implementation of i2c_rpi_transmit()).
+ *
+ * \see ifx_protocol_transmit_callback_t
+ */
+static ifx_status_t i2c_rpi_transmit_frame(ifx_protocol_t *self, const uint8_t *data, size_t data_len)
 {
     // Validate parameters
     if (self == NULL)
@@ -115,7 +163,6 @@ ifx_status_t i2c_rpi_transmit(ifx_protocol_t *self, const uint8_t *data, size_t
     // Get protocol properties with native I2C instance
     I2CRPIProtocolProperties *properties = NULL;
     ifx_status_t status = i2c_rpi_get_protocol_properties(self, &properties);
-    int bytes_written = 0;
     if (ifx_error_check(status))
     {
         return status;
@@ -132,19 +179,53 @@ ifx_status_t i2c_rpi_transmit(ifx_protocol_t *self, const uint8_t *data, size_t
     // Actually send data to I2C slave
     CHECKED_LOG(ifx_logger_log_bytes(self->_logger, LOG_TAG, IFX_LOG_INFO, ">> ", data, data_len, " "));
 
-    /* 1. Set the slave address */
-    if (ioctl(properties->native_instance, I2C_SLAVE, properties->slave_address) < 0)
+    /* 1. Set the slave address (unless still set while pinned) */
+    uint64_t start_ns = i2c_rpi_get_monotonic_ns();
+    uint64_t end_ns = start_ns;
+    int ioctl_result = 0;
+    if (!properties->_slave_address_set)
+    {
+        ioctl_result = properties->backend.set_slave_address(properties->backend.context, properties->native_instance, properties->slave_address);
+        end_ns = i2c_rpi_get_monotonic_ns();
+        i2c_rpi_histogram_record(&properties->latency[I2C_RPI_LATENCY_SET_ADDRESS], end_ns - start_ns);
+        properties->_slave_address_set = properties->slave_address_pinned && (ioctl_result >= 0);
+    }
+    if (ioctl_result < 0)
     {
+        i2c_rpi_counter_add(&properties->counters.ioctl_failures, 1U);
         CHECKED_LOG(ifx_logger_log(self->_logger, LOG_TAG, IFX_LOG_ERROR, "Unspecified error occurred while setting I2C Slave address"));
         return IFX_ERROR(LIBI2CRPI, IFX_PROTOCOL_TRANSMIT, IFX_UNSPECIFIED_ERROR);
     }
     
     /* 2. Write data to I2C character file */
-    if (bytes_written = write(properties->native_instance, data, data_len) != data_len)
+    ssize_t bytes_written = properties->backend.write(properties->backend.context, properties->native_instance, data, data_len);
+    int write_error = errno;
+    start_ns = end_ns;
+    end_ns = i2c_rpi_get_monotonic_ns();
+    i2c_rpi_histogram_record(&properties->latency[I2C_RPI_LATENCY_WRITE], end_ns - start_ns);
+
+    // Missing acknowledge for a write hints at a too short guard time
+    i2c_rpi_record_gap(properties, start_ns, end_ns, (bytes_written >= 0) || ((write_error != ENXIO) && (write_error != EREMOTEIO)));
+    if ((properties->autotune != NULL) && ((bytes_written == (ssize_t) data_len) || (write_error == ENXIO) || (write_error == EREMOTEIO)))
+    {
+        i2c_rpi_autotune_record_write(properties, data, data_len, bytes_written < 0);
+    }
+    if (bytes_written != (ssize_t) data_len)
     {
-        CHECKED_LOG(ifx_logger_log(self->_logger, LOG_TAG, IFX_LOG_ERROR, "Unspecified error occurred while transmitting data via I2C\nNumber of bytes written: %d", bytes_written));
+        if (bytes_written < 0)
+        {
+            i2c_rpi_count_io_error(properties, write_error);
+        }
+        else
+        {
+            i2c_rpi_counter_add(&properties->counters.short_writes, 1U);
+            i2c_rpi_counter_add(&properties->counters.bytes_sent, (uint64_t) bytes_written);
+        }
+        CHECKED_LOG(ifx_logger_log(self->_logger, LOG_TAG, IFX_LOG_ERROR, "Unspecified error occurred while transmitting data via I2C\nNumber of bytes written: %zd", bytes_written));
         return IFX_ERROR(LIBI2CRPI, IFX_PROTOCOL_TRANSMIT, IFX_UNSPECIFIED_ERROR);
     }
+    i2c_rpi_counter_add(&properties->counters.frames_sent, 1U);
+    i2c_rpi_counter_add(&properties->counters.bytes_sent, data_len);
 
     // Start new guard time between secure element accesses
     status = i2c_rpi_start_guard_time(properties);
@@ -163,6 +244,22 @@ ifx_status_t i2c_rpi_transmit(ifx_protocol_t *self, const uint8_t *data, size_t
  * \see ifx_protocol_receive_callback_t
  */
 ifx_status_t i2c_rpi_receive(ifx_protocol_t *self, size_t expected_len, uint8_t **response, size_t *response_len)
+{
+    uint64_t start_ns = I2C_RPI_PROBE_TIMESTAMP(receive__return);
+    I2C_RPI_PROBE2(receive__entry, i2c_rpi_get_probe_address(self), expected_len);
+    trace_rpi_begin("i2c_receive", "i2c", expected_len);
+    ifx_status_t status = i2c_rpi_receive_frame(self, expected_len, response, response_len);
+    trace_rpi_end("i2c_receive", "i2c", ((response_len != NULL) && !ifx_error_check(status)) ? *response_len : 0U, status);
+    I2C_RPI_PROBE4(receive__return, i2c_rpi_get_probe_address(self), ((response_len != NULL) ? *response_len : 0U), status, I2C_RPI_PROBE_ELAPSED(start_ns));
+    return status;
+}
+
+/**
+ * \brief Reads frame from I2C slave (actual implementation of i2c_rpi_receive()).
+ *
+ * \see ifx_protocol_receive_callback_t
+ */
+static ifx_status_t i2c_rpi_receive_frame(ifx_protocol_t *self, size_t expected_len, uint8_t **response, size_t *response_len)
 {
     // Validate parameters
     if (self == NULL)
@@ -203,17 +300,43 @@ ifx_status_t i2c_rpi_receive(ifx_protocol_t *self, size_t expected_len, uint8_t
         return IFX_ERROR(LIBI2CRPI, IFX_PROTOCOL_RECEIVE, IFX_OUT_OF_MEMORY);
     }
 
-    /* 1. Set the slave address */
-    if (ioctl(properties->native_instance, I2C_SLAVE, properties->slave_address) < 0)
+    /* 1. Set the slave address (unless still set while pinned) */
+    uint64_t start_ns = i2c_rpi_get_monotonic_ns();
+    uint64_t end_ns = start_ns;
+    int ioctl_result = 0;
+    if (!properties->_slave_address_set)
+    {
+        ioctl_result = properties->backend.set_slave_address(properties->backend.context, properties->native_instance, properties->slave_address);
+        end_ns = i2c_rpi_get_monotonic_ns();
+        i2c_rpi_histogram_record(&properties->latency[I2C_RPI_LATENCY_SET_ADDRESS], end_ns - start_ns);
+        properties->_slave_address_set = properties->slave_address_pinned && (ioctl_result >= 0);
+    }
+    if (ioctl_result < 0)
     {
+        i2c_rpi_counter_add(&properties->counters.ioctl_failures, 1U);
         CHECKED_LOG(ifx_logger_log(self->_logger, LOG_TAG, IFX_LOG_ERROR, "Unspecified error occurred while setting I2C Slave address"));
+        free(*response);
+        *response = NULL;
+        *response_len = 0U;
         return IFX_ERROR(LIBI2CRPI, IFX_PROTOCOL_TRANSMIT, IFX_UNSPECIFIED_ERROR);
     }
 
     /* 2. Read data from I2C character file */
     /* TODO: May be making it error if expected_len != response_len is a good idea.. */
-    if (*response_len = read(properties->native_instance, *response, expected_len) == -1)
+    ssize_t bytes_read = properties->backend.read(properties->backend.context, properties->native_instance, *response, expected_len);
+    int read_error = errno;
+    start_ns = end_ns;
+    end_ns = i2c_rpi_get_monotonic_ns();
+    i2c_rpi_histogram_record(&properties->latency[I2C_RPI_LATENCY_READ], end_ns - start_ns);
+
+    // Tag does not acknowledge reads while processing, so only successful reads are conclusive
+    if (bytes_read >= 0)
+    {
+        i2c_rpi_record_gap(properties, start_ns, end_ns, true);
+    }
+    if (bytes_read == -1)
     {
+        i2c_rpi_count_io_error(properties, read_error);
         CHECKED_LOG(ifx_logger_log(self->_logger, LOG_TAG, IFX_LOG_ERROR, "Unspecified error occurred while reading data via I2C"));
         free(*response);
         *response = NULL;
@@ -221,6 +344,16 @@ ifx_status_t i2c_rpi_receive(ifx_protocol_t *self, size_t expected_len, uint8_t
         return IFX_ERROR(LIBI2CRPI, IFX_PROTOCOL_TRANSMIT, IFX_UNSPECIFIED_ERROR);
     }
 
+    i2c_rpi_counter_add(&properties->counters.frames_received, 1U);
+    i2c_rpi_counter_add(&properties->counters.bytes_received, (uint64_t) bytes_read);
+    if (properties->autotune != NULL)
+    {
+        i2c_rpi_autotune_record_read(properties, *response, (size_t) bytes_read);
+    }
+    if ((size_t) bytes_read < expected_len)
+    {
+        i2c_rpi_counter_add(&properties->counters.short_reads, 1U);
+    }
     *response_len = expected_len;
     CHECKED_LOG(ifx_logger_log_bytes(self->_logger, LOG_TAG, IFX_LOG_INFO, "<< ", *response, *response_len, " "));
 
@@ -255,6 +388,13 @@ void i2c_rpi_destroy(ifx_protocol_t *self)
             {
                 // Stop running guard timer
                 ifx_timer_destroy(&properties->_guard_time_timer);
+
+                // Free custom transport
+                if (properties->backend.destroy != NULL)
+                {
+                    properties->backend.destroy(properties->backend.context);
+                }
+                i2c_rpi_autotune_free(properties->autotune);
             }
             free(self->_properties);
         }
@@ -404,6 +544,7 @@ ifx_status_t ifx_i2c_set_slave_address(ifx_protocol_t *self, uint16_t address)
 
     // Cache I2C slave address
     properties->slave_address = address & 0xffU;
+    properties->_slave_address_set = false;
     CHECKED_LOG(ifx_logger_log(self->_logger, LOG_TAG, IFX_LOG_DEBUG, "Successfully set I2C slave address to 0x%x", address));
     return IFX_SUCCESS;
 }
@@ -471,10 +612,89 @@ ifx_status_t ifx_i2c_set_guard_time(ifx_protocol_t *self, uint32_t guard_time_us
     }
     properties->guard_time_us = guard_time_us;
 
+    // Explicit guard time ends adaptive tuning
+    i2c_rpi_autotune_free(properties->autotune);
+    properties->autotune = NULL;
+
     CHECKED_LOG(ifx_logger_log(self->_logger, LOG_TAG, IFX_LOG_DEBUG, "Successfully set I2C guard time to %lu us", guard_time_us));
     return IFX_SUCCESS;
 }
 
+/**
+ * \brief Replaces transport of Raspberry PI I2C protocol stack.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[in] backend Backend to be used (\c NULL to restore the i2c-dev backend).
+ * \return ifx_status_t `IFX_SUCCESS` if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_set_backend(ifx_protocol_t *self, const i2c_rpi_backend_t *backend)
+{
+    // Validate parameters
+    if (self == NULL)
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_SET_BACKEND, IFX_ILLEGAL_ARGUMENT);
+    }
+    if ((backend != NULL) && ((backend->set_slave_address == NULL) || (backend->write == NULL) || (backend->read == NULL)))
+    {
+        CHECKED_LOG(ifx_logger_log(self->_logger, LOG_TAG, IFX_LOG_ERROR, "i2c_rpi_set_backend() called with incomplete backend"));
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_SET_BACKEND, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    I2CRPIProtocolProperties *properties = NULL;
+    ifx_status_t status = i2c_rpi_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+
+    // Free previous custom transport
+    if ((properties->backend.destroy != NULL) && ((backend == NULL) || (backend->context != properties->backend.context)))
+    {
+        properties->backend.destroy(properties->backend.context);
+    }
+    if (backend == NULL)
+    {
+        i2c_rpi_get_native_backend(&properties->backend);
+    }
+    else
+    {
+        properties->backend = *backend;
+    }
+    properties->_slave_address_set = false;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Keeps I2C slave address set on the I2C device between frames.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \param[in] pinned Whether slave address shall be kept set between frames.
+ * \param[out] previous Optional buffer to store previous setting in.
+ * \return ifx_status_t `IFX_SUCCESS` if successful, any other value in case of error.
+ */
+ifx_status_t i2c_rpi_pin_slave_address(ifx_protocol_t *self, bool pinned, bool *previous)
+{
+    // Validate parameters
+    if (self == NULL)
+    {
+        return IFX_ERROR(LIBI2CRPI, IFX_I2C_RPI_PIN_SLAVE_ADDRESS, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    I2CRPIProtocolProperties *properties = NULL;
+    ifx_status_t status = i2c_rpi_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    if (previous != NULL)
+    {
+        *previous = properties->slave_address_pinned;
+    }
+    properties->slave_address_pinned = pinned;
+    properties->_slave_address_set = false;
+    return IFX_SUCCESS;
+}
+
 /**
  * \brief Returns current protocol properties for of Raspberry Pi i2c-dev driver layer.
  *
@@ -535,6 +755,7 @@ ifx_status_t i2c_rpi_start_guard_time(I2CRPIProtocolProperties *properties)
     // Set new timer if guard time is set
     if (properties->guard_time_us > 0U)
     {
+        properties->_guard_time_expiry_ns = i2c_rpi_get_monotonic_ns() + ((uint64_t) properties->guard_time_us * 1000U);
         return ifx_timer_set(&properties->_guard_time_timer, properties->guard_time_us);
     }
     else
@@ -550,6 +771,23 @@ ifx_status_t i2c_rpi_start_guard_time(I2CRPIProtocolProperties *properties)
  * \return ifx_status_t `IFX_SUCCESS` if successful, any other value in case of error.
  */
 ifx_status_t i2c_rpi_await_guard_time(I2CRPIProtocolProperties *properties)
+{
+    uint64_t start_ns = I2C_RPI_PROBE_TIMESTAMP(await_guard_time__return);
+    I2C_RPI_PROBE2(await_guard_time__entry, ((properties != NULL) ? properties->slave_address : 0U), ((properties != NULL) ? properties->guard_time_us : 0U));
+    trace_rpi_begin("i2c_guard_time", "i2c", 0U);
+    ifx_status_t status = i2c_rpi_join_guard_time(properties);
+    trace_rpi_end("i2c_guard_time", "i2c", 0U, status);
+    I2C_RPI_PROBE4(await_guard_time__return, ((properties != NULL) ? properties->slave_address : 0U), ((properties != NULL) ? properties->guard_time_us : 0U), status, I2C_RPI_PROBE_ELAPSED(start_ns));
+    return status;
+}
+
+/**
+ * \brief Waits for pending guard time timer (actual implementation of i2c_rpi_await_guard_time()).
+ *
+ * \param[in] properties Protocol properties containing required information.
+ * \return ifx_status_t `IFX_SUCCESS` if successful, any other value in case of error.
+ */
+static ifx_status_t i2c_rpi_join_guard_time(I2CRPIProtocolProperties *properties)
 {
     // Validate parameters
     if (properties == NULL)
@@ -562,8 +800,21 @@ ifx_status_t i2c_rpi_await_guard_time(I2CRPIProtocolProperties *properties)
         return IFX_SUCCESS;
     }
 
+    // Guard time might already have passed naturally (e.g. while host was processing)
+    uint64_t start_ns = i2c_rpi_get_monotonic_ns();
+    if (ifx_timer_has_elapsed(&properties->_guard_time_timer))
+    {
+        i2c_rpi_counter_add(&properties->counters.guard_time_elapsed, 1U);
+        uint64_t slack_ns = (start_ns > properties->_guard_time_expiry_ns) ? (start_ns - properties->_guard_time_expiry_ns) : 0U;
+        i2c_rpi_histogram_record(&properties->latency[I2C_RPI_LATENCY_GUARD_TIME_SLACK], slack_ns);
+        ifx_timer_destroy(&properties->_guard_time_timer);
+        return IFX_SUCCESS;
+    }
+
     // Await old timer
+    i2c_rpi_counter_add(&properties->counters.guard_time_waits, 1U);
     ifx_status_t status = ifx_timer_join(&properties->_guard_time_timer);
+    i2c_rpi_histogram_record(&properties->latency[I2C_RPI_LATENCY_GUARD_TIME], i2c_rpi_get_monotonic_ns() - start_ns);
     ifx_timer_destroy(&properties->_guard_time_timer);
 
     // Check if join was successful
@@ -581,3 +832,110 @@ ifx_status_t i2c_rpi_await_guard_time(I2CRPIProtocolProperties *properties)
 
     return status;
 }
+
+/**
+ * \brief Updates error counters for failed \c read() or \c write() call.
+ *
+ * \param[in] properties Protocol properties containing counters.
+ * \param[in] error \c errno of the failed call.
+ */
+void i2c_rpi_count_io_error(I2CRPIProtocolProperties *properties, int error)
+{
+    // i2c-dev reports missing acknowledge as ENXIO or EREMOTEIO depending on the bus driver
+    if ((error == ENXIO) || (error == EREMOTEIO))
+    {
+        i2c_rpi_counter_add(&properties->counters.nacks, 1U);
+    }
+    else
+    {
+        i2c_rpi_counter_add(&properties->counters.io_errors, 1U);
+    }
+}
+
+/**
+ * \brief Updates gaps between consecutive transfers for the guard time report.
+ *
+ * \param[in] properties Protocol properties containing gaps.
+ * \param[in] start_ns \c CLOCK_MONOTONIC time in [ns] at which the transfer started.
+ * \param[in] end_ns \c CLOCK_MONOTONIC time in [ns] at which the transfer ended.
+ * \param[in] success \c false if the gap has been too short for the tag.
+ */
+static void i2c_rpi_record_gap(I2CRPIProtocolProperties *properties, uint64_t start_ns, uint64_t end_ns, bool success)
+{
+    if ((properties->_last_transfer_end_ns != 0U) && (start_ns > properties->_last_transfer_end_ns))
+    {
+        uint64_t gap_ns = start_ns - properties->_last_transfer_end_ns;
+        if (success)
+        {
+            i2c_rpi_atomic_min(&properties->min_successful_gap_ns, gap_ns);
+        }
+        else
+        {
+            i2c_rpi_atomic_max(&properties->max_failed_gap_ns, gap_ns);
+        }
+    }
+    properties->_last_transfer_end_ns = end_ns;
+}
+
+/**
+ * \brief Returns I2C slave address reported by USDT probes.
+ *
+ * \param[in] self Protocol stack containing a Raspberry PI I2C layer.
+ * \return uint8_t Current I2C slave address or \c 0 if the stack is invalid.
+ */
+static uint8_t i2c_rpi_get_probe_address(ifx_protocol_t *self)
+{
+    I2CRPIProtocolProperties *properties = NULL;
+    if ((self == NULL) || ifx_error_check(i2c_rpi_get_protocol_properties(self, &properties)))
+    {
+        return 0U;
+    }
+    return properties->slave_address;
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_set_slave_address_t using the i2c-dev \c I2C_SLAVE \c ioctl().
+ *
+ * \see i2c_rpi_backend_set_slave_address_t
+ */
+static int i2c_rpi_native_set_slave_address(void *context, int native_instance, uint8_t slave_address)
+{
+    (void) context;
+    return ioctl(native_instance, I2C_SLAVE, slave_address);
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_write_t writing to the i2c-dev character device.
+ *
+ * \see i2c_rpi_backend_write_t
+ */
+static ssize_t i2c_rpi_native_write(void *context, int native_instance, const uint8_t *data, size_t data_len)
+{
+    (void) context;
+    return write(native_instance, data, data_len);
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_read_t reading from the i2c-dev character device.
+ *
+ * \see i2c_rpi_backend_read_t
+ */
+static ssize_t i2c_rpi_native_read(void *context, int native_instance, uint8_t *buffer, size_t buffer_len)
+{
+    (void) context;
+    return read(native_instance, buffer, buffer_len);
+}
+
+/**
+ * \brief Populates backend with i2c-dev implementation based on \c ioctl(), \c write() and \c read().
+ *
+ * \param[out] backend Backend to be populated.
+ */
+void i2c_rpi_get_native_backend(i2c_rpi_backend_t *backend)
+{
+    backend->context = NULL;
+    backend->set_slave_address = i2c_rpi_native_set_slave_address;
+    backend->write = i2c_rpi_native_write;
+    backend->read = i2c_rpi_native_read;
+    backend->destroy = NULL;
+}
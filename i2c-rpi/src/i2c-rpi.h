@@ -39,12 +39,98 @@
 #define CHECKED_LOG(statement) do {} while(0)
 #endif
 
+#if defined(HAVE_SYS_SDT_H) && (HAVE_SYS_SDT_H)
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+/**
+ * \brief Defines semaphore of USDT probe \c optiga_nbt:<name>, incremented by tracers while attached.
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define I2C_RPI_PROBE_SEMAPHORE(name) unsigned short optiga_nbt_##name##_semaphore __attribute__((unused)) __attribute__((section(".probes")))
+
+/**
+ * \brief Checks if a tracer is attached to USDT probe \c optiga_nbt:<name>.
+ *
+ * \details Probes and their arguments are only evaluated while enabled, so
+ * compiled-in probes cost a single load per call site otherwise.
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define I2C_RPI_PROBE_ENABLED(name) __builtin_expect(optiga_nbt_##name##_semaphore != 0U, 0)
+
+/**
+ * \brief Returns timestamp in [ns] for elapsed time reported by USDT probe \c optiga_nbt:<name> (\c 0 if not enabled).
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define I2C_RPI_PROBE_TIMESTAMP(name) (I2C_RPI_PROBE_ENABLED(name) ? i2c_rpi_get_monotonic_ns() : (uint64_t) 0U)
+
+/**
+ * \brief Returns elapsed time in [ns] since I2C_RPI_PROBE_TIMESTAMP() (\c 0 if the tracer attached in between).
+ */
+#define I2C_RPI_PROBE_ELAPSED(start_ns) (((start_ns) != 0U) ? (i2c_rpi_get_monotonic_ns() - (start_ns)) : (uint64_t) 0U)
+
+/**
+ * \brief USDT probe \c optiga_nbt:<name> with two arguments.
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define I2C_RPI_PROBE2(name, arg1, arg2) do { if (I2C_RPI_PROBE_ENABLED(name)) { DTRACE_PROBE2(optiga_nbt, name, arg1, arg2); } } while(0)
+
+/**
+ * \brief USDT probe \c optiga_nbt:<name> with four arguments.
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define I2C_RPI_PROBE4(name, arg1, arg2, arg3, arg4) do { if (I2C_RPI_PROBE_ENABLED(name)) { DTRACE_PROBE4(optiga_nbt, name, arg1, arg2, arg3, arg4); } } while(0)
+#else
+/**
+ * \brief Defines semaphore of USDT probe (no-op without \c sys/sdt.h).
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define I2C_RPI_PROBE_SEMAPHORE(name) struct i2c_rpi_probe_semaphore_##name
+
+/**
+ * \brief Returns timestamp in [ns] for elapsed time reported by USDT probe (always \c 0 without \c sys/sdt.h).
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define I2C_RPI_PROBE_TIMESTAMP(name) ((uint64_t) 0U)
+
+/**
+ * \brief Returns elapsed time in [ns] since I2C_RPI_PROBE_TIMESTAMP() (always \c 0 without \c sys/sdt.h).
+ */
+#define I2C_RPI_PROBE_ELAPSED(start_ns) ((void) (start_ns), (uint64_t) 0U)
+
+/**
+ * \brief USDT probe \c optiga_nbt:<name> with two arguments (no-op without \c sys/sdt.h).
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define I2C_RPI_PROBE2(name, arg1, arg2) do { (void) sizeof(arg1); (void) sizeof(arg2); } while(0)
+
+/**
+ * \brief USDT probe \c optiga_nbt:<name> with four arguments (no-op without \c sys/sdt.h).
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define I2C_RPI_PROBE4(name, arg1, arg2, arg3, arg4) do { (void) sizeof(arg1); (void) sizeof(arg2); (void) sizeof(arg3); (void) sizeof(arg4); } while(0)
+#endif
+
 #include <stdint.h>
 #include <stddef.h>
+#include <stdio.h>
 
 #include "infineon/ifx-error.h"
 #include "infineon/ifx-protocol.h"
 #include "infineon/ifx-timer.h"
+#include "infineon/i2c-rpi.h"
+#include "infineon/i2c-rpi-stats.h"
+#include "infineon/i2c-rpi-capture.h"
+#include "infineon/i2c-rpi-autotune.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -95,6 +181,55 @@ void i2c_rpi_destroy(ifx_protocol_t *self);
  */
 #define I2C_RPI_DEFAULT_GUARD_TIME_US 0U
 
+/**
+ * \brief Maximum length of I2C character device paths in guard time cache files including terminator.
+ */
+#define I2C_RPI_AUTOTUNE_MAX_DEVICE_LEN 256U
+
+/**
+ * \brief Length of GP T=1' prologue (NAD, PCB, LEN) in [bytes].
+ */
+#define I2C_RPI_AUTOTUNE_PROLOGUE_LEN 4U
+
+/** \struct I2CRPIAutotuneState
+ * \brief State of adaptive guard time tuning.
+ */
+typedef struct
+{
+    /**
+     * \brief Progress reported via i2c_rpi_autotune_get_state().
+     */
+    i2c_rpi_autotune_state_t progress;
+
+    /**
+     * \brief Cache file of learned guard times (\c NULL to not persist them).
+     */
+    char *cache_path;
+
+    /**
+     * \brief I2C character device of the layer (empty if unknown).
+     */
+    char device[I2C_RPI_AUTOTUNE_MAX_DEVICE_LEN];
+
+    /**
+     * \brief Number of consecutive frames without error at the current guard time.
+     */
+    uint32_t clean_frames;
+
+    /**
+     * \brief Number of bytes of the next read continuing a frame whose prologue was read separately (\c 0 if none).
+     */
+    size_t expected_body_len;
+
+    /**
+     * \brief Whether the last write was NACKed without successful transfer since.
+     *
+     * \details No guard time is started after a NACKed write, so a NACK of the
+     * retry says nothing about the guard time.
+     */
+    bool nacked;
+} I2CRPIAutotuneState;
+
 /** \struct I2CRPIProtocolProperties
  * \brief State of I2C driver driver layer keeping track of current property values.
  */
@@ -114,6 +249,18 @@ typedef struct
      */
     uint8_t slave_address;
 
+    /**
+     * \brief Whether slave address is kept set on the I2C device between frames.
+     *
+     * \see i2c_rpi_pin_slave_address()
+     */
+    bool slave_address_pinned;
+
+    /**
+     * \brief Whether slave address is still set on the I2C device from a previous frame while pinned.
+     */
+    bool _slave_address_set;
+
     /**
      * \brief I2C clock frequency in [Hz].
      *
@@ -134,6 +281,58 @@ typedef struct
      * \see I2CRPIProtocolProperties.guard_time
      */
     ifx_timer_t _guard_time_timer;
+
+    /**
+     * \brief Latency histograms indexed by i2c_rpi_latency_t.
+     *
+     * \see i2c_rpi_get_latency_histogram()
+     */
+    i2c_rpi_histogram_t latency[I2C_RPI_LATENCY_COUNT];
+
+    /**
+     * \brief Throughput and error counters.
+     *
+     * \see i2c_rpi_get_counters()
+     */
+    i2c_rpi_counters_t counters;
+
+    /**
+     * \brief Transport used to access the bus.
+     *
+     * \see i2c_rpi_set_backend()
+     */
+    i2c_rpi_backend_t backend;
+
+    /**
+     * \brief Smallest gap in [ns] between transfers before a successful transfer.
+     *
+     * \see i2c_rpi_get_guard_time_report()
+     */
+    uint64_t min_successful_gap_ns;
+
+    /**
+     * \brief Largest gap in [ns] between transfers before a failed write.
+     *
+     * \see i2c_rpi_get_guard_time_report()
+     */
+    uint64_t max_failed_gap_ns;
+
+    /**
+     * \brief \c CLOCK_MONOTONIC time in [ns] at which the last transfer ended (\c 0 if none).
+     */
+    uint64_t _last_transfer_end_ns;
+
+    /**
+     * \brief \c CLOCK_MONOTONIC time in [ns] at which the current guard time elapses.
+     */
+    uint64_t _guard_time_expiry_ns;
+
+    /**
+     * \brief Adaptive guard time tuning (\c NULL if not active).
+     *
+     * \see i2c_rpi_autotune_start()
+     */
+    I2CRPIAutotuneState *autotune;
 } I2CRPIProtocolProperties;
 
 /**
@@ -166,6 +365,183 @@ ifx_status_t i2c_rpi_start_guard_time(I2CRPIProtocolProperties *properties);
  */
 ifx_status_t i2c_rpi_await_guard_time(I2CRPIProtocolProperties *properties);
 
+/**
+ * \brief Returns current \c CLOCK_MONOTONIC time in [ns] used for latency measurements.
+ *
+ * \return uint64_t Current monotonic time in [ns].
+ */
+uint64_t i2c_rpi_get_monotonic_ns(void);
+
+/**
+ * \brief Atomically lowers value to given minimum.
+ *
+ * \param[in] value Value to be updated.
+ * \param[in] candidate Candidate for new minimum.
+ */
+void i2c_rpi_atomic_min(uint64_t *value, uint64_t candidate);
+
+/**
+ * \brief Atomically raises value to given maximum.
+ *
+ * \param[in] value Value to be updated.
+ * \param[in] candidate Candidate for new maximum.
+ */
+void i2c_rpi_atomic_max(uint64_t *value, uint64_t candidate);
+
+/**
+ * \brief Atomically adds value to counter of I2C driver layer.
+ *
+ * \param[in] counter Counter to be incremented.
+ * \param[in] value Value to be added.
+ */
+void i2c_rpi_counter_add(uint64_t *counter, uint64_t value);
+
+/**
+ * \brief Sets all counters to \c 0.
+ *
+ * \param[in] counters Counters to be reset.
+ */
+void i2c_rpi_counters_reset(i2c_rpi_counters_t *counters);
+
+/**
+ * \brief Updates error counters for failed \c read() or \c write() call.
+ *
+ * \param[in] properties Protocol properties containing counters.
+ * \param[in] error \c errno of the failed call.
+ */
+void i2c_rpi_count_io_error(I2CRPIProtocolProperties *properties, int error);
+
+/** \struct I2CRPICaptureState
+ * \brief Context of backend capturing the traffic of another backend.
+ */
+typedef struct
+{
+    /**
+     * \brief Backend actually performing the transfers.
+     */
+    i2c_rpi_backend_t wrapped;
+
+    /**
+     * \brief Capture file records are appended to.
+     */
+    FILE *file;
+
+    /**
+     * \brief I2C slave address of subsequent transfers.
+     */
+    uint8_t slave_address;
+} I2CRPICaptureState;
+
+/** \struct I2CRPIReplayRecord
+ * \brief Decoded record of a capture file.
+ */
+typedef struct
+{
+    /**
+     * \brief \c CLOCK_MONOTONIC time in [ns] at end of transfer.
+     */
+    uint64_t timestamp_ns;
+
+    /**
+     * \brief Direction of transfer.
+     */
+    i2c_rpi_capture_direction_t direction;
+
+    /**
+     * \brief Return code (number of bytes or negative \c errno).
+     */
+    int32_t result;
+
+    /**
+     * \brief Transferred data (points into \ref I2CRPIReplayState.capture).
+     */
+    const uint8_t *data;
+
+    /**
+     * \brief Number of bytes in \ref I2CRPIReplayRecord.data.
+     */
+    uint32_t data_len;
+} I2CRPIReplayRecord;
+
+/**
+ * \brief Longest gap in [ns] between records of a capture that is waited for with \ref I2C_RPI_REPLAY_ORIGINAL_TIMING.
+ */
+#define I2C_RPI_REPLAY_MAX_GAP_NS ((uint64_t) 60000000000U)
+
+/** \struct I2CRPIReplayState
+ * \brief Context of backend replaying a capture file.
+ */
+typedef struct
+{
+    /**
+     * \brief Whole capture file.
+     */
+    uint8_t *capture;
+
+    /**
+     * \brief Size of \ref I2CRPIReplayState.capture in [bytes].
+     */
+    size_t capture_len;
+
+    /**
+     * \brief Offset of next record to be considered for writes.
+     */
+    size_t write_offset;
+
+    /**
+     * \brief Offset of next record to be considered for reads.
+     */
+    size_t read_offset;
+
+    /**
+     * \brief Timing of replayed transfers.
+     */
+    i2c_rpi_replay_timing_t timing;
+
+    /**
+     * \brief Timestamp in [ns] of first record in capture (after rebasing sessions onto one timeline).
+     */
+    uint64_t first_timestamp_ns;
+
+    /**
+     * \brief \c CLOCK_MONOTONIC time in [ns] corresponding to first record (\c 0 before first transfer).
+     */
+    uint64_t start_ns;
+} I2CRPIReplayState;
+
+/**
+ * \brief Feeds result of a frame write into adaptive guard time tuning.
+ *
+ * \param[in] properties Protocol properties with active tuning.
+ * \param[in] data Written frame.
+ * \param[in] data_len Number of bytes in \p data.
+ * \param[in] nack Whether the write was not acknowledged.
+ */
+void i2c_rpi_autotune_record_write(I2CRPIProtocolProperties *properties, const uint8_t *data, size_t data_len, bool nack);
+
+/**
+ * \brief Feeds successful read into adaptive guard time tuning.
+ *
+ * \param[in] properties Protocol properties with active tuning.
+ * \param[in] data Read data.
+ * \param[in] data_len Number of bytes in \p data.
+ */
+void i2c_rpi_autotune_record_read(I2CRPIProtocolProperties *properties, const uint8_t *data, size_t data_len);
+
+/**
+ * \brief Frees state of adaptive guard time tuning.
+ *
+ * \param[in] autotune State to be freed (may be \c NULL).
+ */
+void i2c_rpi_autotune_free(I2CRPIAutotuneState *autotune);
+
+/**
+ * \brief Populates backend with i2c-dev implementation based on \c ioctl(), \c write() and \c read().
+ *
+ * \param[out] backend Backend to be populated.
+ */
+void i2c_rpi_get_native_backend(i2c_rpi_backend_t *backend);
+
 #ifdef __cplusplus
 }
 #endif
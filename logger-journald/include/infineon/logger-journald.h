@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/logger-journald.h
+ * \brief Logger API implementation for NBT framework sending records to systemd-journald via its native protocol.
+ */
+#ifndef INFINEON_LOGGER_JOURNALD_H
+#define INFINEON_LOGGER_JOURNALD_H
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-logger.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Path of the native journald socket.
+ */
+#define LOGGER_JOURNALD_DEFAULT_SOCKET_PATH "/run/systemd/journal/socket"
+
+/**
+ * \brief Records larger than this size in [bytes] are passed to journald via a sealed memfd.
+ */
+#define LOGGER_JOURNALD_MAX_DATAGRAM_LEN 16384U
+
+/**
+ * \brief Initializes ifx_logger_t object to send records to systemd-journald.
+ *
+ * \details Each record is sent as a single datagram containing the fields
+ * \c MESSAGE, \c PRIORITY (mapped from ifx_log_level), \c SYSLOG_IDENTIFIER,
+ * \c NBT_SOURCE and \c TID. Records exceeding
+ * \ref LOGGER_JOURNALD_MAX_DATAGRAM_LEN or the socket's datagram limit are
+ * written to a sealed memfd whose descriptor is passed to journald instead.
+ *
+ * \param[in] self Logger object to be initialized.
+ * \param[in] socket_path Path of the journald socket (\c NULL for \ref LOGGER_JOURNALD_DEFAULT_SOCKET_PATH).
+ * \param[in] identifier Value of \c SYSLOG_IDENTIFIER field (\c NULL to omit).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t logger_journald_initialize(ifx_logger_t *self, const char *socket_path, const char *identifier);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_LOGGER_JOURNALD_H
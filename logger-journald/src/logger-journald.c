@@ -0,0 +1,338 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file logger-journald.c
+ * \brief Logger API implementation for NBT framework sending records to systemd-journald via its native protocol.
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-logger.h"
+#include "infineon/logger-journald.h"
+#include "logger-journald.h"
+
+/** \struct LoggerJournaldDatagram
+ * \brief I/O vectors and scratch space of a single record being assembled.
+ */
+typedef struct
+{
+    /**
+     * \brief I/O vectors making up the record.
+     */
+    struct iovec iov[LOGGER_JOURNALD_MAX_IOV];
+
+    /**
+     * \brief Number of used I/O vectors.
+     */
+    int iov_count;
+
+    /**
+     * \brief Total size of the record in [bytes].
+     */
+    size_t size;
+
+    /**
+     * \brief Little endian length prefixes of binary encoded fields.
+     */
+    uint8_t lengths[2][8];
+
+    /**
+     * \brief Number of used length prefixes.
+     */
+    size_t length_count;
+} LoggerJournaldDatagram;
+
+/**
+ * \brief Maps ifx_log_level to syslog priority used by journald.
+ *
+ * \param[in] level Log level to be mapped.
+ * \return int Syslog priority or \c -1 for invalid levels.
+ */
+static int logger_journald_get_priority(ifx_log_level level)
+{
+    switch (level)
+    {
+    case IFX_LOG_DEBUG:
+        return 7;
+    case IFX_LOG_INFO:
+        return 6;
+    case IFX_LOG_WARN:
+        return 4;
+    case IFX_LOG_ERROR:
+        return 3;
+    case IFX_LOG_FATAL:
+        return 2;
+    default:
+        return -1;
+    }
+}
+
+/**
+ * \brief Appends single I/O vector to record.
+ *
+ * \param[in] datagram Record to append to.
+ * \param[in] data Data to be appended (must stay valid until record is sent).
+ * \param[in] data_len Number of bytes in \p data.
+ */
+static void logger_journald_append(LoggerJournaldDatagram *datagram, const void *data, size_t data_len)
+{
+    datagram->iov[datagram->iov_count].iov_base = (void *) data;
+    datagram->iov[datagram->iov_count].iov_len = data_len;
+    datagram->iov_count++;
+    datagram->size += data_len;
+}
+
+/**
+ * \brief Appends field to record using the binary safe encoding if the value contains line breaks.
+ *
+ * \param[in] datagram Record to append to.
+ * \param[in] name Field name.
+ * \param[in] value Field value.
+ */
+static void logger_journald_append_field(LoggerJournaldDatagram *datagram, const char *name, const char *value)
+{
+    size_t value_len = strlen(value);
+    logger_journald_append(datagram, name, strlen(name));
+    if (memchr(value, '\n', value_len) == NULL)
+    {
+        logger_journald_append(datagram, "=", 1U);
+    }
+    else
+    {
+        uint8_t *length = datagram->lengths[datagram->length_count++];
+        for (size_t i = 0U; i < 8U; i++)
+        {
+            length[i] = (uint8_t) (((uint64_t) value_len >> (8U * i)) & 0xffU);
+        }
+        logger_journald_append(datagram, "\n", 1U);
+        logger_journald_append(datagram, length, 8U);
+    }
+    logger_journald_append(datagram, value, value_len);
+    logger_journald_append(datagram, "\n", 1U);
+}
+
+/**
+ * \brief Sends record via sealed memfd for records too large for a single datagram.
+ *
+ * \param[in] state Logger state containing socket information.
+ * \param[in] datagram Record to be sent.
+ * \return int \c 0 if successful, \c -1 in case of error.
+ */
+static int logger_journald_send_memfd(const LoggerJournaldState *state, LoggerJournaldDatagram *datagram)
+{
+    int memfd = memfd_create("nbt-journal", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memfd < 0)
+    {
+        return -1;
+    }
+
+    // Write whole record to memfd
+    struct iovec *iov = datagram->iov;
+    int iov_count = datagram->iov_count;
+    while (iov_count > 0)
+    {
+        ssize_t written = writev(memfd, iov, iov_count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            close(memfd);
+            return -1;
+        }
+        size_t remaining = (size_t) written;
+        while ((iov_count > 0) && (remaining >= iov->iov_len))
+        {
+            remaining -= iov->iov_len;
+            iov++;
+            iov_count--;
+        }
+        if (iov_count > 0)
+        {
+            iov->iov_base = ((uint8_t *) iov->iov_base) + remaining;
+            iov->iov_len -= remaining;
+        }
+    }
+
+    // journald only accepts sealed memfds
+    if (fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0)
+    {
+        close(memfd);
+        return -1;
+    }
+
+    // Pass descriptor with empty payload
+    union
+    {
+        struct cmsghdr header;
+        uint8_t buffer[CMSG_SPACE(sizeof(int))];
+    } control;
+    memset(&control, 0, sizeof(control));
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_name = (void *) &state->address;
+    message.msg_namelen = state->address_len;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &memfd, sizeof(int));
+
+    ssize_t result = sendmsg(state->fd, &message, MSG_NOSIGNAL);
+    close(memfd);
+    return (result < 0) ? -1 : 0;
+}
+
+/**
+ * \brief Initializes ifx_logger_t object to send records to systemd-journald.
+ *
+ * \param[in] self Logger object to be initialized.
+ * \param[in] socket_path Path of the journald socket (\c NULL for \ref LOGGER_JOURNALD_DEFAULT_SOCKET_PATH).
+ * \param[in] identifier Value of \c SYSLOG_IDENTIFIER field (\c NULL to omit).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t logger_journald_initialize(ifx_logger_t *self, const char *socket_path, const char *identifier)
+{
+    // Validate parameters
+    if (socket_path == NULL)
+    {
+        socket_path = LOGGER_JOURNALD_DEFAULT_SOCKET_PATH;
+    }
+    if ((self == NULL) || (strlen(socket_path) >= sizeof(((struct sockaddr_un *) NULL)->sun_path)) ||
+        ((identifier != NULL) && ((strlen(identifier) >= LOGGER_JOURNALD_IDENTIFIER_LEN) || (strchr(identifier, '\n') != NULL))))
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    // Initialize object with default values
+    ifx_status_t status = ifx_logger_initialize(self);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+
+    // Populate journald logger state
+    LoggerJournaldState *state = malloc(sizeof(LoggerJournaldState));
+    if (state == NULL)
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_OUT_OF_MEMORY);
+    }
+    memset(&state->address, 0, sizeof(state->address));
+    state->address.sun_family = AF_UNIX;
+    strcpy(state->address.sun_path, socket_path);
+    state->address_len = (socklen_t) (offsetof(struct sockaddr_un, sun_path) + strlen(socket_path) + 1U);
+    state->identifier[0] = '\0';
+    if (identifier != NULL)
+    {
+        strcpy(state->identifier, identifier);
+    }
+
+    // Socket stays unconnected so that journald restarts do not need a reconnect
+    state->fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (state->fd < 0)
+    {
+        free(state);
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_UNSPECIFIED_ERROR);
+    }
+
+    // Populate member functions
+    self->_data = state;
+    self->_log = logger_journald_log;
+    self->_destructor = logger_journald_destroy;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief \ref ifx_logger_log_callback_t for journald logger.
+ *
+ * \see ifx_logger_log_callback_t
+ */
+ifx_status_t logger_journald_log(const ifx_logger_t *self, const char *source, ifx_log_level level, const char *formatter)
+{
+    // Validate parameters
+    if ((self == NULL) || (self->_data == NULL) || (source == NULL) || (formatter == NULL))
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_ILLEGAL_ARGUMENT);
+    }
+    int priority = logger_journald_get_priority(level);
+    if (priority < 0)
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_ILLEGAL_ARGUMENT);
+    }
+    LoggerJournaldState *state = (LoggerJournaldState *) self->_data;
+
+    // Batch all fields of the record into one datagram
+    LoggerJournaldDatagram datagram;
+    datagram.iov_count = 0;
+    datagram.size = 0U;
+    datagram.length_count = 0U;
+    char header[48];
+    int header_len = snprintf(header, sizeof(header), "PRIORITY=%d\nTID=%ld\n", priority, (long) syscall(SYS_gettid));
+    logger_journald_append(&datagram, header, (size_t) header_len);
+    if (state->identifier[0] != '\0')
+    {
+        logger_journald_append_field(&datagram, "SYSLOG_IDENTIFIER", state->identifier);
+    }
+    logger_journald_append_field(&datagram, "NBT_SOURCE", source);
+    logger_journald_append_field(&datagram, "MESSAGE", formatter);
+
+    if (datagram.size <= LOGGER_JOURNALD_MAX_DATAGRAM_LEN)
+    {
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_name = &state->address;
+        message.msg_namelen = state->address_len;
+        message.msg_iov = datagram.iov;
+        message.msg_iovlen = (size_t) datagram.iov_count;
+        if (sendmsg(state->fd, &message, MSG_NOSIGNAL) >= 0)
+        {
+            return IFX_SUCCESS;
+        }
+        if ((errno != EMSGSIZE) && (errno != ENOBUFS))
+        {
+            return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_UNSPECIFIED_ERROR);
+        }
+    }
+
+    // Record too large for a datagram
+    if (logger_journald_send_memfd(state, &datagram) != 0)
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_UNSPECIFIED_ERROR);
+    }
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief \ref ifx_logger_destroy_callback_t for journald logger.
+ *
+ * \see ifx_logger_destroy_callback_t
+ */
+void logger_journald_destroy(ifx_logger_t *self)
+{
+    if ((self == NULL) || (self->_data == NULL))
+    {
+        return;
+    }
+    LoggerJournaldState *state = (LoggerJournaldState *) self->_data;
+    close(state->fd);
+    free(state);
+    self->_data = NULL;
+}
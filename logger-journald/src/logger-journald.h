@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file logger-journald.h
+ * \brief Internal definitions for journald logger API implementation for NBT framework.
+ */
+#ifndef LOGGER_JOURNALD_H
+#define LOGGER_JOURNALD_H
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-logger.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Maximum length of the \c SYSLOG_IDENTIFIER value.
+ */
+#define LOGGER_JOURNALD_IDENTIFIER_LEN 64U
+
+/**
+ * \brief Maximum number of I/O vectors used per record.
+ */
+#define LOGGER_JOURNALD_MAX_IOV 16U
+
+/**
+ * \brief \ref ifx_logger_log_callback_t for journald logger.
+ *
+ * \see ifx_logger_log_callback_t
+ */
+ifx_status_t logger_journald_log(const ifx_logger_t *self, const char *source, ifx_log_level level, const char *formatter);
+
+/**
+ * \brief \ref ifx_logger_destroy_callback_t for journald logger.
+ *
+ * \see ifx_logger_destroy_callback_t
+ */
+void logger_journald_destroy(ifx_logger_t *self);
+
+/** \struct LoggerJournaldState
+ * \brief State of journald logger stored in ifx_logger_t._data.
+ */
+typedef struct
+{
+    /**
+     * \brief Unbound unix datagram socket used to send records.
+     */
+    int fd;
+
+    /**
+     * \brief Address of the journald socket.
+     */
+    struct sockaddr_un address;
+
+    /**
+     * \brief Length of \ref LoggerJournaldState.address.
+     */
+    socklen_t address_len;
+
+    /**
+     * \brief \c SYSLOG_IDENTIFIER value (empty to omit).
+     */
+    char identifier[LOGGER_JOURNALD_IDENTIFIER_LEN];
+} LoggerJournaldState;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOGGER_JOURNALD_H
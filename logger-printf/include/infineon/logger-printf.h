@@ -8,6 +8,9 @@
 #ifndef INFINEON_LOGGER_PRINTF_H
 #define INFINEON_LOGGER_PRINTF_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "infineon/ifx-error.h"
 #include "infineon/ifx-logger.h"
 
@@ -15,6 +18,20 @@
 extern "C" {
 #endif
 
+/**
+ * \brief Default size of the per-thread buffer in [bytes] used by buffered printf loggers.
+ *
+ * \see logger_printf_initialize_buffered()
+ */
+#define LOGGER_PRINTF_DEFAULT_BUFFER_SIZE 4096U
+
+/**
+ * \brief Default maximum time in [ms] a record stays in the per-thread buffer of buffered printf loggers.
+ *
+ * \see logger_printf_initialize_buffered()
+ */
+#define LOGGER_PRINTF_DEFAULT_FLUSH_INTERVAL_MS 100U
+
 /**
  * \brief Initializes ifx_logger_t object to be used as a printf logger.
  *
@@ -23,6 +40,37 @@ extern "C" {
  */
 ifx_status_t logger_printf_initialize(ifx_logger_t *self);
 
+/**
+ * \brief Initializes ifx_logger_t object to be used as a buffered printf logger.
+ *
+ * \details Each thread formats its records into a thread-local buffer that is
+ * flushed with a single \c write() once it is full, once the oldest buffered
+ * record is older than \p flush_interval_ms, when a record of level
+ * \c IFX_LOG_ERROR or above is logged or when the thread exits. Records are
+ * never split across writes so lines from different threads do not interleave.
+ *
+ * Buffered records are only flushed on the next log call of the same thread.
+ * Threads that go idle for longer periods should call logger_printf_flush().
+ *
+ * \param[in] self Logger object to be initialized.
+ * \param[in] fd File descriptor to write records to (e.g. \c STDOUT_FILENO).
+ * \param[in] buffer_size Size of the per-thread buffer in [bytes].
+ * \param[in] flush_interval_ms Maximum time in [ms] a record stays buffered (\c 0 to only flush full buffers).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ * \see logger_printf_flush()
+ */
+ifx_status_t logger_printf_initialize_buffered(ifx_logger_t *self, int fd, size_t buffer_size, uint32_t flush_interval_ms);
+
+/**
+ * \brief Flushes the calling thread's buffer of a buffered printf logger.
+ *
+ * \details Unbuffered printf loggers are flushed via \c fflush(stdout).
+ *
+ * \param[in] self Logger object to be flushed.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t logger_printf_flush(const ifx_logger_t *self);
+
 #ifdef __cplusplus
 }
 #endif
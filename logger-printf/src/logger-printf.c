@@ -5,13 +5,184 @@
  * \file logger-printf.c
  * \brief Logger API implementation for NBT framework logging via printf.
  */
+#include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/uio.h>
 
 #include "infineon/ifx-error.h"
 #include "infineon/ifx-logger.h"
 #include "infineon/logger-printf.h"
 #include "logger-printf.h"
 
+/**
+ * \brief Maximum length of the record prefix written for records exceeding the per-thread buffer.
+ */
+#define LOGGER_PRINTF_MAX_PREFIX_LEN 128U
+
+/**
+ * \brief Returns current \c CLOCK_MONOTONIC time in [ns].
+ *
+ * \return uint64_t Current monotonic time in [ns].
+ */
+static uint64_t logger_printf_now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * \brief Writes all given I/O vectors to file descriptor, retrying on partial writes.
+ *
+ * \details A single \c writev() is issued in the regular case so that records
+ * written together stay together.
+ *
+ * \param[in] fd File descriptor to write to.
+ * \param[in] iov I/O vectors to be written (modified in place on partial writes).
+ * \param[in] iov_count Number of I/O vectors in \p iov.
+ * \return int \c 0 if successful, \c -1 in case of error.
+ */
+static int logger_printf_write_all(int fd, struct iovec *iov, int iov_count)
+{
+    while (iov_count > 0)
+    {
+        ssize_t written = writev(fd, iov, iov_count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+
+        // Skip fully written vectors and advance into partially written one
+        size_t remaining = (size_t) written;
+        while ((iov_count > 0) && (remaining >= iov->iov_len))
+        {
+            remaining -= iov->iov_len;
+            iov++;
+            iov_count--;
+        }
+        if (iov_count > 0)
+        {
+            iov->iov_base = ((char *) iov->iov_base) + remaining;
+            iov->iov_len -= remaining;
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief Writes all records currently held in thread buffer.
+ *
+ * \param[in] buffer Thread buffer to be flushed.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+static ifx_status_t logger_printf_flush_thread_buffer(LoggerPrintfThreadBuffer *buffer)
+{
+    if (buffer->length == 0U)
+    {
+        return IFX_SUCCESS;
+    }
+
+    struct iovec iov;
+    iov.iov_base = buffer->data;
+    iov.iov_len = buffer->length;
+    int result = logger_printf_write_all(buffer->state->fd, &iov, 1);
+
+    // Records are dropped on error as well to not block the logging thread forever
+    buffer->length = 0U;
+    if (result != 0)
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_UNSPECIFIED_ERROR);
+    }
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Removes thread buffer from its logger and frees it.
+ *
+ * \details Used as \c pthread_key_t destructor so that buffered records of
+ * exiting threads are not lost.
+ *
+ * \param[in] value Thread buffer to be released.
+ */
+static void logger_printf_release_thread_buffer(void *value)
+{
+    LoggerPrintfThreadBuffer *buffer = (LoggerPrintfThreadBuffer *) value;
+    if (buffer == NULL)
+    {
+        return;
+    }
+    LoggerPrintfBufferedState *state = buffer->state;
+    logger_printf_flush_thread_buffer(buffer);
+
+    // Unlink from list of registered buffers
+    pthread_mutex_lock(&state->lock);
+    LoggerPrintfThreadBuffer **link = &state->buffers;
+    while ((*link != NULL) && (*link != buffer))
+    {
+        link = &(*link)->next;
+    }
+    if (*link != NULL)
+    {
+        *link = buffer->next;
+    }
+    pthread_mutex_unlock(&state->lock);
+
+    free(buffer->data);
+    free(buffer);
+}
+
+/**
+ * \brief Returns the calling thread's buffer, creating it on first use.
+ *
+ * \param[in] state Logger state to get thread buffer for.
+ * \return LoggerPrintfThreadBuffer * Thread buffer or \c NULL if out of memory.
+ */
+static LoggerPrintfThreadBuffer *logger_printf_get_thread_buffer(LoggerPrintfBufferedState *state)
+{
+    LoggerPrintfThreadBuffer *buffer = (LoggerPrintfThreadBuffer *) pthread_getspecific(state->key);
+    if (buffer != NULL)
+    {
+        return buffer;
+    }
+
+    // First record of this thread
+    buffer = malloc(sizeof(LoggerPrintfThreadBuffer));
+    if (buffer == NULL)
+    {
+        return NULL;
+    }
+    buffer->data = malloc(state->buffer_size);
+    if (buffer->data == NULL)
+    {
+        free(buffer);
+        return NULL;
+    }
+    buffer->state = state;
+    buffer->length = 0U;
+    buffer->first_record_ns = 0U;
+    if (pthread_setspecific(state->key, buffer) != 0)
+    {
+        free(buffer->data);
+        free(buffer);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&state->lock);
+    buffer->next = state->buffers;
+    state->buffers = buffer;
+    pthread_mutex_unlock(&state->lock);
+    return buffer;
+}
+
 /**
  * \brief Initializes ifx_logger_t object to be used as a printf logger.
  *
@@ -39,42 +210,248 @@ ifx_status_t logger_printf_initialize(ifx_logger_t *self)
 }
 
 /**
- * \brief \ref ifx_logger_log_callback_t for printf logger.
+ * \brief Initializes ifx_logger_t object to be used as a buffered printf logger.
  *
- * \see ifx_logger_log_callback_t
+ * \param[in] self Logger object to be initialized.
+ * \param[in] fd File descriptor to write records to (e.g. \c STDOUT_FILENO).
+ * \param[in] buffer_size Size of the per-thread buffer in [bytes].
+ * \param[in] flush_interval_ms Maximum time in [ms] a record stays buffered (\c 0 to only flush full buffers).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
  */
-ifx_status_t logger_printf_log(const ifx_logger_t *self, const char *source, ifx_log_level level, const char *formatter)
+ifx_status_t logger_printf_initialize_buffered(ifx_logger_t *self, int fd, size_t buffer_size, uint32_t flush_interval_ms)
 {
-    // Validate parameter
-    if ((self == NULL) || (source == NULL) || (formatter == NULL))
+    // Validate parameters
+    if ((self == NULL) || (fd < 0) || (buffer_size < LOGGER_PRINTF_MAX_PREFIX_LEN))
     {
-        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_ILLEGAL_ARGUMENT);
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_ILLEGAL_ARGUMENT);
     }
 
-    // Get log level tag as string
-    const char *level_tag;
+    // Initialize object with default values
+    ifx_status_t status = ifx_logger_initialize(self);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+
+    // Populate buffered logger state
+    LoggerPrintfBufferedState *state = malloc(sizeof(LoggerPrintfBufferedState));
+    if (state == NULL)
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_OUT_OF_MEMORY);
+    }
+    state->fd = fd;
+    state->buffer_size = buffer_size;
+    state->flush_interval_ns = (uint64_t) flush_interval_ms * 1000000U;
+    state->buffers = NULL;
+    if (pthread_key_create(&state->key, logger_printf_release_thread_buffer) != 0)
+    {
+        free(state);
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_UNSPECIFIED_ERROR);
+    }
+    if (pthread_mutex_init(&state->lock, NULL) != 0)
+    {
+        pthread_key_delete(state->key);
+        free(state);
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_UNSPECIFIED_ERROR);
+    }
+
+    // Populate member functions
+    self->_data = state;
+    self->_log = logger_printf_log_buffered;
+    self->_destructor = logger_printf_destroy_buffered;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Returns the textual tag printed for a log level.
+ *
+ * \param[in] level Log level to get tag for.
+ * \return const char * Level tag or \c NULL for invalid levels.
+ */
+const char *logger_printf_get_level_tag(ifx_log_level level)
+{
     switch (level)
     {
     case IFX_LOG_DEBUG:
-        level_tag = "DEBUG";
-        break;
+        return "DEBUG";
     case IFX_LOG_INFO:
-        level_tag = "INFO";
-        break;
+        return "INFO";
     case IFX_LOG_WARN:
-        level_tag = "WARNING";
-        break;
+        return "WARNING";
     case IFX_LOG_ERROR:
-        level_tag = "ERROR";
-        break;
+        return "ERROR";
     case IFX_LOG_FATAL:
-        level_tag = "FATAL";
-        break;
+        return "FATAL";
     default:
+        return NULL;
+    }
+}
+
+/**
+ * \brief \ref ifx_logger_log_callback_t for printf logger.
+ *
+ * \see ifx_logger_log_callback_t
+ */
+ifx_status_t logger_printf_log(const ifx_logger_t *self, const char *source, ifx_log_level level, const char *formatter)
+{
+    // Validate parameter
+    if ((self == NULL) || (source == NULL) || (formatter == NULL))
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    // Get log level tag as string
+    const char *level_tag = logger_printf_get_level_tag(level);
+    if (level_tag == NULL)
+    {
         return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_ILLEGAL_ARGUMENT);
     }
 
     // Actually log data
-    printf("[%-9s] [%-7s] %s\n", source, level_tag, formatter);
+    printf(LOGGER_PRINTF_RECORD_FORMAT, source, level_tag, formatter);
     return IFX_SUCCESS;
 }
+
+/**
+ * \brief \ref ifx_logger_log_callback_t for buffered printf logger.
+ *
+ * \see ifx_logger_log_callback_t
+ */
+ifx_status_t logger_printf_log_buffered(const ifx_logger_t *self, const char *source, ifx_log_level level, const char *formatter)
+{
+    // Validate parameter
+    if ((self == NULL) || (self->_data == NULL) || (source == NULL) || (formatter == NULL))
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_ILLEGAL_ARGUMENT);
+    }
+    const char *level_tag = logger_printf_get_level_tag(level);
+    if (level_tag == NULL)
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_ILLEGAL_ARGUMENT);
+    }
+    LoggerPrintfBufferedState *state = (LoggerPrintfBufferedState *) self->_data;
+    LoggerPrintfThreadBuffer *buffer = logger_printf_get_thread_buffer(state);
+    if (buffer == NULL)
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_OUT_OF_MEMORY);
+    }
+    uint64_t now_ns = logger_printf_now_ns();
+    ifx_status_t status = IFX_SUCCESS;
+
+    // Flush buffered records that are already too old
+    if ((state->flush_interval_ns != 0U) && (buffer->length > 0U) && ((now_ns - buffer->first_record_ns) >= state->flush_interval_ns))
+    {
+        status = logger_printf_flush_thread_buffer(buffer);
+    }
+
+    // Format record into remaining buffer, flushing once if it does not fit
+    size_t available = state->buffer_size - buffer->length;
+    int record_len = snprintf(buffer->data + buffer->length, available, LOGGER_PRINTF_RECORD_FORMAT, source, level_tag, formatter);
+    if (record_len < 0)
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_UNSPECIFIED_ERROR);
+    }
+    if (((size_t) record_len >= available) && (buffer->length > 0U))
+    {
+        status = logger_printf_flush_thread_buffer(buffer);
+        available = state->buffer_size;
+        record_len = snprintf(buffer->data, available, LOGGER_PRINTF_RECORD_FORMAT, source, level_tag, formatter);
+    }
+    if ((size_t) record_len >= available)
+    {
+        // Record exceeds whole buffer so write it directly as one vector write
+        char prefix[LOGGER_PRINTF_MAX_PREFIX_LEN];
+        int prefix_len = snprintf(prefix, sizeof(prefix), "[%-9s] [%-7s] ", source, level_tag);
+        if ((prefix_len < 0) || ((size_t) prefix_len >= sizeof(prefix)))
+        {
+            prefix_len = (int) strlen(prefix);
+        }
+        struct iovec iov[3];
+        iov[0].iov_base = prefix;
+        iov[0].iov_len = (size_t) prefix_len;
+        iov[1].iov_base = (void *) formatter;
+        iov[1].iov_len = strlen(formatter);
+        iov[2].iov_base = (void *) "\n";
+        iov[2].iov_len = 1U;
+        if (logger_printf_write_all(state->fd, iov, 3) != 0)
+        {
+            return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_UNSPECIFIED_ERROR);
+        }
+        return status;
+    }
+    if (buffer->length == 0U)
+    {
+        buffer->first_record_ns = now_ns;
+    }
+    buffer->length += (size_t) record_len;
+
+    // Errors are written out immediately so that they are not lost on a crash
+    if (level >= IFX_LOG_ERROR)
+    {
+        status = logger_printf_flush_thread_buffer(buffer);
+    }
+    return status;
+}
+
+/**
+ * \brief Flushes the calling thread's buffer of a buffered printf logger.
+ *
+ * \param[in] self Logger object to be flushed.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t logger_printf_flush(const ifx_logger_t *self)
+{
+    // Validate parameters
+    if (self == NULL)
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    // Unbuffered printf logger only relies on stdio buffering
+    if (self->_log != logger_printf_log_buffered)
+    {
+        fflush(stdout);
+        return IFX_SUCCESS;
+    }
+    if (self->_data == NULL)
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    LoggerPrintfBufferedState *state = (LoggerPrintfBufferedState *) self->_data;
+    LoggerPrintfThreadBuffer *buffer = (LoggerPrintfThreadBuffer *) pthread_getspecific(state->key);
+    if (buffer == NULL)
+    {
+        return IFX_SUCCESS;
+    }
+    return logger_printf_flush_thread_buffer(buffer);
+}
+
+/**
+ * \brief \ref ifx_logger_destroy_callback_t for buffered printf logger.
+ *
+ * \see ifx_logger_destroy_callback_t
+ */
+void logger_printf_destroy_buffered(ifx_logger_t *self)
+{
+    if ((self == NULL) || (self->_data == NULL))
+    {
+        return;
+    }
+    LoggerPrintfBufferedState *state = (LoggerPrintfBufferedState *) self->_data;
+
+    // Deleting the key does not run destructors so flush all remaining buffers here
+    pthread_key_delete(state->key);
+    LoggerPrintfThreadBuffer *buffer = state->buffers;
+    while (buffer != NULL)
+    {
+        LoggerPrintfThreadBuffer *next = buffer->next;
+        logger_printf_flush_thread_buffer(buffer);
+        free(buffer->data);
+        free(buffer);
+        buffer = next;
+    }
+    pthread_mutex_destroy(&state->lock);
+    free(state);
+    self->_data = NULL;
+}
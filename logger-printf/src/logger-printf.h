@@ -8,6 +8,10 @@
 #ifndef LOGGER_PRINTF_H
 #define LOGGER_PRINTF_H
 
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #include "infineon/ifx-error.h"
 #include "infineon/ifx-logger.h"
 
@@ -15,6 +19,11 @@
 extern "C" {
 #endif
 
+/**
+ * \brief Format of a single log record as written by printf loggers.
+ */
+#define LOGGER_PRINTF_RECORD_FORMAT "[%-9s] [%-7s] %s\n"
+
 /**
  * \brief \ref ifx_logger_log_callback_t for printf logger.
  *
@@ -22,6 +31,100 @@ extern "C" {
  */
 ifx_status_t logger_printf_log(const ifx_logger_t *self, const char *source, ifx_log_level level, const char *formatter);
 
+/**
+ * \brief \ref ifx_logger_log_callback_t for buffered printf logger.
+ *
+ * \see ifx_logger_log_callback_t
+ */
+ifx_status_t logger_printf_log_buffered(const ifx_logger_t *self, const char *source, ifx_log_level level, const char *formatter);
+
+/**
+ * \brief \ref ifx_logger_destroy_callback_t for buffered printf logger.
+ *
+ * \details Flushes and frees the buffers of all threads. Must not be called
+ * while other threads are still logging via \p self.
+ *
+ * \see ifx_logger_destroy_callback_t
+ */
+void logger_printf_destroy_buffered(ifx_logger_t *self);
+
+/**
+ * \brief Returns the textual tag printed for a log level.
+ *
+ * \param[in] level Log level to get tag for.
+ * \return const char * Level tag or \c NULL for invalid levels.
+ */
+const char *logger_printf_get_level_tag(ifx_log_level level);
+
+/** \struct LoggerPrintfThreadBuffer
+ * \brief Buffer of a single thread logging via a buffered printf logger.
+ */
+typedef struct LoggerPrintfThreadBuffer
+{
+    /**
+     * \brief Next buffer registered for the same logger.
+     */
+    struct LoggerPrintfThreadBuffer *next;
+
+    /**
+     * \brief Logger state this buffer belongs to.
+     */
+    struct LoggerPrintfBufferedState *state;
+
+    /**
+     * \brief Number of bytes currently buffered.
+     */
+    size_t length;
+
+    /**
+     * \brief \c CLOCK_MONOTONIC timestamp in [ns] of the oldest buffered record.
+     */
+    uint64_t first_record_ns;
+
+    /**
+     * \brief Buffered records (\ref LoggerPrintfBufferedState.buffer_size bytes).
+     */
+    char *data;
+} LoggerPrintfThreadBuffer;
+
+/** \struct LoggerPrintfBufferedState
+ * \brief State of buffered printf logger stored in ifx_logger_t._data.
+ */
+typedef struct LoggerPrintfBufferedState
+{
+    /**
+     * \brief File descriptor records are written to.
+     */
+    int fd;
+
+    /**
+     * \brief Size of each per-thread buffer in [bytes].
+     */
+    size_t buffer_size;
+
+    /**
+     * \brief Maximum time in [ns] a record stays buffered (\c 0 for no limit).
+     */
+    uint64_t flush_interval_ns;
+
+    /**
+     * \brief Key used to look up the calling thread's buffer.
+     */
+    pthread_key_t key;
+
+    /**
+     * \brief Lock protecting \ref LoggerPrintfBufferedState.buffers.
+     *
+     * \details Only taken when a thread logs for the first time or exits.
+     */
+    pthread_mutex_t lock;
+
+    /**
+     * \brief List of all per-thread buffers currently registered.
+     */
+    LoggerPrintfThreadBuffer *buffers;
+} LoggerPrintfBufferedState;
+
 #ifdef __cplusplus
 }
 #endif
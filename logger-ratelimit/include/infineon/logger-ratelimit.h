@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/logger-ratelimit.h
+ * \brief Logger decorator for NBT framework limiting the rate of log records forwarded to another logger.
+ */
+#ifndef INFINEON_LOGGER_RATELIMIT_H
+#define INFINEON_LOGGER_RATELIMIT_H
+
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-logger.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Default number of records per second forwarded for each message template.
+ */
+#define LOGGER_RATELIMIT_DEFAULT_RATE_PER_SECOND 10U
+
+/**
+ * \brief Default number of records forwarded in a burst for each message template.
+ */
+#define LOGGER_RATELIMIT_DEFAULT_BURST 20U
+
+/**
+ * \brief Default interval in [ms] between "suppressed N messages" summaries.
+ */
+#define LOGGER_RATELIMIT_DEFAULT_SUMMARY_INTERVAL_MS 5000U
+
+/**
+ * \brief IFX status encoding function identifier for logger_ratelimit_get_statistics().
+ */
+#define IFX_LOGGER_RATELIMIT_GET_STATISTICS (0x80U)
+
+/** \struct logger_ratelimit_config_t
+ * \brief Configuration of rate limiting logger.
+ */
+typedef struct
+{
+    /**
+     * \brief Number of records per second forwarded for each (source, message template) pair.
+     */
+    uint32_t rate_per_second;
+
+    /**
+     * \brief Number of records that may be forwarded at once for each (source, message template) pair.
+     */
+    uint32_t burst;
+
+    /**
+     * \brief Interval in [ms] in which summaries of suppressed records are emitted.
+     */
+    uint32_t summary_interval_ms;
+
+    /**
+     * \brief Only forward every n-th \c IFX_LOG_INFO frame dump (\c 0 or \c 1 to forward all).
+     *
+     * \details Frame dumps are records starting with \c ">> " or \c "<< " as
+     * logged by the I2C driver layer.
+     */
+    uint32_t frame_dump_sample_rate;
+} logger_ratelimit_config_t;
+
+/** \struct logger_ratelimit_statistics_t
+ * \brief Number of records dropped by rate limiting logger.
+ */
+typedef struct
+{
+    /**
+     * \brief Number of records suppressed by token bucket limits.
+     */
+    uint64_t suppressed;
+
+    /**
+     * \brief Number of frame dumps dropped by sampling.
+     */
+    uint64_t sampled_out;
+} logger_ratelimit_statistics_t;
+
+/**
+ * \brief Initializes ifx_logger_t object to be used as rate limiting decorator of another logger.
+ *
+ * \details Records are grouped by source and message template. As loggers only
+ * receive the formatted message, the template is approximated by the message
+ * text up to its first decimal digit (frame dumps only by their direction
+ * marker). Each group gets its own token bucket. If more groups are active than
+ * buckets are available, a new group takes over the fill level of the least
+ * recently used bucket instead of starting with a full burst.
+ * Records exceeding the limit are counted and periodically summarized as
+ * \c IFX_LOG_WARN record via \p wrapped. A background thread emits due
+ * summaries even if no further records are logged, so \p wrapped must accept
+ * records from other threads.
+ *
+ * \p wrapped is not destroyed together with \p self.
+ *
+ * \param[in] self Logger object to be initialized.
+ * \param[in] wrapped Logger to forward records to.
+ * \param[in] config Rate limit configuration (\c NULL for default values).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t logger_ratelimit_initialize(ifx_logger_t *self, ifx_logger_t *wrapped, const logger_ratelimit_config_t *config);
+
+/**
+ * \brief Getter for number of records dropped by rate limiting logger.
+ *
+ * \details Does not block logging threads and may be called concurrently.
+ *
+ * \param[in] self Rate limiting logger to get statistics for.
+ * \param[out] statistics_buffer Buffer to store statistics in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t logger_ratelimit_get_statistics(const ifx_logger_t *self, logger_ratelimit_statistics_t *statistics_buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_LOGGER_RATELIMIT_H
@@ -0,0 +1,436 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file logger-ratelimit.c
+ * \brief Logger decorator for NBT framework limiting the rate of log records forwarded to another logger.
+ */
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-logger.h"
+#include "infineon/logger-ratelimit.h"
+#include "logger-ratelimit.h"
+
+/**
+ * \brief Returns current \c CLOCK_MONOTONIC time in [ns].
+ *
+ * \return uint64_t Current monotonic time in [ns].
+ */
+static uint64_t logger_ratelimit_now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * \brief Checks if record is a frame dump as logged by the I2C driver layer.
+ *
+ * \param[in] level Log level of the record.
+ * \param[in] message Formatted message of the record.
+ * \return bool \c true if record is a frame dump.
+ */
+static bool logger_ratelimit_is_frame_dump(ifx_log_level level, const char *message)
+{
+    return (level == IFX_LOG_INFO) && ((message[0] == '>') || (message[0] == '<')) && (message[1] == message[0]) && (message[2] == ' ');
+}
+
+/**
+ * \brief Calculates key of (source, message template) pair.
+ *
+ * \details FNV-1a over source and message up to the first decimal digit, so
+ * records only differing in formatted numbers share the same key. Frame dumps
+ * consist of hex digits only, so just their direction marker is used.
+ *
+ * \param[in] source Source of the record.
+ * \param[in] message Formatted message of the record.
+ * \param[in] frame_dump Whether the record is a frame dump.
+ * \param[out] template_len Buffer to store length of the message template in.
+ * \return uint64_t Key (never \c 0).
+ */
+static uint64_t logger_ratelimit_get_key(const char *source, const char *message, bool frame_dump, size_t *template_len)
+{
+    uint64_t hash = 0xcbf29ce484222325U;
+    for (const char *c = source; *c != '\0'; c++)
+    {
+        hash = (hash ^ (uint8_t) *c) * 0x100000001b3U;
+    }
+    hash = (hash ^ 0xffU) * 0x100000001b3U;
+
+    size_t length = 0U;
+    size_t max_length = frame_dump ? 3U : (LOGGER_RATELIMIT_TEMPLATE_LEN - 1U);
+    while ((message[length] != '\0') && ((message[length] < '0') || (message[length] > '9')) && (length < max_length))
+    {
+        hash = (hash ^ (uint8_t) message[length]) * 0x100000001b3U;
+        length++;
+    }
+    *template_len = length;
+    return (hash == 0U) ? 1U : hash;
+}
+
+/**
+ * \brief Refills token bucket according to time passed since last refill.
+ *
+ * \param[in] state Logger state containing rate configuration.
+ * \param[in] bucket Bucket to be refilled.
+ * \param[in] now_ns Current \c CLOCK_MONOTONIC time in [ns].
+ */
+static void logger_ratelimit_refill(const LoggerRatelimitState *state, LoggerRatelimitBucket *bucket, uint64_t now_ns)
+{
+    uint64_t capacity = (uint64_t) state->config.burst * LOGGER_RATELIMIT_TOKEN_SCALE;
+    uint64_t elapsed_ns = now_ns - bucket->last_refill_ns;
+    bucket->last_refill_ns = now_ns;
+
+    // Tokens are scaled so that one token equals one second of rate
+    uint64_t refill = elapsed_ns * state->config.rate_per_second;
+    if ((state->config.rate_per_second != 0U) && ((refill / state->config.rate_per_second) != elapsed_ns))
+    {
+        refill = capacity;
+    }
+    bucket->tokens = ((capacity - bucket->tokens) <= refill) ? capacity : (bucket->tokens + refill);
+}
+
+/**
+ * \brief Moves due summaries of suppressed records out of all buckets.
+ *
+ * \details Must be called with \ref LoggerRatelimitState.lock held.
+ *
+ * \param[in] state Logger state containing buckets.
+ * \param[in] now_ns Current \c CLOCK_MONOTONIC time in [ns].
+ * \param[out] summaries Buffer of \ref LOGGER_RATELIMIT_BUCKET_COUNT summaries.
+ * \param[in] summary_count Number of summaries already in \p summaries.
+ * \return size_t Number of summaries in \p summaries.
+ */
+static size_t logger_ratelimit_collect_summaries(LoggerRatelimitState *state, uint64_t now_ns, LoggerRatelimitBucket *summaries, size_t summary_count)
+{
+    if (now_ns < state->next_summary_ns)
+    {
+        return summary_count;
+    }
+    state->next_summary_ns = now_ns + ((uint64_t) state->config.summary_interval_ms * 1000000U);
+    if ((state->evicted.suppressed > 0U) && (summary_count < LOGGER_RATELIMIT_BUCKET_COUNT))
+    {
+        summaries[summary_count++] = state->evicted;
+        state->evicted.suppressed = 0U;
+    }
+    for (size_t i = 0U; (i < LOGGER_RATELIMIT_BUCKET_COUNT) && (summary_count < LOGGER_RATELIMIT_BUCKET_COUNT); i++)
+    {
+        if (state->buckets[i].suppressed > 0U)
+        {
+            summaries[summary_count++] = state->buckets[i];
+            state->buckets[i].suppressed = 0U;
+        }
+    }
+    return summary_count;
+}
+
+/**
+ * \brief Logs summaries of suppressed records via the wrapped logger.
+ *
+ * \param[in] state Logger state containing wrapped logger.
+ * \param[in] summaries Summaries to be logged.
+ * \param[in] summary_count Number of summaries in \p summaries.
+ */
+static void logger_ratelimit_emit_summaries(const LoggerRatelimitState *state, const LoggerRatelimitBucket *summaries, size_t summary_count)
+{
+    for (size_t i = 0U; i < summary_count; i++)
+    {
+        if (summaries[i].key == 0U)
+        {
+            ifx_logger_log(state->wrapped, summaries[i].source, IFX_LOG_WARN, "suppressed %llu messages of templates evicted from rate limit table", (unsigned long long) summaries[i].suppressed);
+        }
+        else
+        {
+            ifx_logger_log(state->wrapped, summaries[i].source, IFX_LOG_WARN, "suppressed %llu messages like \"%s...\"", (unsigned long long) summaries[i].suppressed, summaries[i].message_template);
+        }
+    }
+}
+
+/**
+ * \brief Thread function emitting due summaries if no further records are logged.
+ *
+ * \details Without it, the summary of a burst followed by silence would only
+ * be emitted together with the next record.
+ *
+ * \param[in] arg Logger state.
+ * \return void* Always \c NULL.
+ */
+static void *logger_ratelimit_flush(void *arg)
+{
+    LoggerRatelimitState *state = (LoggerRatelimitState *) arg;
+    LoggerRatelimitBucket summaries[LOGGER_RATELIMIT_BUCKET_COUNT];
+    pthread_mutex_lock(&state->lock);
+    while (!state->stop)
+    {
+        struct timespec deadline;
+        deadline.tv_sec = (time_t) (state->next_summary_ns / 1000000000U);
+        deadline.tv_nsec = (long) (state->next_summary_ns % 1000000000U);
+        pthread_cond_timedwait(&state->wakeup, &state->lock, &deadline);
+        if (state->stop)
+        {
+            break;
+        }
+        size_t summary_count = logger_ratelimit_collect_summaries(state, logger_ratelimit_now_ns(), summaries, 0U);
+        if (summary_count > 0U)
+        {
+            pthread_mutex_unlock(&state->lock);
+            logger_ratelimit_emit_summaries(state, summaries, summary_count);
+            pthread_mutex_lock(&state->lock);
+        }
+    }
+    pthread_mutex_unlock(&state->lock);
+    return NULL;
+}
+
+/**
+ * \brief Initializes ifx_logger_t object to be used as rate limiting decorator of another logger.
+ *
+ * \param[in] self Logger object to be initialized.
+ * \param[in] wrapped Logger to forward records to.
+ * \param[in] config Rate limit configuration (\c NULL for default values).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t logger_ratelimit_initialize(ifx_logger_t *self, ifx_logger_t *wrapped, const logger_ratelimit_config_t *config)
+{
+    // Validate parameters
+    if ((self == NULL) || (wrapped == NULL) || (self == wrapped))
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_ILLEGAL_ARGUMENT);
+    }
+    if ((config != NULL) && ((config->burst == 0U) || (config->summary_interval_ms == 0U)))
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    // Initialize object with default values
+    ifx_status_t status = ifx_logger_initialize(self);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+
+    // Populate rate limiting state
+    LoggerRatelimitState *state = calloc(1U, sizeof(LoggerRatelimitState));
+    if (state == NULL)
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_OUT_OF_MEMORY);
+    }
+    if (pthread_mutex_init(&state->lock, NULL) != 0)
+    {
+        free(state);
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_UNSPECIFIED_ERROR);
+    }
+    pthread_condattr_t wakeup_attributes;
+    pthread_condattr_init(&wakeup_attributes);
+    pthread_condattr_setclock(&wakeup_attributes, CLOCK_MONOTONIC);
+    int wakeup_result = pthread_cond_init(&state->wakeup, &wakeup_attributes);
+    pthread_condattr_destroy(&wakeup_attributes);
+    if (wakeup_result != 0)
+    {
+        pthread_mutex_destroy(&state->lock);
+        free(state);
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_UNSPECIFIED_ERROR);
+    }
+    state->wrapped = wrapped;
+    if (config != NULL)
+    {
+        state->config = *config;
+    }
+    else
+    {
+        state->config.rate_per_second = LOGGER_RATELIMIT_DEFAULT_RATE_PER_SECOND;
+        state->config.burst = LOGGER_RATELIMIT_DEFAULT_BURST;
+        state->config.summary_interval_ms = LOGGER_RATELIMIT_DEFAULT_SUMMARY_INTERVAL_MS;
+        state->config.frame_dump_sample_rate = 0U;
+    }
+    state->next_summary_ns = logger_ratelimit_now_ns() + ((uint64_t) state->config.summary_interval_ms * 1000000U);
+    if (pthread_create(&state->flusher, NULL, logger_ratelimit_flush, state) != 0)
+    {
+        pthread_cond_destroy(&state->wakeup);
+        pthread_mutex_destroy(&state->lock);
+        free(state);
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_UNSPECIFIED_ERROR);
+    }
+
+    // Populate member functions
+    self->_data = state;
+    self->_log = logger_ratelimit_log;
+    self->_destructor = logger_ratelimit_destroy;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief \ref ifx_logger_log_callback_t for rate limiting logger.
+ *
+ * \see ifx_logger_log_callback_t
+ */
+ifx_status_t logger_ratelimit_log(const ifx_logger_t *self, const char *source, ifx_log_level level, const char *formatter)
+{
+    // Validate parameters
+    if ((self == NULL) || (self->_data == NULL) || (source == NULL) || (formatter == NULL))
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_ILLEGAL_ARGUMENT);
+    }
+    LoggerRatelimitState *state = (LoggerRatelimitState *) self->_data;
+    if (level < state->wrapped->_level)
+    {
+        return IFX_SUCCESS;
+    }
+    bool frame_dump = logger_ratelimit_is_frame_dump(level, formatter);
+    size_t template_len = 0U;
+    uint64_t key = logger_ratelimit_get_key(source, formatter, frame_dump, &template_len);
+    uint64_t now_ns = logger_ratelimit_now_ns();
+    bool forward = true;
+
+    // Summaries are collected under lock but logged afterwards
+    LoggerRatelimitBucket summaries[LOGGER_RATELIMIT_BUCKET_COUNT];
+    size_t summary_count = 0U;
+
+    pthread_mutex_lock(&state->lock);
+
+    // Sample frame dumps before they consume any tokens
+    if (frame_dump && (state->config.frame_dump_sample_rate > 1U))
+    {
+        if ((state->frame_dumps++ % state->config.frame_dump_sample_rate) != 0U)
+        {
+            __atomic_add_fetch(&state->total_sampled_out, 1U, __ATOMIC_RELAXED);
+            forward = false;
+        }
+    }
+
+    if (forward)
+    {
+        // Look up key in its set, remembering an unused or the least recently used bucket
+        LoggerRatelimitBucket *set = &state->buckets[(key % (LOGGER_RATELIMIT_BUCKET_COUNT / LOGGER_RATELIMIT_WAY_COUNT)) * LOGGER_RATELIMIT_WAY_COUNT];
+        LoggerRatelimitBucket *bucket = NULL;
+        LoggerRatelimitBucket *victim = &set[0];
+        for (size_t way = 0U; (way < LOGGER_RATELIMIT_WAY_COUNT) && (bucket == NULL); way++)
+        {
+            if (set[way].key == key)
+            {
+                bucket = &set[way];
+            }
+            else if ((victim->key != 0U) && ((set[way].key == 0U) || (set[way].last_refill_ns < victim->last_refill_ns)))
+            {
+                victim = &set[way];
+            }
+        }
+        if (bucket == NULL)
+        {
+            // Counts of evicted buckets are summarized together so that thrashing does not flood the log
+            if (victim->suppressed > 0U)
+            {
+                state->evicted.suppressed += victim->suppressed;
+                memcpy(state->evicted.source, victim->source, LOGGER_RATELIMIT_SOURCE_LEN);
+            }
+
+            // Fill level is taken over so that groups thrashing a set are still limited
+            uint64_t tokens = (uint64_t) state->config.burst * LOGGER_RATELIMIT_TOKEN_SCALE;
+            if (victim->key != 0U)
+            {
+                logger_ratelimit_refill(state, victim, now_ns);
+                tokens = victim->tokens;
+            }
+            bucket = victim;
+            bucket->key = key;
+            bucket->tokens = tokens;
+            bucket->last_refill_ns = now_ns;
+            bucket->suppressed = 0U;
+            strncpy(bucket->source, source, LOGGER_RATELIMIT_SOURCE_LEN - 1U);
+            bucket->source[LOGGER_RATELIMIT_SOURCE_LEN - 1U] = '\0';
+            memcpy(bucket->message_template, formatter, template_len);
+            bucket->message_template[template_len] = '\0';
+        }
+        else
+        {
+            logger_ratelimit_refill(state, bucket, now_ns);
+        }
+
+        if (bucket->tokens >= LOGGER_RATELIMIT_TOKEN_SCALE)
+        {
+            bucket->tokens -= LOGGER_RATELIMIT_TOKEN_SCALE;
+        }
+        else
+        {
+            bucket->suppressed++;
+            __atomic_add_fetch(&state->total_suppressed, 1U, __ATOMIC_RELAXED);
+            forward = false;
+        }
+    }
+
+    // Periodically report suppressed records of all buckets
+    summary_count = logger_ratelimit_collect_summaries(state, now_ns, summaries, summary_count);
+
+    pthread_mutex_unlock(&state->lock);
+
+    logger_ratelimit_emit_summaries(state, summaries, summary_count);
+    if (!forward)
+    {
+        return IFX_SUCCESS;
+    }
+    return state->wrapped->_log(state->wrapped, source, level, formatter);
+}
+
+/**
+ * \brief Getter for number of records dropped by rate limiting logger.
+ *
+ * \param[in] self Rate limiting logger to get statistics for.
+ * \param[out] statistics_buffer Buffer to store statistics in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t logger_ratelimit_get_statistics(const ifx_logger_t *self, logger_ratelimit_statistics_t *statistics_buffer)
+{
+    // Validate parameters
+    if ((self == NULL) || (statistics_buffer == NULL) || (self->_log != logger_ratelimit_log) || (self->_data == NULL))
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_RATELIMIT_GET_STATISTICS, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    LoggerRatelimitState *state = (LoggerRatelimitState *) self->_data;
+    statistics_buffer->suppressed = __atomic_load_n(&state->total_suppressed, __ATOMIC_RELAXED);
+    statistics_buffer->sampled_out = __atomic_load_n(&state->total_sampled_out, __ATOMIC_RELAXED);
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief \ref ifx_logger_destroy_callback_t for rate limiting logger.
+ *
+ * \details Stops the summary thread and emits final summaries but does not
+ * destroy the wrapped logger.
+ *
+ * \see ifx_logger_destroy_callback_t
+ */
+void logger_ratelimit_destroy(ifx_logger_t *self)
+{
+    if ((self == NULL) || (self->_data == NULL))
+    {
+        return;
+    }
+    LoggerRatelimitState *state = (LoggerRatelimitState *) self->_data;
+    pthread_mutex_lock(&state->lock);
+    state->stop = true;
+    pthread_cond_signal(&state->wakeup);
+    pthread_mutex_unlock(&state->lock);
+    pthread_join(state->flusher, NULL);
+
+    for (size_t i = 0U; i < LOGGER_RATELIMIT_BUCKET_COUNT; i++)
+    {
+        if (state->buckets[i].suppressed > 0U)
+        {
+            logger_ratelimit_emit_summaries(state, &state->buckets[i], 1U);
+        }
+    }
+    if (state->evicted.suppressed > 0U)
+    {
+        logger_ratelimit_emit_summaries(state, &state->evicted, 1U);
+    }
+    pthread_cond_destroy(&state->wakeup);
+    pthread_mutex_destroy(&state->lock);
+    free(state);
+    self->_data = NULL;
+}
@@ -0,0 +1,168 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file logger-ratelimit.h
+ * \brief Internal definitions for rate limiting logger decorator for NBT framework.
+ */
+#ifndef LOGGER_RATELIMIT_H
+#define LOGGER_RATELIMIT_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-logger.h"
+#include "infineon/logger-ratelimit.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Number of (source, message template) pairs tracked at the same time.
+ */
+#define LOGGER_RATELIMIT_BUCKET_COUNT 64U
+
+/**
+ * \brief Number of buckets per set of the set-associative bucket table.
+ */
+#define LOGGER_RATELIMIT_WAY_COUNT 4U
+
+/**
+ * \brief Maximum number of characters of the message used as message template.
+ */
+#define LOGGER_RATELIMIT_TEMPLATE_LEN 48U
+
+/**
+ * \brief Maximum number of characters of the source stored for summaries.
+ */
+#define LOGGER_RATELIMIT_SOURCE_LEN 16U
+
+/**
+ * \brief Fixed point scaling of token bucket fill levels.
+ */
+#define LOGGER_RATELIMIT_TOKEN_SCALE 1000000000U
+
+/**
+ * \brief \ref ifx_logger_log_callback_t for rate limiting logger.
+ *
+ * \see ifx_logger_log_callback_t
+ */
+ifx_status_t logger_ratelimit_log(const ifx_logger_t *self, const char *source, ifx_log_level level, const char *formatter);
+
+/**
+ * \brief \ref ifx_logger_destroy_callback_t for rate limiting logger.
+ *
+ * \see ifx_logger_destroy_callback_t
+ */
+void logger_ratelimit_destroy(ifx_logger_t *self);
+
+/** \struct LoggerRatelimitBucket
+ * \brief Token bucket of a single (source, message template) pair.
+ */
+typedef struct
+{
+    /**
+     * \brief Hash of source and message template (\c 0 for unused buckets).
+     */
+    uint64_t key;
+
+    /**
+     * \brief Available tokens scaled by \ref LOGGER_RATELIMIT_TOKEN_SCALE.
+     */
+    uint64_t tokens;
+
+    /**
+     * \brief \c CLOCK_MONOTONIC timestamp in [ns] of last refill (i.e. last use).
+     */
+    uint64_t last_refill_ns;
+
+    /**
+     * \brief Number of records suppressed since last summary.
+     */
+    uint64_t suppressed;
+
+    /**
+     * \brief Source of the records for summaries.
+     */
+    char source[LOGGER_RATELIMIT_SOURCE_LEN];
+
+    /**
+     * \brief Message template of the records for summaries.
+     */
+    char message_template[LOGGER_RATELIMIT_TEMPLATE_LEN];
+} LoggerRatelimitBucket;
+
+/** \struct LoggerRatelimitState
+ * \brief State of rate limiting logger stored in ifx_logger_t._data.
+ */
+typedef struct
+{
+    /**
+     * \brief Logger records are forwarded to.
+     */
+    ifx_logger_t *wrapped;
+
+    /**
+     * \brief Active configuration.
+     */
+    logger_ratelimit_config_t config;
+
+    /**
+     * \brief Lock protecting buckets and sampling state.
+     */
+    pthread_mutex_t lock;
+
+    /**
+     * \brief Token buckets, grouped in sets of \ref LOGGER_RATELIMIT_WAY_COUNT selected by key.
+     */
+    LoggerRatelimitBucket buckets[LOGGER_RATELIMIT_BUCKET_COUNT];
+
+    /**
+     * \brief Records suppressed in buckets evicted since last summary (\ref LoggerRatelimitBucket.key is always \c 0).
+     */
+    LoggerRatelimitBucket evicted;
+
+    /**
+     * \brief \c CLOCK_MONOTONIC timestamp in [ns] when the next summary is due.
+     */
+    uint64_t next_summary_ns;
+
+    /**
+     * \brief Thread emitting due summaries if no further records are logged.
+     */
+    pthread_t flusher;
+
+    /**
+     * \brief Condition (using \c CLOCK_MONOTONIC) waking \ref flusher for shutdown.
+     */
+    pthread_cond_t wakeup;
+
+    /**
+     * \brief Whether \ref flusher shall terminate.
+     */
+    bool stop;
+
+    /**
+     * \brief Number of frame dumps seen, used for 1-in-N sampling.
+     */
+    uint64_t frame_dumps;
+
+    /**
+     * \brief Total number of suppressed records (accessed atomically).
+     */
+    uint64_t total_suppressed;
+
+    /**
+     * \brief Total number of frame dumps dropped by sampling (accessed atomically).
+     */
+    uint64_t total_sampled_out;
+} LoggerRatelimitState;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOGGER_RATELIMIT_H
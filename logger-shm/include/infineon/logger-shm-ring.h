@@ -0,0 +1,164 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/logger-shm-ring.h
+ * \brief Memory layout of the shared-memory log ring written by the shared-memory logger.
+ *
+ * \details This header has no dependencies on the NBT framework so that
+ * external tools can attach to the ring without linking the host library.
+ *
+ * Writers claim a sequence number by atomically incrementing
+ * logger_shm_ring_header_t.write_sequence. The record slot of sequence number
+ * \c n is \c n % \c record_count. While a record is written its
+ * logger_shm_record_t.sequence is \c 0, afterwards it is \c n + 1. Readers
+ * copy a record and only accept it if its sequence number matched \c n + 1
+ * before and after copying.
+ */
+#ifndef INFINEON_LOGGER_SHM_RING_H
+#define INFINEON_LOGGER_SHM_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Magic number identifying a log ring ("NBTL").
+ */
+#define LOGGER_SHM_RING_MAGIC 0x4e42544cU
+
+/**
+ * \brief Version of the log ring layout.
+ */
+#define LOGGER_SHM_RING_VERSION 1U
+
+/**
+ * \brief Default POSIX shared-memory object name of the log ring.
+ */
+#define LOGGER_SHM_DEFAULT_NAME "/optiga-nbt-log"
+
+/**
+ * \brief Default number of records held by the log ring.
+ */
+#define LOGGER_SHM_DEFAULT_RECORD_COUNT 4096U
+
+/**
+ * \brief Maximum length of the source stored per record (including terminator).
+ */
+#define LOGGER_SHM_SOURCE_LEN 16U
+
+/**
+ * \brief Maximum length of the message stored per record (including terminator).
+ *
+ * \details Longer messages are cut and marked via
+ * logger_shm_record_t.truncated. This includes the hex frame dumps of the
+ * I2C driver layer for frames above ~70 bytes (3 characters per byte), e.g. a
+ * 255 byte frame needs ~765 characters. Define a larger value for the writer
+ * and all readers alike to keep complete dumps, readers reject rings with a
+ * different logger_shm_ring_header_t.record_size.
+ */
+#ifndef LOGGER_SHM_MESSAGE_LEN
+#define LOGGER_SHM_MESSAGE_LEN 216U
+#endif
+
+/** \struct logger_shm_record_t
+ * \brief Single record slot of the log ring (256 bytes with default \ref LOGGER_SHM_MESSAGE_LEN).
+ */
+typedef struct
+{
+    /**
+     * \brief Sequence number of the record plus one (\c 0 while being written).
+     */
+    uint64_t sequence;
+
+    /**
+     * \brief \c CLOCK_MONOTONIC timestamp in [ns].
+     */
+    uint64_t timestamp_ns;
+
+    /**
+     * \brief Kernel thread ID of the logging thread.
+     */
+    uint32_t tid;
+
+    /**
+     * \brief ifx_log_level of the record.
+     */
+    uint8_t level;
+
+    /**
+     * \brief Set to \c 1 if the message had to be cut to \ref LOGGER_SHM_MESSAGE_LEN.
+     */
+    uint8_t truncated;
+
+    /**
+     * \brief Length of the message excluding terminator.
+     */
+    uint16_t message_len;
+
+    /**
+     * \brief Zero terminated source of the record.
+     */
+    char source[LOGGER_SHM_SOURCE_LEN];
+
+    /**
+     * \brief Zero terminated message of the record.
+     */
+    char message[LOGGER_SHM_MESSAGE_LEN];
+} logger_shm_record_t;
+
+/** \struct logger_shm_ring_header_t
+ * \brief Header at the start of the shared-memory object followed by the record slots.
+ */
+typedef struct
+{
+    /**
+     * \brief \ref LOGGER_SHM_RING_MAGIC.
+     */
+    uint32_t magic;
+
+    /**
+     * \brief \ref LOGGER_SHM_RING_VERSION.
+     */
+    uint32_t version;
+
+    /**
+     * \brief Size of a single record slot in [bytes].
+     */
+    uint32_t record_size;
+
+    /**
+     * \brief Number of record slots following the header.
+     */
+    uint32_t record_count;
+
+    /**
+     * \brief Next sequence number to be claimed by a writer (accessed atomically).
+     */
+    uint64_t write_sequence;
+
+    /**
+     * \brief Padding to keep record slots cache line aligned.
+     */
+    uint8_t reserved[40];
+} logger_shm_ring_header_t;
+
+/**
+ * \brief Returns total size in [bytes] of a log ring with the given number of records.
+ */
+#define LOGGER_SHM_RING_SIZE(record_count) (sizeof(logger_shm_ring_header_t) + ((size_t) (record_count) * sizeof(logger_shm_record_t)))
+
+/**
+ * \brief Returns pointer to record slot of given sequence number.
+ */
+#define LOGGER_SHM_RING_RECORD(header, sequence) \
+    (((logger_shm_record_t *) ((uint8_t *) (header) + sizeof(logger_shm_ring_header_t))) + ((sequence) % (header)->record_count))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_LOGGER_SHM_RING_H
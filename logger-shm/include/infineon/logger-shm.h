@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/logger-shm.h
+ * \brief Logger API implementation for NBT framework publishing records into a shared-memory ring.
+ */
+#ifndef INFINEON_LOGGER_SHM_H
+#define INFINEON_LOGGER_SHM_H
+
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-logger.h"
+#include "infineon/logger-shm-ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Initializes ifx_logger_t object to publish records into a POSIX shared-memory ring.
+ *
+ * \details The shared-memory object is created if it does not exist yet and
+ * re-initialized if its layout does not match. Logging a record costs a single
+ * \c memcpy into the ring and never blocks. Old records are overwritten once
+ * the ring is full. The ring can be inspected with the \c nbt-logtail tool
+ * while the process is running.
+ *
+ * The shared-memory object is not removed when the logger is destroyed so
+ * that the last records stay available, use \c shm_unlink() to remove it.
+ *
+ * \param[in] self Logger object to be initialized.
+ * \param[in] name POSIX shared-memory object name (\c NULL for \ref LOGGER_SHM_DEFAULT_NAME).
+ * \param[in] record_count Number of records held by the ring (\c 0 for \ref LOGGER_SHM_DEFAULT_RECORD_COUNT).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t logger_shm_initialize(ifx_logger_t *self, const char *name, uint32_t record_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_LOGGER_SHM_H
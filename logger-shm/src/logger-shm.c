@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file logger-shm.c
+ * \brief Logger API implementation for NBT framework publishing records into a shared-memory ring.
+ */
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-logger.h"
+#include "infineon/logger-shm.h"
+#include "logger-shm.h"
+
+/**
+ * \brief Returns kernel thread ID of the calling thread, cached per thread.
+ *
+ * \return uint32_t Thread ID of the calling thread.
+ */
+static uint32_t logger_shm_get_tid(void)
+{
+    static __thread uint32_t tid = 0U;
+    if (tid == 0U)
+    {
+        tid = (uint32_t) syscall(SYS_gettid);
+    }
+    return tid;
+}
+
+/**
+ * \brief Checks if mapped ring has been initialized with the expected layout.
+ *
+ * \param[in] ring Mapped ring to be checked.
+ * \param[in] record_count Expected number of records.
+ * \return int \c 1 if layout matches, \c 0 otherwise.
+ */
+static int logger_shm_ring_matches(const logger_shm_ring_header_t *ring, uint32_t record_count)
+{
+    return (__atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) == LOGGER_SHM_RING_MAGIC) && (ring->version == LOGGER_SHM_RING_VERSION) &&
+           (ring->record_size == sizeof(logger_shm_record_t)) && (ring->record_count == record_count);
+}
+
+/**
+ * \brief Initializes ifx_logger_t object to publish records into a POSIX shared-memory ring.
+ *
+ * \param[in] self Logger object to be initialized.
+ * \param[in] name POSIX shared-memory object name (\c NULL for \ref LOGGER_SHM_DEFAULT_NAME).
+ * \param[in] record_count Number of records held by the ring (\c 0 for \ref LOGGER_SHM_DEFAULT_RECORD_COUNT).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t logger_shm_initialize(ifx_logger_t *self, const char *name, uint32_t record_count)
+{
+    // Validate parameters
+    if (self == NULL)
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_ILLEGAL_ARGUMENT);
+    }
+    if (name == NULL)
+    {
+        name = LOGGER_SHM_DEFAULT_NAME;
+    }
+    if (record_count == 0U)
+    {
+        record_count = LOGGER_SHM_DEFAULT_RECORD_COUNT;
+    }
+
+    // Initialize object with default values
+    ifx_status_t status = ifx_logger_initialize(self);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+
+    LoggerShmState *state = malloc(sizeof(LoggerShmState));
+    if (state == NULL)
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_OUT_OF_MEMORY);
+    }
+    state->ring_size = LOGGER_SHM_RING_SIZE(record_count);
+
+    // Open or create shared-memory object
+    int fd = shm_open(name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP);
+    if (fd < 0)
+    {
+        free(state);
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_UNSPECIFIED_ERROR);
+    }
+    struct stat info;
+    if ((fstat(fd, &info) != 0) || ((info.st_size != (off_t) state->ring_size) && (ftruncate(fd, (off_t) state->ring_size) != 0)))
+    {
+        close(fd);
+        free(state);
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_UNSPECIFIED_ERROR);
+    }
+    state->ring = (logger_shm_ring_header_t *) mmap(NULL, state->ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (state->ring == MAP_FAILED)
+    {
+        free(state);
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_UNSPECIFIED_ERROR);
+    }
+
+    // Continue existing ring if compatible so that readers stay attached across restarts
+    if (!logger_shm_ring_matches(state->ring, record_count))
+    {
+        __atomic_store_n(&state->ring->magic, 0U, __ATOMIC_RELEASE);
+        memset(((uint8_t *) state->ring) + sizeof(uint32_t), 0, state->ring_size - sizeof(uint32_t));
+        state->ring->version = LOGGER_SHM_RING_VERSION;
+        state->ring->record_size = sizeof(logger_shm_record_t);
+        state->ring->record_count = record_count;
+        __atomic_store_n(&state->ring->magic, LOGGER_SHM_RING_MAGIC, __ATOMIC_RELEASE);
+    }
+
+    // Populate member functions
+    self->_data = state;
+    self->_log = logger_shm_log;
+    self->_destructor = logger_shm_destroy;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief \ref ifx_logger_log_callback_t for shared-memory logger.
+ *
+ * \see ifx_logger_log_callback_t
+ */
+ifx_status_t logger_shm_log(const ifx_logger_t *self, const char *source, ifx_log_level level, const char *formatter)
+{
+    // Validate parameters
+    if ((self == NULL) || (self->_data == NULL) || (source == NULL) || (formatter == NULL))
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_ILLEGAL_ARGUMENT);
+    }
+    if ((level < IFX_LOG_DEBUG) || (level > IFX_LOG_FATAL))
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_ILLEGAL_ARGUMENT);
+    }
+    LoggerShmState *state = (LoggerShmState *) self->_data;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    // Claim slot and mark it as being written
+    uint64_t sequence = __atomic_fetch_add(&state->ring->write_sequence, 1U, __ATOMIC_RELAXED);
+    logger_shm_record_t *record = LOGGER_SHM_RING_RECORD(state->ring, sequence);
+    __atomic_store_n(&record->sequence, 0U, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    size_t source_len = strnlen(source, LOGGER_SHM_SOURCE_LEN - 1U);
+    size_t message_len = strnlen(formatter, LOGGER_SHM_MESSAGE_LEN);
+    record->truncated = 0U;
+    if (message_len >= LOGGER_SHM_MESSAGE_LEN)
+    {
+        message_len = LOGGER_SHM_MESSAGE_LEN - 1U;
+        record->truncated = 1U;
+    }
+    record->timestamp_ns = ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec;
+    record->tid = logger_shm_get_tid();
+    record->level = (uint8_t) level;
+    record->message_len = (uint16_t) message_len;
+    memcpy(record->source, source, source_len);
+    record->source[source_len] = '\0';
+    memcpy(record->message, formatter, message_len);
+    record->message[message_len] = '\0';
+
+    // Publish record
+    __atomic_store_n(&record->sequence, sequence + 1U, __ATOMIC_RELEASE);
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief \ref ifx_logger_destroy_callback_t for shared-memory logger.
+ *
+ * \details Unmaps the ring but keeps the shared-memory object.
+ *
+ * \see ifx_logger_destroy_callback_t
+ */
+void logger_shm_destroy(ifx_logger_t *self)
+{
+    if ((self == NULL) || (self->_data == NULL))
+    {
+        return;
+    }
+    LoggerShmState *state = (LoggerShmState *) self->_data;
+    munmap(state->ring, state->ring_size);
+    free(state);
+    self->_data = NULL;
+}
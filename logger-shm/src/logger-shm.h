@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file logger-shm.h
+ * \brief Internal definitions for shared-memory logger API implementation for NBT framework.
+ */
+#ifndef LOGGER_SHM_H
+#define LOGGER_SHM_H
+
+#include <stddef.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-logger.h"
+#include "infineon/logger-shm-ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief \ref ifx_logger_log_callback_t for shared-memory logger.
+ *
+ * \see ifx_logger_log_callback_t
+ */
+ifx_status_t logger_shm_log(const ifx_logger_t *self, const char *source, ifx_log_level level, const char *formatter);
+
+/**
+ * \brief \ref ifx_logger_destroy_callback_t for shared-memory logger.
+ *
+ * \see ifx_logger_destroy_callback_t
+ */
+void logger_shm_destroy(ifx_logger_t *self);
+
+/** \struct LoggerShmState
+ * \brief State of shared-memory logger stored in ifx_logger_t._data.
+ */
+typedef struct
+{
+    /**
+     * \brief Mapped log ring.
+     */
+    logger_shm_ring_header_t *ring;
+
+    /**
+     * \brief Size of the mapping in [bytes].
+     */
+    size_t ring_size;
+} LoggerShmState;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOGGER_SHM_H
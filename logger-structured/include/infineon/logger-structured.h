@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/logger-structured.h
+ * \brief Logger API implementation for NBT framework writing structured JSON lines or logfmt records.
+ */
+#ifndef INFINEON_LOGGER_STRUCTURED_H
+#define INFINEON_LOGGER_STRUCTURED_H
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-logger.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Maximum length of a single structured record in [bytes].
+ *
+ * \details Longer messages are cut and the record is marked as truncated.
+ */
+#define LOGGER_STRUCTURED_MAX_RECORD_LEN 4096U
+
+/**
+ * \brief Output formats supported by structured logger.
+ */
+typedef enum
+{
+    /**
+     * \brief One JSON object per line.
+     */
+    LOGGER_STRUCTURED_FORMAT_JSON = 0,
+
+    /**
+     * \brief One logfmt record (\c key=value pairs) per line.
+     */
+    LOGGER_STRUCTURED_FORMAT_LOGFMT = 1
+} logger_structured_format_t;
+
+/**
+ * \brief Initializes ifx_logger_t object to be used as structured logger.
+ *
+ * \details Each record carries the fields \c ts_ns (\c CLOCK_MONOTONIC in
+ * [ns]), \c tid, \c source, \c level and \c msg. Frame dumps as logged by the
+ * I2C driver layer (\c ">> " / \c "<< " followed by hex bytes) are written with
+ * the fields \c dir (\c tx / \c rx), \c len and \c data (hex payload) instead
+ * of \c msg. Records are formatted on the stack and written with a single
+ * \c write() without any heap allocation.
+ *
+ * \param[in] self Logger object to be initialized.
+ * \param[in] fd File descriptor to write records to (e.g. \c STDOUT_FILENO).
+ * \param[in] format Output format of the records.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t logger_structured_initialize(ifx_logger_t *self, int fd, logger_structured_format_t format);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_LOGGER_STRUCTURED_H
@@ -0,0 +1,412 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file logger-structured.c
+ * \brief Logger API implementation for NBT framework writing structured JSON lines or logfmt records.
+ */
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-logger.h"
+#include "infineon/logger-structured.h"
+#include "logger-structured.h"
+
+/**
+ * \brief Returns kernel thread ID of the calling thread, cached per thread.
+ *
+ * \return long Thread ID of the calling thread.
+ */
+static long logger_structured_get_tid(void)
+{
+    static __thread long tid = 0;
+    if (tid == 0)
+    {
+        tid = syscall(SYS_gettid);
+    }
+    return tid;
+}
+
+/**
+ * \brief Returns the level name written for a log level.
+ *
+ * \param[in] level Log level to get name for.
+ * \return const char * Level name or \c NULL for invalid levels.
+ */
+static const char *logger_structured_get_level_name(ifx_log_level level)
+{
+    switch (level)
+    {
+    case IFX_LOG_DEBUG:
+        return "debug";
+    case IFX_LOG_INFO:
+        return "info";
+    case IFX_LOG_WARN:
+        return "warn";
+    case IFX_LOG_ERROR:
+        return "error";
+    case IFX_LOG_FATAL:
+        return "fatal";
+    default:
+        return NULL;
+    }
+}
+
+/**
+ * \brief Appends raw bytes to record, cutting them if the record is full.
+ *
+ * \details Once a record has been cut, nothing is appended anymore.
+ *
+ * \param[in] record Record to append to.
+ * \param[in] data Bytes to be appended.
+ * \param[in] data_len Number of bytes in \p data.
+ */
+static void logger_structured_append(LoggerStructuredRecord *record, const char *data, size_t data_len)
+{
+    if (record->truncated)
+    {
+        return;
+    }
+    size_t available = LOGGER_STRUCTURED_MAX_RECORD_LEN - LOGGER_STRUCTURED_RECORD_TRAILER_LEN - record->length;
+    if (data_len > available)
+    {
+        data_len = available;
+        record->truncated = true;
+    }
+    memcpy(record->data + record->length, data, data_len);
+    record->length += data_len;
+}
+
+/**
+ * \brief Appends bytes closing the current value or record, using the reserved trailer space.
+ *
+ * \param[in] record Record to append to.
+ * \param[in] data Bytes to be appended (less than \ref LOGGER_STRUCTURED_RECORD_TRAILER_LEN in total per record).
+ * \param[in] data_len Number of bytes in \p data.
+ */
+static void logger_structured_append_trailer(LoggerStructuredRecord *record, const char *data, size_t data_len)
+{
+    memcpy(record->data + record->length, data, data_len);
+    record->length += data_len;
+}
+
+/**
+ * \brief Appends unsigned decimal number to record.
+ *
+ * \param[in] record Record to append to.
+ * \param[in] value Number to be appended.
+ */
+static void logger_structured_append_u64(LoggerStructuredRecord *record, uint64_t value)
+{
+    char digits[20];
+    size_t count = 0U;
+    do
+    {
+        digits[sizeof(digits) - 1U - count] = (char) ('0' + (value % 10U));
+        value /= 10U;
+        count++;
+    } while (value != 0U);
+    logger_structured_append(record, digits + sizeof(digits) - count, count);
+}
+
+/**
+ * \brief Appends key of next field including separator to record.
+ *
+ * \param[in] record Record to append to.
+ * \param[in] key Name of the field.
+ */
+static void logger_structured_append_key(LoggerStructuredRecord *record, const char *key)
+{
+    if (record->format == LOGGER_STRUCTURED_FORMAT_JSON)
+    {
+        logger_structured_append(record, (record->fields > 0U) ? ",\"" : "\"", (record->fields > 0U) ? 2U : 1U);
+        logger_structured_append(record, key, strlen(key));
+        logger_structured_append(record, "\":", 2U);
+    }
+    else
+    {
+        if (record->fields > 0U)
+        {
+            logger_structured_append(record, " ", 1U);
+        }
+        logger_structured_append(record, key, strlen(key));
+        logger_structured_append(record, "=", 1U);
+    }
+    record->fields++;
+}
+
+/**
+ * \brief Appends string value to record, escaping it according to the record format.
+ *
+ * \details JSON values are always quoted. logfmt values are only quoted if
+ * they contain spaces, quotes, \c = or control characters.
+ *
+ * \param[in] record Record to append to.
+ * \param[in] value String to be appended.
+ * \param[in] value_len Number of characters in \p value.
+ */
+static void logger_structured_append_string(LoggerStructuredRecord *record, const char *value, size_t value_len)
+{
+    bool quoted = (record->format == LOGGER_STRUCTURED_FORMAT_JSON) || (value_len == 0U);
+    for (size_t i = 0U; (i < value_len) && !quoted; i++)
+    {
+        unsigned char c = (unsigned char) value[i];
+        quoted = (c <= ' ') || (c == '"') || (c == '=') || (c == '\\') || (c == 0x7fU);
+    }
+    // Closing quote is only needed if the opening one made it into the record
+    if (quoted)
+    {
+        logger_structured_append(record, "\"", 1U);
+        quoted = !record->truncated;
+    }
+
+    // Copy runs of plain characters in one go
+    size_t run_start = 0U;
+    for (size_t i = 0U; i < value_len; i++)
+    {
+        unsigned char c = (unsigned char) value[i];
+        if ((c >= ' ') && (c != '"') && (c != '\\') && (c != 0x7fU))
+        {
+            continue;
+        }
+        logger_structured_append(record, value + run_start, i - run_start);
+        run_start = i + 1U;
+
+        char escape[6] = {'\\', 'u', '0', '0', '0', '0'};
+        size_t escape_len = 2U;
+        switch (c)
+        {
+        case '"':
+        case '\\':
+            escape[1] = (char) c;
+            break;
+        case '\n':
+            escape[1] = 'n';
+            break;
+        case '\r':
+            escape[1] = 'r';
+            break;
+        case '\t':
+            escape[1] = 't';
+            break;
+        default:
+            escape[4] = "0123456789abcdef"[(c >> 4) & 0x0fU];
+            escape[5] = "0123456789abcdef"[c & 0x0fU];
+            escape_len = 6U;
+            break;
+        }
+        if ((LOGGER_STRUCTURED_MAX_RECORD_LEN - LOGGER_STRUCTURED_RECORD_TRAILER_LEN - record->length) < escape_len)
+        {
+            record->truncated = true;
+        }
+        logger_structured_append(record, escape, escape_len);
+    }
+    logger_structured_append(record, value + run_start, value_len - run_start);
+
+    if (quoted)
+    {
+        logger_structured_append_trailer(record, "\"", 1U);
+    }
+}
+
+/**
+ * \brief Checks if message is a frame dump as logged by the I2C driver layer.
+ *
+ * \param[in] message Formatted message of the record.
+ * \param[out] digit_count Buffer to store number of hex digits of the payload in.
+ * \return bool \c true if message is a frame dump.
+ */
+static bool logger_structured_is_frame_dump(const char *message, size_t *digit_count)
+{
+    if (((message[0] != '>') && (message[0] != '<')) || (message[1] != message[0]) || (message[2] != ' '))
+    {
+        return false;
+    }
+
+    size_t digits = 0U;
+    for (const char *c = message + 3; *c != '\0'; c++)
+    {
+        if (((*c >= '0') && (*c <= '9')) || ((*c >= 'a') && (*c <= 'f')) || ((*c >= 'A') && (*c <= 'F')))
+        {
+            digits++;
+        }
+        else if (*c != ' ')
+        {
+            return false;
+        }
+    }
+    *digit_count = digits;
+    return (digits % 2U) == 0U;
+}
+
+/**
+ * \brief Initializes ifx_logger_t object to be used as structured logger.
+ *
+ * \param[in] self Logger object to be initialized.
+ * \param[in] fd File descriptor to write records to (e.g. \c STDOUT_FILENO).
+ * \param[in] format Output format of the records.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t logger_structured_initialize(ifx_logger_t *self, int fd, logger_structured_format_t format)
+{
+    // Validate parameters
+    if ((self == NULL) || (fd < 0) || ((format != LOGGER_STRUCTURED_FORMAT_JSON) && (format != LOGGER_STRUCTURED_FORMAT_LOGFMT)))
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    // Initialize object with default values
+    ifx_status_t status = ifx_logger_initialize(self);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+
+    // Populate structured logger state
+    LoggerStructuredState *state = malloc(sizeof(LoggerStructuredState));
+    if (state == NULL)
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_INITIALIZE, IFX_OUT_OF_MEMORY);
+    }
+    state->fd = fd;
+    state->format = format;
+
+    // Populate member functions
+    self->_data = state;
+    self->_log = logger_structured_log;
+    self->_destructor = logger_structured_destroy;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief \ref ifx_logger_log_callback_t for structured logger.
+ *
+ * \see ifx_logger_log_callback_t
+ */
+ifx_status_t logger_structured_log(const ifx_logger_t *self, const char *source, ifx_log_level level, const char *formatter)
+{
+    // Validate parameters
+    if ((self == NULL) || (self->_data == NULL) || (source == NULL) || (formatter == NULL))
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_ILLEGAL_ARGUMENT);
+    }
+    const char *level_name = logger_structured_get_level_name(level);
+    if (level_name == NULL)
+    {
+        return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_ILLEGAL_ARGUMENT);
+    }
+    LoggerStructuredState *state = (LoggerStructuredState *) self->_data;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    // Format record on the stack
+    LoggerStructuredRecord record;
+    record.format = state->format;
+    record.length = 0U;
+    record.fields = 0U;
+    record.truncated = false;
+    if (record.format == LOGGER_STRUCTURED_FORMAT_JSON)
+    {
+        logger_structured_append(&record, "{", 1U);
+    }
+    logger_structured_append_key(&record, "ts_ns");
+    logger_structured_append_u64(&record, ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec);
+    logger_structured_append_key(&record, "tid");
+    logger_structured_append_u64(&record, (uint64_t) logger_structured_get_tid());
+    logger_structured_append_key(&record, "source");
+    logger_structured_append_string(&record, source, strlen(source));
+    logger_structured_append_key(&record, "level");
+    logger_structured_append_string(&record, level_name, strlen(level_name));
+
+    size_t digit_count = 0U;
+    if (logger_structured_is_frame_dump(formatter, &digit_count))
+    {
+        logger_structured_append_key(&record, "dir");
+        logger_structured_append_string(&record, (formatter[0] == '>') ? "tx" : "rx", 2U);
+        logger_structured_append_key(&record, "len");
+        logger_structured_append_u64(&record, digit_count / 2U);
+        logger_structured_append_key(&record, "data");
+        bool quoted = false;
+        if (record.format == LOGGER_STRUCTURED_FORMAT_JSON)
+        {
+            logger_structured_append(&record, "\"", 1U);
+            quoted = !record.truncated;
+        }
+
+        // Copy hex digits without delimiters
+        const char *run = formatter + 3;
+        while (*run != '\0')
+        {
+            size_t run_len = strcspn(run, " ");
+            logger_structured_append(&record, run, run_len);
+            run += run_len;
+            run += strspn(run, " ");
+        }
+        if (quoted)
+        {
+            logger_structured_append_trailer(&record, "\"", 1U);
+        }
+    }
+    else
+    {
+        logger_structured_append_key(&record, "msg");
+        logger_structured_append_string(&record, formatter, strlen(formatter));
+    }
+
+    // Trailer space is reserved so closing the record always succeeds
+    if (record.truncated)
+    {
+        if (record.format == LOGGER_STRUCTURED_FORMAT_JSON)
+        {
+            logger_structured_append_trailer(&record, ",\"truncated\":true", 17U);
+        }
+        else
+        {
+            logger_structured_append_trailer(&record, " truncated=true", 15U);
+        }
+    }
+    if (record.format == LOGGER_STRUCTURED_FORMAT_JSON)
+    {
+        logger_structured_append_trailer(&record, "}", 1U);
+    }
+    logger_structured_append_trailer(&record, "\n", 1U);
+
+    // Single write keeps records from different threads apart
+    size_t written = 0U;
+    while (written < record.length)
+    {
+        ssize_t result = write(state->fd, record.data + written, record.length - written);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return IFX_ERROR(LIB_LOGGER, IFX_LOGGER_LOG, IFX_UNSPECIFIED_ERROR);
+        }
+        written += (size_t) result;
+    }
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief \ref ifx_logger_destroy_callback_t for structured logger.
+ *
+ * \see ifx_logger_destroy_callback_t
+ */
+void logger_structured_destroy(ifx_logger_t *self)
+{
+    if (self != NULL)
+    {
+        free(self->_data);
+        self->_data = NULL;
+    }
+}
@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file logger-structured.h
+ * \brief Internal definitions for structured logger API implementation for NBT framework.
+ */
+#ifndef LOGGER_STRUCTURED_H
+#define LOGGER_STRUCTURED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-logger.h"
+#include "infineon/logger-structured.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Number of bytes kept free in record buffer for closing the record.
+ */
+#define LOGGER_STRUCTURED_RECORD_TRAILER_LEN 32U
+
+/**
+ * \brief \ref ifx_logger_log_callback_t for structured logger.
+ *
+ * \see ifx_logger_log_callback_t
+ */
+ifx_status_t logger_structured_log(const ifx_logger_t *self, const char *source, ifx_log_level level, const char *formatter);
+
+/**
+ * \brief \ref ifx_logger_destroy_callback_t for structured logger.
+ *
+ * \see ifx_logger_destroy_callback_t
+ */
+void logger_structured_destroy(ifx_logger_t *self);
+
+/** \struct LoggerStructuredState
+ * \brief State of structured logger stored in ifx_logger_t._data.
+ */
+typedef struct
+{
+    /**
+     * \brief File descriptor records are written to.
+     */
+    int fd;
+
+    /**
+     * \brief Output format of the records.
+     */
+    logger_structured_format_t format;
+} LoggerStructuredState;
+
+/** \struct LoggerStructuredRecord
+ * \brief Fixed size buffer a single record is formatted into.
+ */
+typedef struct
+{
+    /**
+     * \brief Output format of the record.
+     */
+    logger_structured_format_t format;
+
+    /**
+     * \brief Number of bytes already written to \ref LoggerStructuredRecord.data.
+     */
+    size_t length;
+
+    /**
+     * \brief Number of fields already written.
+     */
+    size_t fields;
+
+    /**
+     * \brief \c true if any field had to be cut.
+     */
+    bool truncated;
+
+    /**
+     * \brief Formatted record.
+     */
+    char data[LOGGER_STRUCTURED_MAX_RECORD_LEN];
+} LoggerStructuredRecord;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOGGER_STRUCTURED_H
@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/metrics-prometheus.h
+ * \brief Exporter serving NBT port statistics in Prometheus text exposition format.
+ */
+#ifndef INFINEON_METRICS_PROMETHEUS_H
+#define INFINEON_METRICS_PROMETHEUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-logger.h"
+#include "infineon/ifx-protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief IFX status code module identifier.
+ */
+#define LIBMETRICSPROMETHEUS 0x37U
+
+/**
+ * \brief IFX status encoding function identifier for metrics_prometheus_start().
+ */
+#define IFX_METRICS_PROMETHEUS_START (0x01U)
+
+/**
+ * \brief IFX status encoding function identifier for metrics_prometheus_render().
+ */
+#define IFX_METRICS_PROMETHEUS_RENDER (0x02U)
+
+/**
+ * \brief TCP port used if neither port nor unix socket path are configured.
+ */
+#define METRICS_PROMETHEUS_DEFAULT_PORT 9465U
+
+/** \struct metrics_prometheus_config_t
+ * \brief Sources and endpoint of Prometheus exporter.
+ */
+typedef struct
+{
+    /**
+     * \brief Protocol stack containing a Raspberry PI I2C layer (\c NULL to omit I2C metrics).
+     *
+     * \details Must stay valid until the exporter has been stopped.
+     */
+    ifx_protocol_t *protocol;
+
+    /**
+     * \brief Rate limiting logger whose drop counts are exported (\c NULL to omit).
+     *
+     * \details Must stay valid until the exporter has been stopped.
+     */
+    const ifx_logger_t *ratelimit_logger;
+
+    /**
+     * \brief Path of unix socket to listen on (\c NULL to listen on TCP instead).
+     */
+    const char *socket_path;
+
+    /**
+     * \brief TCP port to listen on at \c 127.0.0.1 (\c 0 for \ref METRICS_PROMETHEUS_DEFAULT_PORT).
+     */
+    uint16_t port;
+} metrics_prometheus_config_t;
+
+/** \struct metrics_prometheus_t
+ * \brief Running Prometheus exporter.
+ */
+typedef struct
+{
+    /**
+     * \brief Private exporter state.
+     */
+    void *_data;
+} metrics_prometheus_t;
+
+/**
+ * \brief Starts exporter serving metrics via HTTP from a low priority background thread.
+ *
+ * \details Every request on the socket is answered with the current metrics
+ * regardless of its method or path. Metrics are read with relaxed atomic loads
+ * only, so scrapes never block the I/O path.
+ *
+ * \param[out] self Exporter object to be started.
+ * \param[in] config Sources and endpoint (copied, the pointers inside must stay valid).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t metrics_prometheus_start(metrics_prometheus_t *self, const metrics_prometheus_config_t *config);
+
+/**
+ * \brief Renders current metrics in Prometheus text exposition format.
+ *
+ * \details Can be used to embed the metrics in an existing HTTP server or
+ * file based collector instead of running the exporter thread.
+ *
+ * \param[in] config Sources of metrics (endpoint members are ignored).
+ * \param[out] text_buffer Buffer to store allocated text in (to be freed by caller).
+ * \param[out] text_len_buffer Buffer to store text length in [bytes] in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t metrics_prometheus_render(const metrics_prometheus_config_t *config, char **text_buffer, size_t *text_len_buffer);
+
+/**
+ * \brief Stops exporter thread and closes its socket.
+ *
+ * \param[in] self Exporter object to be stopped.
+ */
+void metrics_prometheus_stop(metrics_prometheus_t *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_METRICS_PROMETHEUS_H
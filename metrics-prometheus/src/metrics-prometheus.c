@@ -0,0 +1,554 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file metrics-prometheus.c
+ * \brief Exporter serving NBT port statistics in Prometheus text exposition format.
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-logger.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/i2c-rpi.h"
+#include "infineon/i2c-rpi-stats.h"
+#include "infineon/logger-ratelimit.h"
+#include "infineon/timer-rpi.h"
+#include "infineon/metrics-prometheus.h"
+#include "metrics-prometheus.h"
+
+/**
+ * \brief Label values of I2C latency histograms indexed by \ref i2c_rpi_latency_t.
+ */
+static const char *const metrics_prometheus_latency_names[I2C_RPI_LATENCY_COUNT] = {"write", "read", "guard_time", "set_address", "guard_time_slack"};
+
+/**
+ * \brief Appends formatted text to metrics text buffer.
+ *
+ * \param[in] text Text buffer to append to.
+ * \param[in] format printf() style format string.
+ */
+void metrics_prometheus_append(MetricsPrometheusText *text, const char *format, ...)
+{
+    if (text->failed)
+    {
+        return;
+    }
+
+    for (;;)
+    {
+        size_t available = text->capacity - text->len;
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(text->data + text->len, available, format, args);
+        va_end(args);
+        if (written < 0)
+        {
+            text->failed = true;
+            return;
+        }
+        if ((size_t) written < available)
+        {
+            text->len += (size_t) written;
+            return;
+        }
+
+        // Grow buffer and format again
+        size_t capacity = text->capacity * 2U;
+        while ((capacity - text->len) <= (size_t) written)
+        {
+            capacity *= 2U;
+        }
+        char *data = realloc(text->data, capacity);
+        if (data == NULL)
+        {
+            text->failed = true;
+            return;
+        }
+        text->data = data;
+        text->capacity = capacity;
+    }
+}
+
+/**
+ * \brief Appends single sample with \c HELP and \c TYPE header.
+ *
+ * \param[in] text Text buffer to append to.
+ * \param[in] name Metric name.
+ * \param[in] type Metric type (\c counter or \c gauge).
+ * \param[in] help Help text.
+ * \param[in] value Sample value.
+ */
+static void metrics_prometheus_append_sample(MetricsPrometheusText *text, const char *name, const char *type, const char *help, double value)
+{
+    metrics_prometheus_append(text, "# HELP %s %s\n# TYPE %s %s\n%s %.17g\n", name, help, name, type, name, value);
+}
+
+/**
+ * \brief Appends I2C driver layer counters, guard time and latency histograms.
+ *
+ * \details Histogram buckets are exported at every power of two [ns], so the
+ * set of \c le labels is the same for every scrape. Values are integral [ns],
+ * a bucket therefore counts values below its bound rather than up to it.
+ *
+ * \param[in] text Text buffer to append to.
+ * \param[in] protocol Protocol stack containing a Raspberry PI I2C layer.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+static ifx_status_t metrics_prometheus_append_i2c(MetricsPrometheusText *text, ifx_protocol_t *protocol)
+{
+    i2c_rpi_counters_t counters;
+    ifx_status_t status = i2c_rpi_get_counters(protocol, &counters);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    metrics_prometheus_append_sample(text, "nbt_i2c_frames_sent_total", "counter", "I2C frames written completely.", (double) counters.frames_sent);
+    metrics_prometheus_append_sample(text, "nbt_i2c_sent_bytes_total", "counter", "Bytes written via I2C.", (double) counters.bytes_sent);
+    metrics_prometheus_append_sample(text, "nbt_i2c_frames_received_total", "counter", "I2C frames read.", (double) counters.frames_received);
+    metrics_prometheus_append_sample(text, "nbt_i2c_received_bytes_total", "counter", "Bytes read via I2C.", (double) counters.bytes_received);
+    metrics_prometheus_append_sample(text, "nbt_i2c_nacks_total", "counter", "I2C transfers not acknowledged by the tag.", (double) counters.nacks);
+    metrics_prometheus_append_sample(text, "nbt_i2c_short_reads_total", "counter", "I2C reads returning less data than requested.", (double) counters.short_reads);
+    metrics_prometheus_append_sample(text, "nbt_i2c_short_writes_total", "counter", "I2C writes accepting less data than requested.", (double) counters.short_writes);
+    metrics_prometheus_append_sample(text, "nbt_i2c_io_errors_total", "counter", "I2C transfers failing for other reasons than a missing acknowledge.", (double) counters.io_errors);
+    metrics_prometheus_append_sample(text, "nbt_i2c_ioctl_failures_total", "counter", "Failed I2C slave address ioctl() calls.", (double) counters.ioctl_failures);
+    metrics_prometheus_append_sample(text, "nbt_i2c_guard_time_waits_total", "counter", "I2C accesses blocking on a pending guard time.", (double) counters.guard_time_waits);
+    metrics_prometheus_append_sample(text, "nbt_i2c_guard_time_elapsed_total", "counter", "I2C accesses whose guard time had already elapsed.", (double) counters.guard_time_elapsed);
+
+    i2c_rpi_guard_time_report_t report;
+    status = i2c_rpi_get_guard_time_report(protocol, &report);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    metrics_prometheus_append_sample(text, "nbt_i2c_guard_time_seconds", "gauge", "Configured I2C guard time.", (double) report.guard_time_us / 1e6);
+    metrics_prometheus_append_sample(text, "nbt_i2c_guard_time_recommended_seconds", "gauge", "Smallest I2C guard time observed to work.", (double) report.recommended_guard_time_us / 1e6);
+
+    // Histograms are large, so a single snapshot buffer is reused for all operations
+    i2c_rpi_histogram_t *histogram = malloc(sizeof(i2c_rpi_histogram_t));
+    if (histogram == NULL)
+    {
+        return IFX_ERROR(LIBMETRICSPROMETHEUS, IFX_METRICS_PROMETHEUS_RENDER, IFX_OUT_OF_MEMORY);
+    }
+    metrics_prometheus_append(text, "# HELP nbt_i2c_latency_seconds Latency of I2C driver layer operations.\n# TYPE nbt_i2c_latency_seconds histogram\n");
+    for (int operation = I2C_RPI_LATENCY_WRITE; operation < I2C_RPI_LATENCY_COUNT; operation++)
+    {
+        status = i2c_rpi_get_latency_histogram(protocol, (i2c_rpi_latency_t) operation, histogram);
+        if (ifx_error_check(status))
+        {
+            break;
+        }
+
+        // Counts are summed up from the buckets to stay consistent with +Inf bucket in case of concurrent updates
+        const char *name = metrics_prometheus_latency_names[operation];
+        uint64_t cumulative = 0U;
+        for (uint32_t bucket = 0U; bucket < I2C_RPI_HISTOGRAM_BUCKET_COUNT; bucket++)
+        {
+            if ((bucket >= (2U * I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT)) && ((bucket % I2C_RPI_HISTOGRAM_SUB_BUCKET_COUNT) == 0U))
+            {
+                metrics_prometheus_append(text, "nbt_i2c_latency_seconds_bucket{op=\"%s\",le=\"%.13g\"} %llu\n", name, (double) i2c_rpi_histogram_get_bucket_lower_bound(bucket) / 1e9, (unsigned long long) cumulative);
+            }
+            cumulative += histogram->buckets[bucket];
+        }
+        metrics_prometheus_append(text, "nbt_i2c_latency_seconds_bucket{op=\"%s\",le=\"+Inf\"} %llu\n", name, (unsigned long long) cumulative);
+        metrics_prometheus_append(text, "nbt_i2c_latency_seconds_sum{op=\"%s\"} %.9f\n", name, (double) histogram->sum_ns / 1e9);
+        metrics_prometheus_append(text, "nbt_i2c_latency_seconds_count{op=\"%s\"} %llu\n", name, (unsigned long long) cumulative);
+    }
+    free(histogram);
+    return status;
+}
+
+/**
+ * \brief Renders current metrics in Prometheus text exposition format.
+ *
+ * \param[in] config Sources of metrics (endpoint members are ignored).
+ * \param[out] text_buffer Buffer to store allocated text in (to be freed by caller).
+ * \param[out] text_len_buffer Buffer to store text length in [bytes] in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t metrics_prometheus_render(const metrics_prometheus_config_t *config, char **text_buffer, size_t *text_len_buffer)
+{
+    // Validate parameters
+    if ((config == NULL) || (text_buffer == NULL) || (text_len_buffer == NULL))
+    {
+        return IFX_ERROR(LIBMETRICSPROMETHEUS, IFX_METRICS_PROMETHEUS_RENDER, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    MetricsPrometheusText text;
+    text.len = 0U;
+    text.capacity = METRICS_PROMETHEUS_INITIAL_TEXT_LEN;
+    text.failed = false;
+    text.data = malloc(text.capacity);
+    if (text.data == NULL)
+    {
+        return IFX_ERROR(LIBMETRICSPROMETHEUS, IFX_METRICS_PROMETHEUS_RENDER, IFX_OUT_OF_MEMORY);
+    }
+    text.data[0] = '\0';
+
+    // I2C driver layer
+    ifx_status_t status = IFX_SUCCESS;
+    if (config->protocol != NULL)
+    {
+        status = metrics_prometheus_append_i2c(&text, config->protocol);
+    }
+
+    // Timers
+    timer_rpi_statistics_t timer_statistics;
+    if (!ifx_error_check(status))
+    {
+        status = timer_rpi_get_statistics(&timer_statistics);
+    }
+    if (!ifx_error_check(status))
+    {
+        metrics_prometheus_append_sample(&text, "nbt_timer_sets_total", "counter", "Timers started.", (double) timer_statistics.sets);
+        metrics_prometheus_append_sample(&text, "nbt_timer_set_failures_total", "counter", "Timers that could not be started.", (double) timer_statistics.set_failures);
+        metrics_prometheus_append_sample(&text, "nbt_timer_joins_total", "counter", "Joins of started timers.", (double) timer_statistics.joins);
+        metrics_prometheus_append_sample(&text, "nbt_timer_joins_elapsed_total", "counter", "Joins of timers that had already elapsed.", (double) timer_statistics.joins_elapsed);
+        metrics_prometheus_append_sample(&text, "nbt_timer_join_wait_seconds_total", "counter", "Time spent waiting for timers.", (double) timer_statistics.join_wait_ns / 1e9);
+    }
+
+    // Logger drop counts
+    if (!ifx_error_check(status) && (config->ratelimit_logger != NULL))
+    {
+        logger_ratelimit_statistics_t logger_statistics;
+        status = logger_ratelimit_get_statistics(config->ratelimit_logger, &logger_statistics);
+        if (!ifx_error_check(status))
+        {
+            metrics_prometheus_append_sample(&text, "nbt_logger_suppressed_total", "counter", "Log records dropped by rate limiting.", (double) logger_statistics.suppressed);
+            metrics_prometheus_append_sample(&text, "nbt_logger_sampled_out_total", "counter", "I2C frame dumps dropped by sampling.", (double) logger_statistics.sampled_out);
+        }
+    }
+
+    if (!ifx_error_check(status) && text.failed)
+    {
+        status = IFX_ERROR(LIBMETRICSPROMETHEUS, IFX_METRICS_PROMETHEUS_RENDER, IFX_OUT_OF_MEMORY);
+    }
+    if (ifx_error_check(status))
+    {
+        free(text.data);
+        return status;
+    }
+    *text_buffer = text.data;
+    *text_len_buffer = text.len;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Sends complete buffer to client.
+ *
+ * \param[in] fd Client socket.
+ * \param[in] data Data to be sent.
+ * \param[in] data_len Number of bytes in \p data.
+ * \return bool \c true if all data has been sent.
+ */
+static bool metrics_prometheus_send_all(int fd, const char *data, size_t data_len)
+{
+    while (data_len > 0U)
+    {
+        ssize_t sent = send(fd, data, data_len, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data += sent;
+        data_len -= (size_t) sent;
+    }
+    return true;
+}
+
+/**
+ * \brief Reads HTTP request of a client and answers it with the current metrics.
+ *
+ * \details The request itself is not interpreted, reading stops at the end of
+ * the header, after \ref METRICS_PROMETHEUS_MAX_REQUEST_LEN bytes or after
+ * \ref METRICS_PROMETHEUS_REQUEST_TIMEOUT_MS.
+ *
+ * \param[in] state Exporter state.
+ * \param[in] fd Client socket.
+ */
+static void metrics_prometheus_answer(MetricsPrometheusState *state, int fd)
+{
+    char request[METRICS_PROMETHEUS_MAX_REQUEST_LEN + 1U];
+    size_t request_len = 0U;
+    while (request_len < METRICS_PROMETHEUS_MAX_REQUEST_LEN)
+    {
+        struct pollfd client = {fd, POLLIN, 0};
+        if (poll(&client, 1, METRICS_PROMETHEUS_REQUEST_TIMEOUT_MS) <= 0)
+        {
+            break;
+        }
+        ssize_t received = recv(fd, request + request_len, METRICS_PROMETHEUS_MAX_REQUEST_LEN - request_len, 0);
+        if (received <= 0)
+        {
+            break;
+        }
+        request_len += (size_t) received;
+        request[request_len] = '\0';
+        if (strstr(request, "\r\n\r\n") != NULL)
+        {
+            break;
+        }
+    }
+
+    char *body = NULL;
+    size_t body_len = 0U;
+    char header[160];
+    if (ifx_error_check(metrics_prometheus_render(&state->config, &body, &body_len)))
+    {
+        int header_len = snprintf(header, sizeof(header), "HTTP/1.0 500 Internal Server Error\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        metrics_prometheus_send_all(fd, header, (size_t) header_len);
+        return;
+    }
+    int header_len = snprintf(header, sizeof(header), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n", body_len);
+    if (metrics_prometheus_send_all(fd, header, (size_t) header_len))
+    {
+        metrics_prometheus_send_all(fd, body, body_len);
+    }
+    free(body);
+}
+
+/**
+ * \brief Exporter thread answering scrapes until stopped.
+ *
+ * \param[in] arg \ref MetricsPrometheusState of exporter.
+ * \return void* Always \c NULL.
+ */
+void *metrics_prometheus_serve(void *arg)
+{
+    MetricsPrometheusState *state = (MetricsPrometheusState *) arg;
+
+    // Scrapes must never compete with I/O threads for the CPU
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0)
+    {
+        // On Linux this only affects the calling thread
+        setpriority(PRIO_PROCESS, 0, 19);
+    }
+
+    for (;;)
+    {
+        struct pollfd fds[2] = {{state->listen_fd, POLLIN, 0}, {state->wakeup_fds[0], POLLIN, 0}};
+        if (poll(fds, 2U, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents != 0)
+        {
+            break;
+        }
+        if ((fds[0].revents & POLLIN) != 0)
+        {
+            int client = accept4(state->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+            if (client >= 0)
+            {
+                metrics_prometheus_answer(state, client);
+                close(client);
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * \brief Opens listening socket for configured endpoint.
+ *
+ * \param[in] state Exporter state with configuration.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+static ifx_status_t metrics_prometheus_listen(MetricsPrometheusState *state)
+{
+    if (state->config.socket_path != NULL)
+    {
+        struct sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        size_t path_len = strlen(state->config.socket_path);
+        if ((path_len == 0U) || (path_len >= sizeof(address.sun_path)))
+        {
+            return IFX_ERROR(LIBMETRICSPROMETHEUS, IFX_METRICS_PROMETHEUS_START, IFX_ILLEGAL_ARGUMENT);
+        }
+        memcpy(address.sun_path, state->config.socket_path, path_len);
+
+        // Remove stale socket of a previous run, but never any other file
+        struct stat file_stat;
+        if ((stat(state->config.socket_path, &file_stat) == 0) && S_ISSOCK(file_stat.st_mode))
+        {
+            unlink(state->config.socket_path);
+        }
+
+        state->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (state->listen_fd < 0)
+        {
+            return IFX_ERROR(LIBMETRICSPROMETHEUS, IFX_METRICS_PROMETHEUS_START, IFX_UNSPECIFIED_ERROR);
+        }
+        if (bind(state->listen_fd, (const struct sockaddr *) &address, sizeof(address)) != 0)
+        {
+            return IFX_ERROR(LIBMETRICSPROMETHEUS, IFX_METRICS_PROMETHEUS_START, IFX_UNSPECIFIED_ERROR);
+        }
+        state->socket_path = strdup(state->config.socket_path);
+        if (state->socket_path == NULL)
+        {
+            unlink(state->config.socket_path);
+            return IFX_ERROR(LIBMETRICSPROMETHEUS, IFX_METRICS_PROMETHEUS_START, IFX_OUT_OF_MEMORY);
+        }
+    }
+    else
+    {
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons((state->config.port != 0U) ? state->config.port : METRICS_PROMETHEUS_DEFAULT_PORT);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        state->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (state->listen_fd < 0)
+        {
+            return IFX_ERROR(LIBMETRICSPROMETHEUS, IFX_METRICS_PROMETHEUS_START, IFX_UNSPECIFIED_ERROR);
+        }
+        int reuse = 1;
+        setsockopt(state->listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (bind(state->listen_fd, (const struct sockaddr *) &address, sizeof(address)) != 0)
+        {
+            return IFX_ERROR(LIBMETRICSPROMETHEUS, IFX_METRICS_PROMETHEUS_START, IFX_UNSPECIFIED_ERROR);
+        }
+    }
+
+    if (listen(state->listen_fd, METRICS_PROMETHEUS_BACKLOG) != 0)
+    {
+        return IFX_ERROR(LIBMETRICSPROMETHEUS, IFX_METRICS_PROMETHEUS_START, IFX_UNSPECIFIED_ERROR);
+    }
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Closes sockets and frees exporter state.
+ *
+ * \param[in] state Exporter state to be freed.
+ */
+static void metrics_prometheus_free(MetricsPrometheusState *state)
+{
+    if (state->listen_fd >= 0)
+    {
+        close(state->listen_fd);
+    }
+    if (state->socket_path != NULL)
+    {
+        unlink(state->socket_path);
+        free(state->socket_path);
+    }
+    if (state->wakeup_fds[0] >= 0)
+    {
+        close(state->wakeup_fds[0]);
+        close(state->wakeup_fds[1]);
+    }
+    free(state);
+}
+
+/**
+ * \brief Starts exporter serving metrics via HTTP from a low priority background thread.
+ *
+ * \param[out] self Exporter object to be started.
+ * \param[in] config Sources and endpoint (copied, the pointers inside must stay valid).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t metrics_prometheus_start(metrics_prometheus_t *self, const metrics_prometheus_config_t *config)
+{
+    // Validate parameters
+    if ((self == NULL) || (config == NULL))
+    {
+        return IFX_ERROR(LIBMETRICSPROMETHEUS, IFX_METRICS_PROMETHEUS_START, IFX_ILLEGAL_ARGUMENT);
+    }
+    self->_data = NULL;
+
+    MetricsPrometheusState *state = malloc(sizeof(MetricsPrometheusState));
+    if (state == NULL)
+    {
+        return IFX_ERROR(LIBMETRICSPROMETHEUS, IFX_METRICS_PROMETHEUS_START, IFX_OUT_OF_MEMORY);
+    }
+    state->config = *config;
+    state->socket_path = NULL;
+    state->listen_fd = -1;
+    state->wakeup_fds[0] = -1;
+    state->wakeup_fds[1] = -1;
+
+    ifx_status_t status = metrics_prometheus_listen(state);
+    if (ifx_error_check(status))
+    {
+        metrics_prometheus_free(state);
+        return status;
+    }
+    if (pipe2(state->wakeup_fds, O_CLOEXEC) != 0)
+    {
+        state->wakeup_fds[0] = -1;
+        metrics_prometheus_free(state);
+        return IFX_ERROR(LIBMETRICSPROMETHEUS, IFX_METRICS_PROMETHEUS_START, IFX_UNSPECIFIED_ERROR);
+    }
+
+    // Exporter thread must not receive signals (e.g. of timers) meant for I/O threads
+    sigset_t all_signals;
+    sigset_t previous_signals;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_SETMASK, &all_signals, &previous_signals);
+    int result = pthread_create(&state->thread, NULL, metrics_prometheus_serve, state);
+    pthread_sigmask(SIG_SETMASK, &previous_signals, NULL);
+    if (result != 0)
+    {
+        metrics_prometheus_free(state);
+        return IFX_ERROR(LIBMETRICSPROMETHEUS, IFX_METRICS_PROMETHEUS_START, IFX_UNSPECIFIED_ERROR);
+    }
+
+    self->_data = state;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Stops exporter thread and closes its socket.
+ *
+ * \param[in] self Exporter object to be stopped.
+ */
+void metrics_prometheus_stop(metrics_prometheus_t *self)
+{
+    if ((self == NULL) || (self->_data == NULL))
+    {
+        return;
+    }
+    MetricsPrometheusState *state = (MetricsPrometheusState *) self->_data;
+
+    // Wake up exporter thread, a scrape in progress is finished first
+    const uint8_t wakeup = 1U;
+    while ((write(state->wakeup_fds[1], &wakeup, sizeof(wakeup)) < 0) && (errno == EINTR))
+    {
+    }
+    pthread_join(state->thread, NULL);
+    metrics_prometheus_free(state);
+    self->_data = NULL;
+}
@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file metrics-prometheus.h
+ * \brief Internal definitions for Prometheus exporter.
+ */
+#ifndef METRICS_PROMETHEUS_H
+#define METRICS_PROMETHEUS_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "infineon/metrics-prometheus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Initial capacity of rendered metrics text in [bytes].
+ */
+#define METRICS_PROMETHEUS_INITIAL_TEXT_LEN 8192U
+
+/**
+ * \brief Maximum number of request bytes read before answering.
+ */
+#define METRICS_PROMETHEUS_MAX_REQUEST_LEN 4096U
+
+/**
+ * \brief Time in [ms] after which a client that does not finish its request is answered anyway.
+ */
+#define METRICS_PROMETHEUS_REQUEST_TIMEOUT_MS 1000
+
+/**
+ * \brief Backlog of listening socket.
+ */
+#define METRICS_PROMETHEUS_BACKLOG 4
+
+/** \struct MetricsPrometheusText
+ * \brief Growing text buffer metrics are rendered into.
+ */
+typedef struct
+{
+    /**
+     * \brief Text (always NUL terminated if not \c NULL).
+     */
+    char *data;
+
+    /**
+     * \brief Length of text in [bytes].
+     */
+    size_t len;
+
+    /**
+     * \brief Allocated size of \ref MetricsPrometheusText.data in [bytes].
+     */
+    size_t capacity;
+
+    /**
+     * \brief \c true if an allocation failed.
+     */
+    bool failed;
+} MetricsPrometheusText;
+
+/** \struct MetricsPrometheusState
+ * \brief Private state of running exporter.
+ */
+typedef struct
+{
+    /**
+     * \brief Sources of metrics.
+     */
+    metrics_prometheus_config_t config;
+
+    /**
+     * \brief Copy of unix socket path to be unlinked on stop (\c NULL for TCP).
+     */
+    char *socket_path;
+
+    /**
+     * \brief Listening socket.
+     */
+    int listen_fd;
+
+    /**
+     * \brief Pipe used to wake up exporter thread on stop ([0] read end, [1] write end).
+     */
+    int wakeup_fds[2];
+
+    /**
+     * \brief Exporter thread.
+     */
+    pthread_t thread;
+} MetricsPrometheusState;
+
+/**
+ * \brief Appends formatted text to metrics text buffer.
+ *
+ * \param[in] text Text buffer to append to.
+ * \param[in] format printf() style format string.
+ */
+void metrics_prometheus_append(MetricsPrometheusText *text, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * \brief Exporter thread answering scrapes until stopped.
+ *
+ * \param[in] arg \ref MetricsPrometheusState of exporter.
+ * \return void* Always \c NULL.
+ */
+void *metrics_prometheus_serve(void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // METRICS_PROMETHEUS_H
@@ -0,0 +1,484 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-bench.c
+ * \brief Command line tool benchmarking APDU round trips over a full GP T=1' stack.
+ *
+ * \details Usage: nbt-bench [-d device | -s] [-a address] [-w workload] [-n bytes] [-i iterations] [-W warmup] [-f fid] [-p us]
+ *
+ * The selected workload is executed repeatedly via ifx_protocol_transceive()
+ * and the results are printed as a single JSON object to \c stdout.
+ */
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/ifx-t1prime.h"
+#include "infineon/i2c-rpi.h"
+#include "infineon/i2c-rpi-stats.h"
+#include "infineon/i2c-rpi-capture.h"
+#include "infineon/nbt-sim.h"
+#include "infineon/trace-rpi.h"
+
+/**
+ * \brief Default I2C slave address of the NBT.
+ */
+#define NBT_BENCH_DEFAULT_ADDRESS 0x18U
+
+/**
+ * \brief Default I2C character device.
+ */
+#define NBT_BENCH_DEFAULT_DEVICE "/dev/i2c-1"
+
+/**
+ * \brief Default file used by READ BINARY and UPDATE BINARY workloads.
+ */
+#define NBT_BENCH_DEFAULT_FID 0xe1a1U
+
+/**
+ * \brief Maximum number of data bytes per READ BINARY / UPDATE BINARY.
+ */
+#define NBT_BENCH_MAX_BYTES 4096U
+
+/**
+ * \brief Maximum length of command APDUs in [bytes].
+ */
+#define NBT_BENCH_MAX_APDU_LEN (NBT_BENCH_MAX_BYTES + 9U)
+
+/**
+ * \brief Trace events recorded per measured APDU (enough for a fully chained 4 KiB transfer).
+ */
+#define NBT_BENCH_TRACE_EVENTS_PER_APDU 256U
+
+/**
+ * \brief Upper limit of recorded trace events.
+ */
+#define NBT_BENCH_MAX_TRACE_EVENTS 1048576U
+
+/**
+ * \brief SELECT command for the NFC Forum Type 4 Tag application.
+ */
+static const uint8_t select_application[] = {0x00U, 0xa4U, 0x04U, 0x00U, 0x07U, 0xd2U, 0x76U, 0x00U, 0x00U, 0x85U, 0x01U, 0x01U, 0x00U};
+
+/**
+ * \brief Benchmark workloads.
+ */
+typedef enum
+{
+    /**
+     * \brief SELECT of the Type 4 Tag application.
+     */
+    NBT_BENCH_WORKLOAD_SELECT,
+
+    /**
+     * \brief READ BINARY of N bytes.
+     */
+    NBT_BENCH_WORKLOAD_READ,
+
+    /**
+     * \brief UPDATE BINARY of N bytes.
+     */
+    NBT_BENCH_WORKLOAD_UPDATE
+} NbtBenchWorkload;
+
+/**
+ * \brief Workload names indexed by NbtBenchWorkload.
+ */
+static const char *const workload_names[] = {"select", "read", "update"};
+
+/**
+ * \brief Prints usage information.
+ *
+ * \param[in] program Name of the executable.
+ */
+static void nbt_bench_usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [-d device | -s | -r capture [-R]] [-c capture] [-a address] [-w workload] [-n bytes] [-i iterations] [-W warmup] [-f fid] [-p us] [-t trace]\n"
+            "  -d device      I2C character device (default %s)\n"
+            "  -s             use simulated tag instead of I2C device\n"
+            "  -r capture     replay I2C capture file instead of using I2C device\n"
+            "  -R             replay with original timing instead of as fast as possible\n"
+            "  -c capture     append all I2C frames to capture file\n"
+            "  -p us          processing time per block of simulated tag (default 0)\n"
+            "  -a address     I2C slave address (default 0x%02x)\n"
+            "  -w workload    select, read or update (default select)\n"
+            "  -n bytes       data bytes per read / update (1 to %u, default 32)\n"
+            "  -i iterations  measured APDUs (default 1000)\n"
+            "  -W warmup      APDUs before measurement (default 10)\n"
+            "  -f fid         file used by read / update (default 0x%04x)\n"
+            "  -t trace       write Chrome trace-event JSON of measured APDUs to file\n",
+            program, NBT_BENCH_DEFAULT_DEVICE, NBT_BENCH_DEFAULT_ADDRESS, NBT_BENCH_MAX_BYTES, NBT_BENCH_DEFAULT_FID);
+}
+
+/**
+ * \brief Returns current \c CLOCK_MONOTONIC time in [ns].
+ *
+ * \return uint64_t Current monotonic time in [ns].
+ */
+static uint64_t nbt_bench_get_monotonic_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * \brief Parses unsigned number given on command line (decimal or \c 0x prefixed).
+ *
+ * \param[in] text Text to be parsed.
+ * \param[in] max Maximum accepted value.
+ * \param[out] value Buffer to store value in.
+ * \return bool \c true if successful.
+ */
+static bool nbt_bench_parse_number(const char *text, unsigned long max, unsigned long *value)
+{
+    char *end = NULL;
+    unsigned long parsed = strtoul(text, &end, 0);
+    if ((end == text) || (*end != '\0') || (parsed > max))
+    {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+/**
+ * \brief Builds command APDU of workload.
+ *
+ * \param[in] workload Workload to build APDU for.
+ * \param[in] bytes Number of data bytes to read / update.
+ * \param[out] apdu Buffer of at least \ref NBT_BENCH_MAX_APDU_LEN bytes.
+ * \return size_t Length of APDU.
+ */
+static size_t nbt_bench_build_apdu(NbtBenchWorkload workload, size_t bytes, uint8_t *apdu)
+{
+    if (workload == NBT_BENCH_WORKLOAD_SELECT)
+    {
+        memcpy(apdu, select_application, sizeof(select_application));
+        return sizeof(select_application);
+    }
+
+    apdu[0] = 0x00U;
+    apdu[1] = (workload == NBT_BENCH_WORKLOAD_READ) ? 0xb0U : 0xd6U;
+    apdu[2] = 0x00U;
+    apdu[3] = 0x00U;
+    if (workload == NBT_BENCH_WORKLOAD_READ)
+    {
+        if (bytes <= 256U)
+        {
+            apdu[4] = (uint8_t) bytes;
+            return 5U;
+        }
+        apdu[4] = 0x00U;
+        apdu[5] = (uint8_t) (bytes >> 8);
+        apdu[6] = (uint8_t) bytes;
+        return 7U;
+    }
+
+    // UPDATE BINARY with incrementing pattern
+    size_t header_len = 5U;
+    if (bytes <= 255U)
+    {
+        apdu[4] = (uint8_t) bytes;
+    }
+    else
+    {
+        apdu[4] = 0x00U;
+        apdu[5] = (uint8_t) (bytes >> 8);
+        apdu[6] = (uint8_t) bytes;
+        header_len = 7U;
+    }
+    for (size_t i = 0U; i < bytes; i++)
+    {
+        apdu[header_len + i] = (uint8_t) i;
+    }
+    return header_len + bytes;
+}
+
+/**
+ * \brief Exchanges single APDU and checks for successful status word.
+ *
+ * \param[in] protocol Protocol stack to be used.
+ * \param[in] apdu Command APDU.
+ * \param[in] apdu_len Number of bytes in \p apdu.
+ * \param[in] expected_len Expected response length including status word.
+ * \return bool \c true if successful.
+ */
+static bool nbt_bench_exchange(ifx_protocol_t *protocol, const uint8_t *apdu, size_t apdu_len, size_t expected_len)
+{
+    uint8_t *response = NULL;
+    size_t response_len = 0U;
+    ifx_status_t status = ifx_protocol_transceive(protocol, apdu, apdu_len, &response, &response_len);
+    bool success = !ifx_error_check(status) && (response != NULL) && (response_len >= 2U) && (response[response_len - 2U] == 0x90U) &&
+                   (response[response_len - 1U] == 0x00U) && ((expected_len == 0U) || (response_len == expected_len));
+    if (response != NULL)
+    {
+        free(response);
+    }
+    return success;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *device = NBT_BENCH_DEFAULT_DEVICE;
+    bool simulated = false;
+    unsigned long processing_time_us = 0U;
+    unsigned long address = NBT_BENCH_DEFAULT_ADDRESS;
+    NbtBenchWorkload workload = NBT_BENCH_WORKLOAD_SELECT;
+    unsigned long bytes = 32U;
+    unsigned long iterations = 1000U;
+    unsigned long warmup = 10U;
+    unsigned long fid = NBT_BENCH_DEFAULT_FID;
+    const char *trace_path = NULL;
+    const char *capture_path = NULL;
+    const char *replay_path = NULL;
+    i2c_rpi_replay_timing_t replay_timing = I2C_RPI_REPLAY_AS_FAST_AS_POSSIBLE;
+
+    int option;
+    bool valid = true;
+    while (valid && ((option = getopt(argc, argv, "d:sr:Rc:p:a:w:n:i:W:f:t:h")) != -1))
+    {
+        switch (option)
+        {
+        case 'd':
+            device = optarg;
+            break;
+        case 's':
+            simulated = true;
+            break;
+        case 'r':
+            replay_path = optarg;
+            break;
+        case 'R':
+            replay_timing = I2C_RPI_REPLAY_ORIGINAL_TIMING;
+            break;
+        case 'c':
+            capture_path = optarg;
+            break;
+        case 'p':
+            valid = nbt_bench_parse_number(optarg, UINT32_MAX, &processing_time_us);
+            break;
+        case 'a':
+            valid = nbt_bench_parse_number(optarg, 0x7fU, &address) && (address != 0U);
+            break;
+        case 'w':
+            valid = false;
+            for (unsigned i = 0U; i < (sizeof(workload_names) / sizeof(workload_names[0])); i++)
+            {
+                if (strcmp(optarg, workload_names[i]) == 0)
+                {
+                    workload = (NbtBenchWorkload) i;
+                    valid = true;
+                }
+            }
+            break;
+        case 'n':
+            valid = nbt_bench_parse_number(optarg, NBT_BENCH_MAX_BYTES, &bytes) && (bytes != 0U);
+            break;
+        case 'i':
+            valid = nbt_bench_parse_number(optarg, UINT32_MAX, &iterations) && (iterations != 0U);
+            break;
+        case 'W':
+            valid = nbt_bench_parse_number(optarg, UINT32_MAX, &warmup);
+            break;
+        case 'f':
+            valid = nbt_bench_parse_number(optarg, 0xffffU, &fid) && (fid != 0U);
+            break;
+        case 't':
+            trace_path = optarg;
+            break;
+        default:
+            valid = false;
+            break;
+        }
+    }
+    if (!valid || (optind != argc) || (simulated && (replay_path != NULL)))
+    {
+        nbt_bench_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Simulated tag and replay still need a valid descriptor for the I2C layer
+    int fd = open((simulated || (replay_path != NULL)) ? "/dev/null" : device, O_RDWR);
+    if (fd < 0)
+    {
+        perror("open");
+        return EXIT_FAILURE;
+    }
+
+    // Build GP T=1' stack on top of Raspberry PI I2C layer
+    ifx_protocol_t driver_adapter;
+    ifx_protocol_t protocol;
+    ifx_status_t status = i2c_rpi_initialize(&driver_adapter, fd, (uint8_t) address);
+    if (ifx_error_check(status))
+    {
+        fprintf(stderr, "Could not initialize I2C driver adapter (0x%08x)\n", (unsigned) status);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    if (simulated)
+    {
+        i2c_rpi_backend_t backend;
+        status = nbt_sim_initialize(&backend, (uint32_t) processing_time_us);
+        if (!ifx_error_check(status))
+        {
+            status = i2c_rpi_set_backend(&driver_adapter, &backend);
+        }
+        if (ifx_error_check(status))
+        {
+            fprintf(stderr, "Could not initialize simulated tag (0x%08x)\n", (unsigned) status);
+            ifx_protocol_destroy(&driver_adapter);
+            close(fd);
+            return EXIT_FAILURE;
+        }
+    }
+    else if (replay_path != NULL)
+    {
+        i2c_rpi_backend_t backend;
+        status = i2c_rpi_replay_initialize(&backend, replay_path, replay_timing);
+        if (!ifx_error_check(status))
+        {
+            status = i2c_rpi_set_backend(&driver_adapter, &backend);
+        }
+        if (ifx_error_check(status))
+        {
+            fprintf(stderr, "Could not load capture %s (0x%08x)\n", replay_path, (unsigned) status);
+            ifx_protocol_destroy(&driver_adapter);
+            close(fd);
+            return EXIT_FAILURE;
+        }
+    }
+    if (capture_path != NULL)
+    {
+        status = i2c_rpi_capture_start(&driver_adapter, capture_path);
+        if (ifx_error_check(status))
+        {
+            fprintf(stderr, "Could not open capture %s (0x%08x)\n", capture_path, (unsigned) status);
+            ifx_protocol_destroy(&driver_adapter);
+            close(fd);
+            return EXIT_FAILURE;
+        }
+    }
+    status = ifx_t1prime_initialize(&protocol, &driver_adapter);
+    if (ifx_error_check(status))
+    {
+        fprintf(stderr, "Could not initialize GP T=1' protocol (0x%08x)\n", (unsigned) status);
+        ifx_protocol_destroy(&driver_adapter);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    status = ifx_protocol_activate(&protocol, NULL, NULL);
+    if (ifx_error_check(status))
+    {
+        fprintf(stderr, "Could not activate GP T=1' protocol (0x%08x)\n", (unsigned) status);
+        ifx_protocol_destroy(&protocol);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    // Select application and file once, outside of the measurement
+    uint8_t *apdu = malloc(NBT_BENCH_MAX_APDU_LEN);
+    i2c_rpi_histogram_t *histogram = malloc(sizeof(i2c_rpi_histogram_t));
+    if ((apdu == NULL) || (histogram == NULL))
+    {
+        fprintf(stderr, "Out of memory\n");
+        free(apdu);
+        free(histogram);
+        ifx_protocol_destroy(&protocol);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    uint8_t select_file[] = {0x00U, 0xa4U, 0x00U, 0x0cU, 0x02U, (uint8_t) (fid >> 8), (uint8_t) fid};
+    if (!nbt_bench_exchange(&protocol, select_application, sizeof(select_application), 0U) ||
+        ((workload != NBT_BENCH_WORKLOAD_SELECT) && !nbt_bench_exchange(&protocol, select_file, sizeof(select_file), 0U)))
+    {
+        fprintf(stderr, "Could not select application or file 0x%04lx\n", fid);
+        free(apdu);
+        free(histogram);
+        ifx_protocol_destroy(&protocol);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    size_t apdu_len = nbt_bench_build_apdu(workload, (size_t) bytes, apdu);
+    size_t expected_len = (workload == NBT_BENCH_WORKLOAD_READ) ? ((size_t) bytes + 2U) : 0U;
+
+    // Run workload
+    unsigned long errors = 0U;
+    for (unsigned long i = 0U; i < warmup; i++)
+    {
+        nbt_bench_exchange(&protocol, apdu, apdu_len, expected_len);
+    }
+    i2c_rpi_reset_counters(&protocol);
+    i2c_rpi_reset_latency_histograms(&protocol);
+    i2c_rpi_histogram_reset(histogram);
+    if (trace_path != NULL)
+    {
+        unsigned long trace_events = iterations * NBT_BENCH_TRACE_EVENTS_PER_APDU;
+        trace_rpi_enable((trace_events > NBT_BENCH_MAX_TRACE_EVENTS) ? NBT_BENCH_MAX_TRACE_EVENTS : trace_events);
+    }
+    uint64_t start_ns = nbt_bench_get_monotonic_ns();
+    for (unsigned long i = 0U; i < iterations; i++)
+    {
+        uint64_t apdu_start_ns = nbt_bench_get_monotonic_ns();
+        bool success = nbt_bench_exchange(&protocol, apdu, apdu_len, expected_len);
+        i2c_rpi_histogram_record(histogram, nbt_bench_get_monotonic_ns() - apdu_start_ns);
+        if (!success)
+        {
+            errors++;
+        }
+    }
+    uint64_t elapsed_ns = nbt_bench_get_monotonic_ns() - start_ns;
+    if (trace_path != NULL)
+    {
+        trace_rpi_disable();
+        FILE *trace = fopen(trace_path, "w");
+        if ((trace == NULL) || ifx_error_check(trace_rpi_write_json(trace)))
+        {
+            fprintf(stderr, "Could not write trace to %s\n", trace_path);
+            errors++;
+        }
+        if (trace != NULL)
+        {
+            fclose(trace);
+        }
+    }
+
+    // Report results
+    i2c_rpi_counters_t counters;
+    memset(&counters, 0, sizeof(counters));
+    i2c_rpi_get_counters(&protocol, &counters);
+    i2c_rpi_guard_time_report_t guard_time;
+    memset(&guard_time, 0, sizeof(guard_time));
+    i2c_rpi_get_guard_time_report(&protocol, &guard_time);
+    double elapsed_s = (double) elapsed_ns / 1e9;
+    printf("{\"target\":\"%s\",\"workload\":\"%s\",\"bytes\":%lu,\"iterations\":%lu,\"errors\":%lu,"
+           "\"elapsed_s\":%.6f,\"ops_per_sec\":%.2f,"
+           "\"latency_ns\":{\"min\":%llu,\"mean\":%llu,\"p50\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu},"
+           "\"i2c\":{\"frames_sent\":%llu,\"bytes_sent\":%llu,\"frames_received\":%llu,\"bytes_received\":%llu,\"nacks\":%llu},"
+           "\"guard_time\":{\"configured_us\":%lu,\"recommended_us\":%lu,\"waits\":%llu,\"elapsed\":%llu,\"wait_ns\":%llu}}\n",
+           simulated ? "simulated" : ((replay_path != NULL) ? "replay" : device), workload_names[workload], (workload == NBT_BENCH_WORKLOAD_SELECT) ? 0UL : bytes, iterations, errors,
+           elapsed_s, (double) iterations / elapsed_s, (unsigned long long) histogram->min_ns,
+           (unsigned long long) (histogram->sum_ns / histogram->count), (unsigned long long) i2c_rpi_histogram_get_percentile(histogram, 50.0),
+           (unsigned long long) i2c_rpi_histogram_get_percentile(histogram, 99.0),
+           (unsigned long long) i2c_rpi_histogram_get_percentile(histogram, 99.9), (unsigned long long) histogram->max_ns,
+           (unsigned long long) counters.frames_sent, (unsigned long long) counters.bytes_sent, (unsigned long long) counters.frames_received,
+           (unsigned long long) counters.bytes_received, (unsigned long long) counters.nacks,
+           (unsigned long) guard_time.guard_time_us, (unsigned long) guard_time.recommended_guard_time_us,
+           (unsigned long long) guard_time.waits, (unsigned long long) guard_time.elapsed, (unsigned long long) guard_time.wait_ns);
+
+    free(apdu);
+    free(histogram);
+    ifx_protocol_destroy(&protocol);
+    close(fd);
+    return (errors == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/nbt-cache.h
+ * \brief Protocol layer caching NBT file contents read via READ BINARY.
+ */
+#ifndef INFINEON_NBT_CACHE_H
+#define INFINEON_NBT_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief IFX status code module identifier.
+ */
+#define LIBNBTCACHE 0x3AU
+
+/**
+ * \brief IFX status encoding function identifier for nbt_cache_set_enabled().
+ */
+#define IFX_NBT_CACHE_SET_ENABLED (0x80U)
+
+/**
+ * \brief IFX status encoding function identifier for nbt_cache_invalidate().
+ */
+#define IFX_NBT_CACHE_INVALIDATE (0x81U)
+
+/**
+ * \brief IFX status encoding function identifier for nbt_cache_get_statistics().
+ */
+#define IFX_NBT_CACHE_GET_STATISTICS (0x82U)
+
+/**
+ * \brief Maximum number of files cached at the same time (least recently used file is evicted).
+ */
+#define NBT_CACHE_MAX_FILES 8U
+
+/**
+ * \brief Size of file content addressable by READ BINARY / UPDATE BINARY offsets in [bytes].
+ */
+#define NBT_CACHE_MAX_FILE_SIZE 0x8000U
+
+/** \struct nbt_cache_statistics_t
+ * \brief Effectiveness of the cache since initialization.
+ */
+typedef struct
+{
+    /**
+     * \brief READ BINARY commands answered from the cache.
+     */
+    uint64_t hits;
+
+    /**
+     * \brief READ BINARY commands forwarded to the tag.
+     */
+    uint64_t misses;
+
+    /**
+     * \brief Data bytes answered from the cache.
+     */
+    uint64_t hit_bytes;
+
+    /**
+     * \brief UPDATE BINARY commands whose data was written through into the cache.
+     */
+    uint64_t updates;
+
+    /**
+     * \brief Number of times all cached contents were dropped.
+     */
+    uint64_t invalidations;
+} nbt_cache_statistics_t;
+
+/**
+ * \brief Initializes protocol layer caching file contents of an NBT.
+ *
+ * \details The layer is put on top of a GP T=1' stack and inspects every
+ * APDU. Data returned by READ BINARY of the currently selected file (SELECT
+ * by file ID) is kept in memory keyed by file ID and offset. Later READ
+ * BINARY commands for ranges that are completely cached are answered with
+ * \c 9000 without any I2C traffic. UPDATE BINARY is always sent to the tag
+ * and, if successful, written through into the cache. Any other command
+ * (and READ BINARY / UPDATE BINARY with short file identifier) may change
+ * files in unknown ways and drops all cached contents. This includes SELECT
+ * of an application, as file IDs are only unique within an application.
+ *
+ * Changes made by an NFC reader while the tag is in the field are not
+ * visible to the cache. Sessions where this might happen should disable the
+ * cache via nbt_cache_set_enabled() or call nbt_cache_invalidate().
+ *
+ * \param[out] self Protocol layer to be initialized.
+ * \param[in] base Protocol stack to put cache on top of (e.g. GP T=1').
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_cache_initialize(ifx_protocol_t *self, ifx_protocol_t *base);
+
+/**
+ * \brief Enables or disables caching for the current session.
+ *
+ * \details While disabled, all APDUs are passed through unchanged and no
+ * contents are kept. Disabling drops all cached contents.
+ *
+ * \param[in] self Protocol stack containing a cache layer.
+ * \param[in] enabled Whether file contents shall be cached.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_cache_set_enabled(ifx_protocol_t *self, bool enabled);
+
+/**
+ * \brief Drops all cached contents (e.g. after the tag was in an NFC field).
+ *
+ * \param[in] self Protocol stack containing a cache layer.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_cache_invalidate(ifx_protocol_t *self);
+
+/**
+ * \brief Gets effectiveness statistics of a cache layer.
+ *
+ * \param[in] self Protocol stack containing a cache layer.
+ * \param[out] statistics Buffer to store statistics in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_cache_get_statistics(ifx_protocol_t *self, nbt_cache_statistics_t *statistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_NBT_CACHE_H
@@ -0,0 +1,600 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-cache.c
+ * \brief Protocol layer caching NBT file contents read via READ BINARY.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/nbt-cache.h"
+#include "nbt-cache.h"
+
+/**
+ * \brief Kind of APDU as far as relevant for caching.
+ */
+typedef enum
+{
+    NBT_CACHE_COMMAND_OTHER,
+    NBT_CACHE_COMMAND_SELECT_FILE,
+    NBT_CACHE_COMMAND_SELECT_OTHER,
+    NBT_CACHE_COMMAND_READ_BINARY,
+    NBT_CACHE_COMMAND_UPDATE_BINARY
+} NbtCacheCommandType;
+
+/** \struct NbtCacheCommand
+ * \brief Decoded APDU.
+ */
+typedef struct
+{
+    /**
+     * \brief Kind of APDU.
+     */
+    NbtCacheCommandType type;
+
+    /**
+     * \brief File ID (SELECT FILE only).
+     */
+    uint16_t fid;
+
+    /**
+     * \brief Offset in file (READ BINARY / UPDATE BINARY only).
+     */
+    size_t offset;
+
+    /**
+     * \brief Expected number of data bytes (READ BINARY only).
+     */
+    size_t le;
+
+    /**
+     * \brief Command data (UPDATE BINARY only).
+     */
+    const uint8_t *body;
+
+    /**
+     * \brief Number of bytes in \ref NbtCacheCommand.body.
+     */
+    size_t body_len;
+} NbtCacheCommand;
+
+static void nbt_cache_parse(const uint8_t *data, size_t data_len, NbtCacheCommand *command);
+static void nbt_cache_drop_all(NbtCacheProtocolProperties *properties);
+static NbtCacheFile *nbt_cache_find_file(NbtCacheProtocolProperties *properties, uint16_t fid, bool create);
+static bool nbt_cache_store(NbtCacheFile *file, size_t offset, const uint8_t *data, size_t data_len);
+static bool nbt_cache_is_cached(const NbtCacheFile *file, size_t offset, size_t len);
+static bool nbt_cache_is_success(const uint8_t *response, size_t response_len);
+
+/**
+ * \brief Initializes protocol layer caching file contents of an NBT.
+ *
+ * \param[out] self Protocol layer to be initialized.
+ * \param[in] base Protocol stack to put cache on top of (e.g. GP T=1').
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_cache_initialize(ifx_protocol_t *self, ifx_protocol_t *base)
+{
+    // Validate parameters
+    if ((self == NULL) || (base == NULL))
+    {
+        return IFX_ERROR(LIBNBTCACHE, IFX_PROTOCOL_LAYER_INITIALIZE, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    // Populate object
+    ifx_status_t status = ifx_protocol_layer_initialize(self);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    self->_layer_id = NBT_CACHE_PROTOCOLLAYER_ID;
+    self->_base = base;
+    self->_activate = nbt_cache_activate;
+    self->_transceive = nbt_cache_transceive;
+    self->_transmit = nbt_cache_transmit;
+    self->_destructor = nbt_cache_destroy;
+
+    // Populate protocol properties
+    NbtCacheProtocolProperties *properties = calloc(1U, sizeof(NbtCacheProtocolProperties));
+    if (properties == NULL)
+    {
+        return IFX_ERROR(LIBNBTCACHE, IFX_PROTOCOL_LAYER_INITIALIZE, IFX_OUT_OF_MEMORY);
+    }
+    properties->enabled = true;
+    properties->selected = false;
+    self->_properties = properties;
+
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief ifx_protocol_activate_callback_t for NBT file cache.
+ *
+ * \details Activation resets the file selection of the tag, cached contents stay valid.
+ *
+ * \see ifx_protocol_activate_callback_t
+ */
+ifx_status_t nbt_cache_activate(ifx_protocol_t *self, uint8_t **response, size_t *response_len)
+{
+    NbtCacheProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_cache_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    properties->selected = false;
+    return ifx_protocol_activate(self->_base, response, response_len);
+}
+
+/**
+ * \brief ifx_protocol_transceive_callback_t for NBT file cache.
+ *
+ * \see ifx_protocol_transceive_callback_t
+ */
+ifx_status_t nbt_cache_transceive(ifx_protocol_t *self, const uint8_t *data, size_t data_len, uint8_t **response, size_t *response_len)
+{
+    // Validate parameters
+    if ((data == NULL) || (response == NULL) || (response_len == NULL))
+    {
+        return IFX_ERROR(LIBNBTCACHE, IFX_PROTOCOL_TRANSCEIVE, IFX_ILLEGAL_ARGUMENT);
+    }
+    NbtCacheProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_cache_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    if (!properties->enabled)
+    {
+        return ifx_protocol_transceive(self->_base, data, data_len, response, response_len);
+    }
+
+    NbtCacheCommand command;
+    nbt_cache_parse(data, data_len, &command);
+    NbtCacheFile *file = NULL;
+    if (properties->selected && ((command.type == NBT_CACHE_COMMAND_READ_BINARY) || (command.type == NBT_CACHE_COMMAND_UPDATE_BINARY)))
+    {
+        file = nbt_cache_find_file(properties, properties->selected_fid, command.type == NBT_CACHE_COMMAND_READ_BINARY);
+    }
+
+    // Serve READ BINARY from cache if the whole range is known
+    if ((command.type == NBT_CACHE_COMMAND_READ_BINARY) && (file != NULL) && nbt_cache_is_cached(file, command.offset, command.le))
+    {
+        uint8_t *cached = malloc(command.le + 2U);
+        if (cached == NULL)
+        {
+            return IFX_ERROR(LIBNBTCACHE, IFX_PROTOCOL_TRANSCEIVE, IFX_OUT_OF_MEMORY);
+        }
+        memcpy(cached, &file->data[command.offset], command.le);
+        cached[command.le] = 0x90U;
+        cached[command.le + 1U] = 0x00U;
+        *response = cached;
+        *response_len = command.le + 2U;
+        properties->statistics.hits++;
+        properties->statistics.hit_bytes += command.le;
+        return IFX_SUCCESS;
+    }
+
+    status = ifx_protocol_transceive(self->_base, data, data_len, response, response_len);
+    bool success = !ifx_error_check(status) && nbt_cache_is_success(*response, *response_len);
+    switch (command.type)
+    {
+    case NBT_CACHE_COMMAND_SELECT_FILE:
+        properties->selected = success;
+        properties->selected_fid = command.fid;
+        break;
+    case NBT_CACHE_COMMAND_SELECT_OTHER:
+        // Files are only keyed by FID, which another application may reuse
+        properties->selected = false;
+        nbt_cache_drop_all(properties);
+        break;
+    case NBT_CACHE_COMMAND_READ_BINARY:
+        if (properties->selected)
+        {
+            properties->statistics.misses++;
+        }
+        if (success && (file != NULL) && !nbt_cache_store(file, command.offset, *response, *response_len - 2U))
+        {
+            // Out of memory only means the data is not cached
+            file->in_use = false;
+        }
+        break;
+    case NBT_CACHE_COMMAND_UPDATE_BINARY:
+        if (file != NULL)
+        {
+            // Write through, contents are unknown after failed updates
+            if (success && nbt_cache_store(file, command.offset, command.body, command.body_len))
+            {
+                properties->statistics.updates++;
+            }
+            else
+            {
+                file->in_use = false;
+            }
+        }
+        else if (!properties->selected)
+        {
+            nbt_cache_drop_all(properties);
+        }
+        break;
+    default:
+        // Unknown commands might modify any file
+        nbt_cache_drop_all(properties);
+        break;
+    }
+    return status;
+}
+
+/**
+ * \brief ifx_protocol_transmit_callback_t for NBT file cache.
+ *
+ * \details APDUs sent without ifx_protocol_transceive() are not inspected,
+ * so all cached contents are dropped.
+ *
+ * \see ifx_protocol_transmit_callback_t
+ */
+ifx_status_t nbt_cache_transmit(ifx_protocol_t *self, const uint8_t *data, size_t data_len)
+{
+    NbtCacheProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_cache_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    properties->selected = false;
+    nbt_cache_drop_all(properties);
+    return ifx_protocol_transmit(self->_base, data, data_len);
+}
+
+/**
+ * \brief ifx_protocol_destroy_callback_t for NBT file cache.
+ *
+ * \see ifx_protocol_destroy_callback_t
+ */
+void nbt_cache_destroy(ifx_protocol_t *self)
+{
+    if (self != NULL)
+    {
+        if (self->_properties != NULL)
+        {
+            NbtCacheProtocolProperties *properties = (NbtCacheProtocolProperties *) self->_properties;
+            nbt_cache_drop_all(properties);
+            for (size_t i = 0U; i < NBT_CACHE_MAX_FILES; i++)
+            {
+                free(properties->files[i].data);
+                free(properties->files[i].valid);
+            }
+            free(self->_properties);
+        }
+        self->_properties = NULL;
+    }
+}
+
+/**
+ * \brief Enables or disables caching for the current session.
+ *
+ * \param[in] self Protocol stack containing a cache layer.
+ * \param[in] enabled Whether file contents shall be cached.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_cache_set_enabled(ifx_protocol_t *self, bool enabled)
+{
+    NbtCacheProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_cache_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return IFX_ERROR(LIBNBTCACHE, IFX_NBT_CACHE_SET_ENABLED, IFX_PROTOCOL_STACK_INVALID);
+    }
+
+    // File selection is not tracked while disabled
+    if (!enabled || !properties->enabled)
+    {
+        properties->selected = false;
+        nbt_cache_drop_all(properties);
+    }
+    properties->enabled = enabled;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Drops all cached contents (e.g. after the tag was in an NFC field).
+ *
+ * \param[in] self Protocol stack containing a cache layer.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_cache_invalidate(ifx_protocol_t *self)
+{
+    NbtCacheProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_cache_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return IFX_ERROR(LIBNBTCACHE, IFX_NBT_CACHE_INVALIDATE, IFX_PROTOCOL_STACK_INVALID);
+    }
+    nbt_cache_drop_all(properties);
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Gets effectiveness statistics of a cache layer.
+ *
+ * \param[in] self Protocol stack containing a cache layer.
+ * \param[out] statistics Buffer to store statistics in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_cache_get_statistics(ifx_protocol_t *self, nbt_cache_statistics_t *statistics)
+{
+    // Validate parameters
+    if (statistics == NULL)
+    {
+        return IFX_ERROR(LIBNBTCACHE, IFX_NBT_CACHE_GET_STATISTICS, IFX_ILLEGAL_ARGUMENT);
+    }
+    NbtCacheProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_cache_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return IFX_ERROR(LIBNBTCACHE, IFX_NBT_CACHE_GET_STATISTICS, IFX_PROTOCOL_STACK_INVALID);
+    }
+    *statistics = properties->statistics;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Returns protocol properties of cache layer in protocol stack.
+ *
+ * \param[in] self Protocol stack containing a cache layer.
+ * \param[out] properties_buffer Buffer to store properties in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_cache_get_protocol_properties(ifx_protocol_t *self, NbtCacheProtocolProperties **properties_buffer)
+{
+    // Validate parameters
+    if ((self == NULL) || (properties_buffer == NULL))
+    {
+        return IFX_ERROR(LIBNBTCACHE, IFX_NBT_CACHE_GET_PROPERTIES, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    // Verify that correct protocol layer called this function
+    if (self->_layer_id != NBT_CACHE_PROTOCOLLAYER_ID)
+    {
+        if (self->_base == NULL)
+        {
+            return IFX_ERROR(LIBNBTCACHE, IFX_NBT_CACHE_GET_PROPERTIES, IFX_PROTOCOL_STACK_INVALID);
+        }
+        return nbt_cache_get_protocol_properties(self->_base, properties_buffer);
+    }
+
+    // Verify protocol state
+    if (self->_properties == NULL)
+    {
+        return IFX_ERROR(LIBNBTCACHE, IFX_NBT_CACHE_GET_PROPERTIES, IFX_PROTOCOL_STACK_INVALID);
+    }
+    *properties_buffer = (NbtCacheProtocolProperties *) self->_properties;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Decodes APDU as far as relevant for caching.
+ *
+ * \details Only interindustry class \c 00 commands addressing the currently
+ * selected file are recognized, everything else is reported as
+ * \c NBT_CACHE_COMMAND_OTHER.
+ *
+ * \param[in] data APDU to be decoded.
+ * \param[in] data_len Number of bytes in \p data.
+ * \param[out] command Buffer to store decoded APDU in.
+ */
+static void nbt_cache_parse(const uint8_t *data, size_t data_len, NbtCacheCommand *command)
+{
+    memset(command, 0, sizeof(NbtCacheCommand));
+    command->type = NBT_CACHE_COMMAND_OTHER;
+    if ((data_len < 4U) || (data[0] != 0x00U))
+    {
+        return;
+    }
+
+    // Decode body (short and extended length)
+    size_t lc = 0U;
+    size_t le = 0U;
+    const uint8_t *body = NULL;
+    if (data_len == 5U)
+    {
+        le = (data[4] == 0x00U) ? 256U : data[4];
+    }
+    else if ((data_len == 7U) && (data[4] == 0x00U))
+    {
+        le = ((size_t) data[5] << 8) | data[6];
+        le = (le == 0U) ? 65536U : le;
+    }
+    else if ((data_len > 5U) && (data[4] != 0x00U) && ((data_len == (5U + data[4])) || (data_len == (6U + data[4]))))
+    {
+        lc = data[4];
+        body = &data[5];
+    }
+    else if ((data_len > 7U) && (data[4] == 0x00U))
+    {
+        lc = ((size_t) data[5] << 8) | data[6];
+        if ((data_len != (7U + lc)) && (data_len != (9U + lc)))
+        {
+            return;
+        }
+        body = &data[7];
+    }
+    else if (data_len != 4U)
+    {
+        return;
+    }
+
+    size_t offset = ((size_t) data[2] << 8) | data[3];
+    switch (data[1])
+    {
+    case 0xa4U:
+        if ((data[2] == 0x00U) && (lc == 2U))
+        {
+            command->type = NBT_CACHE_COMMAND_SELECT_FILE;
+            command->fid = (uint16_t) (((uint16_t) body[0] << 8) | body[1]);
+        }
+        else
+        {
+            command->type = NBT_CACHE_COMMAND_SELECT_OTHER;
+        }
+        break;
+    case 0xb0U:
+        // Short file identifiers (P1 bit 8) address files other than the selected one
+        if (((data[2] & 0x80U) == 0U) && (lc == 0U) && (le > 0U) && ((offset + le) <= NBT_CACHE_MAX_FILE_SIZE))
+        {
+            command->type = NBT_CACHE_COMMAND_READ_BINARY;
+            command->offset = offset;
+            command->le = le;
+        }
+        break;
+    case 0xd6U:
+        if (((data[2] & 0x80U) == 0U) && (lc > 0U) && ((offset + lc) <= NBT_CACHE_MAX_FILE_SIZE))
+        {
+            command->type = NBT_CACHE_COMMAND_UPDATE_BINARY;
+            command->offset = offset;
+            command->body = body;
+            command->body_len = lc;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * \brief Drops contents of all files.
+ *
+ * \param[in] properties Protocol properties of cache layer.
+ */
+static void nbt_cache_drop_all(NbtCacheProtocolProperties *properties)
+{
+    for (size_t i = 0U; i < NBT_CACHE_MAX_FILES; i++)
+    {
+        properties->files[i].in_use = false;
+    }
+    properties->statistics.invalidations++;
+}
+
+/**
+ * \brief Looks up cached file, evicting the least recently used file if a new one has to be created.
+ *
+ * \param[in] properties Protocol properties of cache layer.
+ * \param[in] fid File ID to look for.
+ * \param[in] create Whether to create an empty entry if file is not cached yet.
+ * \return NbtCacheFile* Cached file or \c NULL if not cached and \p create is \c false.
+ */
+static NbtCacheFile *nbt_cache_find_file(NbtCacheProtocolProperties *properties, uint16_t fid, bool create)
+{
+    NbtCacheFile *victim = &properties->files[0];
+    for (size_t i = 0U; i < NBT_CACHE_MAX_FILES; i++)
+    {
+        NbtCacheFile *file = &properties->files[i];
+        if (file->in_use && (file->fid == fid))
+        {
+            file->last_used = ++properties->use_counter;
+            return file;
+        }
+        if (victim->in_use && (!file->in_use || (file->last_used < victim->last_used)))
+        {
+            victim = file;
+        }
+    }
+    if (!create)
+    {
+        return NULL;
+    }
+
+    // Buffers of evicted files are reused
+    victim->in_use = true;
+    victim->fid = fid;
+    victim->last_used = ++properties->use_counter;
+    if (victim->valid != NULL)
+    {
+        memset(victim->valid, 0, victim->capacity / 8U);
+    }
+    return victim;
+}
+
+/**
+ * \brief Stores data in cached file, growing its buffers as required.
+ *
+ * \param[in] file Cached file.
+ * \param[in] offset Offset of \p data in file.
+ * \param[in] data Data to be stored.
+ * \param[in] data_len Number of bytes in \p data.
+ * \return bool \c true if successful, \c false if out of memory.
+ */
+static bool nbt_cache_store(NbtCacheFile *file, size_t offset, const uint8_t *data, size_t data_len)
+{
+    size_t end = offset + data_len;
+    if (end > NBT_CACHE_MAX_FILE_SIZE)
+    {
+        return false;
+    }
+    if (end > file->capacity)
+    {
+        size_t capacity = ((end + NBT_CACHE_ALLOCATION_GRANULARITY - 1U) / NBT_CACHE_ALLOCATION_GRANULARITY) * NBT_CACHE_ALLOCATION_GRANULARITY;
+        uint8_t *grown_data = realloc(file->data, capacity);
+        if (grown_data == NULL)
+        {
+            return false;
+        }
+        file->data = grown_data;
+        uint8_t *grown_valid = realloc(file->valid, capacity / 8U);
+        if (grown_valid == NULL)
+        {
+            return false;
+        }
+        memset(&grown_valid[file->capacity / 8U], 0, (capacity - file->capacity) / 8U);
+        file->valid = grown_valid;
+        file->capacity = capacity;
+    }
+
+    memcpy(&file->data[offset], data, data_len);
+    for (size_t i = offset; i < end; i++)
+    {
+        file->valid[i / 8U] |= (uint8_t) (1U << (i % 8U));
+    }
+    return true;
+}
+
+/**
+ * \brief Checks whether a range of a file is completely cached.
+ *
+ * \param[in] file Cached file.
+ * \param[in] offset Offset of range in file.
+ * \param[in] len Number of bytes in range.
+ * \return bool \c true if all bytes are cached.
+ */
+static bool nbt_cache_is_cached(const NbtCacheFile *file, size_t offset, size_t len)
+{
+    if ((offset + len) > file->capacity)
+    {
+        return false;
+    }
+    for (size_t i = offset; i < (offset + len); i++)
+    {
+        if ((file->valid[i / 8U] & (1U << (i % 8U))) == 0U)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Checks whether response ends with status word \c 9000.
+ *
+ * \param[in] response Response APDU.
+ * \param[in] response_len Number of bytes in \p response.
+ * \return bool \c true if successful.
+ */
+static bool nbt_cache_is_success(const uint8_t *response, size_t response_len)
+{
+    return (response != NULL) && (response_len >= 2U) && (response[response_len - 2U] == 0x90U) && (response[response_len - 1U] == 0x00U);
+}
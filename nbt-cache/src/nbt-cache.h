@@ -0,0 +1,153 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-cache.h
+ * \brief Internal definitions for protocol layer caching NBT file contents.
+ */
+#ifndef NBT_CACHE_H
+#define NBT_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/nbt-cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Protocol Layer ID for NBT file cache.
+ *
+ * \details Used to verify that correct protocol layer has called member functionality.
+ */
+#define NBT_CACHE_PROTOCOLLAYER_ID 0x3AU
+
+/**
+ * \brief IFX status encoding function identifier for nbt_cache_get_protocol_properties().
+ */
+#define IFX_NBT_CACHE_GET_PROPERTIES (0x83U)
+
+/**
+ * \brief Granularity in [bytes] in which file buffers grow.
+ */
+#define NBT_CACHE_ALLOCATION_GRANULARITY 256U
+
+/** \struct NbtCacheFile
+ * \brief Cached contents of a single file.
+ */
+typedef struct
+{
+    /**
+     * \brief Whether this slot holds a file.
+     */
+    bool in_use;
+
+    /**
+     * \brief File ID as used in SELECT.
+     */
+    uint16_t fid;
+
+    /**
+     * \brief Value of \ref NbtCacheProtocolProperties.use_counter at last access (for LRU eviction).
+     */
+    uint64_t last_used;
+
+    /**
+     * \brief Number of bytes allocated for \ref NbtCacheFile.data.
+     */
+    size_t capacity;
+
+    /**
+     * \brief File content (only bytes marked in \ref NbtCacheFile.valid are meaningful).
+     */
+    uint8_t *data;
+
+    /**
+     * \brief Bitmap of cached bytes in \ref NbtCacheFile.data.
+     */
+    uint8_t *valid;
+} NbtCacheFile;
+
+/** \struct NbtCacheProtocolProperties
+ * \brief Protocol properties of NBT file cache layer.
+ */
+typedef struct
+{
+    /**
+     * \brief Whether contents are cached.
+     */
+    bool enabled;
+
+    /**
+     * \brief Whether \ref NbtCacheProtocolProperties.selected_fid is known to be selected on the tag.
+     */
+    bool selected;
+
+    /**
+     * \brief File ID of currently selected file.
+     */
+    uint16_t selected_fid;
+
+    /**
+     * \brief Counter incremented on each file access (for LRU eviction).
+     */
+    uint64_t use_counter;
+
+    /**
+     * \brief Cached files.
+     */
+    NbtCacheFile files[NBT_CACHE_MAX_FILES];
+
+    /**
+     * \brief Effectiveness statistics.
+     */
+    nbt_cache_statistics_t statistics;
+} NbtCacheProtocolProperties;
+
+/**
+ * \brief ifx_protocol_activate_callback_t for NBT file cache.
+ *
+ * \see ifx_protocol_activate_callback_t
+ */
+ifx_status_t nbt_cache_activate(ifx_protocol_t *self, uint8_t **response, size_t *response_len);
+
+/**
+ * \brief ifx_protocol_transceive_callback_t for NBT file cache.
+ *
+ * \see ifx_protocol_transceive_callback_t
+ */
+ifx_status_t nbt_cache_transceive(ifx_protocol_t *self, const uint8_t *data, size_t data_len, uint8_t **response, size_t *response_len);
+
+/**
+ * \brief ifx_protocol_transmit_callback_t for NBT file cache.
+ *
+ * \see ifx_protocol_transmit_callback_t
+ */
+ifx_status_t nbt_cache_transmit(ifx_protocol_t *self, const uint8_t *data, size_t data_len);
+
+/**
+ * \brief ifx_protocol_destroy_callback_t for NBT file cache.
+ *
+ * \see ifx_protocol_destroy_callback_t
+ */
+void nbt_cache_destroy(ifx_protocol_t *self);
+
+/**
+ * \brief Returns protocol properties of cache layer in protocol stack.
+ *
+ * \param[in] self Protocol stack containing a cache layer.
+ * \param[out] properties_buffer Buffer to store properties in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_cache_get_protocol_properties(ifx_protocol_t *self, NbtCacheProtocolProperties **properties_buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NBT_CACHE_H
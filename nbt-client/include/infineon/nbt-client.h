@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/nbt-client.h
+ * \brief Protocol layer exchanging APDUs with tags owned by nbt-daemon via a unix domain socket.
+ *
+ * \details Each request consists of a \ref nbt_client_request_header_t
+ * followed by \ref nbt_client_request_header_t.data_len bytes of data, each
+ * response of a \ref nbt_client_response_header_t followed by
+ * \ref nbt_client_response_header_t.data_len bytes of data. Integers are in
+ * host byte order. Clients send the next request only after the response to
+ * the previous one was received.
+ */
+#ifndef INFINEON_NBT_CLIENT_H
+#define INFINEON_NBT_CLIENT_H
+
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief IFX status code module identifier.
+ */
+#define LIBNBTCLIENT 0x3CU
+
+/**
+ * \brief Error reason if the daemon could not be reached or closed the connection.
+ */
+#define NBT_CLIENT_CONNECTION_ERROR (0x01U)
+
+/**
+ * \brief Unix domain socket nbt-daemon listens on if not configured otherwise.
+ */
+#define NBT_CLIENT_DEFAULT_SOCKET_PATH "/run/nbt-daemon.sock"
+
+/**
+ * \brief Maximum number of data bytes in requests and responses.
+ */
+#define NBT_CLIENT_MAX_DATA_LEN 0x10010U
+
+/**
+ * \brief Type of request sent to nbt-daemon.
+ */
+typedef enum
+{
+    /**
+     * \brief Exchange command APDU given as data, response data is the response APDU.
+     */
+    NBT_CLIENT_REQUEST_TRANSCEIVE = 0,
+
+    /**
+     * \brief No data, response data are the communication interface parameters of the tag.
+     */
+    NBT_CLIENT_REQUEST_ACTIVATE = 1
+} nbt_client_request_type_t;
+
+/** \struct nbt_client_request_header_t
+ * \brief Header of requests sent to nbt-daemon.
+ */
+typedef struct
+{
+    /**
+     * \brief Type of request (\ref nbt_client_request_type_t).
+     */
+    uint8_t type;
+
+    /**
+     * \brief Index of tag in daemon configuration.
+     */
+    uint8_t tag;
+
+    /**
+     * \brief Reserved, must be \c 0.
+     */
+    uint16_t reserved;
+
+    /**
+     * \brief Number of data bytes following the header.
+     */
+    uint32_t data_len;
+} nbt_client_request_header_t;
+
+/** \struct nbt_client_response_header_t
+ * \brief Header of responses sent by nbt-daemon.
+ */
+typedef struct
+{
+    /**
+     * \brief Result of the request (\c ifx_status_t).
+     */
+    uint32_t status;
+
+    /**
+     * \brief Number of data bytes following the header.
+     */
+    uint32_t data_len;
+} nbt_client_response_header_t;
+
+/**
+ * \brief Initializes protocol layer forwarding APDUs to a tag of nbt-daemon.
+ *
+ * \details The resulting layer is a complete protocol stack, so
+ * \c ifx_protocol_transceive() and everything built on it (e.g. nbt-file)
+ * work unchanged. The daemon keeps the file selection of each client
+ * separately, so clients may interleave freely.
+ *
+ * \param[out] self Protocol layer to be initialized.
+ * \param[in] socket_path Unix domain socket of the daemon (\c NULL for \ref NBT_CLIENT_DEFAULT_SOCKET_PATH).
+ * \param[in] tag Index of tag in daemon configuration.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_client_initialize(ifx_protocol_t *self, const char *socket_path, uint8_t tag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_NBT_CLIENT_H
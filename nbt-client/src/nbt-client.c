@@ -0,0 +1,314 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-client.c
+ * \brief Protocol layer exchanging APDUs with tags owned by nbt-daemon via a unix domain socket.
+ */
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/nbt-client.h"
+#include "nbt-client.h"
+
+static int nbt_client_write_all(int fd, struct iovec *iov, int iovcnt);
+static int nbt_client_read_all(int fd, void *buffer, size_t len);
+
+/**
+ * \brief Initializes protocol layer forwarding APDUs to a tag of nbt-daemon.
+ *
+ * \details The resulting layer is a complete protocol stack, so
+ * \c ifx_protocol_transceive() and everything built on it (e.g. nbt-file)
+ * work unchanged. The daemon keeps the file selection of each client
+ * separately, so clients may interleave freely.
+ *
+ * \param[out] self Protocol layer to be initialized.
+ * \param[in] socket_path Unix domain socket of the daemon (\c NULL for \ref NBT_CLIENT_DEFAULT_SOCKET_PATH).
+ * \param[in] tag Index of tag in daemon configuration.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_client_initialize(ifx_protocol_t *self, const char *socket_path, uint8_t tag)
+{
+    // Validate parameters
+    if (socket_path == NULL)
+    {
+        socket_path = NBT_CLIENT_DEFAULT_SOCKET_PATH;
+    }
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    if ((self == NULL) || (strlen(socket_path) >= sizeof(address.sun_path)))
+    {
+        return IFX_ERROR(LIBNBTCLIENT, IFX_PROTOCOL_LAYER_INITIALIZE, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    // Connect to daemon
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return IFX_ERROR(LIBNBTCLIENT, IFX_PROTOCOL_LAYER_INITIALIZE, NBT_CLIENT_CONNECTION_ERROR);
+    }
+    if (connect(fd, (const struct sockaddr *) &address, sizeof(address)) != 0)
+    {
+        close(fd);
+        return IFX_ERROR(LIBNBTCLIENT, IFX_PROTOCOL_LAYER_INITIALIZE, NBT_CLIENT_CONNECTION_ERROR);
+    }
+
+    // Populate object
+    ifx_status_t status = ifx_protocol_layer_initialize(self);
+    if (ifx_error_check(status))
+    {
+        close(fd);
+        return status;
+    }
+    self->_layer_id = NBT_CLIENT_PROTOCOLLAYER_ID;
+    self->_activate = nbt_client_activate;
+    self->_transceive = nbt_client_transceive;
+    self->_destructor = nbt_client_destroy;
+
+    // Populate protocol properties
+    NbtClientProtocolProperties *properties = calloc(1U, sizeof(NbtClientProtocolProperties));
+    if (properties == NULL)
+    {
+        close(fd);
+        return IFX_ERROR(LIBNBTCLIENT, IFX_PROTOCOL_LAYER_INITIALIZE, IFX_OUT_OF_MEMORY);
+    }
+    properties->fd = fd;
+    properties->tag = tag;
+    self->_properties = properties;
+
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief ifx_protocol_activate_callback_t for nbt-daemon client.
+ *
+ * \details The tag is activated by the daemon, this only returns its
+ * communication interface parameters so that layers like nbt-file can size
+ * their transfers.
+ *
+ * \see ifx_protocol_activate_callback_t
+ */
+ifx_status_t nbt_client_activate(ifx_protocol_t *self, uint8_t **response, size_t *response_len)
+{
+    // Validate parameters
+    if ((response == NULL) || (response_len == NULL))
+    {
+        return IFX_ERROR(LIBNBTCLIENT, IFX_PROTOCOL_ACTIVATE, IFX_ILLEGAL_ARGUMENT);
+    }
+    NbtClientProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_client_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    return nbt_client_request(properties, NBT_CLIENT_REQUEST_ACTIVATE, NULL, 0U, response, response_len);
+}
+
+/**
+ * \brief ifx_protocol_transceive_callback_t for nbt-daemon client.
+ *
+ * \see ifx_protocol_transceive_callback_t
+ */
+ifx_status_t nbt_client_transceive(ifx_protocol_t *self, const uint8_t *data, size_t data_len, uint8_t **response, size_t *response_len)
+{
+    // Validate parameters
+    if ((data == NULL) || (data_len == 0U) || (data_len > NBT_CLIENT_MAX_DATA_LEN) || (response == NULL) || (response_len == NULL))
+    {
+        return IFX_ERROR(LIBNBTCLIENT, IFX_PROTOCOL_TRANSCEIVE, IFX_ILLEGAL_ARGUMENT);
+    }
+    NbtClientProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_client_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    return nbt_client_request(properties, NBT_CLIENT_REQUEST_TRANSCEIVE, data, data_len, response, response_len);
+}
+
+/**
+ * \brief ifx_protocol_destroy_callback_t for nbt-daemon client.
+ *
+ * \see ifx_protocol_destroy_callback_t
+ */
+void nbt_client_destroy(ifx_protocol_t *self)
+{
+    if (self != NULL)
+    {
+        if (self->_properties != NULL)
+        {
+            NbtClientProtocolProperties *properties = (NbtClientProtocolProperties *) self->_properties;
+            close(properties->fd);
+            free(self->_properties);
+        }
+        self->_properties = NULL;
+    }
+}
+
+/**
+ * \brief Returns nbt-daemon client protocol properties of protocol stack.
+ *
+ * \param[in] self Protocol stack to get client properties for.
+ * \param[out] properties_buffer Buffer to store properties in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_client_get_protocol_properties(ifx_protocol_t *self, NbtClientProtocolProperties **properties_buffer)
+{
+    // Validate parameters
+    if ((self == NULL) || (properties_buffer == NULL))
+    {
+        return IFX_ERROR(LIBNBTCLIENT, IFX_NBT_CLIENT_GET_PROPERTIES, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    // Verify that correct protocol layer called this function
+    if (self->_layer_id != NBT_CLIENT_PROTOCOLLAYER_ID)
+    {
+        if (self->_base == NULL)
+        {
+            return IFX_ERROR(LIBNBTCLIENT, IFX_NBT_CLIENT_GET_PROPERTIES, IFX_PROTOCOL_STACK_INVALID);
+        }
+        return nbt_client_get_protocol_properties(self->_base, properties_buffer);
+    }
+
+    // Verify protocol state
+    if (self->_properties == NULL)
+    {
+        return IFX_ERROR(LIBNBTCLIENT, IFX_NBT_CLIENT_GET_PROPERTIES, IFX_PROTOCOL_STACK_INVALID);
+    }
+    *properties_buffer = (NbtClientProtocolProperties *) self->_properties;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Sends request to daemon and receives its response.
+ *
+ * \param[in] properties Protocol properties of client layer.
+ * \param[in] type Type of request.
+ * \param[in] data Request data.
+ * \param[in] data_len Number of bytes in \p data.
+ * \param[out] response Buffer to store newly allocated response data in (\c NULL if empty).
+ * \param[out] response_len Buffer to store number of bytes in \p response in.
+ * \return ifx_status_t Status reported by daemon or connection error.
+ */
+ifx_status_t nbt_client_request(NbtClientProtocolProperties *properties, nbt_client_request_type_t type, const uint8_t *data, size_t data_len,
+                                uint8_t **response, size_t *response_len)
+{
+    // Send request
+    nbt_client_request_header_t request = {.type = (uint8_t) type, .tag = properties->tag, .reserved = 0U, .data_len = (uint32_t) data_len};
+    struct iovec iov[2] = {{.iov_base = &request, .iov_len = sizeof(request)}, {.iov_base = (void *) data, .iov_len = data_len}};
+    if (nbt_client_write_all(properties->fd, iov, (data_len > 0U) ? 2 : 1) != 0)
+    {
+        return IFX_ERROR(LIBNBTCLIENT, IFX_NBT_CLIENT_REQUEST, NBT_CLIENT_CONNECTION_ERROR);
+    }
+
+    // Receive response
+    nbt_client_response_header_t header;
+    if ((nbt_client_read_all(properties->fd, &header, sizeof(header)) != 0) || (header.data_len > NBT_CLIENT_MAX_DATA_LEN))
+    {
+        return IFX_ERROR(LIBNBTCLIENT, IFX_NBT_CLIENT_REQUEST, NBT_CLIENT_CONNECTION_ERROR);
+    }
+    uint8_t *buffer = NULL;
+    if (header.data_len > 0U)
+    {
+        buffer = malloc(header.data_len);
+        if (buffer == NULL)
+        {
+            return IFX_ERROR(LIBNBTCLIENT, IFX_NBT_CLIENT_REQUEST, IFX_OUT_OF_MEMORY);
+        }
+        if (nbt_client_read_all(properties->fd, buffer, header.data_len) != 0)
+        {
+            free(buffer);
+            return IFX_ERROR(LIBNBTCLIENT, IFX_NBT_CLIENT_REQUEST, NBT_CLIENT_CONNECTION_ERROR);
+        }
+    }
+    if (ifx_error_check((ifx_status_t) header.status))
+    {
+        free(buffer);
+        return (ifx_status_t) header.status;
+    }
+    *response = buffer;
+    *response_len = header.data_len;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Writes all bytes of an I/O vector to a socket.
+ *
+ * \param[in] fd Socket to write to.
+ * \param[in,out] iov I/O vector to be written (modified while writing).
+ * \param[in] iovcnt Number of entries in \p iov.
+ * \return int \c 0 if successful, \c -1 in case of error.
+ */
+static int nbt_client_write_all(int fd, struct iovec *iov, int iovcnt)
+{
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = iov;
+    message.msg_iovlen = (size_t) iovcnt;
+    while (message.msg_iovlen > 0U)
+    {
+        ssize_t written = sendmsg(fd, &message, MSG_NOSIGNAL);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        size_t remaining = (size_t) written;
+        while ((message.msg_iovlen > 0U) && (remaining >= message.msg_iov->iov_len))
+        {
+            remaining -= message.msg_iov->iov_len;
+            message.msg_iov++;
+            message.msg_iovlen--;
+        }
+        if (message.msg_iovlen > 0U)
+        {
+            message.msg_iov->iov_base = (uint8_t *) message.msg_iov->iov_base + remaining;
+            message.msg_iov->iov_len -= remaining;
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief Reads exactly \p len bytes from a socket.
+ *
+ * \param[in] fd Socket to read from.
+ * \param[out] buffer Buffer to store data in.
+ * \param[in] len Number of bytes to read.
+ * \return int \c 0 if successful, \c -1 in case of error or end of stream.
+ */
+static int nbt_client_read_all(int fd, void *buffer, size_t len)
+{
+    size_t offset = 0U;
+    while (offset < len)
+    {
+        ssize_t received = recv(fd, (uint8_t *) buffer + offset, len - offset, 0);
+        if (received < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (received == 0)
+        {
+            return -1;
+        }
+        offset += (size_t) received;
+    }
+    return 0;
+}
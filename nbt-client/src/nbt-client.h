@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-client.h
+ * \brief Internal definitions for protocol layer exchanging APDUs with nbt-daemon.
+ */
+#ifndef NBT_CLIENT_H
+#define NBT_CLIENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/nbt-client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Protocol Layer ID for nbt-daemon client.
+ *
+ * \details Used to verify that correct protocol layer has called member functionality.
+ */
+#define NBT_CLIENT_PROTOCOLLAYER_ID 0x3CU
+
+/**
+ * \brief IFX status encoding function identifier for nbt_client_request().
+ */
+#define IFX_NBT_CLIENT_REQUEST (0x80U)
+
+/**
+ * \brief IFX status encoding function identifier for nbt_client_get_protocol_properties().
+ */
+#define IFX_NBT_CLIENT_GET_PROPERTIES (0x81U)
+
+/** \struct NbtClientProtocolProperties
+ * \brief Protocol properties of nbt-daemon client layer.
+ */
+typedef struct
+{
+    /**
+     * \brief Connected unix domain socket.
+     */
+    int fd;
+
+    /**
+     * \brief Index of tag in daemon configuration.
+     */
+    uint8_t tag;
+} NbtClientProtocolProperties;
+
+/**
+ * \brief ifx_protocol_activate_callback_t for nbt-daemon client.
+ *
+ * \see ifx_protocol_activate_callback_t
+ */
+ifx_status_t nbt_client_activate(ifx_protocol_t *self, uint8_t **response, size_t *response_len);
+
+/**
+ * \brief ifx_protocol_transceive_callback_t for nbt-daemon client.
+ *
+ * \see ifx_protocol_transceive_callback_t
+ */
+ifx_status_t nbt_client_transceive(ifx_protocol_t *self, const uint8_t *data, size_t data_len, uint8_t **response, size_t *response_len);
+
+/**
+ * \brief ifx_protocol_destroy_callback_t for nbt-daemon client.
+ *
+ * \see ifx_protocol_destroy_callback_t
+ */
+void nbt_client_destroy(ifx_protocol_t *self);
+
+/**
+ * \brief Returns nbt-daemon client protocol properties of protocol stack.
+ *
+ * \param[in] self Protocol stack to get client properties for.
+ * \param[out] properties_buffer Buffer to store properties in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_client_get_protocol_properties(ifx_protocol_t *self, NbtClientProtocolProperties **properties_buffer);
+
+/**
+ * \brief Sends request to daemon and receives its response.
+ *
+ * \param[in] properties Protocol properties of client layer.
+ * \param[in] type Type of request.
+ * \param[in] data Request data.
+ * \param[in] data_len Number of bytes in \p data.
+ * \param[out] response Buffer to store newly allocated response data in (\c NULL if empty).
+ * \param[out] response_len Buffer to store number of bytes in \p response in.
+ * \return ifx_status_t Status reported by daemon or connection error.
+ */
+ifx_status_t nbt_client_request(NbtClientProtocolProperties *properties, nbt_client_request_type_t type, const uint8_t *data, size_t data_len,
+                                uint8_t **response, size_t *response_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NBT_CLIENT_H
@@ -0,0 +1,1220 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-daemon.c
+ * \brief Daemon owning NBTs and serving APDUs of several clients via a unix domain socket.
+ *
+ * \details Usage: nbt-daemon [-s [-p us]] [-l socket] device:address...
+ *
+ * Each tag argument is activated once at startup, its position is the tag
+ * index clients address (see infineon/nbt-client.h). Requests are queued per
+ * tag and a worker thread per tag drains its queue in batches:
+ *
+ * - The daemon tracks the SELECTed application and file of every client and
+ *   of the tag, and re-issues the client's SELECTs before its command if
+ *   another client changed them. A SELECT matching the tag state is answered
+ *   without bus traffic.
+ * - Identical READ BINARY commands of clients with the same selection that
+ *   are queued at the same time are merged into one bus transaction, up to
+ *   the first queued command that might modify the file.
+ *
+ * On SIGINT or SIGTERM a JSON summary per tag is written to stdout.
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/ifx-t1prime.h"
+#include "infineon/i2c-rpi.h"
+#include "infineon/nbt-client.h"
+#include "infineon/nbt-sim.h"
+
+/**
+ * \brief Maximum number of tags served by one daemon.
+ */
+#define NBT_DAEMON_MAX_TAGS 16U
+
+/**
+ * \brief Maximum number of simultaneously connected clients.
+ */
+#define NBT_DAEMON_MAX_CLIENTS 64U
+
+/**
+ * \brief Maximum length of SELECT APDUs tracked as selection state in [bytes].
+ */
+#define NBT_DAEMON_MAX_SELECT_LEN 32U
+
+/**
+ * \brief Time a client may take to complete a request or accept a response in [ms].
+ */
+#define NBT_DAEMON_SOCKET_TIMEOUT_MS 1000U
+
+/**
+ * \brief Kind of command APDU as far as relevant for scheduling.
+ */
+typedef enum
+{
+    NBT_DAEMON_COMMAND_OTHER,
+    NBT_DAEMON_COMMAND_SELECT_APPLICATION,
+    NBT_DAEMON_COMMAND_SELECT_FILE,
+    NBT_DAEMON_COMMAND_READ_BINARY
+} NbtDaemonCommandType;
+
+/** \struct NbtDaemonSelection
+ * \brief SELECT APDUs determining which application and file commands address.
+ */
+typedef struct
+{
+    /**
+     * \brief Last successful SELECT of an application.
+     */
+    uint8_t application[NBT_DAEMON_MAX_SELECT_LEN];
+
+    /**
+     * \brief Number of bytes in \ref NbtDaemonSelection.application (\c 0 if none selected).
+     */
+    size_t application_len;
+
+    /**
+     * \brief Last successful SELECT of a file within the application.
+     */
+    uint8_t file[NBT_DAEMON_MAX_SELECT_LEN];
+
+    /**
+     * \brief Number of bytes in \ref NbtDaemonSelection.file (\c 0 if none selected).
+     */
+    size_t file_len;
+} NbtDaemonSelection;
+
+/** \struct NbtDaemonClient
+ * \brief Connected client.
+ */
+typedef struct
+{
+    /**
+     * \brief Connected socket (\c -1 if slot unused).
+     */
+    int fd;
+
+    /**
+     * \brief Whether a request is queued or being executed (main thread only).
+     */
+    bool pending;
+
+    /**
+     * \brief Selection of client per tag (worker of the respective tag only).
+     */
+    NbtDaemonSelection selection[NBT_DAEMON_MAX_TAGS];
+} NbtDaemonClient;
+
+/** \struct NbtDaemonRequest
+ * \brief Queued request of a client.
+ */
+typedef struct NbtDaemonRequest
+{
+    /**
+     * \brief Next request in queue.
+     */
+    struct NbtDaemonRequest *next;
+
+    /**
+     * \brief Index of requesting client.
+     */
+    size_t client;
+
+    /**
+     * \brief Type of request (\ref nbt_client_request_type_t).
+     */
+    uint8_t type;
+
+    /**
+     * \brief Command APDU (transceive requests only).
+     */
+    uint8_t *data;
+
+    /**
+     * \brief Number of bytes in \ref NbtDaemonRequest.data.
+     */
+    size_t data_len;
+
+    /**
+     * \brief Whether the response was already sent.
+     */
+    bool done;
+} NbtDaemonRequest;
+
+struct NbtDaemonContext;
+
+/** \struct NbtDaemonTag
+ * \brief Tag owned by the daemon together with its request queue.
+ */
+typedef struct
+{
+    /**
+     * \brief I2C character device.
+     */
+    const char *device;
+
+    /**
+     * \brief I2C slave address.
+     */
+    uint8_t address;
+
+    /**
+     * \brief File descriptor of \ref NbtDaemonTag.device.
+     */
+    int fd;
+
+    /**
+     * \brief I2C driver adapter.
+     */
+    ifx_protocol_t driver_adapter;
+
+    /**
+     * \brief GP T=1' protocol stack.
+     */
+    ifx_protocol_t protocol;
+
+    /**
+     * \brief Whether \ref NbtDaemonTag.protocol was initialized.
+     */
+    bool stack_initialized;
+
+    /**
+     * \brief Whether the tag has to be activated before the next command (after communication errors).
+     */
+    bool needs_activation;
+
+    /**
+     * \brief Communication interface parameters returned by last activation.
+     */
+    uint8_t *cip;
+
+    /**
+     * \brief Number of bytes in \ref NbtDaemonTag.cip.
+     */
+    size_t cip_len;
+
+    /**
+     * \brief Selection on the tag.
+     */
+    NbtDaemonSelection selection;
+
+    /**
+     * \brief Whether \ref NbtDaemonTag.selection reflects the tag state.
+     */
+    bool selection_known;
+
+    /**
+     * \brief Response to SELECT in \ref NbtDaemonSelection.application of \ref NbtDaemonTag.selection.
+     */
+    uint8_t *application_response;
+
+    /**
+     * \brief Number of bytes in \ref NbtDaemonTag.application_response.
+     */
+    size_t application_response_len;
+
+    /**
+     * \brief Response to SELECT in \ref NbtDaemonSelection.file of \ref NbtDaemonTag.selection.
+     */
+    uint8_t *file_response;
+
+    /**
+     * \brief Number of bytes in \ref NbtDaemonTag.file_response.
+     */
+    size_t file_response_len;
+
+    /**
+     * \brief First queued request (protected by \ref NbtDaemonTag.lock).
+     */
+    NbtDaemonRequest *head;
+
+    /**
+     * \brief Last queued request (protected by \ref NbtDaemonTag.lock).
+     */
+    NbtDaemonRequest *tail;
+
+    /**
+     * \brief Whether the worker shall exit (protected by \ref NbtDaemonTag.lock).
+     */
+    bool stopping;
+
+    /**
+     * \brief Lock protecting the queue.
+     */
+    pthread_mutex_t lock;
+
+    /**
+     * \brief Signalled when requests are queued or the worker shall exit.
+     */
+    pthread_cond_t queued;
+
+    /**
+     * \brief Thread running the worker.
+     */
+    pthread_t thread;
+
+    /**
+     * \brief Daemon the tag belongs to.
+     */
+    struct NbtDaemonContext *context;
+
+    /**
+     * \brief Requests answered.
+     */
+    uint64_t requests;
+
+    /**
+     * \brief Batches taken from the queue.
+     */
+    uint64_t batches;
+
+    /**
+     * \brief APDUs exchanged with the tag.
+     */
+    uint64_t transactions;
+
+    /**
+     * \brief READ BINARY requests answered with the response of another client's identical request.
+     */
+    uint64_t merged_reads;
+
+    /**
+     * \brief SELECT requests answered from the known tag state.
+     */
+    uint64_t skipped_selects;
+
+    /**
+     * \brief SELECTs re-issued to restore the selection of a client.
+     */
+    uint64_t replayed_selects;
+} NbtDaemonTag;
+
+/** \struct NbtDaemonContext
+ * \brief State shared by main thread and workers.
+ */
+typedef struct NbtDaemonContext
+{
+    /**
+     * \brief Served tags in command line order.
+     */
+    NbtDaemonTag tags[NBT_DAEMON_MAX_TAGS];
+
+    /**
+     * \brief Number of entries in \ref NbtDaemonContext.tags.
+     */
+    size_t tag_count;
+
+    /**
+     * \brief Client slots.
+     */
+    NbtDaemonClient clients[NBT_DAEMON_MAX_CLIENTS];
+
+    /**
+     * \brief Pipe workers write indices of answered clients to (read end, write end).
+     */
+    int answered[2];
+} NbtDaemonContext;
+
+/**
+ * \brief Prints usage information.
+ *
+ * \param[in] program Name of the executable.
+ */
+static void nbt_daemon_usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [-s [-p us]] [-l socket] device:address...\n"
+            "  -s             use simulated tags instead of I2C devices\n"
+            "  -p us          processing time per block of simulated tags (default 0)\n"
+            "  -l socket      unix domain socket to listen on (default %s)\n"
+            "tags are numbered in command line order starting at 0 (at most %u)\n",
+            program, NBT_CLIENT_DEFAULT_SOCKET_PATH, NBT_DAEMON_MAX_TAGS);
+}
+
+/**
+ * \brief Signal handler for SIGINT and SIGTERM.
+ *
+ * \details Does nothing itself, the signal interrupts \c ppoll() in the main loop.
+ *
+ * \param[in] signal Received signal.
+ */
+static void nbt_daemon_signal(int signal)
+{
+    (void) signal;
+}
+
+/**
+ * \brief Parses unsigned number (decimal or \c 0x prefixed).
+ *
+ * \param[in] text Text to be parsed.
+ * \param[in] max Maximum accepted value.
+ * \param[out] value Buffer to store value in.
+ * \return bool \c true if successful.
+ */
+static bool nbt_daemon_parse_number(const char *text, unsigned long max, unsigned long *value)
+{
+    char *end = NULL;
+    unsigned long parsed = strtoul(text, &end, 0);
+    if ((end == text) || (*end != '\0') || (parsed > max))
+    {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+/**
+ * \brief Decodes command APDU as far as relevant for scheduling.
+ *
+ * \details SELECTs longer than \ref NBT_DAEMON_MAX_SELECT_LEN are reported
+ * as \c NBT_DAEMON_COMMAND_OTHER.
+ *
+ * \param[in] data Command APDU.
+ * \param[in] data_len Number of bytes in \p data.
+ * \return NbtDaemonCommandType Kind of command.
+ */
+static NbtDaemonCommandType nbt_daemon_parse(const uint8_t *data, size_t data_len)
+{
+    if ((data_len < 4U) || (data[0] != 0x00U))
+    {
+        return NBT_DAEMON_COMMAND_OTHER;
+    }
+    if ((data[1] == 0xa4U) && (data_len >= 5U) && (data_len <= NBT_DAEMON_MAX_SELECT_LEN))
+    {
+        return (data[2] == 0x04U) ? NBT_DAEMON_COMMAND_SELECT_APPLICATION : NBT_DAEMON_COMMAND_SELECT_FILE;
+    }
+    if (data[1] == 0xb0U)
+    {
+        return NBT_DAEMON_COMMAND_READ_BINARY;
+    }
+    return NBT_DAEMON_COMMAND_OTHER;
+}
+
+/**
+ * \brief Checks whether response APDU ends with status word \c 9000.
+ *
+ * \param[in] response Response APDU.
+ * \param[in] response_len Number of bytes in \p response.
+ * \return bool \c true if successful.
+ */
+static bool nbt_daemon_is_success(const uint8_t *response, size_t response_len)
+{
+    return (response_len >= 2U) && (response[response_len - 2U] == 0x90U) && (response[response_len - 1U] == 0x00U);
+}
+
+/**
+ * \brief Checks whether two selections address the same application and file.
+ *
+ * \param[in] a First selection.
+ * \param[in] b Second selection.
+ * \return bool \c true if equal.
+ */
+static bool nbt_daemon_selection_equal(const NbtDaemonSelection *a, const NbtDaemonSelection *b)
+{
+    return (a->application_len == b->application_len) && (a->file_len == b->file_len) &&
+           (memcmp(a->application, b->application, a->application_len) == 0) && (memcmp(a->file, b->file, a->file_len) == 0);
+}
+
+/**
+ * \brief Sends response to a client and hands the client back to the main thread.
+ *
+ * \details Send errors are ignored, the main thread notices the closed
+ * connection when polling the client again.
+ *
+ * \param[in] context Daemon state.
+ * \param[in] client Index of client.
+ * \param[in] status Result of the request.
+ * \param[in] data Response data.
+ * \param[in] data_len Number of bytes in \p data.
+ * \param[in] notify Whether to hand the client back via \ref NbtDaemonContext.answered (\c false on main thread).
+ */
+static void nbt_daemon_respond(NbtDaemonContext *context, size_t client, ifx_status_t status, const uint8_t *data, size_t data_len, bool notify)
+{
+    nbt_client_response_header_t header = {.status = (uint32_t) status, .data_len = (uint32_t) data_len};
+    struct iovec iov[2] = {{.iov_base = &header, .iov_len = sizeof(header)}, {.iov_base = (void *) data, .iov_len = data_len}};
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = iov;
+    message.msg_iovlen = (data_len > 0U) ? 2U : 1U;
+    while (message.msg_iovlen > 0U)
+    {
+        ssize_t written = sendmsg(context->clients[client].fd, &message, MSG_NOSIGNAL);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        size_t remaining = (size_t) written;
+        while ((message.msg_iovlen > 0U) && (remaining >= message.msg_iov->iov_len))
+        {
+            remaining -= message.msg_iov->iov_len;
+            message.msg_iov++;
+            message.msg_iovlen--;
+        }
+        if (message.msg_iovlen > 0U)
+        {
+            message.msg_iov->iov_base = (uint8_t *) message.msg_iov->iov_base + remaining;
+            message.msg_iov->iov_len -= remaining;
+        }
+    }
+    if (notify)
+    {
+        uint32_t index = (uint32_t) client;
+        while ((write(context->answered[1], &index, sizeof(index)) < 0) && (errno == EINTR))
+        {
+        }
+    }
+}
+
+/**
+ * \brief Exchanges APDU with the tag, re-activating it first after communication errors.
+ *
+ * \param[in] tag Tag to exchange APDU with.
+ * \param[in] data Command APDU.
+ * \param[in] data_len Number of bytes in \p data.
+ * \param[out] response Buffer to store newly allocated response APDU in.
+ * \param[out] response_len Buffer to store number of bytes in \p response in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+static ifx_status_t nbt_daemon_exchange(NbtDaemonTag *tag, const uint8_t *data, size_t data_len, uint8_t **response, size_t *response_len)
+{
+    *response = NULL;
+    *response_len = 0U;
+    if (tag->needs_activation)
+    {
+        uint8_t *cip = NULL;
+        size_t cip_len = 0U;
+        ifx_status_t status = ifx_protocol_activate(&tag->protocol, &cip, &cip_len);
+        if (ifx_error_check(status))
+        {
+            return status;
+        }
+        free(tag->cip);
+        tag->cip = cip;
+        tag->cip_len = cip_len;
+        tag->needs_activation = false;
+        tag->selection_known = false;
+    }
+    tag->transactions++;
+    ifx_status_t status = ifx_protocol_transceive(&tag->protocol, data, data_len, response, response_len);
+    if (ifx_error_check(status))
+    {
+        tag->needs_activation = true;
+        tag->selection_known = false;
+        *response = NULL;
+        *response_len = 0U;
+    }
+    return status;
+}
+
+/**
+ * \brief Issues SELECT and records the resulting tag state.
+ *
+ * \param[in] tag Tag to issue SELECT on.
+ * \param[in] type Kind of SELECT.
+ * \param[in] data SELECT APDU.
+ * \param[in] data_len Number of bytes in \p data.
+ * \param[out] response Buffer to store newly allocated response APDU in.
+ * \param[out] response_len Buffer to store number of bytes in \p response in.
+ * \return ifx_status_t \c IFX_SUCCESS if the APDU was exchanged (check status word in \p response), any other value in case of error.
+ */
+static ifx_status_t nbt_daemon_select(NbtDaemonTag *tag, NbtDaemonCommandType type, const uint8_t *data, size_t data_len, uint8_t **response,
+                                      size_t *response_len)
+{
+    ifx_status_t status = nbt_daemon_exchange(tag, data, data_len, response, response_len);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    if (!nbt_daemon_is_success(*response, *response_len))
+    {
+        // Failed SELECT keeps the previous selection, but trust it no further
+        tag->selection_known = false;
+        return IFX_SUCCESS;
+    }
+    uint8_t *copy = malloc(*response_len);
+    if (copy != NULL)
+    {
+        memcpy(copy, *response, *response_len);
+    }
+    if (type == NBT_DAEMON_COMMAND_SELECT_APPLICATION)
+    {
+        memcpy(tag->selection.application, data, data_len);
+        tag->selection.application_len = data_len;
+        tag->selection.file_len = 0U;
+        free(tag->application_response);
+        tag->application_response = copy;
+        tag->application_response_len = *response_len;
+        tag->selection_known = (copy != NULL);
+    }
+    else
+    {
+        memcpy(tag->selection.file, data, data_len);
+        tag->selection.file_len = data_len;
+        free(tag->file_response);
+        tag->file_response = copy;
+        tag->file_response_len = *response_len;
+        tag->selection_known = tag->selection_known && (copy != NULL);
+    }
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Re-issues SELECTs so that the tag state matches the selection of a client.
+ *
+ * \param[in] tag Tag to restore selection on.
+ * \param[in] wanted Selection of the client.
+ * \param[in] include_file Whether the selected file has to match as well.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+static ifx_status_t nbt_daemon_restore(NbtDaemonTag *tag, const NbtDaemonSelection *wanted, bool include_file)
+{
+    if ((wanted->application_len == 0U) && (wanted->file_len == 0U))
+    {
+        // Client never selected anything, so it cannot expect a particular state
+        return IFX_SUCCESS;
+    }
+    bool application_ok = tag->selection_known && (tag->selection.application_len == wanted->application_len) &&
+                          (memcmp(tag->selection.application, wanted->application, wanted->application_len) == 0);
+    bool file_ok = application_ok && (tag->selection.file_len == wanted->file_len) &&
+                   (memcmp(tag->selection.file, wanted->file, wanted->file_len) == 0);
+    if (application_ok && (file_ok || !include_file))
+    {
+        return IFX_SUCCESS;
+    }
+
+    uint8_t *response = NULL;
+    size_t response_len = 0U;
+    if ((!application_ok || (wanted->file_len == 0U)) && (wanted->application_len > 0U))
+    {
+        tag->replayed_selects++;
+        ifx_status_t status = nbt_daemon_select(tag, NBT_DAEMON_COMMAND_SELECT_APPLICATION, wanted->application, wanted->application_len, &response,
+                                                &response_len);
+        bool success = !ifx_error_check(status) && nbt_daemon_is_success(response, response_len);
+        free(response);
+        if (ifx_error_check(status))
+        {
+            return status;
+        }
+        if (!success)
+        {
+            return IFX_ERROR(LIBNBTCLIENT, IFX_PROTOCOL_TRANSCEIVE, IFX_UNSPECIFIED_ERROR);
+        }
+    }
+    if (include_file && (wanted->file_len > 0U))
+    {
+        tag->replayed_selects++;
+        ifx_status_t status = nbt_daemon_select(tag, NBT_DAEMON_COMMAND_SELECT_FILE, wanted->file, wanted->file_len, &response, &response_len);
+        bool success = !ifx_error_check(status) && nbt_daemon_is_success(response, response_len);
+        free(response);
+        if (ifx_error_check(status))
+        {
+            return status;
+        }
+        if (!success)
+        {
+            return IFX_ERROR(LIBNBTCLIENT, IFX_PROTOCOL_TRANSCEIVE, IFX_UNSPECIFIED_ERROR);
+        }
+    }
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Executes SELECT request of a client.
+ *
+ * \param[in] tag Tag to execute request on.
+ * \param[in] index Index of tag.
+ * \param[in] request Request to be executed.
+ * \param[in] type Kind of SELECT.
+ */
+static void nbt_daemon_handle_select(NbtDaemonTag *tag, size_t index, NbtDaemonRequest *request, NbtDaemonCommandType type)
+{
+    NbtDaemonSelection *selection = &tag->context->clients[request->client].selection[index];
+    NbtDaemonSelection next = *selection;
+    if (type == NBT_DAEMON_COMMAND_SELECT_APPLICATION)
+    {
+        memcpy(next.application, request->data, request->data_len);
+        next.application_len = request->data_len;
+        next.file_len = 0U;
+    }
+    else
+    {
+        memcpy(next.file, request->data, request->data_len);
+        next.file_len = request->data_len;
+    }
+
+    // Tag already in requested state, answer with response of the SELECT that got it there
+    if (tag->selection_known && !tag->needs_activation && nbt_daemon_selection_equal(&tag->selection, &next))
+    {
+        *selection = next;
+        tag->skipped_selects++;
+        if (type == NBT_DAEMON_COMMAND_SELECT_APPLICATION)
+        {
+            nbt_daemon_respond(tag->context, request->client, IFX_SUCCESS, tag->application_response, tag->application_response_len, true);
+        }
+        else
+        {
+            nbt_daemon_respond(tag->context, request->client, IFX_SUCCESS, tag->file_response, tag->file_response_len, true);
+        }
+        return;
+    }
+
+    // Files are selected within the client's application
+    ifx_status_t status = IFX_SUCCESS;
+    if (type == NBT_DAEMON_COMMAND_SELECT_FILE)
+    {
+        status = nbt_daemon_restore(tag, selection, false);
+    }
+    uint8_t *response = NULL;
+    size_t response_len = 0U;
+    if (!ifx_error_check(status))
+    {
+        status = nbt_daemon_select(tag, type, request->data, request->data_len, &response, &response_len);
+    }
+    if (!ifx_error_check(status) && nbt_daemon_is_success(response, response_len))
+    {
+        *selection = next;
+    }
+    nbt_daemon_respond(tag->context, request->client, status, response, response_len, true);
+    free(response);
+}
+
+/**
+ * \brief Executes command request of a client and answers identical queued reads with the same response.
+ *
+ * \param[in] tag Tag to execute request on.
+ * \param[in] index Index of tag.
+ * \param[in] request Request to be executed.
+ * \param[in] type Kind of command.
+ */
+static void nbt_daemon_handle_command(NbtDaemonTag *tag, size_t index, NbtDaemonRequest *request, NbtDaemonCommandType type)
+{
+    const NbtDaemonSelection *selection = &tag->context->clients[request->client].selection[index];
+    ifx_status_t status = nbt_daemon_restore(tag, selection, true);
+    uint8_t *response = NULL;
+    size_t response_len = 0U;
+    if (!ifx_error_check(status))
+    {
+        status = nbt_daemon_exchange(tag, request->data, request->data_len, &response, &response_len);
+    }
+    nbt_daemon_respond(tag->context, request->client, status, response, response_len, true);
+
+    // Merge reads of the same range by clients with the same selection until something may modify the file
+    if ((type == NBT_DAEMON_COMMAND_READ_BINARY) && !ifx_error_check(status))
+    {
+        for (NbtDaemonRequest *other = request->next; other != NULL; other = other->next)
+        {
+            if (other->done || (other->type != NBT_CLIENT_REQUEST_TRANSCEIVE))
+            {
+                continue;
+            }
+            NbtDaemonCommandType other_type = nbt_daemon_parse(other->data, other->data_len);
+            if (other_type == NBT_DAEMON_COMMAND_OTHER)
+            {
+                break;
+            }
+            if ((other_type == NBT_DAEMON_COMMAND_READ_BINARY) && (other->data_len == request->data_len) &&
+                (memcmp(other->data, request->data, request->data_len) == 0) &&
+                nbt_daemon_selection_equal(&tag->context->clients[other->client].selection[index], selection))
+            {
+                nbt_daemon_respond(tag->context, other->client, status, response, response_len, true);
+                other->done = true;
+                tag->merged_reads++;
+                tag->requests++;
+            }
+        }
+    }
+    free(response);
+}
+
+/**
+ * \brief Worker thread executing the queued requests of a tag in batches.
+ *
+ * \param[in] arg \ref NbtDaemonTag served by this thread.
+ * \return void* Always \c NULL.
+ */
+static void *nbt_daemon_worker(void *arg)
+{
+    NbtDaemonTag *tag = (NbtDaemonTag *) arg;
+    size_t index = (size_t) (tag - tag->context->tags);
+    pthread_setname_np(pthread_self(), "nbt-daemon");
+    for (;;)
+    {
+        // Take everything queued so far as one batch
+        pthread_mutex_lock(&tag->lock);
+        while ((tag->head == NULL) && !tag->stopping)
+        {
+            pthread_cond_wait(&tag->queued, &tag->lock);
+        }
+        NbtDaemonRequest *batch = tag->head;
+        tag->head = NULL;
+        tag->tail = NULL;
+        bool stopping = tag->stopping;
+        pthread_mutex_unlock(&tag->lock);
+        if (batch == NULL)
+        {
+            break;
+        }
+        tag->batches++;
+
+        for (NbtDaemonRequest *request = batch; request != NULL; request = request->next)
+        {
+            if (request->done)
+            {
+                continue;
+            }
+            tag->requests++;
+            if (stopping)
+            {
+                nbt_daemon_respond(tag->context, request->client, IFX_ERROR(LIBNBTCLIENT, IFX_PROTOCOL_TRANSCEIVE, NBT_CLIENT_CONNECTION_ERROR), NULL,
+                                   0U, true);
+            }
+            else if (request->type == NBT_CLIENT_REQUEST_ACTIVATE)
+            {
+                nbt_daemon_respond(tag->context, request->client, IFX_SUCCESS, tag->cip, tag->cip_len, true);
+            }
+            else
+            {
+                NbtDaemonCommandType type = nbt_daemon_parse(request->data, request->data_len);
+                if ((type == NBT_DAEMON_COMMAND_SELECT_APPLICATION) || (type == NBT_DAEMON_COMMAND_SELECT_FILE))
+                {
+                    nbt_daemon_handle_select(tag, index, request, type);
+                }
+                else
+                {
+                    nbt_daemon_handle_command(tag, index, request, type);
+                }
+            }
+            request->done = true;
+        }
+        while (batch != NULL)
+        {
+            NbtDaemonRequest *next = batch->next;
+            free(batch->data);
+            free(batch);
+            batch = next;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * \brief Opens and activates a tag.
+ *
+ * \param[in,out] tag Tag with \ref NbtDaemonTag.device and \ref NbtDaemonTag.address set.
+ * \param[in] simulated Whether a simulated tag is used instead of the I2C device.
+ * \param[in] processing_time_us Processing time per block of simulated tags in [us].
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+static ifx_status_t nbt_daemon_open_tag(NbtDaemonTag *tag, bool simulated, uint32_t processing_time_us)
+{
+    tag->fd = open(simulated ? "/dev/null" : tag->device, O_RDWR | O_CLOEXEC);
+    if (tag->fd < 0)
+    {
+        perror(tag->device);
+        return IFX_ERROR(LIBI2CRPI, IFX_PROTOCOL_LAYER_INITIALIZE, IFX_UNSPECIFIED_ERROR);
+    }
+    ifx_status_t status = i2c_rpi_initialize(&tag->driver_adapter, tag->fd, tag->address);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    if (simulated)
+    {
+        i2c_rpi_backend_t backend;
+        status = nbt_sim_initialize(&backend, processing_time_us);
+        if (!ifx_error_check(status))
+        {
+            status = i2c_rpi_set_backend(&tag->driver_adapter, &backend);
+        }
+    }
+    if (!ifx_error_check(status))
+    {
+        status = ifx_t1prime_initialize(&tag->protocol, &tag->driver_adapter);
+        tag->stack_initialized = !ifx_error_check(status);
+    }
+    if (!tag->stack_initialized)
+    {
+        ifx_protocol_destroy(&tag->driver_adapter);
+        return status;
+    }
+    return ifx_protocol_activate(&tag->protocol, &tag->cip, &tag->cip_len);
+}
+
+/**
+ * \brief Releases everything held for a tag.
+ *
+ * \param[in] tag Tag to be closed.
+ */
+static void nbt_daemon_close_tag(NbtDaemonTag *tag)
+{
+    if (tag->stack_initialized)
+    {
+        ifx_protocol_destroy(&tag->protocol);
+    }
+    if (tag->fd >= 0)
+    {
+        close(tag->fd);
+    }
+    free(tag->cip);
+    free(tag->application_response);
+    free(tag->file_response);
+}
+
+/**
+ * \brief Reads request of a client and queues it at its tag.
+ *
+ * \param[in] context Daemon state.
+ * \param[in] client Index of client with pending input.
+ * \return bool \c false if the connection has to be closed.
+ */
+static bool nbt_daemon_receive(NbtDaemonContext *context, size_t client)
+{
+    int fd = context->clients[client].fd;
+    nbt_client_request_header_t header;
+    if (recv(fd, &header, sizeof(header), MSG_WAITALL) != (ssize_t) sizeof(header))
+    {
+        return false;
+    }
+    if ((header.reserved != 0U) || (header.data_len > NBT_CLIENT_MAX_DATA_LEN) ||
+        ((header.type != NBT_CLIENT_REQUEST_TRANSCEIVE) && (header.type != NBT_CLIENT_REQUEST_ACTIVATE)))
+    {
+        return false;
+    }
+    NbtDaemonRequest *request = calloc(1U, sizeof(NbtDaemonRequest));
+    uint8_t *data = (header.data_len > 0U) ? malloc(header.data_len) : NULL;
+    if ((request == NULL) || ((header.data_len > 0U) && (data == NULL)))
+    {
+        free(request);
+        free(data);
+        return false;
+    }
+    if ((header.data_len > 0U) && (recv(fd, data, header.data_len, MSG_WAITALL) != (ssize_t) header.data_len))
+    {
+        free(request);
+        free(data);
+        return false;
+    }
+    request->client = client;
+    request->type = header.type;
+    request->data = data;
+    request->data_len = header.data_len;
+
+    // Well-formed but unserviceable requests are answered right away
+    bool valid = (header.tag < context->tag_count) &&
+                 ((header.type == NBT_CLIENT_REQUEST_ACTIVATE) ? (header.data_len == 0U) : (header.data_len >= 4U));
+    if (!valid)
+    {
+        nbt_daemon_respond(context, client, IFX_ERROR(LIBNBTCLIENT, IFX_PROTOCOL_TRANSCEIVE, IFX_ILLEGAL_ARGUMENT), NULL, 0U, false);
+        free(request->data);
+        free(request);
+        return true;
+    }
+
+    NbtDaemonTag *tag = &context->tags[header.tag];
+    context->clients[client].pending = true;
+    pthread_mutex_lock(&tag->lock);
+    if (tag->tail != NULL)
+    {
+        tag->tail->next = request;
+    }
+    else
+    {
+        tag->head = request;
+    }
+    tag->tail = request;
+    pthread_cond_signal(&tag->queued);
+    pthread_mutex_unlock(&tag->lock);
+    return true;
+}
+
+/**
+ * \brief Accepts new client if a slot is free.
+ *
+ * \param[in] context Daemon state.
+ * \param[in] listener Listening socket.
+ */
+static void nbt_daemon_accept(NbtDaemonContext *context, int listener)
+{
+    int fd = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+    if (fd < 0)
+    {
+        return;
+    }
+    for (size_t i = 0U; i < NBT_DAEMON_MAX_CLIENTS; i++)
+    {
+        if (context->clients[i].fd < 0)
+        {
+            // Neither request nor response may stall the daemon indefinitely
+            struct timeval timeout = {.tv_sec = NBT_DAEMON_SOCKET_TIMEOUT_MS / 1000U, .tv_usec = (NBT_DAEMON_SOCKET_TIMEOUT_MS % 1000U) * 1000U};
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            memset(&context->clients[i], 0, sizeof(NbtDaemonClient));
+            context->clients[i].fd = fd;
+            return;
+        }
+    }
+    fprintf(stderr, "Too many clients, connection refused\n");
+    close(fd);
+}
+
+int main(int argc, char *argv[])
+{
+    static NbtDaemonContext context;
+    const char *socket_path = NBT_CLIENT_DEFAULT_SOCKET_PATH;
+    bool simulated = false;
+    unsigned long processing_time_us = 0U;
+
+    int option;
+    bool valid = true;
+    while (valid && ((option = getopt(argc, argv, "sp:l:h")) != -1))
+    {
+        switch (option)
+        {
+        case 's':
+            simulated = true;
+            break;
+        case 'p':
+            valid = nbt_daemon_parse_number(optarg, UINT32_MAX, &processing_time_us);
+            break;
+        case 'l':
+            socket_path = optarg;
+            break;
+        default:
+            valid = false;
+            break;
+        }
+    }
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    valid = valid && (optind < argc) && ((size_t) (argc - optind) <= NBT_DAEMON_MAX_TAGS) && (strlen(socket_path) < sizeof(address.sun_path));
+    for (int i = optind; valid && (i < argc); i++)
+    {
+        NbtDaemonTag *tag = &context.tags[context.tag_count++];
+        tag->fd = -1;
+        tag->context = &context;
+        char *separator = strrchr(argv[i], ':');
+        unsigned long tag_address = 0U;
+        valid = (separator != NULL) && nbt_daemon_parse_number(separator + 1, 0x7fU, &tag_address);
+        if (valid)
+        {
+            *separator = '\0';
+            tag->device = argv[i];
+            tag->address = (uint8_t) tag_address;
+        }
+    }
+    if (!valid)
+    {
+        nbt_daemon_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0U; i < NBT_DAEMON_MAX_CLIENTS; i++)
+    {
+        context.clients[i].fd = -1;
+    }
+
+    // Activate all tags before accepting clients
+    int rc = EXIT_FAILURE;
+    size_t opened = 0U;
+    for (; opened < context.tag_count; opened++)
+    {
+        ifx_status_t status = nbt_daemon_open_tag(&context.tags[opened], simulated, (uint32_t) processing_time_us);
+        if (ifx_error_check(status))
+        {
+            fprintf(stderr, "Could not activate tag %zu (%s:0x%02x): 0x%08x\n", opened, context.tags[opened].device,
+                    (unsigned) context.tags[opened].address, (unsigned) status);
+            nbt_daemon_close_tag(&context.tags[opened]);
+            break;
+        }
+    }
+    int listener = -1;
+    if (opened == context.tag_count)
+    {
+        address.sun_family = AF_UNIX;
+        strcpy(address.sun_path, socket_path);
+
+        // Remove stale socket of a previous run, but never any other file
+        struct stat file_stat;
+        if ((lstat(socket_path, &file_stat) == 0) && S_ISSOCK(file_stat.st_mode))
+        {
+            unlink(socket_path);
+        }
+        listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if ((listener < 0) || (bind(listener, (const struct sockaddr *) &address, sizeof(address)) != 0) ||
+            (listen(listener, (int) NBT_DAEMON_MAX_CLIENTS) != 0))
+        {
+            perror(socket_path);
+        }
+        else if (pipe2(context.answered, O_CLOEXEC | O_NONBLOCK) != 0)
+        {
+            perror("pipe2");
+        }
+        else
+        {
+            rc = EXIT_SUCCESS;
+        }
+    }
+    if (rc != EXIT_SUCCESS)
+    {
+        if (listener >= 0)
+        {
+            close(listener);
+        }
+        for (size_t i = 0U; i < opened; i++)
+        {
+            nbt_daemon_close_tag(&context.tags[i]);
+        }
+        return EXIT_FAILURE;
+    }
+
+    // Workers inherit the blocked signals, only ppoll() below receives them
+    sigset_t blocked;
+    sigset_t unblocked;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &blocked, &unblocked);
+    sigdelset(&unblocked, SIGINT);
+    sigdelset(&unblocked, SIGTERM);
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &action, NULL);
+    action.sa_handler = nbt_daemon_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    size_t started = 0U;
+    for (; started < context.tag_count; started++)
+    {
+        NbtDaemonTag *tag = &context.tags[started];
+        pthread_mutex_init(&tag->lock, NULL);
+        pthread_cond_init(&tag->queued, NULL);
+        if (pthread_create(&tag->thread, NULL, nbt_daemon_worker, tag) != 0)
+        {
+            fprintf(stderr, "Could not start worker for tag %zu\n", started);
+            pthread_cond_destroy(&tag->queued);
+            pthread_mutex_destroy(&tag->lock);
+            rc = EXIT_FAILURE;
+            break;
+        }
+    }
+
+    // Only clients without pending request are polled, so each has at most one queued request
+    while (rc == EXIT_SUCCESS)
+    {
+        struct pollfd fds[2U + NBT_DAEMON_MAX_CLIENTS];
+        size_t clients[NBT_DAEMON_MAX_CLIENTS];
+        nfds_t count = 0U;
+        fds[count++] = (struct pollfd){.fd = listener, .events = POLLIN};
+        fds[count++] = (struct pollfd){.fd = context.answered[0], .events = POLLIN};
+        for (size_t i = 0U; i < NBT_DAEMON_MAX_CLIENTS; i++)
+        {
+            if ((context.clients[i].fd >= 0) && !context.clients[i].pending)
+            {
+                clients[count - 2U] = i;
+                fds[count++] = (struct pollfd){.fd = context.clients[i].fd, .events = POLLIN};
+            }
+        }
+        if (ppoll(fds, count, NULL, &unblocked) < 0)
+        {
+            if (errno != EINTR)
+            {
+                perror("ppoll");
+            }
+            break;
+        }
+        if ((fds[1].revents & POLLIN) != 0)
+        {
+            uint32_t answered;
+            while (read(context.answered[0], &answered, sizeof(answered)) == (ssize_t) sizeof(answered))
+            {
+                context.clients[answered].pending = false;
+            }
+        }
+        for (nfds_t i = 2U; i < count; i++)
+        {
+            size_t client = clients[i - 2U];
+            if ((fds[i].revents != 0) && !nbt_daemon_receive(&context, client))
+            {
+                close(context.clients[client].fd);
+                context.clients[client].fd = -1;
+            }
+        }
+        if ((fds[0].revents & POLLIN) != 0)
+        {
+            nbt_daemon_accept(&context, listener);
+        }
+    }
+
+    // Queued requests are answered with an error before the workers exit
+    for (size_t i = 0U; i < started; i++)
+    {
+        NbtDaemonTag *tag = &context.tags[i];
+        pthread_mutex_lock(&tag->lock);
+        tag->stopping = true;
+        pthread_cond_signal(&tag->queued);
+        pthread_mutex_unlock(&tag->lock);
+        pthread_join(tag->thread, NULL);
+        pthread_cond_destroy(&tag->queued);
+        pthread_mutex_destroy(&tag->lock);
+    }
+    close(listener);
+    unlink(socket_path);
+    for (size_t i = 0U; i < NBT_DAEMON_MAX_CLIENTS; i++)
+    {
+        if (context.clients[i].fd >= 0)
+        {
+            close(context.clients[i].fd);
+        }
+    }
+    close(context.answered[0]);
+    close(context.answered[1]);
+
+    for (size_t i = 0U; i < context.tag_count; i++)
+    {
+        NbtDaemonTag *tag = &context.tags[i];
+        printf("{\"tag\":%zu,\"device\":\"", i);
+        for (const char *c = tag->device; *c != '\0'; c++)
+        {
+            if ((*c == '"') || (*c == '\\'))
+            {
+                putchar('\\');
+            }
+            if ((unsigned char) *c >= 0x20U)
+            {
+                putchar(*c);
+            }
+        }
+        printf("\",\"address\":\"0x%02x\",\"requests\":%llu,\"batches\":%llu,\"transactions\":%llu,\"merged_reads\":%llu,"
+               "\"skipped_selects\":%llu,\"replayed_selects\":%llu}\n",
+               (unsigned) tag->address, (unsigned long long) tag->requests, (unsigned long long) tag->batches,
+               (unsigned long long) tag->transactions, (unsigned long long) tag->merged_reads, (unsigned long long) tag->skipped_selects,
+               (unsigned long long) tag->replayed_selects);
+        nbt_daemon_close_tag(tag);
+    }
+    fflush(stdout);
+    return rc;
+}
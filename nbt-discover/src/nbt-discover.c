@@ -0,0 +1,188 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-discover.c
+ * \brief Command line tool finding NBTs on all I2C adapters in parallel.
+ *
+ * \details Usage: nbt-discover [-a first-last] [-t ms] [-n] [device...]
+ *
+ * Without devices all \c /dev/i2c-N adapters are scanned, each by its own
+ * thread. Every acknowledging address is activated via GP T=1' to tell NBTs
+ * from other devices, except for the EEPROM ranges 0x30 to 0x37 and 0x50 to
+ * 0x5f unless an address range is given explicitly. One JSON line per device is printed, followed by a
+ * summary line. The exit status is \c 0 if at least one NBT (or with \c -n
+ * any device) was found.
+ */
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/i2c-discovery.h"
+
+/**
+ * \brief Prints usage information.
+ *
+ * \param[in] program Name of the executable.
+ */
+static void nbt_discover_usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [-a first-last] [-t ms] [-n] [device...]\n"
+            "  -a first-last  7 bit address range to be probed and activated including EEPROM ranges\n"
+            "                 (default 0x%02x-0x%02x, activation skips 0x30-0x37 and 0x50-0x5f)\n"
+            "  -t ms          abort scan of adapters with probes slower than ms (default %u)\n"
+            "  -n             only probe addresses, no GP T=1' activation\n"
+            "devices default to all /dev/i2c-N\n",
+            program, I2C_DISCOVERY_DEFAULT_FIRST_ADDRESS, I2C_DISCOVERY_DEFAULT_LAST_ADDRESS, I2C_DISCOVERY_DEFAULT_TIMEOUT_MS);
+}
+
+/**
+ * \brief Parses unsigned number (decimal or \c 0x prefixed).
+ *
+ * \param[in] text Text to be parsed.
+ * \param[in] max Maximum accepted value.
+ * \param[out] value Buffer to store value in.
+ * \param[out] end Buffer to store position after number in (\c NULL if the whole text must be a number).
+ * \return bool \c true if successful.
+ */
+static bool nbt_discover_parse_number(const char *text, unsigned long max, unsigned long *value, const char **end)
+{
+    char *parsed_end = NULL;
+    unsigned long parsed = strtoul(text, &parsed_end, 0);
+    if ((parsed_end == text) || (text[0] == '-') || (parsed > max) || ((end == NULL) && (*parsed_end != '\0')))
+    {
+        return false;
+    }
+    if (end != NULL)
+    {
+        *end = parsed_end;
+    }
+    *value = parsed;
+    return true;
+}
+
+/**
+ * \brief Parses address range \c first-last.
+ *
+ * \param[in] text Text to be parsed.
+ * \param[out] options Scan settings to store range in.
+ * \return bool \c true if successful.
+ */
+static bool nbt_discover_parse_range(const char *text, i2c_discovery_options_t *options)
+{
+    unsigned long first = 0U;
+    unsigned long last = 0U;
+    const char *end = NULL;
+    if (!nbt_discover_parse_number(text, 0x7fU, &first, &end) || (*end != '-') || !nbt_discover_parse_number(&end[1], 0x7fU, &last, NULL) ||
+        (first == 0U) || (first > last))
+    {
+        return false;
+    }
+    options->first_address = (uint8_t) first;
+    options->last_address = (uint8_t) last;
+    return true;
+}
+
+/**
+ * \brief Prints JSON line of a single device.
+ *
+ * \param[in] device Acknowledging device.
+ * \param[in] activate Whether activation was requested for the scan.
+ */
+static void nbt_discover_report(const i2c_discovery_device_t *device, bool activate)
+{
+    printf("{\"device\":\"");
+    for (const char *c = device->device; *c != '\0'; c++)
+    {
+        if ((*c == '"') || (*c == '\\'))
+        {
+            putchar('\\');
+        }
+        if ((unsigned char) *c >= 0x20U)
+        {
+            putchar(*c);
+        }
+    }
+    printf("\",\"address\":\"0x%02x\",\"probe_us\":%.1f", (unsigned) device->address, (double) device->probe_ns / 1e3);
+    if (device->activated)
+    {
+        bool nbt = !ifx_error_check(device->activation_status);
+        printf(",\"nbt\":%s,\"status\":\"0x%08x\",\"activation_ms\":%.3f,\"cip\":\"", nbt ? "true" : "false", (unsigned) device->activation_status,
+               (double) device->activation_ns / 1e6);
+        for (size_t i = 0U; i < device->cip_len; i++)
+        {
+            printf("%02x", device->cip[i]);
+        }
+        putchar('"');
+    }
+    else if (activate)
+    {
+        printf(",\"activation\":\"skipped\"");
+    }
+    printf("}\n");
+}
+
+int main(int argc, char *argv[])
+{
+    i2c_discovery_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.activate = true;
+
+    int option;
+    bool valid = true;
+    unsigned long timeout_ms = 0U;
+    while (valid && ((option = getopt(argc, argv, "a:t:nh")) != -1))
+    {
+        switch (option)
+        {
+        case 'a':
+            valid = nbt_discover_parse_range(optarg, &options);
+            options.activate_eeprom_ranges = true;
+            break;
+        case 't':
+            valid = nbt_discover_parse_number(optarg, UINT32_MAX, &timeout_ms, NULL) && (timeout_ms != 0U);
+            break;
+        case 'n':
+            options.activate = false;
+            break;
+        default:
+            valid = false;
+            break;
+        }
+    }
+    if (!valid)
+    {
+        nbt_discover_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    options.timeout_ms = (uint32_t) timeout_ms;
+
+    const char *const *devices = (optind < argc) ? (const char *const *) &argv[optind] : NULL;
+    i2c_discovery_report_t report;
+    memset(&report, 0, sizeof(report));
+    ifx_status_t status = i2c_discovery_scan(devices, (size_t) (argc - optind), &options, &report);
+    if (ifx_error_check(status) && (report.adapter_count == 0U))
+    {
+        fprintf(stderr, "No I2C adapter could be scanned (0x%08x)\n", (unsigned) status);
+        return EXIT_FAILURE;
+    }
+
+    size_t tags = 0U;
+    for (size_t i = 0U; i < report.device_count; i++)
+    {
+        nbt_discover_report(&report.devices[i], options.activate);
+        tags += (report.devices[i].activated && !ifx_error_check(report.devices[i].activation_status)) ? 1U : 0U;
+    }
+    printf("{\"summary\":{\"adapters\":%zu,\"failed_adapters\":%zu,\"slow_adapters\":%zu,\"probes\":%zu,\"busy_addresses\":%zu,\"devices\":%zu,\"tags\":%zu,"
+           "\"elapsed_ms\":%.3f}}\n",
+           report.adapter_count, report.failed_adapters, report.slow_adapters, report.probes, report.busy_addresses, report.device_count, tags,
+           (double) report.elapsed_ns / 1e6);
+    bool found = options.activate ? (tags > 0U) : (report.device_count > 0U);
+    i2c_discovery_free(&report);
+    return found ? EXIT_SUCCESS : EXIT_FAILURE;
+}
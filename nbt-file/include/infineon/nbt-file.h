@@ -0,0 +1,225 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/nbt-file.h
+ * \brief Transfer engine reading and writing NBT files with as few APDUs as possible.
+ */
+#ifndef INFINEON_NBT_FILE_H
+#define INFINEON_NBT_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief IFX status code module identifier.
+ */
+#define LIBNBTFILE 0x3BU
+
+/**
+ * \brief IFX status encoding function identifier for nbt_file_initialize().
+ */
+#define IFX_NBT_FILE_INITIALIZE (0x01U)
+
+/**
+ * \brief IFX status encoding function identifier for nbt_file_read().
+ */
+#define IFX_NBT_FILE_READ (0x02U)
+
+/**
+ * \brief IFX status encoding function identifier for nbt_file_write().
+ */
+#define IFX_NBT_FILE_WRITE (0x03U)
+
+/**
+ * \brief IFX status encoding function identifier for nbt_file_set_read_ahead().
+ */
+#define IFX_NBT_FILE_SET_READ_AHEAD (0x04U)
+
+/**
+ * \brief Error reason if the tag rejected a command (status word other than \c 9000).
+ */
+#define NBT_FILE_STATUS_WORD_ERROR (0x01U)
+
+/**
+ * \brief File ID to transfer data of the currently selected file without SELECT.
+ */
+#define NBT_FILE_SELECTED 0x0000U
+
+/**
+ * \brief Data bytes per APDU tried first if not configured otherwise.
+ */
+#define NBT_FILE_DEFAULT_MAX_DATA_LEN 4096U
+
+/**
+ * \brief Information field size of the tag assumed if no CIP is given in [bytes].
+ */
+#define NBT_FILE_DEFAULT_IFSC 254U
+
+/**
+ * \brief Data bytes per UPDATE BINARY with short length encoding.
+ */
+#define NBT_FILE_MAX_SHORT_UPDATE_LEN 255U
+
+/**
+ * \brief Data bytes per READ BINARY with short length encoding.
+ */
+#define NBT_FILE_MAX_SHORT_READ_LEN 256U
+
+/** \struct nbt_file_t
+ * \brief Transfer engine and the APDU limits it learned.
+ */
+typedef struct
+{
+    /**
+     * \brief Protocol stack used for transfers.
+     */
+    ifx_protocol_t *protocol;
+
+    /**
+     * \brief Information field size of the tag (from CIP) in [bytes].
+     */
+    size_t ifsc;
+
+    /**
+     * \brief Data bytes per READ BINARY currently used.
+     *
+     * \details Lowered when the tag answers \c 6700 (wrong length) and kept for later transfers.
+     */
+    size_t max_read_len;
+
+    /**
+     * \brief Data bytes per UPDATE BINARY currently used.
+     *
+     * \details Lowered when the tag answers \c 6700 (wrong length) and kept for later transfers.
+     */
+    size_t max_update_len;
+
+    /**
+     * \brief Read-ahead state (\c NULL while read-ahead is disabled).
+     *
+     * \details Managed by nbt_file_set_read_ahead(), not to be accessed directly.
+     */
+    void *read_ahead;
+} nbt_file_t;
+
+/** \struct nbt_file_transfer_stats_t
+ * \brief Result of a single transfer.
+ */
+typedef struct
+{
+    /**
+     * \brief Data bytes transferred.
+     */
+    size_t bytes;
+
+    /**
+     * \brief Data bytes of \ref bytes served from the read-ahead buffer without waiting for the tag.
+     */
+    size_t read_ahead_bytes;
+
+    /**
+     * \brief APDUs exchanged (including SELECT and rejected APDUs).
+     */
+    size_t apdus;
+
+    /**
+     * \brief GP T=1' information blocks needed for all APDUs and responses at the learned IFSC.
+     */
+    size_t blocks;
+
+    /**
+     * \brief Duration of the transfer in [ns].
+     */
+    uint64_t elapsed_ns;
+
+    /**
+     * \brief Throughput in [bytes/s].
+     */
+    double bytes_per_second;
+} nbt_file_transfer_stats_t;
+
+/**
+ * \brief Initializes file transfer engine.
+ *
+ * \details The IFSC of the tag is taken from the communication interface
+ * parameters returned by ifx_protocol_activate(). Transfers start with
+ * \p max_data_len bytes per APDU (using extended length encoding where
+ * required). Whenever the tag rejects an APDU as too long, the limit is
+ * halved down to short length encoding and the APDU is repeated, so the
+ * largest supported size is learned within the first transfers.
+ *
+ * \param[out] self Transfer engine to be initialized.
+ * \param[in] protocol Activated protocol stack.
+ * \param[in] cip Communication interface parameters from activation (\c NULL for \ref NBT_FILE_DEFAULT_IFSC).
+ * \param[in] cip_len Number of bytes in \p cip.
+ * \param[in] max_data_len Data bytes per APDU tried first (\c 0 for \ref NBT_FILE_DEFAULT_MAX_DATA_LEN).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_file_initialize(nbt_file_t *self, ifx_protocol_t *protocol, const uint8_t *cip, size_t cip_len, size_t max_data_len);
+
+/**
+ * \brief Reads data of a file into caller supplied buffer.
+ *
+ * \details Response data of each READ BINARY is copied directly to its
+ * final position in \p buffer.
+ *
+ * \param[in] self Transfer engine.
+ * \param[in] fid File to be read (\ref NBT_FILE_SELECTED for currently selected file).
+ * \param[in] offset Offset in file.
+ * \param[out] buffer Buffer to store data in.
+ * \param[in] len Number of bytes to be read.
+ * \param[out] stats Optional buffer to store transfer statistics in (also set in case of error).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, \c IFX_TOO_LITTLE_DATA if file ended early, any other value in case of error.
+ *
+ * \see nbt_file_set_read_ahead()
+ */
+ifx_status_t nbt_file_read(nbt_file_t *self, uint16_t fid, size_t offset, uint8_t *buffer, size_t len, nbt_file_transfer_stats_t *stats);
+
+/**
+ * \brief Writes data to a file.
+ *
+ * \param[in] self Transfer engine.
+ * \param[in] fid File to be written (\ref NBT_FILE_SELECTED for currently selected file).
+ * \param[in] offset Offset in file.
+ * \param[in] data Data to be written.
+ * \param[in] len Number of bytes in \p data.
+ * \param[out] stats Optional buffer to store transfer statistics in (also set in case of error).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_file_write(nbt_file_t *self, uint16_t fid, size_t offset, const uint8_t *data, size_t len, nbt_file_transfer_stats_t *stats);
+
+/**
+ * \brief Enables or disables read-ahead for sequential reads.
+ *
+ * \details Once a call to nbt_file_read() continues the same file at the
+ * offset where the previous one ended, the engine reads the next chunk of
+ * the same size on a helper thread while the application processes the
+ * current one. A following nbt_file_read() of that data is served from the
+ * buffer, any other call first waits for the pending read to finish.
+ * Read-ahead never reads beyond \p file_len or the end of file reported by
+ * the tag.
+ *
+ * While enabled, the protocol stack is used by the helper thread in the
+ * background, so it must only be accessed via this engine and the engine
+ * must not be moved. Read-ahead must be disabled before the engine or the
+ * protocol stack are destroyed.
+ *
+ * \param[in,out] self Transfer engine.
+ * \param[in] file_len Size of files read sequentially in [bytes] (\c 0 to disable read-ahead).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_file_set_read_ahead(nbt_file_t *self, size_t file_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_NBT_FILE_H
@@ -0,0 +1,664 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-file.c
+ * \brief Transfer engine reading and writing NBT files with as few APDUs as possible.
+ */
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/nbt-file.h"
+#include "nbt-file.h"
+
+/**
+ * \brief Returns current \c CLOCK_MONOTONIC time in [ns].
+ *
+ * \return uint64_t Current time in [ns].
+ */
+static uint64_t nbt_file_get_time_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * \brief Completes transfer statistics.
+ *
+ * \param[in,out] stats Transfer statistics.
+ * \param[in] start_ns \c CLOCK_MONOTONIC time in [ns] at start of transfer.
+ */
+static void nbt_file_finish_stats(nbt_file_transfer_stats_t *stats, uint64_t start_ns)
+{
+    stats->elapsed_ns = nbt_file_get_time_ns() - start_ns;
+    stats->bytes_per_second = (stats->elapsed_ns > 0U) ? (((double) stats->bytes * 1e9) / (double) stats->elapsed_ns) : 0.0;
+}
+
+/**
+ * \brief Waits until no chunk is read ahead and locks read-ahead state.
+ *
+ * \param[in] self Transfer engine.
+ * \return NbtFileReadAhead* Locked read-ahead state or \c NULL if read-ahead is disabled.
+ */
+static NbtFileReadAhead *nbt_file_read_ahead_lock(nbt_file_t *self)
+{
+    NbtFileReadAhead *read_ahead = (NbtFileReadAhead *) self->read_ahead;
+    if (read_ahead == NULL)
+    {
+        return NULL;
+    }
+    pthread_mutex_lock(&read_ahead->mutex);
+    while (read_ahead->pending)
+    {
+        pthread_cond_wait(&read_ahead->changed, &read_ahead->mutex);
+    }
+    return read_ahead;
+}
+
+/**
+ * \brief Copies data read ahead into caller supplied buffer.
+ *
+ * \param[in,out] read_ahead Locked read-ahead state with data at \p offset.
+ * \param[in] offset Offset in file.
+ * \param[out] buffer Buffer to store data in.
+ * \param[in] len Number of bytes to be read.
+ * \param[in,out] stats Transfer statistics.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, \c IFX_TOO_LITTLE_DATA if the file ended within the requested data.
+ */
+static ifx_status_t nbt_file_read_ahead_consume(NbtFileReadAhead *read_ahead, size_t offset, uint8_t *buffer, size_t len,
+                                                nbt_file_transfer_stats_t *stats)
+{
+    size_t available = (read_ahead->offset + read_ahead->buffered) - offset;
+    size_t served = (len > available) ? available : len;
+    memcpy(buffer, &read_ahead->buffer[offset - read_ahead->offset], served);
+    stats->bytes += served;
+    stats->read_ahead_bytes += served;
+
+    // APDUs of a chunk are accounted to the first read served from it
+    stats->apdus += read_ahead->stats.apdus;
+    stats->blocks += read_ahead->stats.blocks;
+    read_ahead->stats.apdus = 0U;
+    read_ahead->stats.blocks = 0U;
+
+    if ((served < len) && (read_ahead->status == IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_READ, IFX_TOO_LITTLE_DATA)))
+    {
+        return read_ahead->status;
+    }
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Updates read-ahead state after a read and requests the next chunk for sequential access.
+ *
+ * \param[in,out] read_ahead Locked read-ahead state.
+ * \param[in] fid File that was read (\ref NBT_FILE_SELECTED for currently selected file).
+ * \param[in] offset Offset of read in file.
+ * \param[in] len Number of bytes requested.
+ * \param[in] sequential Whether the read continued the previous one.
+ * \param[in] status Result of the read.
+ * \param[in] bytes Number of bytes read.
+ */
+static void nbt_file_read_ahead_update(NbtFileReadAhead *read_ahead, uint16_t fid, size_t offset, size_t len, bool sequential, ifx_status_t status,
+                                       size_t bytes)
+{
+    bool end_of_file = (status == IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_READ, IFX_TOO_LITTLE_DATA));
+    if (ifx_error_check(status) && !end_of_file)
+    {
+        // Selected file unknown after errors
+        read_ahead->fid = NBT_FILE_SELECTED;
+        read_ahead->sequential = false;
+        read_ahead->buffered = 0U;
+        read_ahead->file_end = read_ahead->file_len;
+        return;
+    }
+
+    if (fid != NBT_FILE_SELECTED)
+    {
+        read_ahead->fid = fid;
+    }
+    read_ahead->sequential = true;
+    read_ahead->next_offset = offset + bytes;
+    if (end_of_file)
+    {
+        read_ahead->file_end = (read_ahead->next_offset < read_ahead->file_end) ? read_ahead->next_offset : read_ahead->file_end;
+        return;
+    }
+
+    // Next chunk of the same size, never beyond the end of file
+    size_t next = offset + len;
+    if (!sequential || (len == 0U) || (next >= read_ahead->file_end) ||
+        ((next >= read_ahead->offset) && ((next + len) <= (read_ahead->offset + read_ahead->buffered))))
+    {
+        return;
+    }
+    size_t chunk = read_ahead->file_end - next;
+    chunk = (chunk > len) ? len : chunk;
+    if (chunk > read_ahead->capacity)
+    {
+        uint8_t *buffer = realloc(read_ahead->buffer, chunk);
+        if (buffer == NULL)
+        {
+            return;
+        }
+        read_ahead->buffer = buffer;
+        read_ahead->capacity = chunk;
+    }
+    read_ahead->offset = next;
+    read_ahead->requested = chunk;
+    read_ahead->buffered = 0U;
+    read_ahead->pending = true;
+    pthread_cond_broadcast(&read_ahead->changed);
+}
+
+/**
+ * \brief Helper thread reading requested chunks ahead.
+ *
+ * \param[in] arg Transfer engine.
+ * \return void* Always \c NULL.
+ */
+static void *nbt_file_read_ahead_run(void *arg)
+{
+    nbt_file_t *self = (nbt_file_t *) arg;
+    NbtFileReadAhead *read_ahead = (NbtFileReadAhead *) self->read_ahead;
+
+    pthread_mutex_lock(&read_ahead->mutex);
+    while (!read_ahead->stop)
+    {
+        if (!read_ahead->pending)
+        {
+            pthread_cond_wait(&read_ahead->changed, &read_ahead->mutex);
+            continue;
+        }
+
+        // Application waits for pending chunk before using protocol stack or buffer
+        size_t offset = read_ahead->offset;
+        size_t len = read_ahead->requested;
+        uint8_t *buffer = read_ahead->buffer;
+        pthread_mutex_unlock(&read_ahead->mutex);
+        nbt_file_transfer_stats_t stats;
+        memset(&stats, 0, sizeof(nbt_file_transfer_stats_t));
+        ifx_status_t status = nbt_file_read_binary(self, offset, buffer, len, &stats);
+        pthread_mutex_lock(&read_ahead->mutex);
+
+        read_ahead->status = status;
+        read_ahead->stats = stats;
+        read_ahead->buffered = stats.bytes;
+        read_ahead->pending = false;
+        pthread_cond_broadcast(&read_ahead->changed);
+    }
+    pthread_mutex_unlock(&read_ahead->mutex);
+    return NULL;
+}
+
+/**
+ * \brief Initializes file transfer engine.
+ *
+ * \param[out] self Transfer engine to be initialized.
+ * \param[in] protocol Activated protocol stack.
+ * \param[in] cip Communication interface parameters from activation (\c NULL for \ref NBT_FILE_DEFAULT_IFSC).
+ * \param[in] cip_len Number of bytes in \p cip.
+ * \param[in] max_data_len Data bytes per APDU tried first (\c 0 for \ref NBT_FILE_DEFAULT_MAX_DATA_LEN).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_file_initialize(nbt_file_t *self, ifx_protocol_t *protocol, const uint8_t *cip, size_t cip_len, size_t max_data_len)
+{
+    // Validate parameters
+    if ((self == NULL) || (protocol == NULL) || (max_data_len > NBT_FILE_MAX_FILE_SIZE))
+    {
+        return IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_INITIALIZE, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    size_t ifsc = NBT_FILE_DEFAULT_IFSC;
+    if (cip != NULL)
+    {
+        ifx_status_t status = nbt_file_parse_ifsc(cip, cip_len, &ifsc);
+        if (ifx_error_check(status))
+        {
+            return status;
+        }
+    }
+    if (max_data_len == 0U)
+    {
+        max_data_len = NBT_FILE_DEFAULT_MAX_DATA_LEN;
+    }
+
+    self->protocol = protocol;
+    self->ifsc = ifsc;
+    self->max_read_len = max_data_len;
+    self->max_update_len = max_data_len;
+    self->read_ahead = NULL;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Reads data of a file into caller supplied buffer.
+ *
+ * \param[in] self Transfer engine.
+ * \param[in] fid File to be read (\ref NBT_FILE_SELECTED for currently selected file).
+ * \param[in] offset Offset in file.
+ * \param[out] buffer Buffer to store data in.
+ * \param[in] len Number of bytes to be read.
+ * \param[out] stats Optional buffer to store transfer statistics in (also set in case of error).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, \c IFX_TOO_LITTLE_DATA if file ended early, any other value in case of error.
+ */
+ifx_status_t nbt_file_read(nbt_file_t *self, uint16_t fid, size_t offset, uint8_t *buffer, size_t len, nbt_file_transfer_stats_t *stats)
+{
+    // Validate parameters
+    if ((self == NULL) || (self->protocol == NULL) || ((buffer == NULL) && (len > 0U)) || (offset > NBT_FILE_MAX_FILE_SIZE) ||
+        (len > (NBT_FILE_MAX_FILE_SIZE - offset)))
+    {
+        return IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_READ, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    nbt_file_transfer_stats_t local_stats;
+    if (stats == NULL)
+    {
+        stats = &local_stats;
+    }
+    memset(stats, 0, sizeof(nbt_file_transfer_stats_t));
+    uint64_t start_ns = nbt_file_get_time_ns();
+
+    // Data read ahead belongs to the file it was read from
+    NbtFileReadAhead *read_ahead = nbt_file_read_ahead_lock(self);
+    bool same_file = (read_ahead != NULL) && ((fid == NBT_FILE_SELECTED) || (fid == read_ahead->fid));
+    bool sequential = same_file && read_ahead->sequential && (offset == read_ahead->next_offset);
+    ifx_status_t status = IFX_SUCCESS;
+    if (same_file && (len > 0U) && (offset >= read_ahead->offset) && (offset < (read_ahead->offset + read_ahead->buffered)))
+    {
+        status = nbt_file_read_ahead_consume(read_ahead, offset, buffer, len, stats);
+    }
+    else
+    {
+        if (read_ahead != NULL)
+        {
+            read_ahead->buffered = 0U;
+            read_ahead->file_end = same_file ? read_ahead->file_end : read_ahead->file_len;
+        }
+        status = nbt_file_select(self, fid, IFX_NBT_FILE_READ, stats);
+    }
+    if (!ifx_error_check(status) && (stats->bytes < len))
+    {
+        status = nbt_file_read_binary(self, offset + stats->bytes, &buffer[stats->bytes], len - stats->bytes, stats);
+    }
+    if (read_ahead != NULL)
+    {
+        nbt_file_read_ahead_update(read_ahead, fid, offset, len, sequential, status, stats->bytes);
+        pthread_mutex_unlock(&read_ahead->mutex);
+    }
+
+    nbt_file_finish_stats(stats, start_ns);
+    return status;
+}
+
+/**
+ * \brief Writes data to a file.
+ *
+ * \param[in] self Transfer engine.
+ * \param[in] fid File to be written (\ref NBT_FILE_SELECTED for currently selected file).
+ * \param[in] offset Offset in file.
+ * \param[in] data Data to be written.
+ * \param[in] len Number of bytes in \p data.
+ * \param[out] stats Optional buffer to store transfer statistics in (also set in case of error).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_file_write(nbt_file_t *self, uint16_t fid, size_t offset, const uint8_t *data, size_t len, nbt_file_transfer_stats_t *stats)
+{
+    // Validate parameters
+    if ((self == NULL) || (self->protocol == NULL) || ((data == NULL) && (len > 0U)) || (offset > NBT_FILE_MAX_FILE_SIZE) ||
+        (len > (NBT_FILE_MAX_FILE_SIZE - offset)))
+    {
+        return IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_WRITE, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    nbt_file_transfer_stats_t local_stats;
+    if (stats == NULL)
+    {
+        stats = &local_stats;
+    }
+    memset(stats, 0, sizeof(nbt_file_transfer_stats_t));
+    uint64_t start_ns = nbt_file_get_time_ns();
+
+    // Single command buffer for the whole transfer, limits only ever shrink
+    size_t max_chunk = (len > self->max_update_len) ? self->max_update_len : len;
+    uint8_t *apdu = malloc(NBT_FILE_MAX_HEADER_LEN + max_chunk);
+    if (apdu == NULL)
+    {
+        return IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_WRITE, IFX_OUT_OF_MEMORY);
+    }
+
+    NbtFileReadAhead *read_ahead = nbt_file_read_ahead_lock(self);
+    ifx_status_t status = nbt_file_select(self, fid, IFX_NBT_FILE_WRITE, stats);
+    while (!ifx_error_check(status) && (stats->bytes < len))
+    {
+        size_t position = offset + stats->bytes;
+        size_t chunk = len - stats->bytes;
+        chunk = (chunk > self->max_update_len) ? self->max_update_len : chunk;
+
+        size_t header_len = 5U;
+        apdu[0] = 0x00U;
+        apdu[1] = 0xd6U;
+        apdu[2] = (uint8_t) (position >> 8);
+        apdu[3] = (uint8_t) position;
+        apdu[4] = (uint8_t) chunk;
+        if (chunk > NBT_FILE_MAX_SHORT_UPDATE_LEN)
+        {
+            apdu[4] = 0x00U;
+            apdu[5] = (uint8_t) (chunk >> 8);
+            apdu[6] = (uint8_t) chunk;
+            header_len = 7U;
+        }
+        memcpy(&apdu[header_len], &data[stats->bytes], chunk);
+
+        uint8_t *response = NULL;
+        size_t response_len = 0U;
+        uint16_t sw = 0U;
+        status = nbt_file_exchange(self, apdu, header_len + chunk, &response, &response_len, &sw, stats);
+        free(response);
+        if (ifx_error_check(status))
+        {
+            break;
+        }
+        if ((sw == NBT_FILE_SW_WRONG_LENGTH) && nbt_file_shrink(&self->max_update_len, NBT_FILE_MAX_SHORT_UPDATE_LEN))
+        {
+            continue;
+        }
+        if (sw != NBT_FILE_SW_SUCCESS)
+        {
+            status = IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_WRITE, NBT_FILE_STATUS_WORD_ERROR);
+            break;
+        }
+        stats->bytes += chunk;
+    }
+    free(apdu);
+
+    // Written data may overlap data read ahead
+    if (read_ahead != NULL)
+    {
+        read_ahead->fid = ifx_error_check(status) ? NBT_FILE_SELECTED : ((fid != NBT_FILE_SELECTED) ? fid : read_ahead->fid);
+        read_ahead->sequential = false;
+        read_ahead->buffered = 0U;
+        read_ahead->file_end = read_ahead->file_len;
+        pthread_mutex_unlock(&read_ahead->mutex);
+    }
+
+    nbt_file_finish_stats(stats, start_ns);
+    return status;
+}
+
+/**
+ * \brief Enables or disables read-ahead for sequential reads.
+ *
+ * \param[in,out] self Transfer engine.
+ * \param[in] file_len Size of files read sequentially in [bytes] (\c 0 to disable read-ahead).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_file_set_read_ahead(nbt_file_t *self, size_t file_len)
+{
+    // Validate parameters
+    if ((self == NULL) || (self->protocol == NULL) || (file_len > NBT_FILE_MAX_FILE_SIZE))
+    {
+        return IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_SET_READ_AHEAD, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    NbtFileReadAhead *read_ahead = nbt_file_read_ahead_lock(self);
+    if ((read_ahead != NULL) && (file_len > 0U))
+    {
+        read_ahead->file_len = file_len;
+        read_ahead->file_end = file_len;
+        read_ahead->buffered = 0U;
+        pthread_mutex_unlock(&read_ahead->mutex);
+        return IFX_SUCCESS;
+    }
+    if (read_ahead != NULL)
+    {
+        read_ahead->stop = true;
+        pthread_cond_broadcast(&read_ahead->changed);
+        pthread_mutex_unlock(&read_ahead->mutex);
+        pthread_join(read_ahead->thread, NULL);
+        pthread_cond_destroy(&read_ahead->changed);
+        pthread_mutex_destroy(&read_ahead->mutex);
+        free(read_ahead->buffer);
+        free(read_ahead);
+        self->read_ahead = NULL;
+        return IFX_SUCCESS;
+    }
+    if (file_len == 0U)
+    {
+        return IFX_SUCCESS;
+    }
+
+    read_ahead = calloc(1U, sizeof(NbtFileReadAhead));
+    if (read_ahead == NULL)
+    {
+        return IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_SET_READ_AHEAD, IFX_OUT_OF_MEMORY);
+    }
+    pthread_mutex_init(&read_ahead->mutex, NULL);
+    pthread_cond_init(&read_ahead->changed, NULL);
+    read_ahead->fid = NBT_FILE_SELECTED;
+    read_ahead->file_len = file_len;
+    read_ahead->file_end = file_len;
+    read_ahead->status = IFX_SUCCESS;
+    self->read_ahead = read_ahead;
+    if (pthread_create(&read_ahead->thread, NULL, nbt_file_read_ahead_run, self) != 0)
+    {
+        self->read_ahead = NULL;
+        pthread_cond_destroy(&read_ahead->changed);
+        pthread_mutex_destroy(&read_ahead->mutex);
+        free(read_ahead);
+        return IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_SET_READ_AHEAD, IFX_UNSPECIFIED_ERROR);
+    }
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Extracts IFSC from communication interface parameters.
+ *
+ * \param[in] cip Communication interface parameters.
+ * \param[in] cip_len Number of bytes in \p cip.
+ * \param[out] ifsc Buffer to store IFSC in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_file_parse_ifsc(const uint8_t *cip, size_t cip_len, size_t *ifsc)
+{
+    // Skip PVER, IIN, PLID and PLP
+    size_t position = 1U;
+    for (unsigned field = 0U; field < 2U; field++)
+    {
+        if (position >= cip_len)
+        {
+            return IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_INITIALIZE, IFX_TOO_LITTLE_DATA);
+        }
+        position += 1U + cip[position];
+        if (field == 0U)
+        {
+            position++;
+        }
+    }
+
+    // DLLP: BWT, IFSC
+    if ((position >= cip_len) || (cip[position] < 4U) || ((position + 1U + cip[position]) > cip_len))
+    {
+        return IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_INITIALIZE, IFX_TOO_LITTLE_DATA);
+    }
+    size_t parsed = ((size_t) cip[position + 3U] << 8) | cip[position + 4U];
+    if (parsed == 0U)
+    {
+        return IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_INITIALIZE, IFX_ILLEGAL_ARGUMENT);
+    }
+    *ifsc = parsed;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Reads data of the currently selected file with READ BINARY commands.
+ *
+ * \param[in] self Transfer engine.
+ * \param[in] offset Offset in file.
+ * \param[out] buffer Buffer to store data in.
+ * \param[in] len Number of bytes to be read.
+ * \param[in,out] stats Transfer statistics (\c bytes increased by the number of bytes read).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, \c IFX_TOO_LITTLE_DATA if file ended early, any other value in case of error.
+ */
+ifx_status_t nbt_file_read_binary(nbt_file_t *self, size_t offset, uint8_t *buffer, size_t len, nbt_file_transfer_stats_t *stats)
+{
+    ifx_status_t status = IFX_SUCCESS;
+    size_t done = 0U;
+    while (!ifx_error_check(status) && (done < len))
+    {
+        // Largest chunk the tag accepts, offsets are limited to 15 bit
+        size_t position = offset + done;
+        size_t chunk = len - done;
+        chunk = (chunk > self->max_read_len) ? self->max_read_len : chunk;
+
+        uint8_t apdu[NBT_FILE_MAX_HEADER_LEN];
+        size_t apdu_len = 5U;
+        apdu[0] = 0x00U;
+        apdu[1] = 0xb0U;
+        apdu[2] = (uint8_t) (position >> 8);
+        apdu[3] = (uint8_t) position;
+        apdu[4] = (uint8_t) chunk;
+        if (chunk > NBT_FILE_MAX_SHORT_READ_LEN)
+        {
+            apdu[4] = 0x00U;
+            apdu[5] = (uint8_t) (chunk >> 8);
+            apdu[6] = (uint8_t) chunk;
+            apdu_len = 7U;
+        }
+
+        uint8_t *response = NULL;
+        size_t response_len = 0U;
+        uint16_t sw = 0U;
+        status = nbt_file_exchange(self, apdu, apdu_len, &response, &response_len, &sw, stats);
+        if (ifx_error_check(status))
+        {
+            break;
+        }
+        if ((sw == NBT_FILE_SW_WRONG_LENGTH) && nbt_file_shrink(&self->max_read_len, NBT_FILE_MAX_SHORT_READ_LEN))
+        {
+            free(response);
+            continue;
+        }
+        if ((sw != NBT_FILE_SW_SUCCESS) && (sw != NBT_FILE_SW_END_OF_FILE))
+        {
+            free(response);
+            status = IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_READ, NBT_FILE_STATUS_WORD_ERROR);
+            break;
+        }
+
+        // Tags may answer with less data than requested, the rest is read with the next APDU
+        size_t data_len = (response_len > chunk) ? chunk : response_len;
+        if (data_len > 0U)
+        {
+            memcpy(&buffer[done], response, data_len);
+        }
+        free(response);
+        done += data_len;
+        stats->bytes += data_len;
+        if ((data_len == 0U) || ((sw == NBT_FILE_SW_END_OF_FILE) && (done < len)))
+        {
+            status = IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_READ, IFX_TOO_LITTLE_DATA);
+        }
+    }
+
+    return status;
+}
+
+/**
+ * \brief Exchanges single APDU and accounts for it in transfer statistics.
+ *
+ * \param[in] self Transfer engine.
+ * \param[in] apdu Command APDU.
+ * \param[in] apdu_len Number of bytes in \p apdu.
+ * \param[out] response Buffer to store response in (without status word, to be freed by caller).
+ * \param[out] response_len Buffer to store number of data bytes in \p response in.
+ * \param[out] sw Buffer to store status word in.
+ * \param[in,out] stats Transfer statistics.
+ * \return ifx_status_t \c IFX_SUCCESS if a response with status word was received, any other value in case of error.
+ */
+ifx_status_t nbt_file_exchange(nbt_file_t *self, const uint8_t *apdu, size_t apdu_len, uint8_t **response, size_t *response_len, uint16_t *sw,
+                               nbt_file_transfer_stats_t *stats)
+{
+    *response = NULL;
+    *response_len = 0U;
+    ifx_status_t status = ifx_protocol_transceive(self->protocol, apdu, apdu_len, response, response_len);
+    stats->apdus++;
+    stats->blocks += (apdu_len + self->ifsc - 1U) / self->ifsc;
+    if (ifx_error_check(status))
+    {
+        free(*response);
+        *response = NULL;
+        return status;
+    }
+    stats->blocks += (*response_len + self->ifsc - 1U) / self->ifsc;
+    if ((*response == NULL) || (*response_len < 2U))
+    {
+        free(*response);
+        *response = NULL;
+        return IFX_ERROR(LIBNBTFILE, IFX_PROTOCOL_TRANSCEIVE, IFX_TOO_LITTLE_DATA);
+    }
+    *response_len -= 2U;
+    *sw = (uint16_t) (((uint16_t) (*response)[*response_len] << 8) | (*response)[*response_len + 1U]);
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Selects file by file ID.
+ *
+ * \param[in] self Transfer engine.
+ * \param[in] fid File to be selected (\ref NBT_FILE_SELECTED to do nothing).
+ * \param[in] function IFX status encoding function identifier for errors.
+ * \param[in,out] stats Transfer statistics.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_file_select(nbt_file_t *self, uint16_t fid, uint8_t function, nbt_file_transfer_stats_t *stats)
+{
+    if (fid == NBT_FILE_SELECTED)
+    {
+        return IFX_SUCCESS;
+    }
+
+    uint8_t select_file[] = {0x00U, 0xa4U, 0x00U, 0x0cU, 0x02U, (uint8_t) (fid >> 8), (uint8_t) fid};
+    uint8_t *response = NULL;
+    size_t response_len = 0U;
+    uint16_t sw = 0U;
+    ifx_status_t status = nbt_file_exchange(self, select_file, sizeof(select_file), &response, &response_len, &sw, stats);
+    free(response);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    if (sw != NBT_FILE_SW_SUCCESS)
+    {
+        return IFX_ERROR(LIBNBTFILE, function, NBT_FILE_STATUS_WORD_ERROR);
+    }
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Lowers data bytes per APDU after the tag rejected an APDU as too long.
+ *
+ * \param[in,out] max_len Current limit to be lowered.
+ * \param[in] short_len Limit with short length encoding.
+ * \return bool \c true if limit was lowered, \c false if already at short length encoding.
+ */
+bool nbt_file_shrink(size_t *max_len, size_t short_len)
+{
+    if (*max_len <= short_len)
+    {
+        return false;
+    }
+    *max_len /= 2U;
+    if (*max_len < short_len)
+    {
+        *max_len = short_len;
+    }
+    return true;
+}
@@ -0,0 +1,207 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-file.h
+ * \brief Internal definitions for transfer engine reading and writing NBT files.
+ */
+#ifndef NBT_FILE_H
+#define NBT_FILE_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/nbt-file.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Size of file content addressable by READ BINARY / UPDATE BINARY offsets in [bytes].
+ */
+#define NBT_FILE_MAX_FILE_SIZE 0x8000U
+
+/**
+ * \brief Length of UPDATE BINARY header with extended length encoding in [bytes].
+ */
+#define NBT_FILE_MAX_HEADER_LEN 7U
+
+/**
+ * \brief Status word: wrong length.
+ */
+#define NBT_FILE_SW_WRONG_LENGTH 0x6700U
+
+/**
+ * \brief Status word: end of file reached before reading requested number of bytes.
+ */
+#define NBT_FILE_SW_END_OF_FILE 0x6282U
+
+/**
+ * \brief Status word: success.
+ */
+#define NBT_FILE_SW_SUCCESS 0x9000U
+
+/** \struct NbtFileReadAhead
+ * \brief Read-ahead state shared between application and helper thread.
+ *
+ * \details All members are protected by \ref mutex. While \ref pending is
+ * set, the helper thread owns the protocol stack and \ref buffer.
+ */
+typedef struct
+{
+    /**
+     * \brief Helper thread reading ahead.
+     */
+    pthread_t thread;
+
+    /**
+     * \brief Mutex protecting all other members.
+     */
+    pthread_mutex_t mutex;
+
+    /**
+     * \brief Signalled whenever \ref pending or \ref stop change.
+     */
+    pthread_cond_t changed;
+
+    /**
+     * \brief Set to terminate helper thread.
+     */
+    bool stop;
+
+    /**
+     * \brief Set while a chunk is requested from or being read by the helper thread.
+     */
+    bool pending;
+
+    /**
+     * \brief Configured file size in [bytes].
+     */
+    size_t file_len;
+
+    /**
+     * \brief End of the current file in [bytes] (lowered once the tag reported the end of file).
+     */
+    size_t file_end;
+
+    /**
+     * \brief File last read or written (\ref NBT_FILE_SELECTED if unknown).
+     */
+    uint16_t fid;
+
+    /**
+     * \brief Whether \ref next_offset is valid for sequential access detection.
+     */
+    bool sequential;
+
+    /**
+     * \brief Offset directly after the data of the last read.
+     */
+    size_t next_offset;
+
+    /**
+     * \brief Offset of chunk in \ref buffer.
+     */
+    size_t offset;
+
+    /**
+     * \brief Number of bytes requested from helper thread.
+     */
+    size_t requested;
+
+    /**
+     * \brief Number of valid bytes in \ref buffer.
+     */
+    size_t buffered;
+
+    /**
+     * \brief Buffer for chunk read ahead.
+     */
+    uint8_t *buffer;
+
+    /**
+     * \brief Capacity of \ref buffer in [bytes].
+     */
+    size_t capacity;
+
+    /**
+     * \brief Result of the last read ahead.
+     */
+    ifx_status_t status;
+
+    /**
+     * \brief APDUs and blocks of the last read ahead (accounted to the read consuming it).
+     */
+    nbt_file_transfer_stats_t stats;
+} NbtFileReadAhead;
+
+/**
+ * \brief Extracts IFSC from communication interface parameters.
+ *
+ * \details CIP layout: PVER, IIN, PLID, PLP, DLLP, HB with each of IIN,
+ * PLP, DLLP and HB prefixed by its length. The IFSC is the second 16 bit
+ * value of DLLP (after BWT).
+ *
+ * \param[in] cip Communication interface parameters.
+ * \param[in] cip_len Number of bytes in \p cip.
+ * \param[out] ifsc Buffer to store IFSC in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_file_parse_ifsc(const uint8_t *cip, size_t cip_len, size_t *ifsc);
+
+/**
+ * \brief Reads data of the currently selected file with READ BINARY commands.
+ *
+ * \param[in] self Transfer engine.
+ * \param[in] offset Offset in file.
+ * \param[out] buffer Buffer to store data in.
+ * \param[in] len Number of bytes to be read.
+ * \param[in,out] stats Transfer statistics (\c bytes increased by the number of bytes read).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, \c IFX_TOO_LITTLE_DATA if file ended early, any other value in case of error.
+ */
+ifx_status_t nbt_file_read_binary(nbt_file_t *self, size_t offset, uint8_t *buffer, size_t len, nbt_file_transfer_stats_t *stats);
+
+/**
+ * \brief Exchanges single APDU and accounts for it in transfer statistics.
+ *
+ * \param[in] self Transfer engine.
+ * \param[in] apdu Command APDU.
+ * \param[in] apdu_len Number of bytes in \p apdu.
+ * \param[out] response Buffer to store response in (without status word, to be freed by caller).
+ * \param[out] response_len Buffer to store number of data bytes in \p response in.
+ * \param[out] sw Buffer to store status word in.
+ * \param[in,out] stats Transfer statistics.
+ * \return ifx_status_t \c IFX_SUCCESS if a response with status word was received, any other value in case of error.
+ */
+ifx_status_t nbt_file_exchange(nbt_file_t *self, const uint8_t *apdu, size_t apdu_len, uint8_t **response, size_t *response_len, uint16_t *sw,
+                               nbt_file_transfer_stats_t *stats);
+
+/**
+ * \brief Selects file by file ID.
+ *
+ * \param[in] self Transfer engine.
+ * \param[in] fid File to be selected (\ref NBT_FILE_SELECTED to do nothing).
+ * \param[in] function IFX status encoding function identifier for errors.
+ * \param[in,out] stats Transfer statistics.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_file_select(nbt_file_t *self, uint16_t fid, uint8_t function, nbt_file_transfer_stats_t *stats);
+
+/**
+ * \brief Lowers data bytes per APDU after the tag rejected an APDU as too long.
+ *
+ * \param[in,out] max_len Current limit to be lowered.
+ * \param[in] short_len Limit with short length encoding.
+ * \return bool \c true if limit was lowered, \c false if already at short length encoding.
+ */
+bool nbt_file_shrink(size_t *max_len, size_t short_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NBT_FILE_H
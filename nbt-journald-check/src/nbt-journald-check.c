@@ -0,0 +1,370 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-journald-check.c
+ * \brief Command line tool verifying the journald logger against a local socket standing in for journald.
+ *
+ * \details Usage: nbt-journald-check
+ *
+ * Binds a temporary unix datagram socket, logs records through the journald
+ * logger and checks the received native protocol fields: a plain record, a
+ * record with line breaks (binary safe encoding) and a record exceeding
+ * \ref LOGGER_JOURNALD_MAX_DATAGRAM_LEN (sealed memfd). Exits with
+ * \c EXIT_FAILURE if any check fails.
+ */
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-logger.h"
+#include "infineon/logger-journald.h"
+
+/**
+ * \brief Value of \c SYSLOG_IDENTIFIER field used for all records.
+ */
+#define NBT_JOURNALD_CHECK_IDENTIFIER "nbt-journald-check"
+
+/**
+ * \brief Maximum number of fields parsed per record.
+ */
+#define NBT_JOURNALD_CHECK_MAX_FIELDS 16U
+
+/**
+ * \brief Size of buffer receiving records in [bytes].
+ */
+#define NBT_JOURNALD_CHECK_BUFFER_LEN (4U * LOGGER_JOURNALD_MAX_DATAGRAM_LEN)
+
+/** \struct NbtJournaldCheckField
+ * \brief Single field of a received record (pointing into the receive buffer).
+ */
+typedef struct
+{
+    /**
+     * \brief Field name.
+     */
+    const char *name;
+
+    /**
+     * \brief Number of bytes in \ref NbtJournaldCheckField.name.
+     */
+    size_t name_len;
+
+    /**
+     * \brief Field value.
+     */
+    const char *value;
+
+    /**
+     * \brief Number of bytes in \ref NbtJournaldCheckField.value.
+     */
+    size_t value_len;
+} NbtJournaldCheckField;
+
+/** \struct NbtJournaldCheckRecord
+ * \brief Parsed record.
+ */
+typedef struct
+{
+    /**
+     * \brief Fields in order of reception.
+     */
+    NbtJournaldCheckField fields[NBT_JOURNALD_CHECK_MAX_FIELDS];
+
+    /**
+     * \brief Number of used entries in \ref NbtJournaldCheckRecord.fields.
+     */
+    size_t field_count;
+
+    /**
+     * \brief Whether the record was passed as memfd.
+     */
+    bool memfd;
+} NbtJournaldCheckRecord;
+
+/**
+ * \brief Number of failed checks.
+ */
+static unsigned failures = 0U;
+
+/**
+ * \brief Reports result of a single check.
+ *
+ * \param[in] passed Whether the check passed.
+ * \param[in] description Description of the check.
+ */
+static void nbt_journald_check_expect(bool passed, const char *description)
+{
+    printf("%s: %s\n", passed ? "ok  " : "FAIL", description);
+    if (!passed)
+    {
+        failures++;
+    }
+}
+
+/**
+ * \brief Parses record in native journal protocol.
+ *
+ * \param[in] data Received record.
+ * \param[in] data_len Number of bytes in \p data.
+ * \param[out] record Buffer to store parsed fields in.
+ * \return bool \c true if the record is well-formed.
+ */
+static bool nbt_journald_check_parse(const char *data, size_t data_len, NbtJournaldCheckRecord *record)
+{
+    record->field_count = 0U;
+    size_t position = 0U;
+    while (position < data_len)
+    {
+        if (record->field_count == NBT_JOURNALD_CHECK_MAX_FIELDS)
+        {
+            return false;
+        }
+        NbtJournaldCheckField *field = &record->fields[record->field_count++];
+        field->name = &data[position];
+        while ((position < data_len) && (data[position] != '=') && (data[position] != '\n'))
+        {
+            position++;
+        }
+        if (position == data_len)
+        {
+            return false;
+        }
+        field->name_len = (size_t) (&data[position] - field->name);
+        if (data[position] == '=')
+        {
+            // Plain field terminated by line break
+            const char *end = memchr(&data[position + 1U], '\n', data_len - position - 1U);
+            if (end == NULL)
+            {
+                return false;
+            }
+            field->value = &data[position + 1U];
+            field->value_len = (size_t) (end - field->value);
+            position = (size_t) (end - data) + 1U;
+        }
+        else
+        {
+            // Binary safe field with little endian length prefix
+            position++;
+            if ((data_len - position) < 8U)
+            {
+                return false;
+            }
+            uint64_t length = 0U;
+            for (size_t i = 0U; i < 8U; i++)
+            {
+                length |= (uint64_t) (uint8_t) data[position + i] << (8U * i);
+            }
+            position += 8U;
+            if (((data_len - position) < 1U) || (length > (data_len - position - 1U)) || (data[position + length] != '\n'))
+            {
+                return false;
+            }
+            field->value = &data[position];
+            field->value_len = (size_t) length;
+            position += (size_t) length + 1U;
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Checks that record contains field with given value.
+ *
+ * \param[in] record Parsed record.
+ * \param[in] name Field name.
+ * \param[in] value Expected value.
+ * \param[in] value_len Number of bytes in \p value.
+ * \return bool \c true if exactly one field of this name with this value exists.
+ */
+static bool nbt_journald_check_has_field(const NbtJournaldCheckRecord *record, const char *name, const char *value, size_t value_len)
+{
+    size_t matches = 0U;
+    for (size_t i = 0U; i < record->field_count; i++)
+    {
+        const NbtJournaldCheckField *field = &record->fields[i];
+        if ((field->name_len == strlen(name)) && (memcmp(field->name, name, field->name_len) == 0))
+        {
+            if ((field->value_len != value_len) || (memcmp(field->value, value, value_len) != 0))
+            {
+                return false;
+            }
+            matches++;
+        }
+    }
+    return matches == 1U;
+}
+
+/**
+ * \brief Receives single record from the socket, reading it from a passed memfd if necessary.
+ *
+ * \param[in] fd Bound datagram socket.
+ * \param[out] buffer Buffer of \ref NBT_JOURNALD_CHECK_BUFFER_LEN bytes to store record in.
+ * \param[out] record Buffer to store parsed fields in.
+ * \return bool \c true if a well-formed record was received.
+ */
+static bool nbt_journald_check_receive(int fd, char *buffer, NbtJournaldCheckRecord *record)
+{
+    union
+    {
+        struct cmsghdr header;
+        uint8_t buffer[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct iovec iov = {buffer, NBT_JOURNALD_CHECK_BUFFER_LEN};
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1U;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+    ssize_t received = recvmsg(fd, &message, MSG_CMSG_CLOEXEC);
+    if ((received < 0) || ((message.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0))
+    {
+        return false;
+    }
+
+    record->memfd = false;
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+    if ((cmsg != NULL) && (cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_RIGHTS))
+    {
+        int memfd;
+        memcpy(&memfd, CMSG_DATA(cmsg), sizeof(int));
+        record->memfd = true;
+
+        // journald rejects memfds that are not sealed or that come with a payload
+        int seals = fcntl(memfd, F_GET_SEALS);
+        int required = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE;
+        nbt_journald_check_expect((seals >= 0) && ((seals & required) == required), "memfd is sealed");
+        nbt_journald_check_expect(received == 0, "memfd datagram has no payload");
+        received = pread(memfd, buffer, NBT_JOURNALD_CHECK_BUFFER_LEN, 0);
+        close(memfd);
+        if (received < 0)
+        {
+            return false;
+        }
+    }
+    return nbt_journald_check_parse(buffer, (size_t) received, record);
+}
+
+/**
+ * \brief Checks the fields every record carries.
+ *
+ * \param[in] record Parsed record.
+ * \param[in] priority Expected \c PRIORITY value.
+ * \param[in] message Expected \c MESSAGE value.
+ * \param[in] message_len Number of bytes in \p message.
+ */
+static void nbt_journald_check_fields(const NbtJournaldCheckRecord *record, const char *priority, const char *message, size_t message_len)
+{
+    char tid[24];
+    snprintf(tid, sizeof(tid), "%ld", (long) syscall(SYS_gettid));
+    nbt_journald_check_expect(nbt_journald_check_has_field(record, "PRIORITY", priority, strlen(priority)), "PRIORITY field");
+    nbt_journald_check_expect(nbt_journald_check_has_field(record, "TID", tid, strlen(tid)), "TID field");
+    nbt_journald_check_expect(
+        nbt_journald_check_has_field(record, "SYSLOG_IDENTIFIER", NBT_JOURNALD_CHECK_IDENTIFIER, strlen(NBT_JOURNALD_CHECK_IDENTIFIER)),
+        "SYSLOG_IDENTIFIER field");
+    nbt_journald_check_expect(nbt_journald_check_has_field(record, "NBT_SOURCE", "CHECK", 5U), "NBT_SOURCE field");
+    nbt_journald_check_expect(nbt_journald_check_has_field(record, "MESSAGE", message, message_len), "MESSAGE field");
+}
+
+int main(void)
+{
+    // Temporary socket standing in for journald
+    char directory[] = "/tmp/nbt-journald-check-XXXXXX";
+    if (mkdtemp(directory) == NULL)
+    {
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    snprintf(address.sun_path, sizeof(address.sun_path), "%s/socket", directory);
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    struct timeval timeout = {1, 0};
+    if ((fd < 0) || (bind(fd, (const struct sockaddr *) &address, sizeof(address)) != 0) ||
+        (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0))
+    {
+        perror(address.sun_path);
+        rmdir(directory);
+        return EXIT_FAILURE;
+    }
+
+    char *buffer = malloc(NBT_JOURNALD_CHECK_BUFFER_LEN);
+    char *large = malloc(LOGGER_JOURNALD_MAX_DATAGRAM_LEN + 1024U);
+    ifx_logger_t logger;
+    ifx_status_t status = logger_journald_initialize(&logger, address.sun_path, NBT_JOURNALD_CHECK_IDENTIFIER);
+    if ((buffer == NULL) || (large == NULL) || ifx_error_check(status))
+    {
+        fprintf(stderr, "Could not initialize journald logger: 0x%08x\n", (unsigned) status);
+        free(buffer);
+        free(large);
+        close(fd);
+        unlink(address.sun_path);
+        rmdir(directory);
+        return EXIT_FAILURE;
+    }
+
+    // Records are passed to the log callback directly, ifx_logger_log() may limit the formatted length
+    NbtJournaldCheckRecord record;
+    static const char plain[] = "plain record";
+    status = logger._log(&logger, "CHECK", IFX_LOG_WARN, plain);
+    nbt_journald_check_expect(!ifx_error_check(status), "plain record logged");
+    if (!ifx_error_check(status) && nbt_journald_check_receive(fd, buffer, &record))
+    {
+        nbt_journald_check_expect(!record.memfd, "plain record sent as datagram");
+        nbt_journald_check_fields(&record, "4", plain, strlen(plain));
+    }
+    else
+    {
+        nbt_journald_check_expect(false, "plain record received");
+    }
+
+    static const char multiline[] = "first line\nsecond line";
+    status = logger._log(&logger, "CHECK", IFX_LOG_ERROR, multiline);
+    nbt_journald_check_expect(!ifx_error_check(status), "multi-line record logged");
+    if (!ifx_error_check(status) && nbt_journald_check_receive(fd, buffer, &record))
+    {
+        nbt_journald_check_expect(!record.memfd, "multi-line record sent as datagram");
+        nbt_journald_check_fields(&record, "3", multiline, strlen(multiline));
+    }
+    else
+    {
+        nbt_journald_check_expect(false, "multi-line record received");
+    }
+
+    memset(large, 'x', LOGGER_JOURNALD_MAX_DATAGRAM_LEN + 1023U);
+    large[LOGGER_JOURNALD_MAX_DATAGRAM_LEN + 1023U] = '\0';
+    status = logger._log(&logger, "CHECK", IFX_LOG_INFO, large);
+    nbt_journald_check_expect(!ifx_error_check(status), "oversized record logged");
+    if (!ifx_error_check(status) && nbt_journald_check_receive(fd, buffer, &record))
+    {
+        nbt_journald_check_expect(record.memfd, "oversized record sent as memfd");
+        nbt_journald_check_fields(&record, "6", large, strlen(large));
+    }
+    else
+    {
+        nbt_journald_check_expect(false, "oversized record received");
+    }
+
+    ifx_logger_destroy(&logger);
+    free(large);
+    free(buffer);
+    close(fd);
+    unlink(address.sun_path);
+    rmdir(directory);
+    printf("%u checks failed\n", failures);
+    return (failures == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,309 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-logtail.c
+ * \brief Command line tool attaching to the shared-memory log ring to dump, filter or tail its records.
+ *
+ * \details Usage: nbt-logtail [-n name] [-f] [-l level] [-s source] [-m text]
+ *
+ * Without \c -f all records currently held by the ring are printed. With
+ * \c -f new records are followed until interrupted.
+ */
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "infineon/logger-shm-ring.h"
+
+/**
+ * \brief Interval in [us] between polls of the ring while following.
+ */
+#define NBT_LOGTAIL_POLL_INTERVAL_US 20000U
+
+/**
+ * \brief Number of polls a claimed record may stay unpublished before it is skipped as lost.
+ *
+ * \details A writer that died while writing never publishes its record.
+ */
+#define NBT_LOGTAIL_STALL_POLLS 50U
+
+/**
+ * \brief Level names indexed by ifx_log_level.
+ */
+static const char *const level_names[] = {"DEBUG", "INFO", "WARNING", "ERROR", "FATAL"};
+
+/**
+ * \brief Set by signal handler to stop following the ring.
+ */
+static volatile sig_atomic_t stop_requested = 0;
+
+/** \struct NbtLogtailFilter
+ * \brief Filter criteria for printed records.
+ */
+typedef struct
+{
+    /**
+     * \brief Minimum level of printed records.
+     */
+    unsigned min_level;
+
+    /**
+     * \brief Exact source of printed records (\c NULL for all).
+     */
+    const char *source;
+
+    /**
+     * \brief Text contained in printed messages (\c NULL for all).
+     */
+    const char *text;
+} NbtLogtailFilter;
+
+/**
+ * \brief Signal handler requesting to stop following the ring.
+ *
+ * \param[in] sig Signal number.
+ */
+static void nbt_logtail_handle_signal(int sig)
+{
+    (void) sig;
+    stop_requested = 1;
+}
+
+/**
+ * \brief Prints usage information.
+ *
+ * \param[in] program Name of the executable.
+ */
+static void nbt_logtail_usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [-n name] [-f] [-l level] [-s source] [-m text]\n"
+            "  -n name    shared-memory object name (default %s)\n"
+            "  -f         follow new records\n"
+            "  -l level   minimum level (debug, info, warn, error, fatal)\n"
+            "  -s source  only print records of given source\n"
+            "  -m text    only print records containing text\n",
+            program, LOGGER_SHM_DEFAULT_NAME);
+}
+
+/**
+ * \brief Parses level name given on command line.
+ *
+ * \param[in] name Level name.
+ * \param[out] level Buffer to store level in.
+ * \return bool \c true if successful.
+ */
+static bool nbt_logtail_parse_level(const char *name, unsigned *level)
+{
+    static const char *const names[] = {"debug", "info", "warn", "error", "fatal"};
+    for (unsigned i = 0U; i < (sizeof(names) / sizeof(names[0])); i++)
+    {
+        if (strcmp(name, names[i]) == 0)
+        {
+            *level = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * \brief Copies record of given sequence number out of the ring.
+ *
+ * \param[in] ring Mapped log ring.
+ * \param[in] sequence Sequence number of the record.
+ * \param[out] copy Buffer to store record in.
+ * \return int \c 1 if record was copied, \c 0 if not written yet, \c -1 if already overwritten.
+ */
+static int nbt_logtail_read_record(const logger_shm_ring_header_t *ring, uint64_t sequence, logger_shm_record_t *copy)
+{
+    const logger_shm_record_t *record = LOGGER_SHM_RING_RECORD(ring, sequence);
+    uint64_t before = __atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE);
+    if (before != (sequence + 1U))
+    {
+        return ((before == 0U) || (before < (sequence + 1U))) ? 0 : -1;
+    }
+    memcpy(copy, record, sizeof(logger_shm_record_t));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint64_t after = __atomic_load_n(&record->sequence, __ATOMIC_RELAXED);
+    if (after != before)
+    {
+        return -1;
+    }
+    copy->source[LOGGER_SHM_SOURCE_LEN - 1U] = '\0';
+    copy->message[LOGGER_SHM_MESSAGE_LEN - 1U] = '\0';
+    return 1;
+}
+
+/**
+ * \brief Prints record if it matches filter.
+ *
+ * \param[in] record Record to be printed.
+ * \param[in] filter Filter criteria.
+ */
+static void nbt_logtail_print_record(const logger_shm_record_t *record, const NbtLogtailFilter *filter)
+{
+    if ((record->level < filter->min_level) || (record->level >= (sizeof(level_names) / sizeof(level_names[0]))))
+    {
+        return;
+    }
+    if ((filter->source != NULL) && (strcmp(record->source, filter->source) != 0))
+    {
+        return;
+    }
+    if ((filter->text != NULL) && (strstr(record->message, filter->text) == NULL))
+    {
+        return;
+    }
+    printf("[%llu.%09llu] [%5u] [%-9s] [%-7s] %s%s\n", (unsigned long long) (record->timestamp_ns / 1000000000U),
+           (unsigned long long) (record->timestamp_ns % 1000000000U), (unsigned) record->tid, record->source, level_names[record->level],
+           record->message, (record->truncated != 0U) ? "..." : "");
+}
+
+int main(int argc, char *argv[])
+{
+    const char *name = LOGGER_SHM_DEFAULT_NAME;
+    bool follow = false;
+    NbtLogtailFilter filter = {0U, NULL, NULL};
+
+    int option;
+    while ((option = getopt(argc, argv, "n:fl:s:m:h")) != -1)
+    {
+        switch (option)
+        {
+        case 'n':
+            name = optarg;
+            break;
+        case 'f':
+            follow = true;
+            break;
+        case 'l':
+            if (!nbt_logtail_parse_level(optarg, &filter.min_level))
+            {
+                nbt_logtail_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 's':
+            filter.source = optarg;
+            break;
+        case 'm':
+            filter.text = optarg;
+            break;
+        default:
+            nbt_logtail_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Attach to ring read-only so that the logging process is never disturbed
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        perror("shm_open");
+        return EXIT_FAILURE;
+    }
+    struct stat info;
+    if ((fstat(fd, &info) != 0) || ((size_t) info.st_size < sizeof(logger_shm_ring_header_t)))
+    {
+        fprintf(stderr, "%s is not a log ring\n", name);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    logger_shm_ring_header_t *ring = (logger_shm_ring_header_t *) mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ring == MAP_FAILED)
+    {
+        perror("mmap");
+        return EXIT_FAILURE;
+    }
+    if ((__atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) != LOGGER_SHM_RING_MAGIC) || (ring->version != LOGGER_SHM_RING_VERSION) ||
+        (ring->record_size != sizeof(logger_shm_record_t)) || (ring->record_count == 0U) ||
+        (LOGGER_SHM_RING_SIZE(ring->record_count) > (size_t) info.st_size))
+    {
+        fprintf(stderr, "%s has incompatible log ring layout\n", name);
+        munmap(ring, (size_t) info.st_size);
+        return EXIT_FAILURE;
+    }
+
+    signal(SIGINT, nbt_logtail_handle_signal);
+    signal(SIGTERM, nbt_logtail_handle_signal);
+
+    // Start at oldest record still held by the ring
+    uint64_t write_sequence = __atomic_load_n(&ring->write_sequence, __ATOMIC_ACQUIRE);
+    uint64_t next = (write_sequence > ring->record_count) ? (write_sequence - ring->record_count) : 0U;
+    uint64_t lost = 0U;
+    uint32_t stalled_polls = 0U;
+    uint32_t record_count = ring->record_count;
+    int exit_status = EXIT_SUCCESS;
+    while (stop_requested == 0)
+    {
+        // Mapping only covers the layout validated above
+        if ((__atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) != LOGGER_SHM_RING_MAGIC) || (ring->record_count != record_count))
+        {
+            fprintf(stderr, "%s was re-initialized with a different layout\n", name);
+            exit_status = EXIT_FAILURE;
+            break;
+        }
+        write_sequence = __atomic_load_n(&ring->write_sequence, __ATOMIC_ACQUIRE);
+        if (write_sequence < next)
+        {
+            // Writer re-initialized the ring: resynchronize to its oldest record
+            next = (write_sequence > ring->record_count) ? (write_sequence - ring->record_count) : 0U;
+            stalled_polls = 0U;
+        }
+        if ((write_sequence - next) > ring->record_count)
+        {
+            // Reader fell behind
+            lost += (write_sequence - next) - ring->record_count;
+            next = write_sequence - ring->record_count;
+        }
+        while (next < write_sequence)
+        {
+            logger_shm_record_t record;
+            int result = nbt_logtail_read_record(ring, next, &record);
+            if (result == 0)
+            {
+                // Writer has claimed but not yet published this record, skip it if it never will be
+                // (a dump does not wait for it, later records are still printed)
+                if (follow && (++stalled_polls < NBT_LOGTAIL_STALL_POLLS))
+                {
+                    break;
+                }
+                result = -1;
+            }
+            stalled_polls = 0U;
+            if (result > 0)
+            {
+                nbt_logtail_print_record(&record, &filter);
+            }
+            else
+            {
+                lost++;
+            }
+            next++;
+        }
+        fflush(stdout);
+        if (!follow)
+        {
+            break;
+        }
+        usleep(NBT_LOGTAIL_POLL_INTERVAL_US);
+    }
+
+    if (lost > 0U)
+    {
+        fprintf(stderr, "%llu records lost (overwritten before they could be read or never published)\n", (unsigned long long) lost);
+    }
+    munmap(ring, (size_t) info.st_size);
+    return exit_status;
+}
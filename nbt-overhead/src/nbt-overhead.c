@@ -0,0 +1,667 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-overhead.c
+ * \brief Command line tool measuring the host-side overhead of the port per APDU and per I2C frame.
+ *
+ * \details Usage: nbt-overhead [-b budget] [-n bytes] [-i iterations] [-g us] [-C ns] [-A allocations] [-S syscalls]
+ *
+ * A full GP T=1' stack is run on top of the I2C driver layer with an
+ * instant-response simulated tag as transport. The tool reports CPU time
+ * (excluding the simulated tag), heap allocations and the syscalls the port
+ * would issue on real hardware. Transport calls are counted in a wrapping
+ * backend, heap and POSIX timer functions are interposed via the linker's
+ * \c --wrap option (the port is compiled into the tool, the GP T=1' libraries
+ * must be static). A run without any observed heap allocation means the
+ * interposition did not take effect and fails. Exceeding any of the given
+ * thresholds results in a non-zero exit code so the tool can gate CI.
+ *
+ * With a budget file (see \c nbt-overhead/budget.conf) each iteration runs a
+ * fixed script of SELECT FILE, UPDATE BINARY and READ BINARY instead and the
+ * per-frame syscall, allocation and timer object counts are checked against
+ * the budget.
+ */
+#include <ctype.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-i2c.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/ifx-t1prime.h"
+#include "infineon/i2c-rpi.h"
+#include "infineon/i2c-rpi-stats.h"
+#include "infineon/nbt-sim.h"
+
+/**
+ * \brief Maximum number of data bytes per READ BINARY.
+ */
+#define NBT_OVERHEAD_MAX_BYTES 4096U
+
+/**
+ * \brief Maximum length of a line in budget files.
+ */
+#define NBT_OVERHEAD_MAX_BUDGET_LINE_LEN 256U
+
+/**
+ * \brief File used by the APDU script of budget checks.
+ */
+#define NBT_OVERHEAD_SCRIPT_FID 0xe104U
+
+/** \struct NbtOverheadBudget
+ * \brief Per-frame upper bounds read from budget file (negative if unlimited).
+ */
+typedef struct
+{
+    /**
+     * \brief Maximum syscalls per I2C frame.
+     */
+    double syscalls_per_frame;
+
+    /**
+     * \brief Maximum heap allocations per I2C frame.
+     */
+    double allocations_per_frame;
+
+    /**
+     * \brief Maximum kernel timer objects created per I2C frame.
+     */
+    double timer_objects_per_frame;
+} NbtOverheadBudget;
+
+/** \struct NbtOverheadCounters
+ * \brief Operations counted while measurement is active.
+ */
+typedef struct
+{
+    /**
+     * \brief Calls of \c malloc(), \c calloc() and \c realloc().
+     */
+    uint64_t allocations;
+
+    /**
+     * \brief Calls of \c free() with non-NULL pointer.
+     */
+    uint64_t frees;
+
+    /**
+     * \brief Slave address \c ioctl() calls.
+     */
+    uint64_t ioctls;
+
+    /**
+     * \brief \c write() calls.
+     */
+    uint64_t writes;
+
+    /**
+     * \brief \c read() calls.
+     */
+    uint64_t reads;
+
+    /**
+     * \brief \c timer_create(), \c timer_settime(), \c timer_delete() and \c sigaction() calls.
+     */
+    uint64_t timer_calls;
+
+    /**
+     * \brief \c timer_create() calls (kernel timer objects).
+     */
+    uint64_t timer_objects;
+
+    /**
+     * \brief Thread CPU time in [ns] spent in the simulated tag.
+     */
+    uint64_t transport_ns;
+} NbtOverheadCounters;
+
+/**
+ * \brief Whether operations are currently counted.
+ */
+static bool counting = false;
+
+/**
+ * \brief Counted operations.
+ */
+static NbtOverheadCounters counters;
+
+/**
+ * \brief Backend of simulated tag wrapped by counting backend.
+ */
+static i2c_rpi_backend_t simulated_tag;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+void __real_free(void *pointer);
+int __real_timer_create(clockid_t clock_id, struct sigevent *event, timer_t *timer_id);
+int __real_timer_settime(timer_t timer_id, int flags, const struct itimerspec *value, struct itimerspec *old_value);
+int __real_timer_delete(timer_t timer_id);
+int __real_sigaction(int sig, const struct sigaction *action, struct sigaction *old_action);
+
+/**
+ * \brief Counting wrapper of \c malloc().
+ */
+void *__wrap_malloc(size_t size)
+{
+    counters.allocations += counting ? 1U : 0U;
+    return __real_malloc(size);
+}
+
+/**
+ * \brief Counting wrapper of \c calloc().
+ */
+void *__wrap_calloc(size_t count, size_t size)
+{
+    counters.allocations += counting ? 1U : 0U;
+    return __real_calloc(count, size);
+}
+
+/**
+ * \brief Counting wrapper of \c realloc().
+ */
+void *__wrap_realloc(void *pointer, size_t size)
+{
+    counters.allocations += counting ? 1U : 0U;
+    return __real_realloc(pointer, size);
+}
+
+/**
+ * \brief Counting wrapper of \c free().
+ */
+void __wrap_free(void *pointer)
+{
+    counters.frees += (counting && (pointer != NULL)) ? 1U : 0U;
+    __real_free(pointer);
+}
+
+/**
+ * \brief Counting wrapper of \c timer_create().
+ */
+int __wrap_timer_create(clockid_t clock_id, struct sigevent *event, timer_t *timer_id)
+{
+    counters.timer_calls += counting ? 1U : 0U;
+    counters.timer_objects += counting ? 1U : 0U;
+    return __real_timer_create(clock_id, event, timer_id);
+}
+
+/**
+ * \brief Counting wrapper of \c timer_settime().
+ */
+int __wrap_timer_settime(timer_t timer_id, int flags, const struct itimerspec *value, struct itimerspec *old_value)
+{
+    counters.timer_calls += counting ? 1U : 0U;
+    return __real_timer_settime(timer_id, flags, value, old_value);
+}
+
+/**
+ * \brief Counting wrapper of \c timer_delete().
+ */
+int __wrap_timer_delete(timer_t timer_id)
+{
+    counters.timer_calls += counting ? 1U : 0U;
+    return __real_timer_delete(timer_id);
+}
+
+/**
+ * \brief Counting wrapper of \c sigaction().
+ */
+int __wrap_sigaction(int sig, const struct sigaction *action, struct sigaction *old_action)
+{
+    counters.timer_calls += counting ? 1U : 0U;
+    return __real_sigaction(sig, action, old_action);
+}
+
+/**
+ * \brief Returns current time in [ns] of given clock.
+ *
+ * \param[in] clock_id Clock to be read.
+ * \return uint64_t Current time in [ns].
+ */
+static uint64_t nbt_overhead_get_time_ns(clockid_t clock_id)
+{
+    struct timespec now;
+    clock_gettime(clock_id, &now);
+    return ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_set_slave_address_t counting the \c ioctl() the i2c-dev backend would issue.
+ *
+ * \see i2c_rpi_backend_set_slave_address_t
+ */
+static int nbt_overhead_set_slave_address(void *context, int native_instance, uint8_t slave_address)
+{
+    (void) context;
+    counters.ioctls += counting ? 1U : 0U;
+    uint64_t start_ns = nbt_overhead_get_time_ns(CLOCK_THREAD_CPUTIME_ID);
+    int result = simulated_tag.set_slave_address(simulated_tag.context, native_instance, slave_address);
+    counters.transport_ns += nbt_overhead_get_time_ns(CLOCK_THREAD_CPUTIME_ID) - start_ns;
+    return result;
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_write_t counting the \c write() the i2c-dev backend would issue.
+ *
+ * \see i2c_rpi_backend_write_t
+ */
+static ssize_t nbt_overhead_write(void *context, int native_instance, const uint8_t *data, size_t data_len)
+{
+    (void) context;
+    counters.writes += counting ? 1U : 0U;
+    uint64_t start_ns = nbt_overhead_get_time_ns(CLOCK_THREAD_CPUTIME_ID);
+    ssize_t result = simulated_tag.write(simulated_tag.context, native_instance, data, data_len);
+    counters.transport_ns += nbt_overhead_get_time_ns(CLOCK_THREAD_CPUTIME_ID) - start_ns;
+    return result;
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_read_t counting the \c read() the i2c-dev backend would issue.
+ *
+ * \see i2c_rpi_backend_read_t
+ */
+static ssize_t nbt_overhead_read(void *context, int native_instance, uint8_t *buffer, size_t buffer_len)
+{
+    (void) context;
+    counters.reads += counting ? 1U : 0U;
+    uint64_t start_ns = nbt_overhead_get_time_ns(CLOCK_THREAD_CPUTIME_ID);
+    ssize_t result = simulated_tag.read(simulated_tag.context, native_instance, buffer, buffer_len);
+    counters.transport_ns += nbt_overhead_get_time_ns(CLOCK_THREAD_CPUTIME_ID) - start_ns;
+    return result;
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_destroy_t freeing the wrapped simulated tag.
+ *
+ * \see i2c_rpi_backend_destroy_t
+ */
+static void nbt_overhead_destroy(void *context)
+{
+    (void) context;
+    simulated_tag.destroy(simulated_tag.context);
+}
+
+/**
+ * \brief Prints usage information.
+ *
+ * \param[in] program Name of the executable.
+ */
+static void nbt_overhead_usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [-b budget] [-n bytes] [-i iterations] [-g us] [-C ns] [-A allocations] [-S syscalls]\n"
+            "  -b budget       run APDU script and fail if per-frame budget in file is exceeded\n"
+            "  -n bytes        data bytes per READ BINARY and UPDATE BINARY (1 to %u, default 32)\n"
+            "  -i iterations   measured APDUs or script runs (default 10000)\n"
+            "  -g us           I2C guard time (default 0)\n"
+            "  -C ns           fail if CPU time per APDU exceeds ns\n"
+            "  -A allocations  fail if heap allocations per APDU exceed allocations\n"
+            "  -S syscalls     fail if syscalls per APDU exceed syscalls\n",
+            program, NBT_OVERHEAD_MAX_BYTES);
+}
+
+/**
+ * \brief Parses unsigned number given on command line.
+ *
+ * \param[in] text Text to be parsed.
+ * \param[in] max Maximum accepted value.
+ * \param[out] value Buffer to store value in.
+ * \return bool \c true if successful.
+ */
+static bool nbt_overhead_parse_number(const char *text, unsigned long max, unsigned long *value)
+{
+    char *end = NULL;
+    unsigned long parsed = strtoul(text, &end, 0);
+    if ((end == text) || (*end != '\0') || (parsed > max))
+    {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+/**
+ * \brief Parses threshold given on command line.
+ *
+ * \param[in] text Text to be parsed.
+ * \param[out] value Buffer to store value in.
+ * \return bool \c true if successful.
+ */
+static bool nbt_overhead_parse_threshold(const char *text, double *value)
+{
+    char *end = NULL;
+    double parsed = strtod(text, &end);
+    if ((end == text) || (*end != '\0') || (parsed < 0.0))
+    {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+/**
+ * \brief Reads per-frame budget and optional run parameters from file.
+ *
+ * \details Lines have the form \c key=value, empty lines and lines starting
+ * with \c # are ignored. Budget keys are \c syscalls_per_frame,
+ * \c allocations_per_frame and \c timer_objects_per_frame, run parameters
+ * \c bytes, \c iterations and \c guard_time_us (overridden by later options).
+ *
+ * \param[in] path Path of budget file.
+ * \param[out] budget Buffer to store budget in.
+ * \param[in,out] bytes Data bytes per APDU.
+ * \param[in,out] iterations Number of script runs.
+ * \param[in,out] guard_time_us I2C guard time.
+ * \return bool \c true if successful.
+ */
+static bool nbt_overhead_read_budget(const char *path, NbtOverheadBudget *budget, unsigned long *bytes, unsigned long *iterations,
+                                     unsigned long *guard_time_us)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    char line[NBT_OVERHEAD_MAX_BUDGET_LINE_LEN];
+    unsigned line_number = 0U;
+    bool valid = true;
+    while (valid && (fgets(line, sizeof(line), file) != NULL))
+    {
+        line_number++;
+
+        // Strip surrounding whitespace
+        char *key = line;
+        while (isspace((unsigned char) *key))
+        {
+            key++;
+        }
+        size_t len = strlen(key);
+        while ((len > 0U) && isspace((unsigned char) key[len - 1U]))
+        {
+            key[--len] = '\0';
+        }
+        if ((*key == '\0') || (*key == '#'))
+        {
+            continue;
+        }
+
+        char *value = strchr(key, '=');
+        if (value == NULL)
+        {
+            valid = false;
+            break;
+        }
+        char *key_end = value;
+        *value++ = '\0';
+        while ((key_end > key) && isspace((unsigned char) key_end[-1]))
+        {
+            *--key_end = '\0';
+        }
+        while (isspace((unsigned char) *value))
+        {
+            value++;
+        }
+
+        if (strcmp(key, "syscalls_per_frame") == 0)
+        {
+            valid = nbt_overhead_parse_threshold(value, &budget->syscalls_per_frame);
+        }
+        else if (strcmp(key, "allocations_per_frame") == 0)
+        {
+            valid = nbt_overhead_parse_threshold(value, &budget->allocations_per_frame);
+        }
+        else if (strcmp(key, "timer_objects_per_frame") == 0)
+        {
+            valid = nbt_overhead_parse_threshold(value, &budget->timer_objects_per_frame);
+        }
+        else if (strcmp(key, "bytes") == 0)
+        {
+            valid = nbt_overhead_parse_number(value, NBT_OVERHEAD_MAX_BYTES, bytes) && (*bytes != 0U);
+        }
+        else if (strcmp(key, "iterations") == 0)
+        {
+            valid = nbt_overhead_parse_number(value, UINT32_MAX, iterations) && (*iterations != 0U);
+        }
+        else if (strcmp(key, "guard_time_us") == 0)
+        {
+            valid = nbt_overhead_parse_number(value, UINT32_MAX, guard_time_us);
+        }
+        else
+        {
+            valid = false;
+        }
+    }
+    if (!valid)
+    {
+        fprintf(stderr, "%s:%u: invalid budget entry\n", path, line_number);
+    }
+    fclose(file);
+    return valid;
+}
+
+/**
+ * \brief Exchanges single APDU and checks for successful status word.
+ *
+ * \param[in] protocol Protocol stack to be used.
+ * \param[in] apdu Command APDU.
+ * \param[in] apdu_len Number of bytes in \p apdu.
+ * \return bool \c true if successful.
+ */
+static bool nbt_overhead_exchange(ifx_protocol_t *protocol, const uint8_t *apdu, size_t apdu_len)
+{
+    uint8_t *response = NULL;
+    size_t response_len = 0U;
+    ifx_status_t status = ifx_protocol_transceive(protocol, apdu, apdu_len, &response, &response_len);
+    bool success = !ifx_error_check(status) && (response != NULL) && (response_len >= 2U) && (response[response_len - 2U] == 0x90U) &&
+                   (response[response_len - 1U] == 0x00U);
+    if (response != NULL)
+    {
+        free(response);
+    }
+    return success;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long bytes = 32U;
+    unsigned long iterations = 10000U;
+    unsigned long guard_time_us = 0U;
+    double max_cpu_ns = -1.0;
+    double max_allocations = -1.0;
+    double max_syscalls = -1.0;
+    NbtOverheadBudget budget = {-1.0, -1.0, -1.0};
+    bool script = false;
+
+    int option;
+    bool valid = true;
+    while (valid && ((option = getopt(argc, argv, "b:n:i:g:C:A:S:h")) != -1))
+    {
+        switch (option)
+        {
+        case 'b':
+            valid = nbt_overhead_read_budget(optarg, &budget, &bytes, &iterations, &guard_time_us);
+            script = true;
+            break;
+        case 'n':
+            valid = nbt_overhead_parse_number(optarg, NBT_OVERHEAD_MAX_BYTES, &bytes) && (bytes != 0U);
+            break;
+        case 'i':
+            valid = nbt_overhead_parse_number(optarg, UINT32_MAX, &iterations) && (iterations != 0U);
+            break;
+        case 'g':
+            valid = nbt_overhead_parse_number(optarg, UINT32_MAX, &guard_time_us);
+            break;
+        case 'C':
+            valid = nbt_overhead_parse_threshold(optarg, &max_cpu_ns);
+            break;
+        case 'A':
+            valid = nbt_overhead_parse_threshold(optarg, &max_allocations);
+            break;
+        case 'S':
+            valid = nbt_overhead_parse_threshold(optarg, &max_syscalls);
+            break;
+        default:
+            valid = false;
+            break;
+        }
+    }
+    if (!valid || (optind != argc))
+    {
+        nbt_overhead_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Build GP T=1' stack on top of I2C layer with counting instant-response transport
+    int fd = open("/dev/null", O_RDWR);
+    if (fd < 0)
+    {
+        perror("open");
+        return EXIT_FAILURE;
+    }
+    ifx_protocol_t driver_adapter;
+    ifx_protocol_t protocol;
+    ifx_status_t status = i2c_rpi_initialize(&driver_adapter, fd, 0x18U);
+    if (!ifx_error_check(status))
+    {
+        status = nbt_sim_initialize(&simulated_tag, 0U);
+        if (ifx_error_check(status))
+        {
+            ifx_protocol_destroy(&driver_adapter);
+        }
+    }
+    if (ifx_error_check(status))
+    {
+        fprintf(stderr, "Could not initialize I2C driver adapter (0x%08x)\n", (unsigned) status);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    i2c_rpi_backend_t backend = {NULL, nbt_overhead_set_slave_address, nbt_overhead_write, nbt_overhead_read, nbt_overhead_destroy};
+    i2c_rpi_set_backend(&driver_adapter, &backend);
+    status = ifx_t1prime_initialize(&protocol, &driver_adapter);
+    if (!ifx_error_check(status))
+    {
+        status = ifx_protocol_activate(&protocol, NULL, NULL);
+    }
+    if (!ifx_error_check(status))
+    {
+        status = ifx_i2c_set_guard_time(&protocol, (uint32_t) guard_time_us);
+    }
+    uint8_t select_application[] = {0x00U, 0xa4U, 0x04U, 0x00U, 0x07U, 0xd2U, 0x76U, 0x00U, 0x00U, 0x85U, 0x01U, 0x01U, 0x00U};
+    uint8_t select_file[] = {0x00U, 0xa4U, 0x00U, 0x0cU, 0x02U, 0xe1U, 0x04U};
+    if (ifx_error_check(status) || !nbt_overhead_exchange(&protocol, select_application, sizeof(select_application)) ||
+        !nbt_overhead_exchange(&protocol, select_file, sizeof(select_file)))
+    {
+        fprintf(stderr, "Could not set up GP T=1' stack (0x%08x)\n", (unsigned) status);
+        ifx_protocol_destroy(&protocol);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    // READ BINARY of requested length
+    uint8_t read_binary[7] = {0x00U, 0xb0U, 0x00U, 0x00U, (uint8_t) bytes, 0x00U, 0x00U};
+    size_t read_binary_len = 5U;
+    if (bytes > 256U)
+    {
+        read_binary[4] = 0x00U;
+        read_binary[5] = (uint8_t) (bytes >> 8);
+        read_binary[6] = (uint8_t) bytes;
+        read_binary_len = 7U;
+    }
+
+    // UPDATE BINARY of requested length for APDU script
+    static uint8_t update_binary[7U + NBT_OVERHEAD_MAX_BYTES];
+    size_t update_binary_header_len = 5U;
+    update_binary[0] = 0x00U;
+    update_binary[1] = 0xd6U;
+    update_binary[2] = 0x00U;
+    update_binary[3] = 0x00U;
+    update_binary[4] = (uint8_t) bytes;
+    if (bytes > 255U)
+    {
+        update_binary[4] = 0x00U;
+        update_binary[5] = (uint8_t) (bytes >> 8);
+        update_binary[6] = (uint8_t) bytes;
+        update_binary_header_len = 7U;
+    }
+    for (unsigned long i = 0U; i < bytes; i++)
+    {
+        update_binary[update_binary_header_len + i] = (uint8_t) i;
+    }
+    size_t update_binary_len = update_binary_header_len + bytes;
+
+    // Measure
+    unsigned long errors = 0U;
+    i2c_rpi_reset_counters(&protocol);
+    memset(&counters, 0, sizeof(counters));
+    counting = true;
+    uint64_t start_ns = nbt_overhead_get_time_ns(CLOCK_THREAD_CPUTIME_ID);
+    for (unsigned long i = 0U; i < iterations; i++)
+    {
+        if (script && (!nbt_overhead_exchange(&protocol, select_file, sizeof(select_file)) ||
+                       !nbt_overhead_exchange(&protocol, update_binary, update_binary_len)))
+        {
+            errors++;
+        }
+        if (!nbt_overhead_exchange(&protocol, read_binary, read_binary_len))
+        {
+            errors++;
+        }
+    }
+    uint64_t cpu_ns = nbt_overhead_get_time_ns(CLOCK_THREAD_CPUTIME_ID) - start_ns;
+    counting = false;
+
+    // Evaluate
+    i2c_rpi_counters_t frames;
+    memset(&frames, 0, sizeof(frames));
+    i2c_rpi_get_counters(&protocol, &frames);
+    uint64_t frame_count = frames.frames_sent + frames.frames_received;
+    uint64_t port_ns = (cpu_ns > counters.transport_ns) ? (cpu_ns - counters.transport_ns) : 0U;
+    uint64_t syscalls = counters.ioctls + counters.writes + counters.reads + counters.timer_calls;
+    uint64_t apdus = (uint64_t) iterations * (script ? 3U : 1U);
+    double cpu_ns_per_apdu = (double) port_ns / (double) apdus;
+    double allocations_per_apdu = (double) counters.allocations / (double) apdus;
+    double syscalls_per_apdu = (double) syscalls / (double) apdus;
+    double syscalls_per_frame = (frame_count > 0U) ? ((double) syscalls / (double) frame_count) : 0.0;
+    double allocations_per_frame = (frame_count > 0U) ? ((double) counters.allocations / (double) frame_count) : 0.0;
+    double timer_objects_per_frame = (frame_count > 0U) ? ((double) counters.timer_objects / (double) frame_count) : 0.0;
+    bool interposed = counters.allocations > 0U;
+    bool pass = interposed && (errors == 0U) && ((max_cpu_ns < 0.0) || (cpu_ns_per_apdu <= max_cpu_ns)) &&
+                ((max_allocations < 0.0) || (allocations_per_apdu <= max_allocations)) && ((max_syscalls < 0.0) || (syscalls_per_apdu <= max_syscalls)) &&
+                ((budget.syscalls_per_frame < 0.0) || (syscalls_per_frame <= budget.syscalls_per_frame)) &&
+                ((budget.allocations_per_frame < 0.0) || (allocations_per_frame <= budget.allocations_per_frame)) &&
+                ((budget.timer_objects_per_frame < 0.0) || (timer_objects_per_frame <= budget.timer_objects_per_frame));
+
+    printf("{\"script\":%s,\"bytes\":%lu,\"iterations\":%lu,\"errors\":%lu,\"guard_time_us\":%lu,\"frames\":%llu,"
+           "\"per_apdu\":{\"cpu_ns\":%.1f,\"transport_ns\":%.1f,\"allocations\":%.2f,\"frees\":%.2f,\"syscalls\":%.2f},"
+           "\"per_frame\":{\"cpu_ns\":%.1f,\"allocations\":%.2f,\"syscalls\":%.2f,\"timer_objects\":%.2f},"
+           "\"syscalls\":{\"ioctl\":%llu,\"write\":%llu,\"read\":%llu,\"timer\":%llu,\"timer_create\":%llu},\"pass\":%s}\n",
+           script ? "true" : "false", bytes, iterations, errors, guard_time_us, (unsigned long long) frame_count, cpu_ns_per_apdu,
+           (double) counters.transport_ns / (double) apdus, allocations_per_apdu, (double) counters.frees / (double) apdus,
+           syscalls_per_apdu, (frame_count > 0U) ? ((double) port_ns / (double) frame_count) : 0.0, allocations_per_frame, syscalls_per_frame,
+           timer_objects_per_frame, (unsigned long long) counters.ioctls, (unsigned long long) counters.writes,
+           (unsigned long long) counters.reads, (unsigned long long) counters.timer_calls, (unsigned long long) counters.timer_objects,
+           pass ? "true" : "false");
+    if (!interposed)
+    {
+        fprintf(stderr, "No heap allocation observed, heap functions are not interposed (shared library build?)\n");
+    }
+    else if (!pass)
+    {
+        fprintf(stderr, "Port overhead threshold exceeded\n");
+    }
+
+    ifx_protocol_destroy(&protocol);
+    close(fd);
+    return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,761 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-provision.c
+ * \brief Command line tool personalising many NBTs on several I2C buses in parallel.
+ *
+ * \details Usage: nbt-provision [-s [-p us]] [-j workers] [-o output] manifest
+ *
+ * Each manifest line assigns a payload to a file of a tag:
+ *
+ *     # device     address  fid   payload (hex)
+ *     /dev/i2c-1   0x18     e104  0003d00000
+ *
+ * Lines of the same device and address form one job that writes, reads back
+ * and verifies all files of that tag. Every bus gets its own group of
+ * workers, each with its own file descriptor (so the kernel arbitrates the
+ * bus per transfer), so a slow or failing tag only occupies one worker while
+ * the others keep the bus busy. One JSON line per file is appended to the
+ * output as soon as it is done, followed by a summary line.
+ */
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/ifx-t1prime.h"
+#include "infineon/i2c-rpi.h"
+#include "infineon/nbt-file.h"
+#include "infineon/nbt-sim.h"
+
+/**
+ * \brief Default number of workers per bus.
+ */
+#define NBT_PROVISION_DEFAULT_WORKERS 4U
+
+/**
+ * \brief Maximum number of workers per bus.
+ */
+#define NBT_PROVISION_MAX_WORKERS 64U
+
+/**
+ * \brief Maximum payload per file in [bytes].
+ */
+#define NBT_PROVISION_MAX_PAYLOAD_LEN 0x8000U
+
+/** \struct NbtProvisionFile
+ * \brief Payload of a single file.
+ */
+typedef struct
+{
+    /**
+     * \brief File ID.
+     */
+    uint16_t fid;
+
+    /**
+     * \brief Data to be written.
+     */
+    uint8_t *data;
+
+    /**
+     * \brief Number of bytes in \ref NbtProvisionFile.data.
+     */
+    size_t len;
+} NbtProvisionFile;
+
+/** \struct NbtProvisionTag
+ * \brief Job provisioning all files of a single tag.
+ */
+typedef struct
+{
+    /**
+     * \brief I2C slave address.
+     */
+    uint8_t address;
+
+    /**
+     * \brief Files to be provisioned in manifest order.
+     */
+    NbtProvisionFile *files;
+
+    /**
+     * \brief Number of entries in \ref NbtProvisionTag.files.
+     */
+    size_t file_count;
+} NbtProvisionTag;
+
+/** \struct NbtProvisionBus
+ * \brief Jobs of a single I2C bus shared by its workers.
+ */
+typedef struct
+{
+    /**
+     * \brief I2C character device.
+     */
+    char *device;
+
+    /**
+     * \brief Tags on this bus.
+     */
+    NbtProvisionTag *tags;
+
+    /**
+     * \brief Number of entries in \ref NbtProvisionBus.tags.
+     */
+    size_t tag_count;
+
+    /**
+     * \brief Index of next tag to be provisioned (protected by \ref NbtProvisionBus.lock).
+     */
+    size_t next_tag;
+
+    /**
+     * \brief Lock protecting \ref NbtProvisionBus.next_tag (initialized once manifest is complete).
+     */
+    pthread_mutex_t lock;
+
+    /**
+     * \brief Number of worker threads started for this bus.
+     */
+    size_t started_workers;
+} NbtProvisionBus;
+
+/** \struct NbtProvisionContext
+ * \brief Settings and results shared by all workers.
+ */
+typedef struct
+{
+    /**
+     * \brief Whether simulated tags are used instead of I2C devices.
+     */
+    bool simulated;
+
+    /**
+     * \brief Processing time per block of simulated tags in [us].
+     */
+    uint32_t processing_time_us;
+
+    /**
+     * \brief Stream results are written to (protected by \ref NbtProvisionContext.lock).
+     */
+    FILE *output;
+
+    /**
+     * \brief Files successfully provisioned (protected by \ref NbtProvisionContext.lock).
+     */
+    size_t succeeded;
+
+    /**
+     * \brief Files not provisioned (protected by \ref NbtProvisionContext.lock).
+     */
+    size_t failed;
+
+    /**
+     * \brief Lock serializing result output.
+     */
+    pthread_mutex_t lock;
+} NbtProvisionContext;
+
+/** \struct NbtProvisionWorker
+ * \brief Arguments of a single worker thread.
+ */
+typedef struct
+{
+    /**
+     * \brief Bus the worker takes jobs from.
+     */
+    NbtProvisionBus *bus;
+
+    /**
+     * \brief Shared settings and results.
+     */
+    NbtProvisionContext *context;
+
+    /**
+     * \brief Thread running the worker.
+     */
+    pthread_t thread;
+} NbtProvisionWorker;
+
+/**
+ * \brief Prints usage information.
+ *
+ * \param[in] program Name of the executable.
+ */
+static void nbt_provision_usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [-s [-p us]] [-j workers] [-o output] manifest\n"
+            "  -s             use simulated tags instead of I2C devices\n"
+            "  -p us          processing time per block of simulated tags (default 0)\n"
+            "  -j workers     maximum workers per bus (1 to %u, default %u)\n"
+            "  -o output      append results to file instead of stdout\n"
+            "manifest lines: device address fid payload-hex\n",
+            program, NBT_PROVISION_MAX_WORKERS, NBT_PROVISION_DEFAULT_WORKERS);
+}
+
+/**
+ * \brief Returns current \c CLOCK_MONOTONIC time in [ns].
+ *
+ * \return uint64_t Current monotonic time in [ns].
+ */
+static uint64_t nbt_provision_get_monotonic_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * \brief Parses unsigned number (decimal or \c 0x prefixed).
+ *
+ * \param[in] text Text to be parsed.
+ * \param[in] base Base of number (\c 0 for automatic).
+ * \param[in] max Maximum accepted value.
+ * \param[out] value Buffer to store value in.
+ * \return bool \c true if successful.
+ */
+static bool nbt_provision_parse_number(const char *text, int base, unsigned long max, unsigned long *value)
+{
+    char *end = NULL;
+    unsigned long parsed = strtoul(text, &end, base);
+    if ((end == text) || (*end != '\0') || (parsed > max))
+    {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+/**
+ * \brief Decodes hex string.
+ *
+ * \param[in] text Hex string of even length.
+ * \param[out] data Buffer to store newly allocated data in.
+ * \param[out] len Buffer to store number of bytes in \p data in.
+ * \return bool \c true if successful.
+ */
+static bool nbt_provision_parse_hex(const char *text, uint8_t **data, size_t *len)
+{
+    size_t text_len = strlen(text);
+    if (((text_len % 2U) != 0U) || (text_len == 0U) || ((text_len / 2U) > NBT_PROVISION_MAX_PAYLOAD_LEN))
+    {
+        return false;
+    }
+    uint8_t *decoded = malloc(text_len / 2U);
+    if (decoded == NULL)
+    {
+        return false;
+    }
+    for (size_t i = 0U; i < (text_len / 2U); i++)
+    {
+        char digits[3] = {text[2U * i], text[(2U * i) + 1U], '\0'};
+        unsigned long value = 0U;
+        if ((digits[0] == '+') || (digits[0] == '-') || !nbt_provision_parse_number(digits, 16, 0xffU, &value))
+        {
+            free(decoded);
+            return false;
+        }
+        decoded[i] = (uint8_t) value;
+    }
+    *data = decoded;
+    *len = text_len / 2U;
+    return true;
+}
+
+/**
+ * \brief Returns bus of device, adding it if not known yet.
+ *
+ * \param[in,out] buses Known buses.
+ * \param[in,out] bus_count Number of entries in \p buses.
+ * \param[in] device I2C character device.
+ * \return NbtProvisionBus* Bus or \c NULL if out of memory.
+ */
+static NbtProvisionBus *nbt_provision_get_bus(NbtProvisionBus **buses, size_t *bus_count, const char *device)
+{
+    for (size_t i = 0U; i < *bus_count; i++)
+    {
+        if (strcmp((*buses)[i].device, device) == 0)
+        {
+            return &(*buses)[i];
+        }
+    }
+    NbtProvisionBus *grown = realloc(*buses, (*bus_count + 1U) * sizeof(NbtProvisionBus));
+    if (grown == NULL)
+    {
+        return NULL;
+    }
+    *buses = grown;
+    NbtProvisionBus *bus = &grown[*bus_count];
+    memset(bus, 0, sizeof(NbtProvisionBus));
+    bus->device = strdup(device);
+    if (bus->device == NULL)
+    {
+        return NULL;
+    }
+    (*bus_count)++;
+    return bus;
+}
+
+/**
+ * \brief Returns tag of bus, adding it if not known yet.
+ *
+ * \param[in,out] bus Bus the tag is connected to.
+ * \param[in] address I2C slave address.
+ * \return NbtProvisionTag* Tag or \c NULL if out of memory.
+ */
+static NbtProvisionTag *nbt_provision_get_tag(NbtProvisionBus *bus, uint8_t address)
+{
+    for (size_t i = 0U; i < bus->tag_count; i++)
+    {
+        if (bus->tags[i].address == address)
+        {
+            return &bus->tags[i];
+        }
+    }
+    NbtProvisionTag *grown = realloc(bus->tags, (bus->tag_count + 1U) * sizeof(NbtProvisionTag));
+    if (grown == NULL)
+    {
+        return NULL;
+    }
+    bus->tags = grown;
+    NbtProvisionTag *tag = &grown[bus->tag_count++];
+    memset(tag, 0, sizeof(NbtProvisionTag));
+    tag->address = address;
+    return tag;
+}
+
+/**
+ * \brief Reads manifest and groups its lines by bus and tag.
+ *
+ * \param[in] path Path of manifest.
+ * \param[out] buses Buffer to store newly allocated buses in.
+ * \param[out] bus_count Buffer to store number of buses in.
+ * \return bool \c true if successful.
+ */
+static bool nbt_provision_read_manifest(const char *path, NbtProvisionBus **buses, size_t *bus_count)
+{
+    FILE *manifest = fopen(path, "r");
+    if (manifest == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    char *line = NULL;
+    size_t line_capacity = 0U;
+    unsigned line_number = 0U;
+    bool valid = true;
+    while (valid && (getline(&line, &line_capacity, manifest) != -1))
+    {
+        line_number++;
+        char *save = NULL;
+        char *device = strtok_r(line, " \t\r\n", &save);
+        if ((device == NULL) || (device[0] == '#'))
+        {
+            continue;
+        }
+        char *address_text = strtok_r(NULL, " \t\r\n", &save);
+        char *fid_text = strtok_r(NULL, " \t\r\n", &save);
+        char *payload_text = strtok_r(NULL, " \t\r\n", &save);
+        unsigned long address = 0U;
+        unsigned long fid = 0U;
+        NbtProvisionFile file;
+        valid = (payload_text != NULL) && (strtok_r(NULL, " \t\r\n", &save) == NULL) && nbt_provision_parse_number(address_text, 0, 0x7fU, &address) &&
+                nbt_provision_parse_number(fid_text, 16, 0xffffU, &fid) && (fid != NBT_FILE_SELECTED) &&
+                nbt_provision_parse_hex(payload_text, &file.data, &file.len);
+        if (!valid)
+        {
+            fprintf(stderr, "%s:%u: invalid manifest line\n", path, line_number);
+            break;
+        }
+        file.fid = (uint16_t) fid;
+
+        NbtProvisionBus *bus = nbt_provision_get_bus(buses, bus_count, device);
+        NbtProvisionTag *tag = (bus != NULL) ? nbt_provision_get_tag(bus, (uint8_t) address) : NULL;
+        NbtProvisionFile *files = (tag != NULL) ? realloc(tag->files, (tag->file_count + 1U) * sizeof(NbtProvisionFile)) : NULL;
+        if (files == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            free(file.data);
+            valid = false;
+            break;
+        }
+        tag->files = files;
+        tag->files[tag->file_count++] = file;
+    }
+    free(line);
+    fclose(manifest);
+    if (valid && (*bus_count == 0U))
+    {
+        fprintf(stderr, "%s: no tags to provision\n", path);
+        valid = false;
+    }
+    return valid;
+}
+
+/**
+ * \brief Frees all buses read from manifest.
+ *
+ * \param[in] buses Buses to be freed.
+ * \param[in] bus_count Number of entries in \p buses.
+ */
+static void nbt_provision_free_manifest(NbtProvisionBus *buses, size_t bus_count)
+{
+    for (size_t i = 0U; i < bus_count; i++)
+    {
+        for (size_t j = 0U; j < buses[i].tag_count; j++)
+        {
+            for (size_t k = 0U; k < buses[i].tags[j].file_count; k++)
+            {
+                free(buses[i].tags[j].files[k].data);
+            }
+            free(buses[i].tags[j].files);
+        }
+        free(buses[i].tags);
+        free(buses[i].device);
+    }
+    free(buses);
+}
+
+/**
+ * \brief Writes result of a single file as JSON line.
+ *
+ * \param[in] context Shared settings and results.
+ * \param[in] bus Bus of the tag.
+ * \param[in] tag Provisioned tag.
+ * \param[in] file Provisioned file.
+ * \param[in] stage Stage that failed or \c "verify" if successful.
+ * \param[in] status Result of the stage.
+ * \param[in] write_stats Statistics of write stage.
+ * \param[in] read_stats Statistics of read-back stage.
+ */
+static void nbt_provision_report(NbtProvisionContext *context, const NbtProvisionBus *bus, const NbtProvisionTag *tag, const NbtProvisionFile *file,
+                                 const char *stage, ifx_status_t status, const nbt_file_transfer_stats_t *write_stats,
+                                 const nbt_file_transfer_stats_t *read_stats)
+{
+    bool ok = !ifx_error_check(status);
+    pthread_mutex_lock(&context->lock);
+    fprintf(context->output, "{\"device\":\"");
+    for (const char *c = bus->device; *c != '\0'; c++)
+    {
+        if ((*c == '"') || (*c == '\\'))
+        {
+            fputc('\\', context->output);
+        }
+        if ((unsigned char) *c >= 0x20U)
+        {
+            fputc(*c, context->output);
+        }
+    }
+    fprintf(context->output,
+            "\",\"address\":\"0x%02x\",\"fid\":\"0x%04x\",\"bytes\":%zu,\"result\":\"%s\",\"stage\":\"%s\",\"status\":\"0x%08x\","
+            "\"write_ms\":%.3f,\"write_apdus\":%zu,\"read_ms\":%.3f,\"read_apdus\":%zu}\n",
+            (unsigned) tag->address, (unsigned) file->fid, file->len, ok ? "ok" : "failed", stage, (unsigned) status,
+            (double) write_stats->elapsed_ns / 1e6, write_stats->apdus, (double) read_stats->elapsed_ns / 1e6, read_stats->apdus);
+    fflush(context->output);
+    if (ok)
+    {
+        context->succeeded++;
+    }
+    else
+    {
+        context->failed++;
+    }
+    pthread_mutex_unlock(&context->lock);
+}
+
+/**
+ * \brief Writes, reads back and verifies all files of a single tag.
+ *
+ * \param[in] context Shared settings and results.
+ * \param[in] bus Bus of the tag.
+ * \param[in] tag Tag to be provisioned.
+ */
+static void nbt_provision_tag(NbtProvisionContext *context, const NbtProvisionBus *bus, const NbtProvisionTag *tag)
+{
+    nbt_file_transfer_stats_t write_stats;
+    nbt_file_transfer_stats_t read_stats;
+    memset(&write_stats, 0, sizeof(write_stats));
+    memset(&read_stats, 0, sizeof(read_stats));
+
+    // Own descriptor per worker, i2c-dev keeps the slave address per descriptor
+    int fd = open(context->simulated ? "/dev/null" : bus->device, O_RDWR);
+    if (fd < 0)
+    {
+        for (size_t i = 0U; i < tag->file_count; i++)
+        {
+            nbt_provision_report(context, bus, tag, &tag->files[i], "setup", IFX_ERROR(LIBI2CRPI, IFX_PROTOCOL_LAYER_INITIALIZE, IFX_UNSPECIFIED_ERROR),
+                                 &write_stats, &read_stats);
+        }
+        return;
+    }
+
+    // Build and activate GP T=1' stack
+    ifx_protocol_t driver_adapter;
+    ifx_protocol_t protocol;
+    bool stack_initialized = false;
+    ifx_status_t status = i2c_rpi_initialize(&driver_adapter, fd, tag->address);
+    if (!ifx_error_check(status) && context->simulated)
+    {
+        i2c_rpi_backend_t backend;
+        status = nbt_sim_initialize(&backend, context->processing_time_us);
+        if (!ifx_error_check(status))
+        {
+            status = i2c_rpi_set_backend(&driver_adapter, &backend);
+
+            // Backend is only owned by the I2C layer once installed
+            if (ifx_error_check(status) && (backend.destroy != NULL))
+            {
+                backend.destroy(backend.context);
+            }
+        }
+    }
+    if (!ifx_error_check(status))
+    {
+        status = ifx_t1prime_initialize(&protocol, &driver_adapter);
+        stack_initialized = !ifx_error_check(status);
+    }
+    if (!stack_initialized)
+    {
+        ifx_protocol_destroy(&driver_adapter);
+    }
+    uint8_t *cip = NULL;
+    size_t cip_len = 0U;
+    if (stack_initialized)
+    {
+        status = ifx_protocol_activate(&protocol, &cip, &cip_len);
+    }
+    nbt_file_t engine;
+    if (!ifx_error_check(status))
+    {
+        status = nbt_file_initialize(&engine, &protocol, cip, cip_len, 0U);
+    }
+    free(cip);
+    if (!ifx_error_check(status))
+    {
+        uint8_t select_application[] = {0x00U, 0xa4U, 0x04U, 0x00U, 0x07U, 0xd2U, 0x76U, 0x00U, 0x00U, 0x85U, 0x01U, 0x01U, 0x00U};
+        uint8_t *response = NULL;
+        size_t response_len = 0U;
+        status = ifx_protocol_transceive(&protocol, select_application, sizeof(select_application), &response, &response_len);
+        if (!ifx_error_check(status) && ((response_len < 2U) || (response[response_len - 2U] != 0x90U) || (response[response_len - 1U] != 0x00U)))
+        {
+            status = IFX_ERROR(LIBNBTFILE, IFX_PROTOCOL_TRANSCEIVE, NBT_FILE_STATUS_WORD_ERROR);
+        }
+        free(response);
+    }
+
+    // Write, read back and verify each file, a failure skips the rest of the tag
+    uint8_t *readback = NULL;
+    for (size_t i = 0U; i < tag->file_count; i++)
+    {
+        const NbtProvisionFile *file = &tag->files[i];
+        memset(&write_stats, 0, sizeof(write_stats));
+        memset(&read_stats, 0, sizeof(read_stats));
+        if (ifx_error_check(status))
+        {
+            nbt_provision_report(context, bus, tag, file, (i == 0U) ? "setup" : "skipped", status, &write_stats, &read_stats);
+            continue;
+        }
+
+        uint8_t *grown = realloc(readback, file->len);
+        if (grown == NULL)
+        {
+            status = IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_READ, IFX_OUT_OF_MEMORY);
+            nbt_provision_report(context, bus, tag, file, "read", status, &write_stats, &read_stats);
+            continue;
+        }
+        readback = grown;
+
+        const char *stage = "write";
+        status = nbt_file_write(&engine, file->fid, 0U, file->data, file->len, &write_stats);
+        if (!ifx_error_check(status))
+        {
+            stage = "read";
+            status = nbt_file_read(&engine, file->fid, 0U, readback, file->len, &read_stats);
+        }
+        if (!ifx_error_check(status))
+        {
+            stage = "verify";
+            if (memcmp(readback, file->data, file->len) != 0)
+            {
+                status = IFX_ERROR(LIBNBTFILE, IFX_NBT_FILE_READ, IFX_UNSPECIFIED_ERROR);
+            }
+        }
+        nbt_provision_report(context, bus, tag, file, stage, status, &write_stats, &read_stats);
+    }
+    free(readback);
+
+    if (stack_initialized)
+    {
+        ifx_protocol_destroy(&protocol);
+    }
+    close(fd);
+}
+
+/**
+ * \brief Worker thread provisioning tags of its bus until none are left.
+ *
+ * \param[in] arg \ref NbtProvisionWorker of this thread.
+ * \return void* Always \c NULL.
+ */
+static void *nbt_provision_worker(void *arg)
+{
+    NbtProvisionWorker *worker = (NbtProvisionWorker *) arg;
+    pthread_setname_np(pthread_self(), "nbt-provision");
+    for (;;)
+    {
+        pthread_mutex_lock(&worker->bus->lock);
+        size_t index = worker->bus->next_tag;
+        if (index < worker->bus->tag_count)
+        {
+            worker->bus->next_tag++;
+        }
+        pthread_mutex_unlock(&worker->bus->lock);
+        if (index >= worker->bus->tag_count)
+        {
+            break;
+        }
+        nbt_provision_tag(worker->context, worker->bus, &worker->bus->tags[index]);
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    NbtProvisionContext context;
+    memset(&context, 0, sizeof(context));
+    const char *output_path = NULL;
+    unsigned long processing_time_us = 0U;
+    unsigned long max_workers = NBT_PROVISION_DEFAULT_WORKERS;
+
+    int option;
+    bool valid = true;
+    while (valid && ((option = getopt(argc, argv, "sp:j:o:h")) != -1))
+    {
+        switch (option)
+        {
+        case 's':
+            context.simulated = true;
+            break;
+        case 'p':
+            valid = nbt_provision_parse_number(optarg, 0, UINT32_MAX, &processing_time_us);
+            break;
+        case 'j':
+            valid = nbt_provision_parse_number(optarg, 0, NBT_PROVISION_MAX_WORKERS, &max_workers) && (max_workers != 0U);
+            break;
+        case 'o':
+            output_path = optarg;
+            break;
+        default:
+            valid = false;
+            break;
+        }
+    }
+    if (!valid || (optind != (argc - 1)))
+    {
+        nbt_provision_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    context.processing_time_us = (uint32_t) processing_time_us;
+
+    NbtProvisionBus *buses = NULL;
+    size_t bus_count = 0U;
+    if (!nbt_provision_read_manifest(argv[optind], &buses, &bus_count))
+    {
+        nbt_provision_free_manifest(buses, bus_count);
+        return EXIT_FAILURE;
+    }
+    context.output = (output_path != NULL) ? fopen(output_path, "a") : stdout;
+    if (context.output == NULL)
+    {
+        perror(output_path);
+        nbt_provision_free_manifest(buses, bus_count);
+        return EXIT_FAILURE;
+    }
+    // Up to max_workers per bus, never more than tags on that bus
+    size_t worker_count = 0U;
+    size_t tag_count = 0U;
+    for (size_t i = 0U; i < bus_count; i++)
+    {
+        worker_count += (buses[i].tag_count < max_workers) ? buses[i].tag_count : max_workers;
+        tag_count += buses[i].tag_count;
+    }
+    NbtProvisionWorker *workers = calloc(worker_count, sizeof(NbtProvisionWorker));
+    if (workers == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        if (context.output != stdout)
+        {
+            fclose(context.output);
+        }
+        nbt_provision_free_manifest(buses, bus_count);
+        return EXIT_FAILURE;
+    }
+    pthread_mutex_init(&context.lock, NULL);
+    for (size_t i = 0U; i < bus_count; i++)
+    {
+        pthread_mutex_init(&buses[i].lock, NULL);
+    }
+
+    uint64_t start_ns = nbt_provision_get_monotonic_ns();
+    size_t started = 0U;
+    for (size_t i = 0U; i < bus_count; i++)
+    {
+        size_t bus_workers = (buses[i].tag_count < max_workers) ? buses[i].tag_count : max_workers;
+        for (size_t j = 0U; j < bus_workers; j++)
+        {
+            workers[started].bus = &buses[i];
+            workers[started].context = &context;
+            if (pthread_create(&workers[started].thread, NULL, nbt_provision_worker, &workers[started]) != 0)
+            {
+                // Remaining workers of the bus pick up its tags
+                fprintf(stderr, "Could not start worker for %s\n", buses[i].device);
+                continue;
+            }
+            buses[i].started_workers++;
+            started++;
+        }
+    }
+    for (size_t i = 0U; i < bus_count; i++)
+    {
+        // Tags of buses without any worker are provisioned by this thread
+        if (buses[i].started_workers == 0U)
+        {
+            NbtProvisionWorker fallback = {&buses[i], &context, pthread_self()};
+            nbt_provision_worker(&fallback);
+        }
+    }
+    for (size_t i = 0U; i < started; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+    }
+    uint64_t elapsed_ns = nbt_provision_get_monotonic_ns() - start_ns;
+
+    fprintf(context.output, "{\"summary\":{\"buses\":%zu,\"tags\":%zu,\"workers\":%zu,\"files_ok\":%zu,\"files_failed\":%zu,\"elapsed_ms\":%.3f}}\n",
+            bus_count, tag_count, started, context.succeeded, context.failed, (double) elapsed_ns / 1e6);
+    fflush(context.output);
+    if (context.output != stdout)
+    {
+        fclose(context.output);
+    }
+    pthread_mutex_destroy(&context.lock);
+    for (size_t i = 0U; i < bus_count; i++)
+    {
+        pthread_mutex_destroy(&buses[i].lock);
+    }
+    free(workers);
+    nbt_provision_free_manifest(buses, bus_count);
+    return (context.failed == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,146 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/nbt-select.h
+ * \brief Protocol layer answering redundant SELECT commands locally.
+ */
+#ifndef INFINEON_NBT_SELECT_H
+#define INFINEON_NBT_SELECT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief IFX status code module identifier.
+ */
+#define LIBNBTSELECT 0x3EU
+
+/**
+ * \brief IFX status encoding function identifier for nbt_select_invalidate().
+ */
+#define IFX_NBT_SELECT_INVALIDATE (0x80U)
+
+/**
+ * \brief IFX status encoding function identifier for nbt_select_get_statistics().
+ */
+#define IFX_NBT_SELECT_GET_STATISTICS (0x81U)
+
+/**
+ * \brief IFX status encoding function identifier for nbt_select_get_selection().
+ */
+#define IFX_NBT_SELECT_GET_SELECTION (0x83U)
+
+/**
+ * \brief Maximum length of SELECT APDUs tracked in [bytes] (longer ones drop the tracked selection).
+ */
+#define NBT_SELECT_MAX_APDU_LEN 32U
+
+/** \struct nbt_select_statistics_t
+ * \brief Effectiveness of selection tracking since initialization.
+ */
+typedef struct
+{
+    /**
+     * \brief SELECT commands sent to the tag.
+     */
+    uint64_t forwarded;
+
+    /**
+     * \brief SELECT commands answered locally.
+     */
+    uint64_t skipped;
+
+    /**
+     * \brief Number of times the tracked selection was dropped.
+     */
+    uint64_t invalidations;
+} nbt_select_statistics_t;
+
+/** \struct nbt_select_selection_t
+ * \brief SELECT commands that established the tracked application and file.
+ */
+typedef struct
+{
+    /**
+     * \brief SELECT APDU of the application.
+     */
+    uint8_t application[NBT_SELECT_MAX_APDU_LEN];
+
+    /**
+     * \brief Number of bytes in \ref nbt_select_selection_t.application (\c 0 if unknown).
+     */
+    size_t application_len;
+
+    /**
+     * \brief SELECT APDU of the file.
+     */
+    uint8_t file[NBT_SELECT_MAX_APDU_LEN];
+
+    /**
+     * \brief Number of bytes in \ref nbt_select_selection_t.file (\c 0 if unknown).
+     */
+    size_t file_len;
+} nbt_select_selection_t;
+
+/**
+ * \brief Initializes protocol layer answering redundant SELECT commands locally.
+ *
+ * \details The layer is put on top of a GP T=1' stack and tracks the
+ * application (SELECT by AID) and file (any other SELECT) selected on the
+ * tag. A SELECT identical to the one that established the current
+ * application or file is answered with the response the tag returned for it,
+ * without any I2C traffic.
+ *
+ * The tracked selection is dropped on activation, on communication errors,
+ * on any response other than \c 9000 and on every command except READ BINARY
+ * and UPDATE BINARY of the current file (a short file identifier in P1 drops
+ * the tracked file).
+ *
+ * \param[out] self Protocol layer to be initialized.
+ * \param[in] base Protocol stack to put selection tracking on top of (e.g. GP T=1').
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_select_initialize(ifx_protocol_t *self, ifx_protocol_t *base);
+
+/**
+ * \brief Drops the tracked selection, e.g. after the tag might have been reset externally.
+ *
+ * \param[in] self Protocol stack containing a selection tracking layer.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_select_invalidate(ifx_protocol_t *self);
+
+/**
+ * \brief Gets effectiveness statistics of a selection tracking layer.
+ *
+ * \param[in] self Protocol stack containing a selection tracking layer.
+ * \param[out] statistics Buffer to store statistics in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_select_get_statistics(ifx_protocol_t *self, nbt_select_statistics_t *statistics);
+
+/**
+ * \brief Gets the SELECT commands that established the tracked application and file.
+ *
+ * \details Allows layers stacked on top to restore the selection after they
+ * re-activated the tag (which drops the tracked selection).
+ *
+ * \param[in] self Protocol stack containing a selection tracking layer.
+ * \param[out] selection Buffer to store tracked SELECT commands in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_select_get_selection(ifx_protocol_t *self, nbt_select_selection_t *selection);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_NBT_SELECT_H
@@ -0,0 +1,398 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-select.c
+ * \brief Protocol layer answering redundant SELECT commands locally.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/nbt-select.h"
+#include "nbt-select.h"
+
+/**
+ * \brief Kind of APDU as far as relevant for selection tracking.
+ */
+typedef enum
+{
+    NBT_SELECT_COMMAND_OTHER,
+    NBT_SELECT_COMMAND_SELECT_APPLICATION,
+    NBT_SELECT_COMMAND_SELECT_FILE,
+    NBT_SELECT_COMMAND_FILE_ACCESS,
+    NBT_SELECT_COMMAND_FILE_ACCESS_SFI
+} NbtSelectCommandType;
+
+static NbtSelectCommandType nbt_select_parse(const uint8_t *data, size_t data_len);
+static void nbt_select_clear(NbtSelectState *state);
+static void nbt_select_drop_all(NbtSelectProtocolProperties *properties);
+static bool nbt_select_is_success(const uint8_t *response, size_t response_len);
+
+/**
+ * \brief Initializes protocol layer answering redundant SELECT commands locally.
+ *
+ * \param[out] self Protocol layer to be initialized.
+ * \param[in] base Protocol stack to put selection tracking on top of (e.g. GP T=1').
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_select_initialize(ifx_protocol_t *self, ifx_protocol_t *base)
+{
+    // Validate parameters
+    if ((self == NULL) || (base == NULL))
+    {
+        return IFX_ERROR(LIBNBTSELECT, IFX_PROTOCOL_LAYER_INITIALIZE, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    // Populate object
+    ifx_status_t status = ifx_protocol_layer_initialize(self);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    self->_layer_id = NBT_SELECT_PROTOCOLLAYER_ID;
+    self->_base = base;
+    self->_activate = nbt_select_activate;
+    self->_transceive = nbt_select_transceive;
+    self->_transmit = nbt_select_transmit;
+    self->_destructor = nbt_select_destroy;
+
+    // Populate protocol properties
+    NbtSelectProtocolProperties *properties = calloc(1U, sizeof(NbtSelectProtocolProperties));
+    if (properties == NULL)
+    {
+        return IFX_ERROR(LIBNBTSELECT, IFX_PROTOCOL_LAYER_INITIALIZE, IFX_OUT_OF_MEMORY);
+    }
+    self->_properties = properties;
+
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief ifx_protocol_activate_callback_t for selection tracking.
+ *
+ * \details Activation resets the selection of the tag.
+ *
+ * \see ifx_protocol_activate_callback_t
+ */
+ifx_status_t nbt_select_activate(ifx_protocol_t *self, uint8_t **response, size_t *response_len)
+{
+    NbtSelectProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_select_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    nbt_select_drop_all(properties);
+    return ifx_protocol_activate(self->_base, response, response_len);
+}
+
+/**
+ * \brief ifx_protocol_transceive_callback_t for selection tracking.
+ *
+ * \see ifx_protocol_transceive_callback_t
+ */
+ifx_status_t nbt_select_transceive(ifx_protocol_t *self, const uint8_t *data, size_t data_len, uint8_t **response, size_t *response_len)
+{
+    // Validate parameters
+    if ((data == NULL) || (response == NULL) || (response_len == NULL))
+    {
+        return IFX_ERROR(LIBNBTSELECT, IFX_PROTOCOL_TRANSCEIVE, IFX_ILLEGAL_ARGUMENT);
+    }
+    NbtSelectProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_select_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+
+    // Answer SELECT establishing the current application or file locally
+    NbtSelectCommandType type = nbt_select_parse(data, data_len);
+    NbtSelectState *state = NULL;
+    if (type == NBT_SELECT_COMMAND_SELECT_APPLICATION)
+    {
+        state = &properties->application;
+    }
+    else if (type == NBT_SELECT_COMMAND_SELECT_FILE)
+    {
+        state = &properties->file;
+    }
+    if ((state != NULL) && (state->apdu_len == data_len) && (memcmp(state->apdu, data, data_len) == 0))
+    {
+        uint8_t *copy = malloc(state->response_len);
+        if (copy == NULL)
+        {
+            return IFX_ERROR(LIBNBTSELECT, IFX_PROTOCOL_TRANSCEIVE, IFX_OUT_OF_MEMORY);
+        }
+        memcpy(copy, state->response, state->response_len);
+        *response = copy;
+        *response_len = state->response_len;
+        properties->statistics.skipped++;
+        return IFX_SUCCESS;
+    }
+
+    status = ifx_protocol_transceive(self->_base, data, data_len, response, response_len);
+    if (ifx_error_check(status) || !nbt_select_is_success(*response, *response_len))
+    {
+        // Selection is unknown after any error
+        nbt_select_drop_all(properties);
+        return status;
+    }
+    switch (type)
+    {
+    case NBT_SELECT_COMMAND_SELECT_APPLICATION:
+    case NBT_SELECT_COMMAND_SELECT_FILE:
+    {
+        properties->statistics.forwarded++;
+        uint8_t *copy = malloc(*response_len);
+        if (copy == NULL)
+        {
+            // Out of memory only means the selection is not tracked
+            nbt_select_drop_all(properties);
+            break;
+        }
+        memcpy(copy, *response, *response_len);
+        if (type == NBT_SELECT_COMMAND_SELECT_APPLICATION)
+        {
+            nbt_select_clear(&properties->file);
+        }
+        nbt_select_clear(state);
+        memcpy(state->apdu, data, data_len);
+        state->apdu_len = data_len;
+        state->response = copy;
+        state->response_len = *response_len;
+        break;
+    }
+    case NBT_SELECT_COMMAND_FILE_ACCESS:
+        break;
+    case NBT_SELECT_COMMAND_FILE_ACCESS_SFI:
+        // Short file identifier implicitly selects another file
+        nbt_select_clear(&properties->file);
+        break;
+    default:
+        // Unknown commands might change the selection
+        nbt_select_drop_all(properties);
+        break;
+    }
+    return status;
+}
+
+/**
+ * \brief ifx_protocol_transmit_callback_t for selection tracking.
+ *
+ * \details APDUs sent without ifx_protocol_transceive() are not inspected,
+ * so the tracked selection is dropped.
+ *
+ * \see ifx_protocol_transmit_callback_t
+ */
+ifx_status_t nbt_select_transmit(ifx_protocol_t *self, const uint8_t *data, size_t data_len)
+{
+    NbtSelectProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_select_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    nbt_select_drop_all(properties);
+    return ifx_protocol_transmit(self->_base, data, data_len);
+}
+
+/**
+ * \brief ifx_protocol_destroy_callback_t for selection tracking.
+ *
+ * \see ifx_protocol_destroy_callback_t
+ */
+void nbt_select_destroy(ifx_protocol_t *self)
+{
+    if (self != NULL)
+    {
+        if (self->_properties != NULL)
+        {
+            NbtSelectProtocolProperties *properties = (NbtSelectProtocolProperties *) self->_properties;
+            nbt_select_clear(&properties->application);
+            nbt_select_clear(&properties->file);
+            free(self->_properties);
+        }
+        self->_properties = NULL;
+    }
+}
+
+/**
+ * \brief Drops the tracked selection, e.g. after the tag might have been reset externally.
+ *
+ * \param[in] self Protocol stack containing a selection tracking layer.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_select_invalidate(ifx_protocol_t *self)
+{
+    NbtSelectProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_select_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return IFX_ERROR(LIBNBTSELECT, IFX_NBT_SELECT_INVALIDATE, IFX_PROTOCOL_STACK_INVALID);
+    }
+    nbt_select_drop_all(properties);
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Gets effectiveness statistics of a selection tracking layer.
+ *
+ * \param[in] self Protocol stack containing a selection tracking layer.
+ * \param[out] statistics Buffer to store statistics in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_select_get_statistics(ifx_protocol_t *self, nbt_select_statistics_t *statistics)
+{
+    // Validate parameters
+    if (statistics == NULL)
+    {
+        return IFX_ERROR(LIBNBTSELECT, IFX_NBT_SELECT_GET_STATISTICS, IFX_ILLEGAL_ARGUMENT);
+    }
+    NbtSelectProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_select_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return IFX_ERROR(LIBNBTSELECT, IFX_NBT_SELECT_GET_STATISTICS, IFX_PROTOCOL_STACK_INVALID);
+    }
+    *statistics = properties->statistics;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Gets the SELECT commands that established the tracked application and file.
+ *
+ * \param[in] self Protocol stack containing a selection tracking layer.
+ * \param[out] selection Buffer to store tracked SELECT commands in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_select_get_selection(ifx_protocol_t *self, nbt_select_selection_t *selection)
+{
+    // Validate parameters
+    if (selection == NULL)
+    {
+        return IFX_ERROR(LIBNBTSELECT, IFX_NBT_SELECT_GET_SELECTION, IFX_ILLEGAL_ARGUMENT);
+    }
+    NbtSelectProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_select_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return IFX_ERROR(LIBNBTSELECT, IFX_NBT_SELECT_GET_SELECTION, IFX_PROTOCOL_STACK_INVALID);
+    }
+    memcpy(selection->application, properties->application.apdu, properties->application.apdu_len);
+    selection->application_len = properties->application.apdu_len;
+    memcpy(selection->file, properties->file.apdu, properties->file.apdu_len);
+    selection->file_len = properties->file.apdu_len;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Returns protocol properties of selection tracking layer in protocol stack.
+ *
+ * \param[in] self Protocol stack containing a selection tracking layer.
+ * \param[out] properties_buffer Buffer to store properties in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_select_get_protocol_properties(ifx_protocol_t *self, NbtSelectProtocolProperties **properties_buffer)
+{
+    // Validate parameters
+    if ((self == NULL) || (properties_buffer == NULL))
+    {
+        return IFX_ERROR(LIBNBTSELECT, IFX_NBT_SELECT_GET_PROPERTIES, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    // Verify that correct protocol layer called this function
+    if (self->_layer_id != NBT_SELECT_PROTOCOLLAYER_ID)
+    {
+        if (self->_base == NULL)
+        {
+            return IFX_ERROR(LIBNBTSELECT, IFX_NBT_SELECT_GET_PROPERTIES, IFX_PROTOCOL_STACK_INVALID);
+        }
+        return nbt_select_get_protocol_properties(self->_base, properties_buffer);
+    }
+
+    // Verify protocol state
+    if (self->_properties == NULL)
+    {
+        return IFX_ERROR(LIBNBTSELECT, IFX_NBT_SELECT_GET_PROPERTIES, IFX_PROTOCOL_STACK_INVALID);
+    }
+    *properties_buffer = (NbtSelectProtocolProperties *) self->_properties;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Decodes APDU as far as relevant for selection tracking.
+ *
+ * \details SELECT commands longer than \ref NBT_SELECT_MAX_APDU_LEN are
+ * reported as \c NBT_SELECT_COMMAND_OTHER so that they drop the tracked
+ * selection.
+ *
+ * \param[in] data APDU to be decoded.
+ * \param[in] data_len Number of bytes in \p data.
+ * \return NbtSelectCommandType Kind of APDU.
+ */
+static NbtSelectCommandType nbt_select_parse(const uint8_t *data, size_t data_len)
+{
+    if ((data_len < 4U) || (data[0] != 0x00U))
+    {
+        return NBT_SELECT_COMMAND_OTHER;
+    }
+    switch (data[1])
+    {
+    case 0xa4U:
+        if ((data_len < 5U) || (data_len > NBT_SELECT_MAX_APDU_LEN))
+        {
+            return NBT_SELECT_COMMAND_OTHER;
+        }
+        return (data[2] == 0x04U) ? NBT_SELECT_COMMAND_SELECT_APPLICATION : NBT_SELECT_COMMAND_SELECT_FILE;
+    case 0xb0U:
+    case 0xd6U:
+        return ((data[2] & 0x80U) != 0x00U) ? NBT_SELECT_COMMAND_FILE_ACCESS_SFI : NBT_SELECT_COMMAND_FILE_ACCESS;
+    default:
+        return NBT_SELECT_COMMAND_OTHER;
+    }
+}
+
+/**
+ * \brief Forgets tracked SELECT.
+ *
+ * \param[in,out] state State to be cleared.
+ */
+static void nbt_select_clear(NbtSelectState *state)
+{
+    free(state->response);
+    state->response = NULL;
+    state->response_len = 0U;
+    state->apdu_len = 0U;
+}
+
+/**
+ * \brief Forgets tracked application and file.
+ *
+ * \param[in,out] properties Protocol properties of selection tracking layer.
+ */
+static void nbt_select_drop_all(NbtSelectProtocolProperties *properties)
+{
+    if ((properties->application.apdu_len > 0U) || (properties->file.apdu_len > 0U))
+    {
+        properties->statistics.invalidations++;
+    }
+    nbt_select_clear(&properties->application);
+    nbt_select_clear(&properties->file);
+}
+
+/**
+ * \brief Checks whether response APDU ends with status word \c 9000.
+ *
+ * \param[in] response Response APDU.
+ * \param[in] response_len Number of bytes in \p response.
+ * \return bool \c true if successful.
+ */
+static bool nbt_select_is_success(const uint8_t *response, size_t response_len)
+{
+    return (response_len >= 2U) && (response[response_len - 2U] == 0x90U) && (response[response_len - 1U] == 0x00U);
+}
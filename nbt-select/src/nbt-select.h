@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-select.h
+ * \brief Internal definitions for protocol layer answering redundant SELECT commands locally.
+ */
+#ifndef NBT_SELECT_H
+#define NBT_SELECT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/nbt-select.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Protocol Layer ID for selection tracking.
+ *
+ * \details Used to verify that correct protocol layer has called member functionality.
+ */
+#define NBT_SELECT_PROTOCOLLAYER_ID 0x3EU
+
+/**
+ * \brief IFX status encoding function identifier for nbt_select_get_protocol_properties().
+ */
+#define IFX_NBT_SELECT_GET_PROPERTIES (0x82U)
+
+/** \struct NbtSelectState
+ * \brief SELECT that established the current application or file together with the tag's response.
+ */
+typedef struct
+{
+    /**
+     * \brief SELECT APDU.
+     */
+    uint8_t apdu[NBT_SELECT_MAX_APDU_LEN];
+
+    /**
+     * \brief Number of bytes in \ref NbtSelectState.apdu (\c 0 if unknown).
+     */
+    size_t apdu_len;
+
+    /**
+     * \brief Response APDU of the tag.
+     */
+    uint8_t *response;
+
+    /**
+     * \brief Number of bytes in \ref NbtSelectState.response.
+     */
+    size_t response_len;
+} NbtSelectState;
+
+/** \struct NbtSelectProtocolProperties
+ * \brief Protocol properties of selection tracking layer.
+ */
+typedef struct
+{
+    /**
+     * \brief Selected application.
+     */
+    NbtSelectState application;
+
+    /**
+     * \brief Selected file.
+     */
+    NbtSelectState file;
+
+    /**
+     * \brief Effectiveness statistics.
+     */
+    nbt_select_statistics_t statistics;
+} NbtSelectProtocolProperties;
+
+/**
+ * \brief ifx_protocol_activate_callback_t for selection tracking.
+ *
+ * \see ifx_protocol_activate_callback_t
+ */
+ifx_status_t nbt_select_activate(ifx_protocol_t *self, uint8_t **response, size_t *response_len);
+
+/**
+ * \brief ifx_protocol_transceive_callback_t for selection tracking.
+ *
+ * \see ifx_protocol_transceive_callback_t
+ */
+ifx_status_t nbt_select_transceive(ifx_protocol_t *self, const uint8_t *data, size_t data_len, uint8_t **response, size_t *response_len);
+
+/**
+ * \brief ifx_protocol_transmit_callback_t for selection tracking.
+ *
+ * \see ifx_protocol_transmit_callback_t
+ */
+ifx_status_t nbt_select_transmit(ifx_protocol_t *self, const uint8_t *data, size_t data_len);
+
+/**
+ * \brief ifx_protocol_destroy_callback_t for selection tracking.
+ *
+ * \see ifx_protocol_destroy_callback_t
+ */
+void nbt_select_destroy(ifx_protocol_t *self);
+
+/**
+ * \brief Returns protocol properties of selection tracking layer in protocol stack.
+ *
+ * \param[in] self Protocol stack containing a selection tracking layer.
+ * \param[out] properties_buffer Buffer to store properties in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_select_get_protocol_properties(ifx_protocol_t *self, NbtSelectProtocolProperties **properties_buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NBT_SELECT_H
@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/nbt-session.h
+ * \brief Protocol layer keeping an activated NBT session alive across jobs.
+ */
+#ifndef INFINEON_NBT_SESSION_H
+#define INFINEON_NBT_SESSION_H
+
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief IFX status code module identifier.
+ */
+#define LIBNBTSESSION 0x3DU
+
+/**
+ * \brief IFX status encoding function identifier for nbt_session_set_liveness_interval().
+ */
+#define IFX_NBT_SESSION_SET_LIVENESS_INTERVAL (0x80U)
+
+/**
+ * \brief IFX status encoding function identifier for nbt_session_reset().
+ */
+#define IFX_NBT_SESSION_RESET (0x81U)
+
+/**
+ * \brief IFX status encoding function identifier for nbt_session_get_statistics().
+ */
+#define IFX_NBT_SESSION_GET_STATISTICS (0x82U)
+
+/**
+ * \brief Idle time after which reuse of a session is preceded by a liveness check in [ms].
+ */
+#define NBT_SESSION_DEFAULT_LIVENESS_INTERVAL_MS 1000U
+
+/** \struct nbt_session_statistics_t
+ * \brief Effectiveness of session reuse since initialization.
+ */
+typedef struct
+{
+    /**
+     * \brief Activations performed on the tag.
+     */
+    uint64_t activations;
+
+    /**
+     * \brief Activations answered from the running session.
+     */
+    uint64_t reused_activations;
+
+    /**
+     * \brief Liveness checks exchanged with the tag.
+     */
+    uint64_t liveness_checks;
+
+    /**
+     * \brief Times the session was re-established after the tag reset or communication failed.
+     */
+    uint64_t recoveries;
+} nbt_session_statistics_t;
+
+/**
+ * \brief Initializes protocol layer keeping an activated session alive across jobs.
+ *
+ * \details The layer is put on top of the selection tracking layer of
+ * \c infineon/nbt-select.h and a GP T=1' stack, built once and kept for the
+ * lifetime of the process. Jobs keep calling \c ifx_protocol_activate() and
+ * SELECT the application and files as if they started from scratch:
+ *
+ * - Activation is performed on the tag once, later activations return the
+ *   stored communication interface parameters. As they do not reach the
+ *   selection tracking layer, it answers the repeated SELECTs locally.
+ *   If the session was idle for longer than the liveness interval, a
+ *   single-byte READ BINARY of the selected file (or the application SELECT if no file is selected) checks
+ *   first that the tag still runs the session.
+ * - If the liveness check fails, a SELECT or READ BINARY fails on the link
+ *   or READ BINARY / UPDATE BINARY report that no file is selected
+ *   (\c 6986), the tag is assumed to have reset: it is activated again, the
+ *   application and file are re-selected and the command is retried once.
+ *   Other commands failing on the link might already have taken effect, so
+ *   their error is returned without retry.
+ *
+ * \param[out] self Protocol layer to be initialized.
+ * \param[in] base Protocol stack to keep alive containing a selection tracking layer (e.g. nbt-select on top of GP T=1').
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_session_initialize(ifx_protocol_t *self, ifx_protocol_t *base);
+
+/**
+ * \brief Sets idle time after which reuse of the session is preceded by a liveness check.
+ *
+ * \param[in] self Protocol stack containing a session layer.
+ * \param[in] interval_ms Idle time in [ms] (\c 0 to check before every activation).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_session_set_liveness_interval(ifx_protocol_t *self, uint32_t interval_ms);
+
+/**
+ * \brief Forgets the running session so that the next activation is performed on the tag.
+ *
+ * \param[in] self Protocol stack containing a session layer.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_session_reset(ifx_protocol_t *self);
+
+/**
+ * \brief Gets effectiveness statistics of a session layer.
+ *
+ * \param[in] self Protocol stack containing a session layer.
+ * \param[out] statistics Buffer to store statistics in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_session_get_statistics(ifx_protocol_t *self, nbt_session_statistics_t *statistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_NBT_SESSION_H
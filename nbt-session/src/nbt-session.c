@@ -0,0 +1,525 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-session.c
+ * \brief Protocol layer keeping an activated NBT session alive across jobs.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/nbt-select.h"
+#include "infineon/nbt-session.h"
+#include "nbt-session.h"
+
+/**
+ * \brief Kind of APDU as far as relevant for session tracking.
+ */
+typedef enum
+{
+    NBT_SESSION_COMMAND_OTHER,
+    NBT_SESSION_COMMAND_SELECT,
+    NBT_SESSION_COMMAND_READ_BINARY,
+    NBT_SESSION_COMMAND_UPDATE_BINARY
+} NbtSessionCommandType;
+
+static uint64_t nbt_session_get_monotonic_ns(void);
+static NbtSessionCommandType nbt_session_parse(const uint8_t *data, size_t data_len);
+static bool nbt_session_is_success(const uint8_t *response, size_t response_len);
+static bool nbt_session_is_reset(const uint8_t *response, size_t response_len);
+static ifx_status_t nbt_session_copy(const uint8_t *data, size_t data_len, uint8_t **copy, size_t *copy_len);
+static ifx_status_t nbt_session_activate_tag(ifx_protocol_t *self, NbtSessionProtocolProperties *properties);
+static ifx_status_t nbt_session_select(ifx_protocol_t *self, const uint8_t *apdu, size_t apdu_len);
+static ifx_status_t nbt_session_recover(ifx_protocol_t *self, NbtSessionProtocolProperties *properties, const nbt_select_selection_t *selection);
+static bool nbt_session_is_alive(ifx_protocol_t *self, NbtSessionProtocolProperties *properties, const nbt_select_selection_t *selection);
+
+/**
+ * \brief Initializes protocol layer keeping an activated session alive across jobs.
+ *
+ * \param[out] self Protocol layer to be initialized.
+ * \param[in] base Protocol stack to keep alive containing a selection tracking layer (e.g. nbt-select on top of GP T=1').
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_session_initialize(ifx_protocol_t *self, ifx_protocol_t *base)
+{
+    // Validate parameters
+    if ((self == NULL) || (base == NULL))
+    {
+        return IFX_ERROR(LIBNBTSESSION, IFX_PROTOCOL_LAYER_INITIALIZE, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    // Selection to be restored after a reset is tracked by the base
+    nbt_select_selection_t selection;
+    if (ifx_error_check(nbt_select_get_selection(base, &selection)))
+    {
+        return IFX_ERROR(LIBNBTSESSION, IFX_PROTOCOL_LAYER_INITIALIZE, IFX_PROTOCOL_STACK_INVALID);
+    }
+
+    // Populate object
+    ifx_status_t status = ifx_protocol_layer_initialize(self);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    self->_layer_id = NBT_SESSION_PROTOCOLLAYER_ID;
+    self->_base = base;
+    self->_activate = nbt_session_activate;
+    self->_transceive = nbt_session_transceive;
+    self->_transmit = nbt_session_transmit;
+    self->_destructor = nbt_session_destroy;
+
+    // Populate protocol properties
+    NbtSessionProtocolProperties *properties = calloc(1U, sizeof(NbtSessionProtocolProperties));
+    if (properties == NULL)
+    {
+        return IFX_ERROR(LIBNBTSESSION, IFX_PROTOCOL_LAYER_INITIALIZE, IFX_OUT_OF_MEMORY);
+    }
+    properties->activated = false;
+    properties->liveness_interval_ms = NBT_SESSION_DEFAULT_LIVENESS_INTERVAL_MS;
+    self->_properties = properties;
+
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief ifx_protocol_activate_callback_t for NBT session keep-alive.
+ *
+ * \details Only the first activation (and the first after a detected reset)
+ * reaches the tag, later ones return the stored communication interface
+ * parameters, preceded by a liveness check if the session was idle.
+ *
+ * \see ifx_protocol_activate_callback_t
+ */
+ifx_status_t nbt_session_activate(ifx_protocol_t *self, uint8_t **response, size_t *response_len)
+{
+    // Validate parameters
+    if ((response == NULL) || (response_len == NULL))
+    {
+        return IFX_ERROR(LIBNBTSESSION, IFX_PROTOCOL_ACTIVATE, IFX_ILLEGAL_ARGUMENT);
+    }
+    NbtSessionProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_session_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+
+    if (!properties->activated)
+    {
+        status = nbt_session_activate_tag(self, properties);
+    }
+    else if ((nbt_session_get_monotonic_ns() - properties->last_used_ns) >= ((uint64_t) properties->liveness_interval_ms * 1000000U))
+    {
+        nbt_select_selection_t selection;
+        status = nbt_select_get_selection(self->_base, &selection);
+        if (!ifx_error_check(status))
+        {
+            status = nbt_session_is_alive(self, properties, &selection) ? IFX_SUCCESS : nbt_session_recover(self, properties, &selection);
+        }
+        if (!ifx_error_check(status))
+        {
+            properties->statistics.reused_activations++;
+        }
+    }
+    else
+    {
+        properties->statistics.reused_activations++;
+    }
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    return nbt_session_copy(properties->cip, properties->cip_len, response, response_len);
+}
+
+/**
+ * \brief ifx_protocol_transceive_callback_t for NBT session keep-alive.
+ *
+ * \see ifx_protocol_transceive_callback_t
+ */
+ifx_status_t nbt_session_transceive(ifx_protocol_t *self, const uint8_t *data, size_t data_len, uint8_t **response, size_t *response_len)
+{
+    // Validate parameters
+    if ((data == NULL) || (response == NULL) || (response_len == NULL))
+    {
+        return IFX_ERROR(LIBNBTSESSION, IFX_PROTOCOL_TRANSCEIVE, IFX_ILLEGAL_ARGUMENT);
+    }
+    NbtSessionProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_session_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+
+    // Selection tracking drops the selection on errors, so it is needed from before the command
+    nbt_select_selection_t selection;
+    status = nbt_select_get_selection(self->_base, &selection);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+
+    // Only commands that cannot take effect twice are retried after a link error,
+    // file access rejected because the tag lost its selection never took effect
+    NbtSessionCommandType type = nbt_session_parse(data, data_len);
+    status = ifx_protocol_transceive(self->_base, data, data_len, response, response_len);
+    bool idempotent = (type == NBT_SESSION_COMMAND_SELECT) || (type == NBT_SESSION_COMMAND_READ_BINARY);
+    bool rejected = !ifx_error_check(status) && ((type == NBT_SESSION_COMMAND_READ_BINARY) || (type == NBT_SESSION_COMMAND_UPDATE_BINARY)) &&
+                    (selection.file_len > 0U) && nbt_session_is_reset(*response, *response_len);
+    if (properties->activated && ((ifx_error_check(status) && idempotent) || rejected))
+    {
+        if (rejected)
+        {
+            free(*response);
+            *response = NULL;
+            *response_len = 0U;
+        }
+        status = nbt_session_recover(self, properties, &selection);
+        if (!ifx_error_check(status))
+        {
+            status = ifx_protocol_transceive(self->_base, data, data_len, response, response_len);
+        }
+    }
+    properties->last_used_ns = nbt_session_get_monotonic_ns();
+    return status;
+}
+
+/**
+ * \brief ifx_protocol_transmit_callback_t for NBT session keep-alive.
+ *
+ * \see ifx_protocol_transmit_callback_t
+ */
+ifx_status_t nbt_session_transmit(ifx_protocol_t *self, const uint8_t *data, size_t data_len)
+{
+    NbtSessionProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_session_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    properties->last_used_ns = nbt_session_get_monotonic_ns();
+    return ifx_protocol_transmit(self->_base, data, data_len);
+}
+
+/**
+ * \brief ifx_protocol_destroy_callback_t for NBT session keep-alive.
+ *
+ * \see ifx_protocol_destroy_callback_t
+ */
+void nbt_session_destroy(ifx_protocol_t *self)
+{
+    if (self != NULL)
+    {
+        if (self->_properties != NULL)
+        {
+            NbtSessionProtocolProperties *properties = (NbtSessionProtocolProperties *) self->_properties;
+            free(properties->cip);
+            free(self->_properties);
+        }
+        self->_properties = NULL;
+    }
+}
+
+/**
+ * \brief Sets idle time after which reuse of the session is preceded by a liveness check.
+ *
+ * \param[in] self Protocol stack containing a session layer.
+ * \param[in] interval_ms Idle time in [ms] (\c 0 to check before every activation).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_session_set_liveness_interval(ifx_protocol_t *self, uint32_t interval_ms)
+{
+    NbtSessionProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_session_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return IFX_ERROR(LIBNBTSESSION, IFX_NBT_SESSION_SET_LIVENESS_INTERVAL, IFX_PROTOCOL_STACK_INVALID);
+    }
+    properties->liveness_interval_ms = interval_ms;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Forgets the running session so that the next activation is performed on the tag.
+ *
+ * \param[in] self Protocol stack containing a session layer.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_session_reset(ifx_protocol_t *self)
+{
+    NbtSessionProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_session_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return IFX_ERROR(LIBNBTSESSION, IFX_NBT_SESSION_RESET, IFX_PROTOCOL_STACK_INVALID);
+    }
+    properties->activated = false;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Gets effectiveness statistics of a session layer.
+ *
+ * \param[in] self Protocol stack containing a session layer.
+ * \param[out] statistics Buffer to store statistics in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_session_get_statistics(ifx_protocol_t *self, nbt_session_statistics_t *statistics)
+{
+    // Validate parameters
+    if (statistics == NULL)
+    {
+        return IFX_ERROR(LIBNBTSESSION, IFX_NBT_SESSION_GET_STATISTICS, IFX_ILLEGAL_ARGUMENT);
+    }
+    NbtSessionProtocolProperties *properties = NULL;
+    ifx_status_t status = nbt_session_get_protocol_properties(self, &properties);
+    if (ifx_error_check(status))
+    {
+        return IFX_ERROR(LIBNBTSESSION, IFX_NBT_SESSION_GET_STATISTICS, IFX_PROTOCOL_STACK_INVALID);
+    }
+    *statistics = properties->statistics;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Returns protocol properties of session layer in protocol stack.
+ *
+ * \param[in] self Protocol stack containing a session layer.
+ * \param[out] properties_buffer Buffer to store properties in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_session_get_protocol_properties(ifx_protocol_t *self, NbtSessionProtocolProperties **properties_buffer)
+{
+    // Validate parameters
+    if ((self == NULL) || (properties_buffer == NULL))
+    {
+        return IFX_ERROR(LIBNBTSESSION, IFX_NBT_SESSION_GET_PROPERTIES, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    // Verify that correct protocol layer called this function
+    if (self->_layer_id != NBT_SESSION_PROTOCOLLAYER_ID)
+    {
+        if (self->_base == NULL)
+        {
+            return IFX_ERROR(LIBNBTSESSION, IFX_NBT_SESSION_GET_PROPERTIES, IFX_PROTOCOL_STACK_INVALID);
+        }
+        return nbt_session_get_protocol_properties(self->_base, properties_buffer);
+    }
+
+    // Verify protocol state
+    if (self->_properties == NULL)
+    {
+        return IFX_ERROR(LIBNBTSESSION, IFX_NBT_SESSION_GET_PROPERTIES, IFX_PROTOCOL_STACK_INVALID);
+    }
+    *properties_buffer = (NbtSessionProtocolProperties *) self->_properties;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Returns current \c CLOCK_MONOTONIC time in [ns].
+ *
+ * \return uint64_t Current monotonic time in [ns].
+ */
+static uint64_t nbt_session_get_monotonic_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * \brief Decodes APDU as far as relevant for session tracking.
+ *
+ * \param[in] data APDU to be decoded.
+ * \param[in] data_len Number of bytes in \p data.
+ * \return NbtSessionCommandType Kind of APDU.
+ */
+static NbtSessionCommandType nbt_session_parse(const uint8_t *data, size_t data_len)
+{
+    if ((data_len < 4U) || (data[0] != 0x00U))
+    {
+        return NBT_SESSION_COMMAND_OTHER;
+    }
+    if (data[1] == 0xa4U)
+    {
+        return NBT_SESSION_COMMAND_SELECT;
+    }
+    if (data[1] == 0xb0U)
+    {
+        return NBT_SESSION_COMMAND_READ_BINARY;
+    }
+    if (data[1] == 0xd6U)
+    {
+        return NBT_SESSION_COMMAND_UPDATE_BINARY;
+    }
+    return NBT_SESSION_COMMAND_OTHER;
+}
+
+/**
+ * \brief Checks whether response APDU ends with status word \c 9000.
+ *
+ * \param[in] response Response APDU.
+ * \param[in] response_len Number of bytes in \p response.
+ * \return bool \c true if successful.
+ */
+static bool nbt_session_is_success(const uint8_t *response, size_t response_len)
+{
+    return (response_len >= 2U) && (response[response_len - 2U] == 0x90U) && (response[response_len - 1U] == 0x00U);
+}
+
+/**
+ * \brief Checks whether status word indicates that the tag lost its selection (e.g. after a reset).
+ *
+ * \param[in] response Response APDU.
+ * \param[in] response_len Number of bytes in \p response.
+ * \return bool \c true if the session has to be re-established.
+ */
+static bool nbt_session_is_reset(const uint8_t *response, size_t response_len)
+{
+    if (response_len < 2U)
+    {
+        return true;
+    }
+    uint16_t sw = (uint16_t) ((response[response_len - 2U] << 8) | response[response_len - 1U]);
+    return (sw == 0x6986U) || (sw == 0x6d00U);
+}
+
+/**
+ * \brief Copies data into newly allocated buffer.
+ *
+ * \param[in] data Data to be copied (may be \c NULL if \p data_len is \c 0).
+ * \param[in] data_len Number of bytes in \p data.
+ * \param[out] copy Buffer to store newly allocated copy in.
+ * \param[out] copy_len Buffer to store number of bytes in \p copy in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+static ifx_status_t nbt_session_copy(const uint8_t *data, size_t data_len, uint8_t **copy, size_t *copy_len)
+{
+    *copy = NULL;
+    *copy_len = 0U;
+    if (data_len == 0U)
+    {
+        return IFX_SUCCESS;
+    }
+    *copy = malloc(data_len);
+    if (*copy == NULL)
+    {
+        return IFX_ERROR(LIBNBTSESSION, IFX_PROTOCOL_TRANSCEIVE, IFX_OUT_OF_MEMORY);
+    }
+    memcpy(*copy, data, data_len);
+    *copy_len = data_len;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Activates the tag and starts a new session.
+ *
+ * \param[in] self Session layer.
+ * \param[in,out] properties Protocol properties of \p self.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+static ifx_status_t nbt_session_activate_tag(ifx_protocol_t *self, NbtSessionProtocolProperties *properties)
+{
+    properties->activated = false;
+    uint8_t *cip = NULL;
+    size_t cip_len = 0U;
+    ifx_status_t status = ifx_protocol_activate(self->_base, &cip, &cip_len);
+    properties->last_used_ns = nbt_session_get_monotonic_ns();
+    if (ifx_error_check(status))
+    {
+        return status;
+    }
+    free(properties->cip);
+    properties->cip = cip;
+    properties->cip_len = cip_len;
+    properties->activated = true;
+    properties->statistics.activations++;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Sends SELECT of the previous session to the tag again.
+ *
+ * \details Selection tracking below records it again if successful.
+ *
+ * \param[in] self Session layer.
+ * \param[in] apdu SELECT APDU.
+ * \param[in] apdu_len Number of bytes in \p apdu.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+static ifx_status_t nbt_session_select(ifx_protocol_t *self, const uint8_t *apdu, size_t apdu_len)
+{
+    uint8_t *response = NULL;
+    size_t response_len = 0U;
+    ifx_status_t status = ifx_protocol_transceive(self->_base, apdu, apdu_len, &response, &response_len);
+    if (!ifx_error_check(status) && !nbt_session_is_success(response, response_len))
+    {
+        status = IFX_ERROR(LIBNBTSESSION, IFX_PROTOCOL_TRANSCEIVE, IFX_UNSPECIFIED_ERROR);
+    }
+    free(response);
+    return status;
+}
+
+/**
+ * \brief Re-establishes session after the tag reset: activation and re-selection of application and file.
+ *
+ * \param[in] self Session layer.
+ * \param[in,out] properties Protocol properties of \p self.
+ * \param[in] selection Selection to be restored.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+static ifx_status_t nbt_session_recover(ifx_protocol_t *self, NbtSessionProtocolProperties *properties, const nbt_select_selection_t *selection)
+{
+    properties->statistics.recoveries++;
+    ifx_status_t status = nbt_session_activate_tag(self, properties);
+    if (!ifx_error_check(status) && (selection->application_len > 0U))
+    {
+        status = nbt_session_select(self, selection->application, selection->application_len);
+    }
+    if (!ifx_error_check(status) && (selection->file_len > 0U))
+    {
+        status = nbt_session_select(self, selection->file, selection->file_len);
+    }
+    return status;
+}
+
+/**
+ * \brief Checks with a single cheap exchange that the tag still runs the session.
+ *
+ * \details Reads one byte of the selected file, or re-selects the application
+ * if no file is selected. Without any selection there is nothing to lose,
+ * communication errors are then handled by the next command.
+ *
+ * \param[in] self Session layer.
+ * \param[in,out] properties Protocol properties of \p self.
+ * \param[in] selection Selection tracked below.
+ * \return bool \c true if the session can be reused as is.
+ */
+static bool nbt_session_is_alive(ifx_protocol_t *self, NbtSessionProtocolProperties *properties, const nbt_select_selection_t *selection)
+{
+    if ((selection->file_len == 0U) && (selection->application_len == 0U))
+    {
+        return true;
+    }
+    properties->statistics.liveness_checks++;
+    properties->last_used_ns = nbt_session_get_monotonic_ns();
+    if (selection->file_len == 0U)
+    {
+        // Selection tracking would answer the repeated SELECT locally
+        nbt_select_invalidate(self->_base);
+        return !ifx_error_check(nbt_session_select(self, selection->application, selection->application_len));
+    }
+    static const uint8_t probe[] = {0x00U, 0xb0U, 0x00U, 0x00U, 0x01U};
+    uint8_t *response = NULL;
+    size_t response_len = 0U;
+    ifx_status_t status = ifx_protocol_transceive(self->_base, probe, sizeof(probe), &response, &response_len);
+    bool alive = !ifx_error_check(status) && !nbt_session_is_reset(response, response_len);
+    free(response);
+    return alive;
+}
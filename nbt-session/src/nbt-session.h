@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-session.h
+ * \brief Internal definitions for protocol layer keeping an activated NBT session alive.
+ */
+#ifndef NBT_SESSION_H
+#define NBT_SESSION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-protocol.h"
+#include "infineon/nbt-session.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Protocol Layer ID for NBT session keep-alive.
+ *
+ * \details Used to verify that correct protocol layer has called member functionality.
+ */
+#define NBT_SESSION_PROTOCOLLAYER_ID 0x3DU
+
+/**
+ * \brief IFX status encoding function identifier for nbt_session_get_protocol_properties().
+ */
+#define IFX_NBT_SESSION_GET_PROPERTIES (0x83U)
+
+/** \struct NbtSessionProtocolProperties
+ * \brief Protocol properties of NBT session layer.
+ */
+typedef struct
+{
+    /**
+     * \brief Whether the tag was activated and is believed to still run the session.
+     */
+    bool activated;
+
+    /**
+     * \brief Communication interface parameters returned by last activation on the tag.
+     */
+    uint8_t *cip;
+
+    /**
+     * \brief Number of bytes in \ref NbtSessionProtocolProperties.cip.
+     */
+    size_t cip_len;
+
+    /**
+     * \brief Idle time after which reuse is preceded by a liveness check in [ms].
+     */
+    uint32_t liveness_interval_ms;
+
+    /**
+     * \brief \c CLOCK_MONOTONIC time of last exchange with the tag in [ns].
+     */
+    uint64_t last_used_ns;
+
+    /**
+     * \brief Effectiveness statistics.
+     */
+    nbt_session_statistics_t statistics;
+} NbtSessionProtocolProperties;
+
+/**
+ * \brief ifx_protocol_activate_callback_t for NBT session keep-alive.
+ *
+ * \see ifx_protocol_activate_callback_t
+ */
+ifx_status_t nbt_session_activate(ifx_protocol_t *self, uint8_t **response, size_t *response_len);
+
+/**
+ * \brief ifx_protocol_transceive_callback_t for NBT session keep-alive.
+ *
+ * \see ifx_protocol_transceive_callback_t
+ */
+ifx_status_t nbt_session_transceive(ifx_protocol_t *self, const uint8_t *data, size_t data_len, uint8_t **response, size_t *response_len);
+
+/**
+ * \brief ifx_protocol_transmit_callback_t for NBT session keep-alive.
+ *
+ * \see ifx_protocol_transmit_callback_t
+ */
+ifx_status_t nbt_session_transmit(ifx_protocol_t *self, const uint8_t *data, size_t data_len);
+
+/**
+ * \brief ifx_protocol_destroy_callback_t for NBT session keep-alive.
+ *
+ * \see ifx_protocol_destroy_callback_t
+ */
+void nbt_session_destroy(ifx_protocol_t *self);
+
+/**
+ * \brief Returns protocol properties of session layer in protocol stack.
+ *
+ * \param[in] self Protocol stack containing a session layer.
+ * \param[out] properties_buffer Buffer to store properties in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_session_get_protocol_properties(ifx_protocol_t *self, NbtSessionProtocolProperties **properties_buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NBT_SESSION_H
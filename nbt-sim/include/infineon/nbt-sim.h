@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/nbt-sim.h
+ * \brief Simulated OPTIGA Authenticate NBT speaking GP T=1' to be used as I2C driver layer backend.
+ */
+#ifndef INFINEON_NBT_SIM_H
+#define INFINEON_NBT_SIM_H
+
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/i2c-rpi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief IFX status code module identifier.
+ */
+#define LIBNBTSIM 0x36U
+
+/**
+ * \brief IFX status encoding function identifier for nbt_sim_initialize().
+ */
+#define IFX_NBT_SIM_INITIALIZE (0x01U)
+
+/**
+ * \brief Information field size of the simulated tag (IFSC) in [bytes].
+ */
+#define NBT_SIM_IFSC 254U
+
+/**
+ * \brief Size of each file of the simulated tag in [bytes].
+ */
+#define NBT_SIM_FILE_SIZE 4096U
+
+/**
+ * \brief Maximum number of distinct files the simulated tag can hold.
+ */
+#define NBT_SIM_FILE_COUNT 8U
+
+/**
+ * \brief Populates I2C driver layer backend with a simulated NBT.
+ *
+ * \details The simulated tag implements the GP T=1' data link layer
+ * (CRC, block chaining, S(CIP), S(IFS), S(RESYNCH), S(SWR), S(RELEASE)) and
+ * a minimal file system handling SELECT by AID and file ID, READ BINARY and
+ * UPDATE BINARY. Files are created on first selection and zero filled.
+ * Reads before \p processing_time_us has elapsed after a frame was written
+ * are not acknowledged, like on the real tag.
+ *
+ * \param[out] backend Backend to be populated (install via i2c_rpi_set_backend()).
+ * \param[in] processing_time_us Simulated processing time per block in [us] (\c 0 for instant responses).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_sim_initialize(i2c_rpi_backend_t *backend, uint32_t processing_time_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_NBT_SIM_H
@@ -0,0 +1,550 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-sim.c
+ * \brief Simulated OPTIGA Authenticate NBT speaking GP T=1' to be used as I2C driver layer backend.
+ */
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/i2c-rpi.h"
+#include "infineon/nbt-sim.h"
+#include "nbt-sim.h"
+
+/**
+ * \brief Communication interface parameters returned in S(CIP) response.
+ *
+ * \details PVER, IIN, PLID (I2C), PLP (400 kHz, MPOT 100 us, no SEGT/WUT),
+ * DLLP (BWT 100 ms, IFSC \ref NBT_SIM_IFSC) and empty historical bytes.
+ */
+static const uint8_t nbt_sim_cip[] = {
+    // PVER
+    0x01U,
+    // IIN
+    0x04U, 0x00U, 0x00U, 0x00U, 0x00U,
+    // PLID
+    0x02U,
+    // PLP
+    0x0cU, 0x00U, 0x01U, 0x90U, 0x00U, 0x01U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U,
+    // DLLP
+    0x04U, 0x00U, 0x64U, (uint8_t) (NBT_SIM_IFSC >> 8), (uint8_t) NBT_SIM_IFSC,
+    // HB
+    0x00U};
+
+/**
+ * \brief Returns current \c CLOCK_MONOTONIC time in [ns].
+ *
+ * \return uint64_t Current monotonic time in [ns].
+ */
+static uint64_t nbt_sim_get_monotonic_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * \brief Calculates CRC-16/X.25 (ISO/IEC 13239) as used by GP T=1'.
+ *
+ * \param[in] data Data to calculate CRC over.
+ * \param[in] data_len Number of bytes in \p data.
+ * \return uint16_t CRC value.
+ */
+static uint16_t nbt_sim_crc(const uint8_t *data, size_t data_len)
+{
+    uint16_t crc = 0xffffU;
+    for (size_t i = 0U; i < data_len; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x0001U) ? (uint16_t) ((crc >> 1) ^ 0x8408U) : (uint16_t) (crc >> 1);
+        }
+    }
+    return (uint16_t) ~crc;
+}
+
+/**
+ * \brief Builds block to be read by the host next.
+ *
+ * \param[in] state Simulated tag state.
+ * \param[in] pcb Protocol control byte.
+ * \param[in] inf Information field (may be \c NULL if \p inf_len is \c 0).
+ * \param[in] inf_len Number of bytes in \p inf.
+ */
+static void nbt_sim_send_block(NbtSimState *state, uint8_t pcb, const uint8_t *inf, size_t inf_len)
+{
+    state->block[0] = NBT_SIM_NAD_TAG;
+    state->block[1] = pcb;
+    state->block[2] = (uint8_t) (inf_len >> 8);
+    state->block[3] = (uint8_t) inf_len;
+    if (inf_len > 0U)
+    {
+        memcpy(&state->block[NBT_SIM_PROLOGUE_LEN], inf, inf_len);
+    }
+    uint16_t crc = nbt_sim_crc(state->block, NBT_SIM_PROLOGUE_LEN + inf_len);
+    state->block[NBT_SIM_PROLOGUE_LEN + inf_len] = (uint8_t) (crc >> 8);
+    state->block[NBT_SIM_PROLOGUE_LEN + inf_len + 1U] = (uint8_t) crc;
+    state->block_len = NBT_SIM_PROLOGUE_LEN + inf_len + NBT_SIM_EPILOGUE_LEN;
+    state->block_offset = 0U;
+    state->block_pending = true;
+    state->ready_at_ns = nbt_sim_get_monotonic_ns() + ((uint64_t) state->processing_time_us * 1000U);
+}
+
+/**
+ * \brief Sends R-block acknowledging or rejecting host block.
+ *
+ * \param[in] state Simulated tag state.
+ * \param[in] error Error bits (\c 0x01 CRC error, \c 0x02 other error).
+ */
+static void nbt_sim_send_r_block(NbtSimState *state, uint8_t error)
+{
+    nbt_sim_send_block(state, (uint8_t) (0x80U | (state->host_sequence << 4) | error), NULL, 0U);
+}
+
+/**
+ * \brief Sends next (chained) I-block of the pending response APDU.
+ *
+ * \param[in] state Simulated tag state.
+ */
+static void nbt_sim_send_response_chunk(NbtSimState *state)
+{
+    size_t remaining = state->response_len - state->response_offset;
+    size_t chunk_len = (remaining > state->ifsd) ? state->ifsd : remaining;
+    bool more = chunk_len < remaining;
+    uint8_t pcb = (uint8_t) ((state->tag_sequence << 6) | (more ? 0x20U : 0x00U));
+    nbt_sim_send_block(state, pcb, &state->response[state->response_offset], chunk_len);
+    state->response_offset += chunk_len;
+    state->tag_sequence ^= 1U;
+}
+
+/**
+ * \brief Sets status word of response APDU.
+ *
+ * \param[in] state Simulated tag state.
+ * \param[in] data_len Number of response data bytes already in \ref NbtSimState.response.
+ * \param[in] sw Status word.
+ */
+static void nbt_sim_set_status_word(NbtSimState *state, size_t data_len, uint16_t sw)
+{
+    state->response[data_len] = (uint8_t) (sw >> 8);
+    state->response[data_len + 1U] = (uint8_t) sw;
+    state->response_len = data_len + 2U;
+}
+
+/**
+ * \brief Selects file by ID, creating it on first use.
+ *
+ * \param[in] state Simulated tag state.
+ * \param[in] fid File identifier.
+ * \return uint16_t Status word.
+ */
+static uint16_t nbt_sim_select_file(NbtSimState *state, uint16_t fid)
+{
+    NbtSimFile *unused = NULL;
+    for (size_t i = 0U; i < NBT_SIM_FILE_COUNT; i++)
+    {
+        if (state->files[i].fid == fid)
+        {
+            state->selected_file = &state->files[i];
+            return 0x9000U;
+        }
+        if ((unused == NULL) && (state->files[i].fid == 0U))
+        {
+            unused = &state->files[i];
+        }
+    }
+    if ((fid == 0U) || (unused == NULL))
+    {
+        return 0x6a82U;
+    }
+    unused->fid = fid;
+    memset(unused->content, 0, sizeof(unused->content));
+    state->selected_file = unused;
+    return 0x9000U;
+}
+
+/**
+ * \brief Executes command APDU and stores response APDU.
+ *
+ * \param[in] state Simulated tag state with complete command in \ref NbtSimState.command.
+ */
+static void nbt_sim_process_apdu(NbtSimState *state)
+{
+    const uint8_t *apdu = state->command;
+    size_t apdu_len = state->command_len;
+    if (apdu_len < 4U)
+    {
+        nbt_sim_set_status_word(state, 0U, 0x6700U);
+        return;
+    }
+
+    // Decode body (short and extended length)
+    const uint8_t *data = NULL;
+    size_t lc = 0U;
+    size_t le = 0U;
+    if (apdu_len == 5U)
+    {
+        le = (apdu[4] == 0U) ? 256U : apdu[4];
+    }
+    else if ((apdu_len == 7U) && (apdu[4] == 0U))
+    {
+        le = ((size_t) apdu[5] << 8) | apdu[6];
+        le = (le == 0U) ? 65536U : le;
+    }
+    else if ((apdu_len > 5U) && (apdu[4] != 0U))
+    {
+        lc = apdu[4];
+        data = &apdu[5];
+        if (apdu_len == (6U + lc))
+        {
+            le = (apdu[5U + lc] == 0U) ? 256U : apdu[5U + lc];
+        }
+        else if (apdu_len != (5U + lc))
+        {
+            nbt_sim_set_status_word(state, 0U, 0x6700U);
+            return;
+        }
+    }
+    else if (apdu_len > 7U)
+    {
+        lc = ((size_t) apdu[5] << 8) | apdu[6];
+        data = &apdu[7];
+        if (apdu_len == (9U + lc))
+        {
+            le = ((size_t) apdu[7U + lc] << 8) | apdu[8U + lc];
+            le = (le == 0U) ? 65536U : le;
+        }
+        else if (apdu_len != (7U + lc))
+        {
+            nbt_sim_set_status_word(state, 0U, 0x6700U);
+            return;
+        }
+    }
+    else if (apdu_len != 4U)
+    {
+        nbt_sim_set_status_word(state, 0U, 0x6700U);
+        return;
+    }
+
+    if (apdu[0] != 0x00U)
+    {
+        nbt_sim_set_status_word(state, 0U, 0x6e00U);
+        return;
+    }
+    size_t offset = ((size_t) (apdu[2] & 0x7fU) << 8) | apdu[3];
+    switch (apdu[1])
+    {
+    case 0xa4U:
+        // SELECT by AID always succeeds, by file ID creates file on demand
+        if (apdu[2] == 0x04U)
+        {
+            state->selected_file = NULL;
+            nbt_sim_set_status_word(state, 0U, 0x9000U);
+        }
+        else if ((apdu[2] == 0x00U) && (lc == 2U))
+        {
+            nbt_sim_set_status_word(state, 0U, nbt_sim_select_file(state, (uint16_t) ((data[0] << 8) | data[1])));
+        }
+        else
+        {
+            nbt_sim_set_status_word(state, 0U, 0x6a86U);
+        }
+        break;
+
+    case 0xb0U:
+        if (state->selected_file == NULL)
+        {
+            nbt_sim_set_status_word(state, 0U, 0x6986U);
+        }
+        else if (offset > NBT_SIM_FILE_SIZE)
+        {
+            nbt_sim_set_status_word(state, 0U, 0x6b00U);
+        }
+        else
+        {
+            size_t available = NBT_SIM_FILE_SIZE - offset;
+            size_t read_len = (le > available) ? available : le;
+            memcpy(state->response, &state->selected_file->content[offset], read_len);
+            nbt_sim_set_status_word(state, read_len, 0x9000U);
+        }
+        break;
+
+    case 0xd6U:
+        if (state->selected_file == NULL)
+        {
+            nbt_sim_set_status_word(state, 0U, 0x6986U);
+        }
+        else if ((offset + lc) > NBT_SIM_FILE_SIZE)
+        {
+            nbt_sim_set_status_word(state, 0U, 0x6b00U);
+        }
+        else
+        {
+            memcpy(&state->selected_file->content[offset], data, lc);
+            nbt_sim_set_status_word(state, 0U, 0x9000U);
+        }
+        break;
+
+    default:
+        nbt_sim_set_status_word(state, 0U, 0x6d00U);
+        break;
+    }
+}
+
+/**
+ * \brief Resets data link layer state (sequence numbers and pending APDUs).
+ *
+ * \param[in] state Simulated tag state.
+ */
+static void nbt_sim_reset_link(NbtSimState *state)
+{
+    state->host_sequence = 0U;
+    state->tag_sequence = 0U;
+    state->command_len = 0U;
+    state->response_len = 0U;
+    state->response_offset = 0U;
+}
+
+/**
+ * \brief Handles S-block request of the host.
+ *
+ * \param[in] state Simulated tag state.
+ * \param[in] pcb Protocol control byte of the request.
+ * \param[in] inf Information field of the request.
+ * \param[in] inf_len Number of bytes in \p inf.
+ */
+static void nbt_sim_handle_s_block(NbtSimState *state, uint8_t pcb, const uint8_t *inf, size_t inf_len)
+{
+    uint8_t response_pcb = (uint8_t) (pcb | 0x20U);
+    switch (pcb & 0x1fU)
+    {
+    case 0x00U: // RESYNCH
+    case 0x06U: // RELEASE
+        nbt_sim_reset_link(state);
+        nbt_sim_send_block(state, response_pcb, NULL, 0U);
+        break;
+
+    case 0x0fU: // SWR
+        nbt_sim_reset_link(state);
+        state->ifsd = NBT_SIM_IFSC;
+        state->selected_file = NULL;
+        nbt_sim_send_block(state, response_pcb, NULL, 0U);
+        break;
+
+    case 0x01U: // IFS
+    {
+        size_t ifsd = 0U;
+        for (size_t i = 0U; i < inf_len; i++)
+        {
+            ifsd = (ifsd << 8) | inf[i];
+        }
+        if ((ifsd == 0U) || (ifsd > NBT_SIM_MAX_IFSD) || (inf_len > 2U))
+        {
+            nbt_sim_send_r_block(state, 0x02U);
+            return;
+        }
+        state->ifsd = ifsd;
+        nbt_sim_send_block(state, response_pcb, inf, inf_len);
+        break;
+    }
+
+    case 0x02U: // ABORT
+        state->command_len = 0U;
+        state->response_len = 0U;
+        state->response_offset = 0U;
+        nbt_sim_send_block(state, response_pcb, NULL, 0U);
+        break;
+
+    case 0x04U: // CIP
+        nbt_sim_send_block(state, response_pcb, nbt_sim_cip, sizeof(nbt_sim_cip));
+        break;
+
+    default:
+        nbt_sim_send_r_block(state, 0x02U);
+        break;
+    }
+}
+
+/**
+ * \brief Populates I2C driver layer backend with a simulated NBT.
+ *
+ * \param[out] backend Backend to be populated (install via i2c_rpi_set_backend()).
+ * \param[in] processing_time_us Simulated processing time per block in [us] (\c 0 for instant responses).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t nbt_sim_initialize(i2c_rpi_backend_t *backend, uint32_t processing_time_us)
+{
+    // Validate parameters
+    if (backend == NULL)
+    {
+        return IFX_ERROR(LIBNBTSIM, IFX_NBT_SIM_INITIALIZE, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    NbtSimState *state = calloc(1U, sizeof(NbtSimState));
+    if (state == NULL)
+    {
+        return IFX_ERROR(LIBNBTSIM, IFX_NBT_SIM_INITIALIZE, IFX_OUT_OF_MEMORY);
+    }
+    state->processing_time_us = processing_time_us;
+    state->ifsd = NBT_SIM_IFSC;
+
+    backend->context = state;
+    backend->set_slave_address = nbt_sim_set_slave_address;
+    backend->write = nbt_sim_write;
+    backend->read = nbt_sim_read;
+    backend->destroy = nbt_sim_destroy;
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_set_slave_address_t for simulated tag.
+ *
+ * \see i2c_rpi_backend_set_slave_address_t
+ */
+int nbt_sim_set_slave_address(void *context, int native_instance, uint8_t slave_address)
+{
+    (void) context;
+    (void) native_instance;
+    (void) slave_address;
+    return 0;
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_write_t for simulated tag.
+ *
+ * \see i2c_rpi_backend_write_t
+ */
+ssize_t nbt_sim_write(void *context, int native_instance, const uint8_t *data, size_t data_len)
+{
+    (void) native_instance;
+    NbtSimState *state = (NbtSimState *) context;
+    if ((state == NULL) || (data == NULL))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // Validate block structure
+    if ((data_len < (NBT_SIM_PROLOGUE_LEN + NBT_SIM_EPILOGUE_LEN)) || (data[0] != NBT_SIM_NAD_HOST) ||
+        ((((size_t) data[2] << 8) | data[3]) != (data_len - NBT_SIM_PROLOGUE_LEN - NBT_SIM_EPILOGUE_LEN)))
+    {
+        nbt_sim_send_r_block(state, 0x02U);
+        return (ssize_t) data_len;
+    }
+    uint16_t crc = nbt_sim_crc(data, data_len - NBT_SIM_EPILOGUE_LEN);
+    if ((data[data_len - 2U] != (uint8_t) (crc >> 8)) || (data[data_len - 1U] != (uint8_t) crc))
+    {
+        nbt_sim_send_r_block(state, 0x01U);
+        return (ssize_t) data_len;
+    }
+    uint8_t pcb = data[1];
+    const uint8_t *inf = &data[NBT_SIM_PROLOGUE_LEN];
+    size_t inf_len = data_len - NBT_SIM_PROLOGUE_LEN - NBT_SIM_EPILOGUE_LEN;
+
+    if ((pcb & 0x80U) == 0x00U)
+    {
+        // I-block
+        uint8_t sequence = (uint8_t) ((pcb >> 6) & 0x01U);
+        if (sequence != state->host_sequence)
+        {
+            // Host did not receive last response, repeat it
+            state->block_offset = 0U;
+            state->block_pending = state->block_len > 0U;
+            return (ssize_t) data_len;
+        }
+        if ((inf_len > NBT_SIM_IFSC) || ((state->command_len + inf_len) > sizeof(state->command)))
+        {
+            state->command_len = 0U;
+            nbt_sim_send_r_block(state, 0x02U);
+            return (ssize_t) data_len;
+        }
+        memcpy(&state->command[state->command_len], inf, inf_len);
+        state->command_len += inf_len;
+        state->host_sequence ^= 1U;
+        if ((pcb & 0x20U) != 0x00U)
+        {
+            nbt_sim_send_r_block(state, 0x00U);
+            return (ssize_t) data_len;
+        }
+        nbt_sim_process_apdu(state);
+        state->command_len = 0U;
+        state->response_offset = 0U;
+        nbt_sim_send_response_chunk(state);
+    }
+    else if ((pcb & 0xc0U) == 0x80U)
+    {
+        // R-block: continue chained response or repeat last block
+        uint8_t sequence = (uint8_t) ((pcb >> 4) & 0x01U);
+        if ((sequence == state->tag_sequence) && (state->response_offset < state->response_len) && ((pcb & 0x0fU) == 0x00U))
+        {
+            nbt_sim_send_response_chunk(state);
+        }
+        else
+        {
+            state->block_offset = 0U;
+            state->block_pending = state->block_len > 0U;
+            state->ready_at_ns = nbt_sim_get_monotonic_ns() + ((uint64_t) state->processing_time_us * 1000U);
+        }
+    }
+    else if ((pcb & 0xe0U) == 0xc0U)
+    {
+        nbt_sim_handle_s_block(state, pcb, inf, inf_len);
+    }
+    else
+    {
+        nbt_sim_send_r_block(state, 0x02U);
+    }
+    return (ssize_t) data_len;
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_read_t for simulated tag.
+ *
+ * \see i2c_rpi_backend_read_t
+ */
+ssize_t nbt_sim_read(void *context, int native_instance, uint8_t *buffer, size_t buffer_len)
+{
+    (void) native_instance;
+    NbtSimState *state = (NbtSimState *) context;
+    if ((state == NULL) || (buffer == NULL))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // Tag does not acknowledge its address while busy or idle
+    if (!state->block_pending || ((state->processing_time_us > 0U) && (nbt_sim_get_monotonic_ns() < state->ready_at_ns)))
+    {
+        errno = EREMOTEIO;
+        return -1;
+    }
+
+    // Master always clocks the requested number of bytes, idle bus reads as 0xff
+    size_t available = state->block_len - state->block_offset;
+    size_t copy_len = (buffer_len > available) ? available : buffer_len;
+    memcpy(buffer, &state->block[state->block_offset], copy_len);
+    memset(&buffer[copy_len], 0xff, buffer_len - copy_len);
+    state->block_offset += copy_len;
+    if (state->block_offset >= state->block_len)
+    {
+        state->block_pending = false;
+    }
+    return (ssize_t) buffer_len;
+}
+
+/**
+ * \brief \ref i2c_rpi_backend_destroy_t for simulated tag.
+ *
+ * \see i2c_rpi_backend_destroy_t
+ */
+void nbt_sim_destroy(void *context)
+{
+    free(context);
+}
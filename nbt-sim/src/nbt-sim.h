@@ -0,0 +1,191 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file nbt-sim.h
+ * \brief Internal definitions for simulated OPTIGA Authenticate NBT.
+ */
+#ifndef NBT_SIM_H
+#define NBT_SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "infineon/nbt-sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Node address of blocks sent by the host.
+ */
+#define NBT_SIM_NAD_HOST 0x21U
+
+/**
+ * \brief Node address of blocks sent by the tag.
+ */
+#define NBT_SIM_NAD_TAG 0x12U
+
+/**
+ * \brief Length of the block prologue (NAD, PCB, LEN) in [bytes].
+ */
+#define NBT_SIM_PROLOGUE_LEN 4U
+
+/**
+ * \brief Length of the block epilogue (CRC) in [bytes].
+ */
+#define NBT_SIM_EPILOGUE_LEN 2U
+
+/**
+ * \brief Maximum information field size accepted from the host (IFSD) in [bytes].
+ */
+#define NBT_SIM_MAX_IFSD 0xff9U
+
+/**
+ * \brief Maximum length of command and response APDUs in [bytes].
+ */
+#define NBT_SIM_MAX_APDU_LEN (NBT_SIM_FILE_SIZE + 16U)
+
+/**
+ * \brief Maximum length of a block in [bytes].
+ */
+#define NBT_SIM_MAX_BLOCK_LEN (NBT_SIM_PROLOGUE_LEN + NBT_SIM_MAX_IFSD + NBT_SIM_EPILOGUE_LEN)
+
+/** \struct NbtSimFile
+ * \brief Single file of the simulated tag.
+ */
+typedef struct
+{
+    /**
+     * \brief File identifier (\c 0 if unused).
+     */
+    uint16_t fid;
+
+    /**
+     * \brief File content.
+     */
+    uint8_t content[NBT_SIM_FILE_SIZE];
+} NbtSimFile;
+
+/** \struct NbtSimState
+ * \brief State of simulated tag stored in i2c_rpi_backend_t.context.
+ */
+typedef struct
+{
+    /**
+     * \brief Simulated processing time per block in [us].
+     */
+    uint32_t processing_time_us;
+
+    /**
+     * \brief \c CLOCK_MONOTONIC time in [ns] at which the pending block may be read.
+     */
+    uint64_t ready_at_ns;
+
+    /**
+     * \brief Expected send sequence number N(S) of the next host I-block.
+     */
+    uint8_t host_sequence;
+
+    /**
+     * \brief Send sequence number N(S) of the next tag I-block.
+     */
+    uint8_t tag_sequence;
+
+    /**
+     * \brief Information field size of the host (IFSD) in [bytes].
+     */
+    size_t ifsd;
+
+    /**
+     * \brief Command APDU assembled from (chained) host I-blocks.
+     */
+    uint8_t command[NBT_SIM_MAX_APDU_LEN];
+
+    /**
+     * \brief Number of bytes in \ref NbtSimState.command.
+     */
+    size_t command_len;
+
+    /**
+     * \brief Response APDU sent in (chained) tag I-blocks.
+     */
+    uint8_t response[NBT_SIM_MAX_APDU_LEN];
+
+    /**
+     * \brief Number of bytes in \ref NbtSimState.response.
+     */
+    size_t response_len;
+
+    /**
+     * \brief Number of bytes of \ref NbtSimState.response already sent.
+     */
+    size_t response_offset;
+
+    /**
+     * \brief Last block sent by the tag (kept for retransmission).
+     */
+    uint8_t block[NBT_SIM_MAX_BLOCK_LEN];
+
+    /**
+     * \brief Number of bytes in \ref NbtSimState.block.
+     */
+    size_t block_len;
+
+    /**
+     * \brief Number of bytes of \ref NbtSimState.block already read by the host.
+     */
+    size_t block_offset;
+
+    /**
+     * \brief Whether \ref NbtSimState.block is waiting to be read.
+     */
+    bool block_pending;
+
+    /**
+     * \brief Files of the simulated tag.
+     */
+    NbtSimFile files[NBT_SIM_FILE_COUNT];
+
+    /**
+     * \brief Currently selected file (\c NULL if none).
+     */
+    NbtSimFile *selected_file;
+} NbtSimState;
+
+/**
+ * \brief \ref i2c_rpi_backend_set_slave_address_t for simulated tag.
+ *
+ * \see i2c_rpi_backend_set_slave_address_t
+ */
+int nbt_sim_set_slave_address(void *context, int native_instance, uint8_t slave_address);
+
+/**
+ * \brief \ref i2c_rpi_backend_write_t for simulated tag.
+ *
+ * \see i2c_rpi_backend_write_t
+ */
+ssize_t nbt_sim_write(void *context, int native_instance, const uint8_t *data, size_t data_len);
+
+/**
+ * \brief \ref i2c_rpi_backend_read_t for simulated tag.
+ *
+ * \see i2c_rpi_backend_read_t
+ */
+ssize_t nbt_sim_read(void *context, int native_instance, uint8_t *buffer, size_t buffer_len);
+
+/**
+ * \brief \ref i2c_rpi_backend_destroy_t for simulated tag.
+ *
+ * \see i2c_rpi_backend_destroy_t
+ */
+void nbt_sim_destroy(void *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NBT_SIM_H
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/timer-rpi.h
+ * \brief Statistics of Timer API implementation for NBT framework based on Raspberry PI Linux OS.
+ */
+#ifndef INFINEON_TIMER_RPI_H
+#define INFINEON_TIMER_RPI_H
+
+#include <stdint.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/ifx-timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief IFX status encoding function identifier for timer_rpi_get_statistics().
+ */
+#define IFX_TIMER_RPI_GET_STATISTICS (0x80U)
+
+/** \struct timer_rpi_statistics_t
+ * \brief Process wide statistics of all ifx_timer_t objects.
+ */
+typedef struct
+{
+    /**
+     * \brief Number of timers successfully started via ifx_timer_set().
+     */
+    uint64_t sets;
+
+    /**
+     * \brief Number of failed ifx_timer_set() calls.
+     */
+    uint64_t set_failures;
+
+    /**
+     * \brief Number of ifx_timer_join() calls on a set timer.
+     */
+    uint64_t joins;
+
+    /**
+     * \brief Number of joins whose timer had already elapsed.
+     */
+    uint64_t joins_elapsed;
+
+    /**
+     * \brief Total time in [ns] spent waiting in ifx_timer_join().
+     */
+    uint64_t join_wait_ns;
+} timer_rpi_statistics_t;
+
+/**
+ * \brief Getter for process wide timer statistics.
+ *
+ * \details Counters are maintained atomically, so this may be called from any
+ * thread without blocking timer users.
+ *
+ * \param[out] statistics_buffer Buffer to store statistics in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t timer_rpi_get_statistics(timer_rpi_statistics_t *statistics_buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_TIMER_RPI_H
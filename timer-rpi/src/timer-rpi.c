@@ -22,6 +22,9 @@
 
 #include "infineon/ifx-error.h"
 #include "infineon/ifx-timer.h"
+#include "infineon/timer-rpi.h"
+#include "infineon/trace-rpi.h"
+#include "timer-rpi.h"
 
 /* Timer._start structure */
 struct posix_timer_rpi {
@@ -34,6 +37,30 @@ struct posix_timer_rpi {
 
 
 
+static ifx_status_t timer_rpi_set(ifx_timer_t *timer, uint64_t us);
+static ifx_status_t timer_rpi_join(const ifx_timer_t *timer);
+
+/* Process wide statistics (accessed atomically) */
+static timer_rpi_statistics_t timer_rpi_statistics;
+
+/* Semaphores of USDT probes, incremented by tracers while attached */
+TIMER_RPI_PROBE_SEMAPHORE(timer_set__entry);
+TIMER_RPI_PROBE_SEMAPHORE(timer_set__return);
+TIMER_RPI_PROBE_SEMAPHORE(timer_join__entry);
+TIMER_RPI_PROBE_SEMAPHORE(timer_join__return);
+
+/**
+ * \brief Returns current \c CLOCK_MONOTONIC time in [ns].
+ *
+ * \return uint64_t Current monotonic time in [ns].
+ */
+uint64_t timer_rpi_get_monotonic_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec;
+}
+
 /**
  * \brief 
 */
@@ -49,7 +76,7 @@ static void handler(int sig, siginfo_t *si, void *uc)
     (void)sig;
     (void)uc;
     struct posix_timer_rpi *data = (struct posix_timer_rpi *) si->_sifields._rt.si_sigval.sival_ptr;
-    data->is_timer_elapsed = true;
+    __atomic_store_n(&data->is_timer_elapsed, true, __ATOMIC_RELEASE);
 }
 
 /**
@@ -62,6 +89,31 @@ static void handler(int sig, siginfo_t *si, void *uc)
  * \relates ifx_timer_t
  */
 ifx_status_t ifx_timer_set(ifx_timer_t *timer, uint64_t us)
+{
+    uint64_t start_ns = TIMER_RPI_PROBE_TIMESTAMP(timer_set__return);
+    TIMER_RPI_PROBE1(timer_set__entry, us);
+    ifx_status_t status = timer_rpi_set(timer, us);
+    if (ifx_error_check(status))
+    {
+        __atomic_fetch_add(&timer_rpi_statistics.set_failures, 1U, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        __atomic_fetch_add(&timer_rpi_statistics.sets, 1U, __ATOMIC_RELAXED);
+    }
+    TIMER_RPI_PROBE3(timer_set__return, us, status, TIMER_RPI_PROBE_ELAPSED(start_ns));
+    return status;
+}
+
+/**
+ * \brief Creates and starts POSIX timer (actual implementation of ifx_timer_set()).
+ *
+ * \param[in] timer Timer object to be set.
+ * \param[in] us Timer duration in [us].
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in
+ * case of error.
+ */
+static ifx_status_t timer_rpi_set(ifx_timer_t *timer, uint64_t us)
 {
     // Validate parameters
     if ((timer == NULL) || (us > UINT32_MAX))
@@ -146,7 +198,7 @@ bool ifx_timer_has_elapsed(const ifx_timer_t *timer)
     }
 
     struct posix_timer_rpi *rpi_timer = (struct posix_timer_rpi *) timer->_start;
-    return rpi_timer->is_timer_elapsed == true;
+    return __atomic_load_n(&rpi_timer->is_timer_elapsed, __ATOMIC_ACQUIRE) == true;
 }
 
 /**
@@ -158,6 +210,24 @@ bool ifx_timer_has_elapsed(const ifx_timer_t *timer)
  * \relates ifx_timer_t
  */
 ifx_status_t ifx_timer_join(const ifx_timer_t *timer)
+{
+    uint64_t start_ns = TIMER_RPI_PROBE_TIMESTAMP(timer_join__return);
+    TIMER_RPI_PROBE1(timer_join__entry, ((timer != NULL) ? timer->_start : NULL));
+    trace_rpi_begin("timer_join", "timer", 0U);
+    ifx_status_t status = timer_rpi_join(timer);
+    trace_rpi_end("timer_join", "timer", 0U, status);
+    TIMER_RPI_PROBE3(timer_join__return, ((timer != NULL) ? timer->_start : NULL), status, TIMER_RPI_PROBE_ELAPSED(start_ns));
+    return status;
+}
+
+/**
+ * \brief Waits for POSIX timer to elapse (actual implementation of ifx_timer_join()).
+ *
+ * \param[in] timer Timer to be joined (wait until finished).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in
+ * case of error.
+ */
+static ifx_status_t timer_rpi_join(const ifx_timer_t *timer)
 {
     if (timer == NULL)
     {
@@ -170,11 +240,24 @@ ifx_status_t ifx_timer_join(const ifx_timer_t *timer)
     
     struct posix_timer_rpi *rpi_timer = (struct posix_timer_rpi *) timer->_start;
     ifx_status_t result = IFX_SUCCESS;
+    __atomic_fetch_add(&timer_rpi_statistics.joins, 1U, __ATOMIC_RELAXED);
 
-    while (rpi_timer->is_timer_elapsed == false)
-        ;
+    // Only take timestamps if there actually is something to wait for
+    if (__atomic_load_n(&rpi_timer->is_timer_elapsed, __ATOMIC_ACQUIRE) == true)
+    {
+        __atomic_fetch_add(&timer_rpi_statistics.joins_elapsed, 1U, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        uint64_t start_ns = timer_rpi_get_monotonic_ns();
 
-    rpi_timer->is_timer_elapsed = false;
+        // Flag is set from signal handler, so it must be reloaded on every iteration
+        while (__atomic_load_n(&rpi_timer->is_timer_elapsed, __ATOMIC_ACQUIRE) == false)
+            ;
+        __atomic_fetch_add(&timer_rpi_statistics.join_wait_ns, timer_rpi_get_monotonic_ns() - start_ns, __ATOMIC_RELAXED);
+    }
+
+    __atomic_store_n(&rpi_timer->is_timer_elapsed, false, __ATOMIC_RELAXED);
 
     return result;
 }
@@ -206,3 +289,25 @@ void ifx_timer_destroy(ifx_timer_t *timer)
         timer->_duration = 0U;
     }
 }
+
+/**
+ * \brief Getter for process wide timer statistics.
+ *
+ * \param[out] statistics_buffer Buffer to store statistics in.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t timer_rpi_get_statistics(timer_rpi_statistics_t *statistics_buffer)
+{
+    // Validate parameters
+    if (statistics_buffer == NULL)
+    {
+        return IFX_ERROR(LIB_TIMER, IFX_TIMER_RPI_GET_STATISTICS, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    statistics_buffer->sets = __atomic_load_n(&timer_rpi_statistics.sets, __ATOMIC_RELAXED);
+    statistics_buffer->set_failures = __atomic_load_n(&timer_rpi_statistics.set_failures, __ATOMIC_RELAXED);
+    statistics_buffer->joins = __atomic_load_n(&timer_rpi_statistics.joins, __ATOMIC_RELAXED);
+    statistics_buffer->joins_elapsed = __atomic_load_n(&timer_rpi_statistics.joins_elapsed, __ATOMIC_RELAXED);
+    statistics_buffer->join_wait_ns = __atomic_load_n(&timer_rpi_statistics.join_wait_ns, __ATOMIC_RELAXED);
+    return IFX_SUCCESS;
+}
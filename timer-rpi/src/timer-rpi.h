@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file timer-rpi.h
+ * \brief Internal definitions for Timer API implementation for NBT framework based on Raspberry PI Linux OS.
+ */
+#ifndef TIMER_RPI_H
+#define TIMER_RPI_H
+
+#include <stdint.h>
+
+#include "infineon/timer-rpi.h"
+
+#if defined(HAVE_SYS_SDT_H) && (HAVE_SYS_SDT_H)
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+/**
+ * \brief Defines semaphore of USDT probe \c optiga_nbt:<name>, incremented by tracers while attached.
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define TIMER_RPI_PROBE_SEMAPHORE(name) unsigned short optiga_nbt_##name##_semaphore __attribute__((unused)) __attribute__((section(".probes")))
+
+/**
+ * \brief Checks if a tracer is attached to USDT probe \c optiga_nbt:<name>.
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define TIMER_RPI_PROBE_ENABLED(name) __builtin_expect(optiga_nbt_##name##_semaphore != 0U, 0)
+
+/**
+ * \brief Returns timestamp in [ns] for elapsed time reported by USDT probe \c optiga_nbt:<name> (\c 0 if not enabled).
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define TIMER_RPI_PROBE_TIMESTAMP(name) (TIMER_RPI_PROBE_ENABLED(name) ? timer_rpi_get_monotonic_ns() : (uint64_t) 0U)
+
+/**
+ * \brief Returns elapsed time in [ns] since TIMER_RPI_PROBE_TIMESTAMP() (\c 0 if the tracer attached in between).
+ */
+#define TIMER_RPI_PROBE_ELAPSED(start_ns) (((start_ns) != 0U) ? (timer_rpi_get_monotonic_ns() - (start_ns)) : (uint64_t) 0U)
+
+/**
+ * \brief USDT probe \c optiga_nbt:<name> with one argument.
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define TIMER_RPI_PROBE1(name, arg1) do { if (TIMER_RPI_PROBE_ENABLED(name)) { DTRACE_PROBE1(optiga_nbt, name, arg1); } } while(0)
+
+/**
+ * \brief USDT probe \c optiga_nbt:<name> with three arguments.
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define TIMER_RPI_PROBE3(name, arg1, arg2, arg3) do { if (TIMER_RPI_PROBE_ENABLED(name)) { DTRACE_PROBE3(optiga_nbt, name, arg1, arg2, arg3); } } while(0)
+#else
+/**
+ * \brief Defines semaphore of USDT probe (no-op without \c sys/sdt.h).
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define TIMER_RPI_PROBE_SEMAPHORE(name) struct timer_rpi_probe_semaphore_##name
+
+/**
+ * \brief Returns timestamp in [ns] for elapsed time reported by USDT probe (always \c 0 without \c sys/sdt.h).
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define TIMER_RPI_PROBE_TIMESTAMP(name) ((uint64_t) 0U)
+
+/**
+ * \brief Returns elapsed time in [ns] since TIMER_RPI_PROBE_TIMESTAMP() (always \c 0 without \c sys/sdt.h).
+ */
+#define TIMER_RPI_PROBE_ELAPSED(start_ns) ((void) (start_ns), (uint64_t) 0U)
+
+/**
+ * \brief USDT probe \c optiga_nbt:<name> with one argument (no-op without \c sys/sdt.h).
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define TIMER_RPI_PROBE1(name, arg1) do { (void) sizeof(arg1); } while(0)
+
+/**
+ * \brief USDT probe \c optiga_nbt:<name> with three arguments (no-op without \c sys/sdt.h).
+ *
+ * \param[in] name Probe name (\c __ is shown as \c - by tracing tools).
+ */
+#define TIMER_RPI_PROBE3(name, arg1, arg2, arg3) do { (void) sizeof(arg1); (void) sizeof(arg2); (void) sizeof(arg3); } while(0)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Returns current \c CLOCK_MONOTONIC time in [ns].
+ *
+ * \return uint64_t Current monotonic time in [ns].
+ */
+uint64_t timer_rpi_get_monotonic_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TIMER_RPI_H
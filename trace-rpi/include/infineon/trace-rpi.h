@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file infineon/trace-rpi.h
+ * \brief Timeline tracing of NBT port activity exported as Chrome trace-event JSON.
+ */
+#ifndef INFINEON_TRACE_RPI_H
+#define INFINEON_TRACE_RPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "infineon/ifx-error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief IFX status code module identifier.
+ */
+#define LIBTRACERPI 0x38U
+
+/**
+ * \brief IFX status encoding function identifier for trace_rpi_enable().
+ */
+#define IFX_TRACE_RPI_ENABLE (0x01U)
+
+/**
+ * \brief IFX status encoding function identifier for trace_rpi_write_json().
+ */
+#define IFX_TRACE_RPI_WRITE_JSON (0x02U)
+
+/**
+ * \brief Number of events recorded per thread if not configured otherwise.
+ */
+#define TRACE_RPI_DEFAULT_EVENT_COUNT 65536U
+
+/**
+ * \brief Starts recording trace events.
+ *
+ * \details Each thread records into its own buffer allocated on its first
+ * event, so recording never takes locks. Once a buffer is full further events
+ * of that thread are dropped and counted. Events are recorded for
+ * \c i2c_rpi_transmit(), \c i2c_rpi_receive(), \c i2c_rpi_await_guard_time()
+ * and \c ifx_timer_join().
+ *
+ * \param[in] event_count Capacity of per-thread buffers allocated from now on (\c 0 for \ref TRACE_RPI_DEFAULT_EVENT_COUNT).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t trace_rpi_enable(size_t event_count);
+
+/**
+ * \brief Stops recording trace events, recorded events are kept.
+ */
+void trace_rpi_disable(void);
+
+/**
+ * \brief Discards all recorded events.
+ *
+ * \details May be called while other threads are recording. Each thread
+ * discards its events before recording its next one, until then they are
+ * skipped by trace_rpi_write_json().
+ */
+void trace_rpi_clear(void);
+
+/**
+ * \brief Records begin of an operation on calling thread.
+ *
+ * \param[in] name Name of the operation (static string).
+ * \param[in] category Category of the operation (static string).
+ * \param[in] bytes Number of bytes to be transferred (\c 0 if not applicable).
+ */
+void trace_rpi_begin(const char *name, const char *category, uint64_t bytes);
+
+/**
+ * \brief Records end of an operation on calling thread.
+ *
+ * \details Operations must be ended in reverse order of their begin. The end
+ * is recorded whenever the begin was, even if tracing was disabled in between.
+ *
+ * \param[in] name Name of the operation (static string, same as for trace_rpi_begin()).
+ * \param[in] category Category of the operation (static string, same as for trace_rpi_begin()).
+ * \param[in] bytes Number of bytes actually transferred (\c 0 if not applicable).
+ * \param[in] status Result of the operation.
+ */
+void trace_rpi_end(const char *name, const char *category, uint64_t bytes, ifx_status_t status);
+
+/**
+ * \brief Writes all recorded events as Chrome trace-event JSON (viewable e.g. in Perfetto).
+ *
+ * \details May be called while tracing is active, events recorded
+ * concurrently may or may not be included.
+ *
+ * \param[in] stream Stream to write JSON to.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t trace_rpi_write_json(FILE *stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INFINEON_TRACE_RPI_H
@@ -0,0 +1,297 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file trace-rpi.c
+ * \brief Timeline tracing of NBT port activity exported as Chrome trace-event JSON.
+ */
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "infineon/ifx-error.h"
+#include "infineon/trace-rpi.h"
+#include "trace-rpi.h"
+
+/* Whether events are currently recorded (accessed atomically) */
+static bool trace_rpi_enabled = false;
+
+/* Capacity of newly allocated thread buffers (accessed atomically) */
+static size_t trace_rpi_event_count = TRACE_RPI_DEFAULT_EVENT_COUNT;
+
+/* Incremented by every trace_rpi_clear() (accessed atomically) */
+static uint64_t trace_rpi_generation = 0U;
+
+/* All thread buffers, kept after their threads exited so that their events can still be written */
+static TraceRpiThreadBuffer *trace_rpi_buffers = NULL;
+static pthread_mutex_t trace_rpi_buffers_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Buffer of calling thread */
+static __thread TraceRpiThreadBuffer *trace_rpi_thread_buffer = NULL;
+
+/* Nesting depth of operations of calling thread, whether recorded or not */
+static __thread uint32_t trace_rpi_thread_depth = 0U;
+
+/* Bit n is set if the begin of the open operation at depth n was recorded in the current generation */
+static __thread uint64_t trace_rpi_thread_open = 0U;
+
+/**
+ * \brief Starts recording trace events.
+ *
+ * \param[in] event_count Capacity of per-thread buffers allocated from now on (\c 0 for \ref TRACE_RPI_DEFAULT_EVENT_COUNT).
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t trace_rpi_enable(size_t event_count)
+{
+    // Validate parameters
+    if (event_count > ((SIZE_MAX - sizeof(TraceRpiThreadBuffer)) / sizeof(TraceRpiEvent)))
+    {
+        return IFX_ERROR(LIBTRACERPI, IFX_TRACE_RPI_ENABLE, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    __atomic_store_n(&trace_rpi_event_count, (event_count == 0U) ? TRACE_RPI_DEFAULT_EVENT_COUNT : event_count, __ATOMIC_RELAXED);
+    __atomic_store_n(&trace_rpi_enabled, true, __ATOMIC_RELEASE);
+    return IFX_SUCCESS;
+}
+
+/**
+ * \brief Stops recording trace events, recorded events are kept.
+ */
+void trace_rpi_disable(void)
+{
+    __atomic_store_n(&trace_rpi_enabled, false, __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief Discards all recorded events.
+ */
+void trace_rpi_clear(void)
+{
+    // Buffers are only reset by their owning threads, which may be appending right now
+    __atomic_add_fetch(&trace_rpi_generation, 1U, __ATOMIC_ACQ_REL);
+}
+
+/**
+ * \brief Resets buffer of calling thread if events have been cleared since its last event.
+ *
+ * \param[in] buffer Buffer of calling thread.
+ */
+static void trace_rpi_sync_generation(TraceRpiThreadBuffer *buffer)
+{
+    uint64_t generation = __atomic_load_n(&trace_rpi_generation, __ATOMIC_ACQUIRE);
+    if (buffer->generation != generation)
+    {
+        __atomic_store_n(&buffer->count, 0U, __ATOMIC_RELAXED);
+        __atomic_store_n(&buffer->dropped, 0U, __ATOMIC_RELAXED);
+        trace_rpi_thread_open = 0U;
+        __atomic_store_n(&buffer->generation, generation, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * \brief Returns buffer of calling thread, allocating it on first use.
+ *
+ * \return TraceRpiThreadBuffer* Buffer of calling thread or \c NULL if out of memory.
+ */
+TraceRpiThreadBuffer *trace_rpi_get_thread_buffer(void)
+{
+    if (trace_rpi_thread_buffer != NULL)
+    {
+        return trace_rpi_thread_buffer;
+    }
+
+    size_t capacity = __atomic_load_n(&trace_rpi_event_count, __ATOMIC_RELAXED);
+    TraceRpiThreadBuffer *buffer = malloc(sizeof(TraceRpiThreadBuffer) + (capacity * sizeof(TraceRpiEvent)));
+    if (buffer == NULL)
+    {
+        return NULL;
+    }
+    buffer->tid = (pid_t) syscall(SYS_gettid);
+    if (pthread_getname_np(pthread_self(), buffer->thread_name, sizeof(buffer->thread_name)) != 0)
+    {
+        buffer->thread_name[0] = '\0';
+    }
+    buffer->generation = __atomic_load_n(&trace_rpi_generation, __ATOMIC_ACQUIRE);
+    buffer->count = 0U;
+    buffer->dropped = 0U;
+    buffer->capacity = capacity;
+
+    // Only registration takes the lock, recording itself is lock-free
+    pthread_mutex_lock(&trace_rpi_buffers_lock);
+    buffer->next = trace_rpi_buffers;
+    trace_rpi_buffers = buffer;
+    pthread_mutex_unlock(&trace_rpi_buffers_lock);
+
+    trace_rpi_thread_buffer = buffer;
+    return buffer;
+}
+
+/**
+ * \brief Records single event on calling thread.
+ *
+ * \param[in] phase Chrome trace-event phase.
+ * \param[in] name Name of the operation.
+ * \param[in] category Category of the operation.
+ * \param[in] bytes Number of bytes.
+ * \param[in] status Result of the operation.
+ * \return bool \c true if the event was recorded, \c false if it was dropped.
+ */
+bool trace_rpi_record(char phase, const char *name, const char *category, uint64_t bytes, ifx_status_t status)
+{
+    TraceRpiThreadBuffer *buffer = trace_rpi_get_thread_buffer();
+    if (buffer == NULL)
+    {
+        return false;
+    }
+    trace_rpi_sync_generation(buffer);
+
+    size_t index = __atomic_load_n(&buffer->count, __ATOMIC_RELAXED);
+    if (index >= buffer->capacity)
+    {
+        __atomic_fetch_add(&buffer->dropped, 1U, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    TraceRpiEvent *event = &buffer->events[index];
+    event->timestamp_ns = ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec;
+    event->name = name;
+    event->category = category;
+    event->bytes = bytes;
+    event->status = status;
+    event->phase = phase;
+    __atomic_store_n(&buffer->count, index + 1U, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * \brief Records begin of an operation on calling thread.
+ *
+ * \param[in] name Name of the operation (static string).
+ * \param[in] category Category of the operation (static string).
+ * \param[in] bytes Number of bytes to be transferred (\c 0 if not applicable).
+ */
+void trace_rpi_begin(const char *name, const char *category, uint64_t bytes)
+{
+    uint32_t depth = trace_rpi_thread_depth++;
+    if (depth >= TRACE_RPI_MAX_DEPTH)
+    {
+        return;
+    }
+    trace_rpi_thread_open &= ~((uint64_t) 1U << depth);
+    if (__atomic_load_n(&trace_rpi_enabled, __ATOMIC_RELAXED) && trace_rpi_record('B', name, category, bytes, IFX_SUCCESS))
+    {
+        trace_rpi_thread_open |= (uint64_t) 1U << depth;
+    }
+}
+
+/**
+ * \brief Records end of an operation on calling thread.
+ *
+ * \details End events are recorded if and only if the matching begin event
+ * was recorded, even if tracing was disabled in between, so that exported
+ * operations are always balanced.
+ *
+ * \param[in] name Name of the operation (static string, same as for trace_rpi_begin()).
+ * \param[in] category Category of the operation (static string, same as for trace_rpi_begin()).
+ * \param[in] bytes Number of bytes actually transferred (\c 0 if not applicable).
+ * \param[in] status Result of the operation.
+ */
+void trace_rpi_end(const char *name, const char *category, uint64_t bytes, ifx_status_t status)
+{
+    if (trace_rpi_thread_depth == 0U)
+    {
+        return;
+    }
+    uint32_t depth = --trace_rpi_thread_depth;
+    if (depth >= TRACE_RPI_MAX_DEPTH)
+    {
+        return;
+    }
+
+    // Close operation whose begin was recorded (unless cleared since), also if tracing was disabled in between
+    TraceRpiThreadBuffer *buffer = trace_rpi_thread_buffer;
+    if (buffer != NULL)
+    {
+        trace_rpi_sync_generation(buffer);
+    }
+    uint64_t bit = (uint64_t) 1U << depth;
+    if ((trace_rpi_thread_open & bit) != 0U)
+    {
+        trace_rpi_thread_open &= ~bit;
+        trace_rpi_record('E', name, category, bytes, status);
+    }
+}
+
+/**
+ * \brief Writes all recorded events as Chrome trace-event JSON (viewable e.g. in Perfetto).
+ *
+ * \param[in] stream Stream to write JSON to.
+ * \return ifx_status_t \c IFX_SUCCESS if successful, any other value in case of error.
+ */
+ifx_status_t trace_rpi_write_json(FILE *stream)
+{
+    // Validate parameters
+    if (stream == NULL)
+    {
+        return IFX_ERROR(LIBTRACERPI, IFX_TRACE_RPI_WRITE_JSON, IFX_ILLEGAL_ARGUMENT);
+    }
+
+    int pid = (int) getpid();
+    bool first = true;
+    fprintf(stream, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    uint64_t generation = __atomic_load_n(&trace_rpi_generation, __ATOMIC_ACQUIRE);
+    pthread_mutex_lock(&trace_rpi_buffers_lock);
+    for (TraceRpiThreadBuffer *buffer = trace_rpi_buffers; buffer != NULL; buffer = buffer->next)
+    {
+        // Events of buffers not reset since the last trace_rpi_clear() are outdated
+        bool current = (__atomic_load_n(&buffer->generation, __ATOMIC_ACQUIRE) == generation);
+
+        // Thread names are plain identifiers set via pthread_setname_np(), control characters are skipped
+        fprintf(stream, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"", first ? "" : ",", pid, (int) buffer->tid);
+        for (const char *c = buffer->thread_name; *c != '\0'; c++)
+        {
+            if ((*c == '"') || (*c == '\\'))
+            {
+                fputc('\\', stream);
+            }
+            if ((unsigned char) *c >= 0x20U)
+            {
+                fputc(*c, stream);
+            }
+        }
+        fprintf(stream, "\",\"dropped_events\":%llu}}", current ? (unsigned long long) __atomic_load_n(&buffer->dropped, __ATOMIC_RELAXED) : 0ULL);
+        first = false;
+
+        size_t count = current ? __atomic_load_n(&buffer->count, __ATOMIC_ACQUIRE) : 0U;
+        for (size_t i = 0U; i < count; i++)
+        {
+            const TraceRpiEvent *event = &buffer->events[i];
+            fprintf(stream, ",{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":%d,\"tid\":%d,\"args\":{\"bytes\":%llu",
+                    event->name, event->category, event->phase, (unsigned long long) (event->timestamp_ns / 1000U), (unsigned) (event->timestamp_ns % 1000U),
+                    pid, (int) buffer->tid, (unsigned long long) event->bytes);
+            if (event->phase == 'E')
+            {
+                fprintf(stream, ",\"status\":\"0x%08x\"", (unsigned) event->status);
+            }
+            fprintf(stream, "}}");
+        }
+    }
+    pthread_mutex_unlock(&trace_rpi_buffers_lock);
+    fprintf(stream, "]}\n");
+
+    if (ferror(stream))
+    {
+        return IFX_ERROR(LIBTRACERPI, IFX_TRACE_RPI_WRITE_JSON, IFX_UNSPECIFIED_ERROR);
+    }
+    return IFX_SUCCESS;
+}
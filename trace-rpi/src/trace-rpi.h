@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText: 2024 Infineon Technologies AG
+// SPDX-License-Identifier: MIT
+
+/**
+ * \file trace-rpi.h
+ * \brief Internal definitions for timeline tracing of NBT port activity.
+ */
+#ifndef TRACE_RPI_H
+#define TRACE_RPI_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "infineon/trace-rpi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Maximum length of thread names in [bytes] (including terminator).
+ */
+#define TRACE_RPI_THREAD_NAME_LEN 16U
+
+/**
+ * \brief Maximum nesting depth of operations per thread (deeper operations are not recorded).
+ */
+#define TRACE_RPI_MAX_DEPTH 64U
+
+/** \struct TraceRpiEvent
+ * \brief Single begin or end event.
+ */
+typedef struct
+{
+    /**
+     * \brief \c CLOCK_MONOTONIC time in [ns] of the event.
+     */
+    uint64_t timestamp_ns;
+
+    /**
+     * \brief Name of the operation.
+     */
+    const char *name;
+
+    /**
+     * \brief Category of the operation.
+     */
+    const char *category;
+
+    /**
+     * \brief Number of bytes (requested for begin, transferred for end events).
+     */
+    uint64_t bytes;
+
+    /**
+     * \brief Result of the operation (end events only).
+     */
+    ifx_status_t status;
+
+    /**
+     * \brief Chrome trace-event phase (\c 'B' or \c 'E').
+     */
+    char phase;
+} TraceRpiEvent;
+
+/** \struct TraceRpiThreadBuffer
+ * \brief Events of a single thread.
+ *
+ * \details Only the owning thread writes events. \ref TraceRpiThreadBuffer.count
+ * is published with release semantics after each event, so readers see
+ * complete events only. trace_rpi_clear() does not touch the buffer but
+ * starts a new generation; the owning thread resets its buffer before its next
+ * event and readers ignore buffers of older generations.
+ */
+typedef struct TraceRpiThreadBuffer
+{
+    /**
+     * \brief Next buffer in list of all buffers.
+     */
+    struct TraceRpiThreadBuffer *next;
+
+    /**
+     * \brief Kernel thread ID of owning thread.
+     */
+    pid_t tid;
+
+    /**
+     * \brief Name of owning thread at time of its first event.
+     */
+    char thread_name[TRACE_RPI_THREAD_NAME_LEN];
+
+    /**
+     * \brief Generation of trace_rpi_clear() the events belong to (accessed atomically).
+     */
+    uint64_t generation;
+
+    /**
+     * \brief Number of recorded events (accessed atomically).
+     */
+    size_t count;
+
+    /**
+     * \brief Number of events dropped because buffer was full (accessed atomically).
+     */
+    uint64_t dropped;
+
+    /**
+     * \brief Capacity of \ref TraceRpiThreadBuffer.events.
+     */
+    size_t capacity;
+
+    /**
+     * \brief Recorded events.
+     */
+    TraceRpiEvent events[];
+} TraceRpiThreadBuffer;
+
+/**
+ * \brief Returns buffer of calling thread, allocating it on first use.
+ *
+ * \return TraceRpiThreadBuffer* Buffer of calling thread or \c NULL if out of memory.
+ */
+TraceRpiThreadBuffer *trace_rpi_get_thread_buffer(void);
+
+/**
+ * \brief Records single event on calling thread.
+ *
+ * \param[in] phase Chrome trace-event phase.
+ * \param[in] name Name of the operation.
+ * \param[in] category Category of the operation.
+ * \param[in] bytes Number of bytes.
+ * \param[in] status Result of the operation.
+ * \return bool \c true if the event was recorded, \c false if it was dropped.
+ */
+bool trace_rpi_record(char phase, const char *name, const char *category, uint64_t bytes, ifx_status_t status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRACE_RPI_H